@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// This example steps the same scene with Step and with BeginStep and WaitStep.
+// It hashes the body transforms and the order of the contact events after each step
+// and checks that both runs are identical.
+// While a background step runs the published transforms are read and checked against
+// the transforms of the bodies at the time the step began.
+
+// Number of steps of each run.
+static const u32 e_stepCount = 300;
+
+static const scalar e_timeStep = scalar(1) / scalar(60);
+static const u32 e_velocityIterations = 8;
+static const u32 e_positionIterations = 2;
+
+// Number of published transform reads during each background step.
+static const u32 e_readCount = 16;
+
+// 64-bit FNV-1a hash.
+static u64 Hash(u64 hash, const void* data, u32 size)
+{
+	const u8* bytes = (const u8*)data;
+	for (u32 i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Hash the contact events in the order they are reported.
+class EventHasher : public b3ContactListener
+{
+public:
+	void BeginContact(b3Contact* contact) override
+	{
+		Add(1, contact);
+	}
+
+	void EndContact(b3Contact* contact) override
+	{
+		Add(2, contact);
+	}
+
+	void PreSolve(b3Contact* contact) override
+	{
+		Add(3, contact);
+	}
+
+	void Add(u32 event, b3Contact* contact)
+	{
+		// The body user data is the body number.
+		uintptr_t key[3];
+		key[0] = event;
+		key[1] = (uintptr_t)contact->GetFixtureA()->GetBody()->GetUserData();
+		key[2] = (uintptr_t)contact->GetFixtureB()->GetBody()->GetUserData();
+		m_hash = Hash(m_hash, key, sizeof(key));
+	}
+
+	u64 m_hash;
+};
+
+// A pile of spheres, capsules, and boxes falling on a mesh.
+class Scene
+{
+public:
+	Scene()
+	{
+		m_groundMesh.BuildTree();
+		m_groundMesh.BuildAdjacency();
+
+		b3BodyDef groundDef;
+		b3Body* ground = m_world.CreateBody(groundDef);
+
+		b3MeshShape groundShape;
+		groundShape.m_mesh = &m_groundMesh;
+
+		b3FixtureDef groundFixtureDef;
+		groundFixtureDef.shape = &groundShape;
+		ground->CreateFixture(groundFixtureDef);
+
+		b3SphereShape sphere;
+		sphere.m_center.SetZero();
+		sphere.m_radius = scalar(0.5);
+
+		b3CapsuleShape capsule;
+		capsule.m_vertex1.Set(scalar(0), scalar(-0.5), scalar(0));
+		capsule.m_vertex2.Set(scalar(0), scalar(0.5), scalar(0));
+		capsule.m_radius = scalar(0.5);
+
+		b3HullShape box;
+		box.m_hull = &b3BoxHull_identity;
+
+		const b3Shape* shapes[3] = { &sphere, &capsule, &box };
+
+		uintptr_t bodyNumber = 0;
+		for (u32 i = 0; i < 8; ++i)
+		{
+			for (u32 j = 0; j < 8; ++j)
+			{
+				for (u32 k = 0; k < 8; ++k)
+				{
+					b3BodyDef bodyDef;
+					bodyDef.type = e_dynamicBody;
+					bodyDef.userData = (void*)++bodyNumber;
+					bodyDef.position.Set(scalar(2.2) * scalar(i) - scalar(8), scalar(2) + scalar(2.2) * scalar(j), scalar(2.2) * scalar(k) - scalar(8));
+					bodyDef.orientation = b3QuatRotationZ(scalar(0.3) * scalar(i + j + k));
+
+					b3Body* body = m_world.CreateBody(bodyDef);
+
+					b3FixtureDef fixtureDef;
+					fixtureDef.shape = shapes[(i + j + k) % 3];
+					fixtureDef.density = scalar(1);
+					fixtureDef.friction = scalar(0.4);
+					body->CreateFixture(fixtureDef);
+				}
+			}
+		}
+
+		m_listener.m_hash = 14695981039346656037ull;
+		m_world.SetContactListener(&m_listener);
+
+		m_readCount = 0;
+		m_readMismatchCount = 0;
+	}
+
+	// Run the scene and return the hash of all steps.
+	// If async is true then step on the background thread of the world.
+	u64 Run(bool async)
+	{
+		u32 bodyCount = m_world.GetBodyList().m_count;
+		b3Transform* published = (b3Transform*)malloc(bodyCount * sizeof(b3Transform));
+
+		u64 hash = 14695981039346656037ull;
+		for (u32 i = 0; i < e_stepCount; ++i)
+		{
+			if (async)
+			{
+				// The transforms the step begins with.
+				u32 count;
+				const b3Transform* transforms = m_world.GetTransforms(&count);
+				u64 beginHash = Hash(14695981039346656037ull, transforms, count * sizeof(b3Transform));
+
+				m_world.BeginStep(e_timeStep, e_velocityIterations, e_positionIterations);
+
+				// Read the published transforms while the step runs.
+				for (u32 j = 0; j < e_readCount; ++j)
+				{
+					u32 publishedCount = m_world.GetPublishedTransforms(published, bodyCount);
+					u64 publishedHash = Hash(14695981039346656037ull, published, publishedCount * sizeof(b3Transform));
+
+					++m_readCount;
+					if (publishedCount != count || publishedHash != beginHash)
+					{
+						++m_readMismatchCount;
+					}
+				}
+
+				m_world.WaitStep();
+			}
+			else
+			{
+				m_world.Step(e_timeStep, e_velocityIterations, e_positionIterations);
+			}
+
+			for (const b3Body* b = m_world.GetBodyList().m_head; b; b = b->GetNext())
+			{
+				b3Transform xf = b->GetTransform();
+				hash = Hash(hash, &xf, sizeof(b3Transform));
+			}
+		}
+
+		free(published);
+
+		return Hash(hash, &m_listener.m_hash, sizeof(u64));
+	}
+
+	// Number of published transform reads and the reads that didn't match.
+	u32 m_readCount;
+	u32 m_readMismatchCount;
+private:
+	b3GridMesh<20, 20> m_groundMesh;
+	EventHasher m_listener;
+	b3World m_world;
+};
+
+int main(int argc, char** argv)
+{
+	// The reference run uses Step.
+	Scene* reference = new Scene();
+
+	b3Time referenceTime;
+	u64 referenceHash = reference->Run(false);
+	referenceTime.Update();
+
+	delete reference;
+
+	printf("Step: hash %016llx, %.2f ms\n", (unsigned long long)referenceHash, referenceTime.GetCurrentMilis());
+
+	Scene* scene = new Scene();
+
+	b3Time time;
+	u64 hash = scene->Run(true);
+	time.Update();
+
+	u32 readCount = scene->m_readCount;
+	u32 readMismatchCount = scene->m_readMismatchCount;
+
+	delete scene;
+
+	bool match = hash == referenceHash;
+
+	printf("BeginStep: hash %016llx, %.2f ms, %s\n", (unsigned long long)hash, time.GetCurrentMilis(), match ? "match" : "MISMATCH");
+	printf("Published transform reads %d, %s\n", readCount, readMismatchCount == 0 ? "match" : "MISMATCH");
+
+	return match && readMismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// This example creates the same grid of bodies once with CreateBody and once with 
+// a bulk load, checks the broad-phase trees, and checks that both worlds find 
+// the same contacts.
+
+// Number of bodies along each axis.
+static const u32 e_gridSize = 24;
+
+static const u32 e_bodyCount = e_gridSize * e_gridSize * e_gridSize;
+
+// Result of a run.
+struct Result
+{
+	double createTime;
+	double stepTime;
+	u32 treeHeight;
+	u32 treeNodeCount;
+	u32 contactCount;
+	u32 overlappingCount;
+};
+
+static void CreateDefs(b3BodyDef* bodyDefs, b3FixtureDef* fixtureDefs, const b3Shape* shape)
+{
+	u32 index = 0;
+	for (u32 i = 0; i < e_gridSize; ++i)
+	{
+		for (u32 j = 0; j < e_gridSize; ++j)
+		{
+			for (u32 k = 0; k < e_gridSize; ++k)
+			{
+				b3BodyDef& bodyDef = bodyDefs[index];
+				bodyDef.type = e_dynamicBody;
+				
+				// Neighbours overlap slightly along the x axis.
+				bodyDef.position.Set(scalar(0.95) * scalar(i), scalar(1.5) * scalar(j), scalar(1.5) * scalar(k));
+
+				b3FixtureDef& fixtureDef = fixtureDefs[index];
+				fixtureDef.shape = shape;
+				fixtureDef.density = scalar(1);
+
+				++index;
+			}
+		}
+	}
+}
+
+static void Run(Result* result, bool bulkLoad, const b3BodyDef* bodyDefs, const b3FixtureDef* fixtureDefs)
+{
+	b3World* world = new b3World();
+
+	b3Time createTime;
+	if (bulkLoad)
+	{
+		b3Body** bodies = (b3Body**)malloc(e_bodyCount * sizeof(b3Body*));
+		
+		world->CreateBodies(bodyDefs, fixtureDefs, e_bodyCount, bodies);
+		
+		free(bodies);
+	}
+	else
+	{
+		for (u32 i = 0; i < e_bodyCount; ++i)
+		{
+			b3Body* body = world->CreateBody(bodyDefs[i]);
+			body->CreateFixture(fixtureDefs[i]);
+		}
+	}
+	createTime.Update();
+
+	const b3DynamicTree& tree = world->GetBroadPhase().GetTree();
+	// This asserts on a broken tree in debug builds.
+	tree.Validate();
+
+	// A step without time updates the contacts. 
+	// The contacts of the bodies created with CreateBody are found here, 
+	// while EndBulkLoad finds them in a single pass.
+	b3Time stepTime;
+	world->Step(scalar(0), 8, 2);
+	stepTime.Update();
+
+	result->createTime = createTime.GetCurrentMilis();
+	result->stepTime = stepTime.GetCurrentMilis();
+	result->treeHeight = tree.GetHeight();
+	result->treeNodeCount = tree.GetNodeCount();
+	result->contactCount = world->GetContactList().m_count;
+	result->overlappingCount = 0;
+	for (b3Contact* c = world->GetContactList().m_head; c; c = c->GetNext())
+	{
+		if (c->IsOverlapping())
+		{
+			++result->overlappingCount;
+		}
+	}
+
+	delete world;
+}
+
+int main(int argc, char** argv)
+{
+	b3SphereShape sphere;
+	sphere.m_center.SetZero();
+	sphere.m_radius = scalar(0.5);
+
+	b3BodyDef* bodyDefs = new b3BodyDef[e_bodyCount];
+	b3FixtureDef* fixtureDefs = new b3FixtureDef[e_bodyCount];
+	CreateDefs(bodyDefs, fixtureDefs, &sphere);
+
+	Result incremental, bulk;
+	Run(&incremental, false, bodyDefs, fixtureDefs);
+	Run(&bulk, true, bodyDefs, fixtureDefs);
+
+	delete[] bodyDefs;
+	delete[] fixtureDefs;
+
+	printf("%d bodies\n", e_bodyCount);
+	printf("CreateBody: create %.2f ms, first step %.2f ms, total %.2f ms, tree height %d, nodes %d, contacts %d, overlapping %d\n", 
+		incremental.createTime, incremental.stepTime, incremental.createTime + incremental.stepTime, incremental.treeHeight, incremental.treeNodeCount, incremental.contactCount, incremental.overlappingCount);
+	printf("bulk load:  create %.2f ms, first step %.2f ms, total %.2f ms, tree height %d, nodes %d, contacts %d, overlapping %d\n", 
+		bulk.createTime, bulk.stepTime, bulk.createTime + bulk.stepTime, bulk.treeHeight, bulk.treeNodeCount, bulk.contactCount, bulk.overlappingCount);
+
+	bool match = incremental.contactCount == bulk.contactCount && incremental.overlappingCount == bulk.overlappingCount && 
+		incremental.treeNodeCount == bulk.treeNodeCount;
+	
+	printf("%s\n", match ? "match" : "MISMATCH");
+
+	return match ? 0 : 1;
+}
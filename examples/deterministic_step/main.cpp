@@ -0,0 +1,204 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// This example steps the same scene without a thread pool and with thread pools 
+// of different sizes. It hashes the body transforms and the order of the contact 
+// events after each step and checks that all the runs are identical.
+
+// Number of steps of each run.
+static const u32 e_stepCount = 300;
+
+static const scalar e_timeStep = scalar(1) / scalar(60);
+static const u32 e_velocityIterations = 8;
+static const u32 e_positionIterations = 2;
+
+// 64-bit FNV-1a hash.
+static u64 Hash(u64 hash, const void* data, u32 size)
+{
+	const u8* bytes = (const u8*)data;
+	for (u32 i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Hash the contact events in the order they are reported.
+class EventHasher : public b3ContactListener
+{
+public:
+	void BeginContact(b3Contact* contact) override
+	{
+		Add(1, contact);
+	}
+
+	void EndContact(b3Contact* contact) override
+	{
+		Add(2, contact);
+	}
+
+	void PreSolve(b3Contact* contact) override
+	{
+		Add(3, contact);
+	}
+
+	void Add(u32 event, b3Contact* contact)
+	{
+		// The body user data is the body number.
+		uintptr_t key[3];
+		key[0] = event;
+		key[1] = (uintptr_t)contact->GetFixtureA()->GetBody()->GetUserData();
+		key[2] = (uintptr_t)contact->GetFixtureB()->GetBody()->GetUserData();
+		m_hash = Hash(m_hash, key, sizeof(key));
+	}
+
+	u64 m_hash;
+};
+
+// A pile of spheres, capsules, and boxes falling on a mesh.
+class Scene
+{
+public:
+	Scene()
+	{
+		m_groundMesh.BuildTree();
+		m_groundMesh.BuildAdjacency();
+
+		b3BodyDef groundDef;
+		b3Body* ground = m_world.CreateBody(groundDef);
+
+		b3MeshShape groundShape;
+		groundShape.m_mesh = &m_groundMesh;
+
+		b3FixtureDef groundFixtureDef;
+		groundFixtureDef.shape = &groundShape;
+		ground->CreateFixture(groundFixtureDef);
+
+		b3SphereShape sphere;
+		sphere.m_center.SetZero();
+		sphere.m_radius = scalar(0.5);
+
+		b3CapsuleShape capsule;
+		capsule.m_vertex1.Set(scalar(0), scalar(-0.5), scalar(0));
+		capsule.m_vertex2.Set(scalar(0), scalar(0.5), scalar(0));
+		capsule.m_radius = scalar(0.5);
+
+		b3HullShape box;
+		box.m_hull = &b3BoxHull_identity;
+
+		const b3Shape* shapes[3] = { &sphere, &capsule, &box };
+
+		uintptr_t bodyNumber = 0;
+		for (u32 i = 0; i < 8; ++i)
+		{
+			for (u32 j = 0; j < 8; ++j)
+			{
+				for (u32 k = 0; k < 8; ++k)
+				{
+					b3BodyDef bodyDef;
+					bodyDef.type = e_dynamicBody;
+					bodyDef.userData = (void*)++bodyNumber;
+					bodyDef.position.Set(scalar(2.2) * scalar(i) - scalar(8), scalar(2) + scalar(2.2) * scalar(j), scalar(2.2) * scalar(k) - scalar(8));
+					bodyDef.orientation = b3QuatRotationZ(scalar(0.3) * scalar(i + j + k));
+					
+					b3Body* body = m_world.CreateBody(bodyDef);
+
+					b3FixtureDef fixtureDef;
+					fixtureDef.shape = shapes[(i + j + k) % 3];
+					fixtureDef.density = scalar(1);
+					fixtureDef.friction = scalar(0.4);
+					body->CreateFixture(fixtureDef);
+				}
+			}
+		}
+
+		m_listener.m_hash = 14695981039346656037ull;
+		m_world.SetContactListener(&m_listener);
+	}
+
+	// Run the scene and return the hash of all steps.
+	u64 Run(b3ThreadPool* pool)
+	{
+		m_world.SetThreadPool(pool);
+
+		u64 hash = 14695981039346656037ull;
+		for (u32 i = 0; i < e_stepCount; ++i)
+		{
+			m_world.Step(e_timeStep, e_velocityIterations, e_positionIterations);
+
+			for (const b3Body* b = m_world.GetBodyList().m_head; b; b = b->GetNext())
+			{
+				b3Transform xf = b->GetTransform();
+				hash = Hash(hash, &xf, sizeof(b3Transform));
+			}
+		}
+
+		return Hash(hash, &m_listener.m_hash, sizeof(u64));
+	}
+private:
+	b3GridMesh<20, 20> m_groundMesh;
+	EventHasher m_listener;
+	b3World m_world;
+};
+
+int main(int argc, char** argv)
+{
+	// The reference run doesn't use a thread pool.
+	Scene* reference = new Scene();
+	
+	b3Time referenceTime;
+	u64 referenceHash = reference->Run(nullptr);
+	referenceTime.Update();
+	
+	delete reference;
+
+	printf("no pool: hash %016llx, %.2f ms\n", (unsigned long long)referenceHash, referenceTime.GetCurrentMilis());
+
+	const u32 threadCounts[] = { 1, 2, 3, 4, 8 };
+
+	u32 mismatchCount = 0;
+	for (u32 i = 0; i < sizeof(threadCounts) / sizeof(u32); ++i)
+	{
+		b3ThreadPool pool(threadCounts[i]);
+		
+		Scene* scene = new Scene();
+		
+		b3Time time;
+		u64 hash = scene->Run(&pool);
+		time.Update();
+		
+		delete scene;
+
+		bool match = hash == referenceHash;
+		if (match == false)
+		{
+			++mismatchCount;
+		}
+
+		printf("%d threads: hash %016llx, %.2f ms, %s\n", threadCounts[i], (unsigned long long)hash, time.GetCurrentMilis(), match ? "match" : "MISMATCH");
+	}
+
+	return mismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+// This example steps many independent worlds on a pool of threads, 
+// like a server hosting many small game rooms, and checks that the results 
+// are exactly the same as stepping the worlds one after the other.
+
+// Number of worlds.
+static const u32 e_worldCount = 64;
+
+// Number of steps of each world.
+static const u32 e_stepCount = 240;
+
+static const scalar e_timeStep = scalar(1) / scalar(60);
+static const u32 e_velocityIterations = 8;
+static const u32 e_positionIterations = 2;
+
+// A small game room. The scene depends on the room index.
+class Room
+{
+public:
+	Room(u32 index)
+	{
+		m_groundBox.SetExtents(scalar(20), scalar(1), scalar(20));
+		m_box.SetIdentity();
+
+		b3BodyDef groundDef;
+		b3Body* ground = m_world.CreateBody(groundDef);
+
+		b3HullShape groundShape;
+		groundShape.m_hull = &m_groundBox;
+
+		b3FixtureDef groundFixtureDef;
+		groundFixtureDef.shape = &groundShape;
+		ground->CreateFixture(groundFixtureDef);
+
+		b3HullShape boxShape;
+		boxShape.m_hull = &m_box;
+
+		b3SphereShape sphereShape;
+		sphereShape.m_center.SetZero();
+		sphereShape.m_radius = scalar(0.5);
+
+		// Vary the stack height and the shape mix between the rooms.
+		u32 height = 4 + index % 5;
+		for (u32 i = 0; i < height; ++i)
+		{
+			for (u32 j = 0; j < 3; ++j)
+			{
+				b3BodyDef bodyDef;
+				bodyDef.type = e_dynamicBody;
+				bodyDef.position.Set(scalar(2.1) * scalar(j) - scalar(2.1), scalar(2) + scalar(2.05) * scalar(i), scalar(0.1) * scalar(index % 3));
+				bodyDef.angularVelocity.Set(scalar(0), scalar(0.1) * scalar(index % 7), scalar(0));
+
+				b3Body* body = m_world.CreateBody(bodyDef);
+
+				b3FixtureDef fixtureDef;
+				fixtureDef.density = scalar(1);
+				fixtureDef.friction = scalar(0.5);
+				
+				if ((i + j + index) % 4 == 0)
+				{
+					fixtureDef.shape = &sphereShape;
+				}
+				else
+				{
+					fixtureDef.shape = &boxShape;
+				}
+
+				body->CreateFixture(fixtureDef);
+			}
+		}
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < e_stepCount; ++i)
+		{
+			m_world.Step(e_timeStep, e_velocityIterations, e_positionIterations);
+		}
+	}
+
+	// Compare the body transforms and the step statistics with another room.
+	bool IsEqual(const Room& other) const
+	{
+		const b3Body* b1 = m_world.GetBodyList().m_head;
+		const b3Body* b2 = other.m_world.GetBodyList().m_head;
+		for (; b1 && b2; b1 = b1->GetNext(), b2 = b2->GetNext())
+		{
+			b3Transform xf1 = b1->GetTransform();
+			b3Transform xf2 = b2->GetTransform();
+			if (memcmp(&xf1, &xf2, sizeof(b3Transform)) != 0)
+			{
+				return false;
+			}
+		}
+
+		if (b1 != nullptr || b2 != nullptr)
+		{
+			return false;
+		}
+
+		const b3StepStats& stats1 = m_world.GetStepStats();
+		const b3StepStats& stats2 = other.m_world.GetStepStats();
+		return memcmp(&stats1, &stats2, sizeof(b3StepStats)) == 0;
+	}
+private:
+	b3BoxHull m_groundBox;
+	b3BoxHull m_box;
+	b3World m_world;
+};
+
+int main(int argc, char** argv)
+{
+	// The number of threads can be passed in the command line.
+	u32 threadCount = std::thread::hardware_concurrency();
+	if (argc > 1)
+	{
+		threadCount = atoi(argv[1]);
+	}
+	
+	if (threadCount == 0)
+	{
+		threadCount = 4;
+	}
+
+	// Step the rooms one after the other.
+	std::vector<Room*> serialRooms;
+	for (u32 i = 0; i < e_worldCount; ++i)
+	{
+		serialRooms.push_back(new Room(i));
+	}
+	
+	b3Time serialTime;
+	for (u32 i = 0; i < e_worldCount; ++i)
+	{
+		serialRooms[i]->Run();
+	}
+	serialTime.Update();
+
+	// Create and step the rooms concurrently.
+	// Each thread takes the next room until all rooms are done.
+	std::vector<Room*> rooms(e_worldCount);
+	std::atomic<u32> nextRoom(0);
+	
+	b3Time concurrentTime;
+	std::vector<std::thread> threads;
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		threads.push_back(std::thread([&rooms, &nextRoom]()
+		{
+			for (;;)
+			{
+				u32 index = nextRoom.fetch_add(1);
+				if (index >= e_worldCount)
+				{
+					break;
+				}
+				
+				rooms[index] = new Room(index);
+				rooms[index]->Run();
+			}
+		}));
+	}
+
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		threads[i].join();
+	}
+	concurrentTime.Update();
+
+	u32 mismatchCount = 0;
+	for (u32 i = 0; i < e_worldCount; ++i)
+	{
+		if (rooms[i]->IsEqual(*serialRooms[i]) == false)
+		{
+			printf("World %d differs from the serial run.\n", i);
+			++mismatchCount;
+		}
+	}
+
+	printf("%d worlds, %d steps, %d threads\n", e_worldCount, e_stepCount, threadCount);
+	printf("serial %.2f ms, concurrent %.2f ms (including creation)\n", serialTime.GetCurrentMilis(), concurrentTime.GetCurrentMilis());
+	printf("%d mismatches\n", mismatchCount);
+
+	for (u32 i = 0; i < e_worldCount; ++i)
+	{
+		delete rooms[i];
+		delete serialRooms[i];
+	}
+
+	return mismatchCount == 0 ? 0 : 1;
+}
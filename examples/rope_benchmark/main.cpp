@@ -0,0 +1,176 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/rope/rope_system.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// This example steps many hanging ropes, like cables or hair strands, 
+// once by looping over b3Rope::Step and once with a b3RopeSystem, 
+// and checks that the results agree.
+
+// Number of ropes.
+static const u32 e_ropeCount = 2048;
+
+// Number of steps.
+static const u32 e_stepCount = 120;
+
+static const scalar e_timeStep = scalar(1) / scalar(60);
+
+// The link count and the shape depend on the rope index.
+static void CreateRopeDef(u32 index, b3Vec3* vertices, scalar* masses, b3RopeDef* def)
+{
+	u32 count = 8 + index % 9;
+
+	scalar x = scalar(index % 64);
+	scalar z = scalar(index / 64);
+
+	vertices[0].Set(x, scalar(0), z);
+	masses[0] = scalar(0);
+
+	for (u32 i = 1; i < count; ++i)
+	{
+		vertices[i].Set(x + scalar(0.5) * scalar(i), scalar(-0.1) * scalar(index % 5) * scalar(i), z);
+		masses[i] = scalar(1);
+	}
+
+	def->count = count;
+	def->vertices = vertices;
+	def->masses = masses;
+	def->linearDamping = scalar(0.1);
+	def->angularDamping = scalar(0.1);
+}
+
+// The system uses specialized formulas for rope joints, 
+// so it agrees with b3Rope up to round-off.
+static const scalar e_tolerance = scalar(1.0e-3);
+
+int main(int argc, char** argv)
+{
+	// The number of threads can be passed in the command line.
+	u32 threadCount = std::thread::hardware_concurrency();
+	if (argc > 1)
+	{
+		threadCount = atoi(argv[1]);
+	}
+	
+	if (threadCount == 0)
+	{
+		threadCount = 4;
+	}
+
+	b3Vec3 gravity(scalar(0), scalar(-10), scalar(0));
+
+	std::vector<b3Vec3> vertices(16 * e_ropeCount);
+	std::vector<scalar> masses(16 * e_ropeCount);
+	std::vector<b3RopeDef> defs(e_ropeCount);
+	for (u32 i = 0; i < e_ropeCount; ++i)
+	{
+		CreateRopeDef(i, vertices.data() + 16 * i, masses.data() + 16 * i, &defs[i]);
+	}
+
+	std::vector<b3Rope*> ropes(e_ropeCount);
+	for (u32 i = 0; i < e_ropeCount; ++i)
+	{
+		ropes[i] = new b3Rope(defs[i]);
+		ropes[i]->SetGravity(gravity);
+	}
+
+	b3RopeSystemDef systemDef;
+	systemDef.ropeCount = e_ropeCount;
+	systemDef.ropes = defs.data();
+
+	b3RopeSystem serialSystem(systemDef);
+	serialSystem.SetGravity(gravity);
+
+	b3RopeSystem parallelSystem(systemDef);
+	parallelSystem.SetGravity(gravity);
+
+	b3ThreadPool threadPool(threadCount);
+	parallelSystem.SetThreadPool(&threadPool);
+
+	// Step the ropes one after the other.
+	b3Time ropeTime;
+	for (u32 step = 0; step < e_stepCount; ++step)
+	{
+		for (u32 i = 0; i < e_ropeCount; ++i)
+		{
+			ropes[i]->Step(e_timeStep);
+		}
+	}
+	ropeTime.Update();
+
+	b3Time serialTime;
+	for (u32 step = 0; step < e_stepCount; ++step)
+	{
+		serialSystem.Step(e_timeStep);
+	}
+	serialTime.Update();
+
+	b3Time parallelTime;
+	for (u32 step = 0; step < e_stepCount; ++step)
+	{
+		parallelSystem.Step(e_timeStep);
+	}
+	parallelTime.Update();
+
+	// The threads must not change the results.
+	u32 mismatchCount = 0;
+	scalar maxDistance = scalar(0);
+	for (u32 i = 0; i < e_ropeCount; ++i)
+	{
+		bool mismatch = false;
+		for (u32 j = 0; j < ropes[i]->GetLinkCount(); ++j)
+		{
+			b3Transform xf = ropes[i]->GetLinkTransform(j);
+			b3Transform xf1 = serialSystem.GetLinkTransform(i, j);
+			b3Transform xf2 = parallelSystem.GetLinkTransform(i, j);
+			
+			scalar distance = b3Length(xf1.translation - xf.translation);
+			maxDistance = b3Max(maxDistance, distance);
+
+			if (distance > e_tolerance || memcmp(&xf1, &xf2, sizeof(b3Transform)) != 0)
+			{
+				mismatch = true;
+			}
+		}
+
+		if (mismatch)
+		{
+			printf("Rope %d differs.\n", i);
+			++mismatchCount;
+		}
+	}
+
+	printf("%d ropes, %d steps, %d threads\n", e_ropeCount, e_stepCount, threadCount);
+	printf("b3Rope %.2f ms, b3RopeSystem %.2f ms, b3RopeSystem with threads %.2f ms\n", 
+		ropeTime.GetCurrentMilis(), serialTime.GetCurrentMilis(), parallelTime.GetCurrentMilis());
+	printf("maximum distance to b3Rope %g m, %d mismatches\n", maxDistance, mismatchCount);
+
+	for (u32 i = 0; i < e_ropeCount; ++i)
+	{
+		delete ropes[i];
+	}
+
+	return mismatchCount == 0 ? 0 : 1;
+}
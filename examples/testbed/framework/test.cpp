@@ -23,11 +23,6 @@ extern "C"
 #include <quickhull/quickhull.h>
 }
 
-extern u32 b3_allocCalls, b3_maxAllocCalls;
-extern u32 b3_convexCalls, b3_convexCacheHits;
-extern u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters;
-extern bool b3_convexCache;
-
 float RandomFloat(float a, float b)
 {
 	float r = float(rand()) / float(RAND_MAX);
@@ -112,16 +107,23 @@ Test::Test() :
 	m_groundMesh.BuildTree();
 	m_groundMesh.BuildAdjacency();
 
-	b3_convexCache = g_testSettings->convexCache;
+	m_world.SetConvexCache(g_testSettings->convexCache);
 }
 
 void Test::Step()
 {
-	b3_convexCache = g_testSettings->convexCache;
-
 	// Step
+	m_world.SetConvexCache(g_testSettings->convexCache);
+	m_world.SetContactReuse(g_testSettings->contactReuse);
 	m_world.SetSleeping(g_testSettings->sleep);
 	m_world.SetWarmStart(g_testSettings->warmStart);
+	m_world.SetBlockSolve(g_testSettings->blockSolve);
+	m_world.SetSplitImpulse(g_testSettings->splitImpulse);
+	m_world.SetContinuousPhysics(g_testSettings->continuousPhysics);
+	m_world.SetSpeculativeContacts(g_testSettings->speculativeContacts);
+	m_world.SetJointBatching(g_testSettings->jointBatching);
+	m_world.SetImpulseTolerance(g_testSettings->impulseTolerance);
+	m_world.SetSubStepCount(g_testSettings->subStepCount);
 	m_world.Step(g_testSettings->inv_hertz, g_testSettings->velocityIterations, g_testSettings->positionIterations);
 
 	// Draw
@@ -154,24 +156,57 @@ void Test::Step()
 		DrawString(b3Color_white, "Joints %d", m_world.GetJointList().m_count);
 		DrawString(b3Color_white, "Contacts %d", m_world.GetContactList().m_count);
 
+		const b3StepStats& stepStats = m_world.GetStepStats();
+
 		scalar avgGjkIters = 0.0f;
-		if (b3_gjkCalls > 0)
+		if (stepStats.gjkCalls > 0)
 		{
-			avgGjkIters = scalar(b3_gjkIters) / scalar(b3_gjkCalls);
+			avgGjkIters = scalar(stepStats.gjkIters) / scalar(stepStats.gjkCalls);
 		}
 
-		DrawString(b3Color_white, "GJK Calls %d", b3_gjkCalls);
-		DrawString(b3Color_white, "GJK Iterations %d (%d) (%f)", b3_gjkIters, b3_gjkMaxIters, avgGjkIters);
+		DrawString(b3Color_white, "GJK Calls %d", stepStats.gjkCalls);
+		DrawString(b3Color_white, "GJK Iterations %d (%d) (%f)", stepStats.gjkIters, stepStats.gjkMaxIters, avgGjkIters);
 
 		scalar convexCacheHitRatio = 0.0f;
-		if (b3_convexCalls > 0)
+		if (stepStats.convexCalls > 0)
+		{
+			convexCacheHitRatio = scalar(stepStats.convexCacheHits) / scalar(stepStats.convexCalls);
+		}
+
+		DrawString(b3Color_white, "Convex Calls %d", stepStats.convexCalls);
+		DrawString(b3Color_white, "Convex Cache Hits %d (%f)", stepStats.convexCacheHits, convexCacheHitRatio);
+
+		scalar contactReuseRatio = 0.0f;
+		if (stepStats.contactUpdates > 0)
 		{
-			convexCacheHitRatio = scalar(b3_convexCacheHits) / scalar(b3_convexCalls);
+			contactReuseRatio = scalar(stepStats.contactReuses) / scalar(stepStats.contactUpdates);
 		}
 
-		DrawString(b3Color_white, "Convex Calls %d", b3_convexCalls);
-		DrawString(b3Color_white, "Convex Cache Hits %d (%f)", b3_convexCacheHits, convexCacheHitRatio);
-		DrawString(b3Color_white, "Frame Allocations %d (%d)", b3_allocCalls, b3_maxAllocCalls);
+		DrawString(b3Color_white, "Contact Updates %d", stepStats.contactUpdates);
+		DrawString(b3Color_white, "Contact Reuses %d (%f)", stepStats.contactReuses, contactReuseRatio);
+		DrawString(b3Color_white, "Frame Allocations %d (%d)", stepStats.allocCalls, stepStats.maxAllocCalls);
+
+		scalar avgVelocityIters = 0.0f;
+		if (stepStats.islandCount > 0)
+		{
+			avgVelocityIters = scalar(stepStats.velocityIters) / scalar(stepStats.islandCount);
+		}
+
+		DrawString(b3Color_white, "Islands %d", stepStats.islandCount);
+		DrawString(b3Color_white, "Velocity Iterations %d (%d) (%f)", stepStats.velocityIters, stepStats.maxVelocityIters, avgVelocityIters);
+
+		b3StackAllocatorStats stackStats;
+		m_world.GetStackStats(&stackStats);
+
+		DrawString(b3Color_white, "Stack Memory %d KiB (%d KiB) (%d KiB)", stackStats.allocatedSize / 1024, stackStats.maxAllocatedSize / 1024, stackStats.capacity / 1024);
+		DrawString(b3Color_white, "Stack Parent Allocations %d", stackStats.parentAllocationCount);
+
+		b3WorldMemoryStats memoryStats;
+		m_world.GetMemoryStats(&memoryStats);
+
+		DrawString(b3Color_white, "World Memory %d KiB", memoryStats.totalSize / 1024);
+		DrawString(b3Color_white, "Contact Memory %d KiB (%d KiB)", memoryStats.contactSize / 1024, memoryStats.contactCacheSize / 1024);
+		DrawString(b3Color_white, "Tree Nodes %d (%d)", memoryStats.treeNodeCount, memoryStats.treeNodeCapacity);
 	}
 }
 
@@ -253,7 +253,7 @@ void View::Interface()
 
 	if (ImGui::BeginPopupModal("About Bounce Testbed", NULL, ImGuiWindowFlags_Popup | ImGuiWindowFlags_NoResize))
 	{
-		extern b3Version b3_version;
+		extern const b3Version b3_version;
 
 		ImGui::Text("Bounce Testbed");
 		ImGui::Text("Version %d.%d.%d", b3_version.major, b3_version.minor, b3_version.revision);
@@ -341,9 +341,21 @@ void View::Interface()
 	ImGui::Text("Position Iterations");
 	ImGui::SliderInt("##Position Iterations", &testSettings.positionIterations, 0, 50);
 
+	ImGui::Text("Impulse Tolerance");
+	ImGui::SliderFloat("##Impulse Tolerance", &testSettings.impulseTolerance, 0.0f, 0.1f, "%.4f");
+
+	ImGui::Text("Sub-Steps");
+	ImGui::SliderInt("##Sub-Steps", &testSettings.subStepCount, 0, 16);
+
 	ImGui::Checkbox("Sleep", &testSettings.sleep);
 	ImGui::Checkbox("Convex Cache", &testSettings.convexCache);
+	ImGui::Checkbox("Contact Reuse", &testSettings.contactReuse);
 	ImGui::Checkbox("Warm Start", &testSettings.warmStart);
+	ImGui::Checkbox("Block Solve", &testSettings.blockSolve);
+	ImGui::Checkbox("Split Impulse", &testSettings.splitImpulse);
+	ImGui::Checkbox("Continuous", &testSettings.continuousPhysics);
+	ImGui::Checkbox("Speculative", &testSettings.speculativeContacts);
+	ImGui::Checkbox("Joint Batching", &testSettings.jointBatching);
 
 	if (ImGui::Button("Play/Pause", buttonSize))
 	{
@@ -40,6 +40,7 @@
 #include "tests/capsule_spin.h"
 #include "tests/quadric_shapes.h"
 #include "tests/compound_body.h"
+#include "tests/compound_shape_test.h"
 #include "tests/spring_test.h"
 #include "tests/motor_test.h"
 #include "tests/weld_test.h"
@@ -48,9 +49,11 @@
 #include "tests/prismatic_test.h"
 #include "tests/wheel_test.h"
 #include "tests/hinge_chain.h"
+#include "tests/articulated_chain.h"
 #include "tests/newton_cradle.h"
 #include "tests/ragdoll.h"
 #include "tests/mesh_contact_test.h"
+#include "tests/height_field_test.h"
 #include "tests/triangle_contact_test.h"
 #include "tests/hull_contact_test.h"
 #include "tests/sphere_stack.h"
@@ -71,6 +74,8 @@
 #include "tests/multiple_pendulum.h"
 #include "tests/conveyor_belt.h"
 #include "tests/rope_test.h"
+#include "tests/rope_system_test.h"
+#include "tests/bullet_test.h"
 
 TestSettings* g_testSettings = nullptr;
 Settings* g_settings = nullptr;
@@ -115,10 +120,12 @@ ViewModel::ViewModel(Model* model, GLFWwindow* window)
 	m_settings.RegisterTest("Hull Contact Test", &HullContactTest::Create );
 	m_settings.RegisterTest("Triangle Contact Test", &TriangleContactTest::Create );
 	m_settings.RegisterTest("Mesh Contact Test", &MeshContactTest::Create );
+	m_settings.RegisterTest("Height Field Test", &HeightFieldTest::Create );
 	m_settings.RegisterTest("Linear Motion", &LinearMotion::Create );
 	m_settings.RegisterTest("Angular Motion", &AngularMotion::Create );
 	m_settings.RegisterTest("Gyroscopic Motion", &GyroMotion::Create );
 	m_settings.RegisterTest("Compound Body", &CompoundBody::Create );
+	m_settings.RegisterTest("Compound Shape Test", &CompoundShapeTest::Create );
 	m_settings.RegisterTest("Quadric Shapes", &QuadricShapes::Create );
 	m_settings.RegisterTest("Spring Test", &SpringTest::Create );
 	m_settings.RegisterTest("Prismatic Test", &PrismaticTest::Create );
@@ -128,6 +135,7 @@ ViewModel::ViewModel(Model* model, GLFWwindow* window)
 	m_settings.RegisterTest("Motor Test", &MotorTest::Create );
 	m_settings.RegisterTest("Revolute Test", &RevoluteTest::Create );
 	m_settings.RegisterTest("Hinge Chain", &HingeChain::Create );
+	m_settings.RegisterTest("Articulated Chain", &ArticulatedChain::Create );
 	m_settings.RegisterTest("Ragdoll", &Ragdoll::Create );
 	m_settings.RegisterTest("Newton's Cradle", &NewtonCradle::Create );
 	m_settings.RegisterTest("Sphere Stack", &SphereStack::Create );
@@ -149,6 +157,8 @@ ViewModel::ViewModel(Model* model, GLFWwindow* window)
 	m_settings.RegisterTest("Multiple Pendulum", &MultiplePendulum::Create );
 	m_settings.RegisterTest("Conveyor Belt", &ConveyorBelt::Create );
 	m_settings.RegisterTest("Rope", &Rope::Create);
+	m_settings.RegisterTest("Rope System", &RopeSystemTest::Create);
+	m_settings.RegisterTest("Bullet Test", &BulletTest::Create);
 
 	g_settings = &m_settings;
 	g_testSettings = &m_testSettings;
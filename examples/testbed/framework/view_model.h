@@ -64,9 +64,17 @@ struct TestSettings
 		inv_hertz = 1.0f / hertz;
 		velocityIterations = 8;
 		positionIterations = 2;
+		subStepCount = 0;
+		impulseTolerance = 0.0f;
 		sleep = false;
 		warmStart = true;
 		convexCache = true;
+		contactReuse = true;
+		blockSolve = false;
+		splitImpulse = false;
+		continuousPhysics = false;
+		speculativeContacts = false;
+		jointBatching = false;
 		drawCenterOfMasses = true;
 		drawShapes = true;
 		drawBounds = false;
@@ -82,9 +90,17 @@ struct TestSettings
 	float hertz, inv_hertz;
 	int velocityIterations;
 	int positionIterations;
+	int subStepCount;
+	float impulseTolerance;
 	bool sleep;
 	bool warmStart;
 	bool convexCache;
+	bool contactReuse;
+	bool blockSolve;
+	bool splitImpulse;
+	bool continuousPhysics;
+	bool speculativeContacts;
+	bool jointBatching;
 
 	bool drawCenterOfMasses;
 	bool drawBounds;
@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef ARTICULATED_CHAIN_H
+#define ARTICULATED_CHAIN_H
+
+// The chain of the hinge chain test simulated as an articulation.
+// The joints never separate, so there is no joint error to measure.
+class ArticulatedChain : public Test
+{
+public:
+	enum
+	{
+		e_count = 20
+	};
+
+	ArticulatedChain()
+	{
+		{
+			b3BodyDef bd;
+			b3Body* ground = m_world.CreateBody(bd);
+
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
+
+			b3FixtureDef fd;
+			fd.shape = &hs;
+			fd.friction = 1.0f;
+
+			ground->CreateFixture(fd);
+		}
+
+		static b3BoxHull box(2.0f, 4.0f, 0.5f);
+
+		scalar x = -50.0f;
+		scalar y = 50.0f;
+
+		b3ArticulationLinkDef links[e_count + 1];
+
+		for (u32 i = 0; i < e_count + 1; ++i)
+		{
+			b3BodyDef bd;
+			bd.type = e_dynamicBody;
+			bd.position.Set(x, y, 0.0f);
+			b3Body* body = m_world.CreateBody(bd);
+
+			b3HullShape hull;
+			hull.m_hull = &box;
+
+			b3FixtureDef fd;
+			fd.shape = &hull;
+			fd.density = 1.0f;
+			fd.friction = 0.5f;
+
+			body->CreateFixture(fd);
+
+			if (i == 0)
+			{
+				links[i].body = body;
+			}
+			else
+			{
+				b3Vec3 hingeAxis(0.0f, 1.0f, 0.0f);
+				b3Vec3 hingeAnchor(x - 2.25f, y, 0.0f);
+
+				links[i].Initialize(body, i - 1, e_revoluteArticulationJoint, hingeAnchor, hingeAxis);
+				links[i].enableLimit = true;
+				links[i].lowerLimit = 0.0f;
+				links[i].upperLimit = 0.5f * B3_PI;
+			}
+
+			x += 4.25f;
+		}
+
+		b3ArticulationDef ad;
+		ad.linkCount = e_count + 1;
+		ad.links = links;
+		ad.fixedBase = true;
+
+		m_articulation = m_world.CreateArticulation(ad);
+	}
+
+	void Step()
+	{
+		Test::Step();
+
+		DrawString(b3Color_white, "Links %d", m_articulation->GetLinkCount());
+		DrawString(b3Color_white, "Last Joint Angle %f", m_articulation->GetJointPosition(e_count));
+	}
+
+	static Test* Create()
+	{
+		return new ArticulatedChain();
+	}
+
+	b3Articulation* m_articulation;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BULLET_TEST_H
+#define BULLET_TEST_H
+
+class BulletTest : public Test
+{
+public:
+	BulletTest()
+	{
+		{
+			b3BodyDef bd;
+			b3Body* ground = m_world.CreateBody(bd);
+
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
+
+			b3FixtureDef sd;
+			sd.shape = &hs;
+
+			ground->CreateFixture(sd);
+		}
+
+		{
+			b3BodyDef bd;
+			bd.position.Set(0.0f, 5.0f, 0.0f);
+
+			b3Body* wall = m_world.CreateBody(bd);
+
+			static b3BoxHull wallHull(0.1f, 5.0f, 10.0f);
+
+			b3HullShape hs;
+			hs.m_hull = &wallHull;
+
+			b3FixtureDef sd;
+			sd.shape = &hs;
+
+			wall->CreateFixture(sd);
+		}
+
+		m_bullet = true;
+	}
+
+	void Step()
+	{
+		Test::Step();
+
+		DrawString(b3Color_white, "Enable Continuous in the settings to stop the bodies at the wall");
+		DrawString(b3Color_white, "Space - Shoot Box");
+		DrawString(b3Color_white, "C - Shoot Capsule");
+		DrawString(b3Color_white, "B - Toggle Bullet Flag (%s)", m_bullet ? "On" : "Off");
+	}
+
+	void Shoot(const b3Shape* shape)
+	{
+		b3BodyDef bd;
+		bd.type = b3BodyType::e_dynamicBody;
+		bd.position.Set(-20.0f, RandomFloat(2.0f, 8.0f), RandomFloat(-8.0f, 8.0f));
+		bd.linearVelocity.Set(300.0f, 0.0f, 0.0f);
+		bd.angularVelocity.Set(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+		bd.bullet = m_bullet;
+
+		b3Body* body = m_world.CreateBody(bd);
+
+		b3FixtureDef sd;
+		sd.shape = shape;
+		sd.density = 1.0f;
+		sd.friction = 0.5f;
+
+		body->CreateFixture(sd);
+	}
+
+	void KeyDown(int key)
+	{
+		if (key == GLFW_KEY_SPACE)
+		{
+			static b3BoxHull boxHull(0.25f, 0.25f, 0.25f);
+
+			b3HullShape hs;
+			hs.m_hull = &boxHull;
+
+			Shoot(&hs);
+		}
+
+		if (key == GLFW_KEY_C)
+		{
+			b3CapsuleShape cs;
+			cs.m_vertex1.Set(0.0f, -0.25f, 0.0f);
+			cs.m_vertex2.Set(0.0f, 0.25f, 0.0f);
+			cs.m_radius = 0.1f;
+
+			Shoot(&cs);
+		}
+
+		if (key == GLFW_KEY_B)
+		{
+			m_bullet = !m_bullet;
+		}
+	}
+
+	static Test* Create()
+	{
+		return new BulletTest();
+	}
+
+	bool m_bullet;
+};
+
+#endif
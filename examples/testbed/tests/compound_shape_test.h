@@ -0,0 +1,99 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef COMPOUND_SHAPE_TEST_H
+#define COMPOUND_SHAPE_TEST_H
+
+class CompoundShapeTest : public Test
+{
+public:
+	CompoundShapeTest()
+	{
+		{
+			b3BodyDef bd;
+			b3Body* body = m_world.CreateBody(bd);
+
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
+
+			b3FixtureDef sd;
+			sd.shape = &hs;
+
+			body->CreateFixture(sd);
+		}
+
+		// A table made of a top and four legs.
+		m_top.SetExtents(2.0f, 0.25f, 1.0f);
+		m_leg.SetExtents(0.25f, 1.0f, 0.25f);
+
+		m_topShape.m_hull = &m_top;
+		m_legShape.m_hull = &m_leg;
+
+		m_children[0].shape = &m_topShape;
+		m_children[0].transform.SetIdentity();
+		m_children[0].transform.translation.Set(0.0f, 1.25f, 0.0f);
+
+		for (u32 i = 0; i < 4; ++i)
+		{
+			scalar x = i % 2 == 0 ? -1.75f : 1.75f;
+			scalar z = i / 2 == 0 ? -0.75f : 0.75f;
+
+			m_children[i + 1].shape = &m_legShape;
+			m_children[i + 1].transform.SetIdentity();
+			m_children[i + 1].transform.translation.Set(x, 0.0f, z);
+		}
+
+		m_compound.childCount = 5;
+		m_compound.children = m_children;
+		m_compound.BuildTree();
+
+		b3CompoundShape cs;
+		cs.m_compound = &m_compound;
+
+		for (u32 i = 0; i < 5; ++i)
+		{
+			b3BodyDef bd;
+			bd.type = e_dynamicBody;
+			bd.position.Set(0.0f, 2.0f + 3.0f * scalar(i), 0.0f);
+			bd.orientation = b3QuatRotationY(0.25f * B3_PI * scalar(i));
+
+			b3Body* body = m_world.CreateBody(bd);
+
+			b3FixtureDef sd;
+			sd.shape = &cs;
+			sd.density = 0.5f;
+			sd.friction = 0.6f;
+
+			body->CreateFixture(sd);
+		}
+	}
+
+	static Test* Create()
+	{
+		return new CompoundShapeTest();
+	}
+
+	b3BoxHull m_top;
+	b3BoxHull m_leg;
+	b3HullShape m_topShape;
+	b3HullShape m_legShape;
+	b3CompoundChild m_children[5];
+	b3Compound m_compound;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HEIGHT_FIELD_TEST_H
+#define HEIGHT_FIELD_TEST_H
+
+class HeightFieldTest : public Test
+{
+public:
+	enum
+	{
+		e_rowCount = 51,
+		e_columnCount = 51
+	};
+
+	HeightFieldTest()
+	{
+		// Transform the grid into a terrain
+		for (u32 i = 0; i < e_rowCount; ++i)
+		{
+			for (u32 j = 0; j < e_columnCount; ++j)
+			{
+				m_heights[i * e_columnCount + j] = u16(RandomFloat(0.0f, 100.0f));
+			}
+		}
+
+		m_heightField.rowCount = e_rowCount;
+		m_heightField.columnCount = e_columnCount;
+		m_heightField.shortHeights = m_heights;
+		m_heightField.ComputeBounds();
+
+		{
+			b3BodyDef bd;
+			bd.position.Set(-25.0f, 0.0f, -25.0f);
+
+			b3Body* groundBody = m_world.CreateBody(bd);
+
+			b3HeightFieldShape hs;
+			hs.m_heightField = &m_heightField;
+			hs.m_scale.Set(1.0f, 0.01f, 1.0f);
+
+			b3FixtureDef sd;
+			sd.shape = &hs;
+
+			groundBody->CreateFixture(sd);
+		}
+
+		for (u32 i = 0; i < 5; ++i)
+		{
+			for (u32 j = 0; j < 5; ++j)
+			{
+				b3BodyDef bd;
+				bd.type = b3BodyType::e_dynamicBody;
+				bd.position.Set(-10.0f + 5.0f * scalar(j), 5.0f, -10.0f + 5.0f * scalar(i));
+
+				b3Body* body = m_world.CreateBody(bd);
+
+				b3FixtureDef sd;
+				sd.density = 1.0f;
+				sd.friction = 0.5f;
+
+				u32 type = (i + j) % 3;
+				if (type == 0)
+				{
+					b3SphereShape sphere;
+					sphere.m_center.SetZero();
+					sphere.m_radius = 1.0f;
+
+					sd.shape = &sphere;
+					body->CreateFixture(sd);
+				}
+				else if (type == 1)
+				{
+					b3CapsuleShape capsule;
+					capsule.m_vertex1.Set(0.0f, -1.0f, 0.0f);
+					capsule.m_vertex2.Set(0.0f, 1.0f, 0.0f);
+					capsule.m_radius = 1.0f;
+
+					sd.shape = &capsule;
+					body->CreateFixture(sd);
+				}
+				else
+				{
+					b3HullShape hull;
+					hull.m_hull = &b3BoxHull_identity;
+
+					sd.shape = &hull;
+					body->CreateFixture(sd);
+				}
+			}
+		}
+	}
+
+	static Test* Create()
+	{
+		return new HeightFieldTest();
+	}
+
+	u16 m_heights[e_rowCount * e_columnCount];
+	b3HeightField m_heightField;
+};
+
+#endif
@@ -78,6 +78,23 @@ public:
 		}
 	}
 
+	void Step()
+	{
+		Test::Step();
+
+		// Measure the separation of the joint anchors to compare the solvers.
+		scalar maxError = 0.0f;
+		for (b3Joint* j = m_world.GetJointList().m_head; j; j = j->GetNext())
+		{
+			b3RevoluteJoint* rj = (b3RevoluteJoint*)j;
+			scalar error = b3Length(rj->GetFrameB().translation - rj->GetFrameA().translation);
+			maxError = b3Max(maxError, error);
+		}
+
+		DrawString(b3Color_white, "Sub-Steps %d", g_testSettings->subStepCount);
+		DrawString(b3Color_white, "Max Joint Error %f", maxError);
+	}
+
 	static Test* Create()
 	{
 		return new HingeChain();
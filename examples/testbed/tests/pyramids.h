@@ -93,6 +93,30 @@ public:
 		}
 	}
 
+	void Step()
+	{
+		Test::Step();
+
+		// Measure the deepest contact point to compare the solvers.
+		scalar minSeparation = 0.0f;
+		for (b3Contact* c = m_world.GetContactList().m_head; c; c = c->GetNext())
+		{
+			for (u32 i = 0; i < c->GetManifoldCount(); ++i)
+			{
+				b3WorldManifold wm;
+				c->GetWorldManifold(&wm, i);
+
+				for (u32 j = 0; j < wm.pointCount; ++j)
+				{
+					minSeparation = b3Min(minSeparation, wm.points[j].separation);
+				}
+			}
+		}
+
+		DrawString(b3Color_white, "Sub-Steps %d", g_testSettings->subStepCount);
+		DrawString(b3Color_white, "Max Penetration %f", -minSeparation);
+	}
+
 	static Test* Create()
 	{
 		return new Pyramids();
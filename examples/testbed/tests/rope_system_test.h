@@ -0,0 +1,100 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef ROPE_SYSTEM_TEST_H
+#define ROPE_SYSTEM_TEST_H
+
+#include <bounce/rope/rope_system.h>
+
+// A curtain of ropes of different lengths stepped together.
+class RopeSystemTest : public Test
+{
+public:
+	enum 
+	{
+		e_rowCount = 8,
+		e_columnCount = 16,
+		e_ropeCount = e_rowCount * e_columnCount,
+		e_maxLinkCount = 12
+	};
+
+	RopeSystemTest()
+	{
+		b3Vec3 vertices[e_ropeCount][e_maxLinkCount];
+		scalar masses[e_ropeCount][e_maxLinkCount];
+		b3RopeDef ropeDefs[e_ropeCount];
+
+		for (u32 i = 0; i < e_rowCount; ++i)
+		{
+			for (u32 j = 0; j < e_columnCount; ++j)
+			{
+				u32 index = i * e_columnCount + j;
+				u32 count = e_maxLinkCount / 2 + (i + j) % (e_maxLinkCount / 2 + 1);
+
+				for (u32 k = 0; k < count; ++k)
+				{
+					vertices[index][k].x = 2.0f * scalar(j) - scalar(e_columnCount) + scalar(k);
+					vertices[index][k].y = 20.0f;
+					vertices[index][k].z = 2.0f * scalar(i) - scalar(e_rowCount);
+
+					masses[index][k] = k == 0 ? 0.0f : 1.0f;
+				}
+
+				b3RopeDef& def = ropeDefs[index];
+				def.count = count;
+				def.vertices = vertices[index];
+				def.masses = masses[index];
+				def.linearDamping = 0.1f;
+				def.angularDamping = 0.1f;
+			}
+		}
+
+		b3RopeSystemDef def;
+		def.ropeCount = e_ropeCount;
+		def.ropes = ropeDefs;
+
+		m_ropes = new b3RopeSystem(def);
+
+		m_ropes->SetGravity(b3Vec3(0.0f, -10.0f, 0.0f));
+	}
+
+	~RopeSystemTest()
+	{
+		delete m_ropes;
+	}
+
+	void Step()
+	{
+		Test::Step();
+
+		m_ropes->Step(g_testSettings->inv_hertz);
+
+		m_ropes->Draw(&m_draw);
+
+		DrawString(b3Color_white, "Ropes %d", m_ropes->GetRopeCount());
+	}
+
+	static Test* Create()
+	{
+		return new RopeSystemTest();
+	}
+
+	b3RopeSystem* m_ropes;
+};
+
+#endif
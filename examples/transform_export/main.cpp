@@ -0,0 +1,188 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/bounce.h>
+#include <bounce/common/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// This example keeps arrays of body transforms updated with the moved-only export
+// and checks them against a full export after every step, for the transforms after 
+// the step and for the transforms blended halfway through the step.
+// Bodies are created, moved by SetTransform, and destroyed between the steps,
+// and the bodies fall asleep on the ground, so the moved list changes every step.
+
+// Number of steps.
+static const u32 e_stepCount = 1200;
+
+static const scalar e_timeStep = scalar(1) / scalar(60);
+static const u32 e_velocityIterations = 8;
+static const u32 e_positionIterations = 2;
+
+// Number of bodies along each axis.
+static const u32 e_gridSize = 8;
+
+// Maximum number of bodies, including the ground and the bodies created while stepping.
+static const u32 e_bodyCapacity = e_gridSize * e_gridSize * e_gridSize + e_stepCount;
+
+// Add a box at the given position.
+static b3Body* CreateBox(b3World* world, const b3Vec3& position)
+{
+	b3BodyDef bodyDef;
+	bodyDef.type = e_dynamicBody;
+	bodyDef.position = position;
+
+	b3Body* body = world->CreateBody(bodyDef);
+
+	b3HullShape box;
+	box.m_hull = &b3BoxHull_identity;
+
+	b3FixtureDef fixtureDef;
+	fixtureDef.shape = &box;
+	fixtureDef.density = scalar(1);
+	fixtureDef.friction = scalar(0.6);
+	body->CreateFixture(fixtureDef);
+
+	return body;
+}
+
+int main(int argc, char** argv)
+{
+	b3World* world = new b3World();
+	world->SetSleeping(true);
+
+	b3BoxHull groundHull(scalar(50), scalar(1), scalar(50));
+
+	b3BodyDef groundDef;
+	groundDef.position.Set(scalar(0), scalar(-1), scalar(0));
+	b3Body* ground = world->CreateBody(groundDef);
+
+	b3HullShape groundShape;
+	groundShape.m_hull = &groundHull;
+
+	b3FixtureDef groundFixtureDef;
+	groundFixtureDef.shape = &groundShape;
+	ground->CreateFixture(groundFixtureDef);
+
+	for (u32 i = 0; i < e_gridSize; ++i)
+	{
+		for (u32 j = 0; j < e_gridSize; ++j)
+		{
+			for (u32 k = 0; k < e_gridSize; ++k)
+			{
+				b3Vec3 position(scalar(3) * scalar(i) - scalar(12), scalar(1) + scalar(2.5) * scalar(j), scalar(3) * scalar(k) - scalar(12));
+				CreateBox(world, position);
+			}
+		}
+	}
+
+	// The arrays kept by the moved-only export and the arrays written by the full export, 
+	// for the transforms after the step and for the transforms halfway through the step.
+	const scalar alphas[2] = { scalar(1), scalar(0.5) };
+
+	b3Transform* cached[2];
+	b3Transform* full[2];
+	for (u32 k = 0; k < 2; ++k)
+	{
+		cached[k] = (b3Transform*)malloc(e_bodyCapacity * sizeof(b3Transform));
+		full[k] = (b3Transform*)malloc(e_bodyCapacity * sizeof(b3Transform));
+		world->ExportTransforms(cached[k], false, alphas[k]);
+	}
+
+	u32 mismatchCounts[2] = { 0, 0 };
+	double movedTimes[2] = { 0.0, 0.0 };
+	double fullTimes[2] = { 0.0, 0.0 };
+	u32 movedCount = 0;
+	for (u32 i = 0; i < e_stepCount; ++i)
+	{
+		// Create a body during the first half, and let the bodies fall asleep in the second.
+		if (i < e_stepCount / 2 && i % 10 == 0)
+		{
+			CreateBox(world, b3Vec3(scalar(0), scalar(30), scalar(0)));
+		}
+
+		// Move a body.
+		if (i < e_stepCount / 2 && i % 25 == 0)
+		{
+			b3Body* body = world->GetBodyList().m_head;
+			body->SetTransform(b3Vec3(scalar(20), scalar(5), scalar(i % 50) - scalar(25)), b3Quat_identity);
+		}
+
+		if (i < e_stepCount / 2 && i % 100 == 50)
+		{
+			// Destroy a few bodies of the middle of the body list.
+			b3Body* body = world->GetBodyList().m_head;
+			for (u32 j = 0; j < 100 && body; ++j)
+			{
+				body = body->GetNext();
+			}
+
+			for (u32 j = 0; j < 4 && body && body != ground; ++j)
+			{
+				b3Body* next = body->GetNext();
+				world->DestroyBody(body);
+				body = next;
+			}
+		}
+
+		world->Step(e_timeStep, e_velocityIterations, e_positionIterations);
+
+		u32 count;
+		world->GetMovedBodies(&count);
+		movedCount += count;
+
+		u32 bodyCount = world->GetBodyList().m_count;
+
+		for (u32 k = 0; k < 2; ++k)
+		{
+			b3Time time;
+			
+			world->ExportTransforms(cached[k], true, alphas[k]);
+			time.Update();
+			movedTimes[k] += time.GetElapsedMilis();
+
+			world->ExportTransforms(full[k], false, alphas[k]);
+			time.Update();
+			fullTimes[k] += time.GetElapsedMilis();
+
+			if (memcmp(cached[k], full[k], bodyCount * sizeof(b3Transform)) != 0)
+			{
+				++mismatchCounts[k];
+			}
+		}
+	}
+
+	printf("%d bodies, %d steps, %.1f moved bodies per step\n", world->GetBodyList().m_count, e_stepCount, double(movedCount) / double(e_stepCount));
+	
+	for (u32 k = 0; k < 2; ++k)
+	{
+		printf("factor %.1f: moved-only export %.3f ms, full export %.3f ms, %s\n", 
+			alphas[k], movedTimes[k], fullTimes[k], mismatchCounts[k] == 0 ? "match" : "MISMATCH");
+	}
+
+	for (u32 k = 0; k < 2; ++k)
+	{
+		free(cached[k]);
+		free(full[k]);
+	}
+
+	delete world;
+
+	return mismatchCounts[0] == 0 && mismatchCounts[1] == 0 ? 0 : 1;
+}
@@ -23,6 +23,7 @@
 
 #include <bounce/common/settings.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/thread_pool.h>
 
 #include <bounce/collision/geometry/geometry.h>
 #include <bounce/collision/geometry/sphere.h>
@@ -33,12 +34,16 @@
 #include <bounce/collision/geometry/cone_hull.h>
 #include <bounce/collision/geometry/mesh.h>
 #include <bounce/collision/geometry/grid_mesh.h>
+#include <bounce/collision/geometry/height_field.h>
+#include <bounce/collision/geometry/compound.h>
 
 #include <bounce/collision/shapes/sphere_shape.h>
 #include <bounce/collision/shapes/capsule_shape.h>
 #include <bounce/collision/shapes/triangle_shape.h>
 #include <bounce/collision/shapes/hull_shape.h>
 #include <bounce/collision/shapes/mesh_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/shapes/compound_shape.h>
 
 #include <bounce/collision/trees/dynamic_tree.h>
 #include <bounce/collision/trees/static_tree.h>
@@ -57,6 +62,7 @@
 #include <bounce/dynamics/joints/prismatic_joint.h>
 #include <bounce/dynamics/joints/wheel_joint.h>
 
+#include <bounce/dynamics/articulation.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/fixture.h>
 #include <bounce/dynamics/time_step.h>
@@ -53,6 +53,22 @@ public:
 	// Force move the proxy
 	void TouchProxy(u32 proxyId);
 
+	// Begin a bulk load of the tree. See b3DynamicTree::BeginBulkLoad.
+	void BeginBulkLoad();
+
+	// End a bulk load of the tree. 
+	// The created proxies stay in the move buffer so their pairs are found in the next call to FindPairs.
+	void EndBulkLoad();
+
+	// Is a bulk load in progress?
+	bool IsBulkLoading() const;
+
+	// Write the tree and the move buffer to a buffer.
+	void SaveState(b3StateBuffer* buffer) const;
+
+	// Read the state written by SaveState. The proxies must be the same as the saved ones.
+	void RestoreState(b3StateBuffer* buffer);
+
 	// Get the AABB of a given proxy.
 	const b3AABB& GetAABB(u32 proxyId) const;
 
@@ -62,6 +78,15 @@ public:
 	// Get the number of proxies.
 	u32 GetProxyCount() const;
 
+	// Get the dynamic tree.
+	const b3DynamicTree& GetTree() const;
+
+	// Get the number of proxies the move buffer can hold.
+	u32 GetMoveCapacity() const;
+
+	// Get the number of pairs the pair buffer can hold.
+	u32 GetPairCapacity() const;
+
 	// Test if two proxy AABBs are overlapping.
 	bool TestOverlap(u32 proxy1, u32 proxy2) const;
 	
@@ -128,6 +153,26 @@ inline u32 b3BroadPhase::GetProxyCount() const
 	return m_proxyCount;
 }
 
+inline bool b3BroadPhase::IsBulkLoading() const
+{
+	return m_tree.IsBulkLoading();
+}
+
+inline const b3DynamicTree& b3BroadPhase::GetTree() const
+{
+	return m_tree;
+}
+
+inline u32 b3BroadPhase::GetMoveCapacity() const
+{
+	return m_moveBufferCapacity;
+}
+
+inline u32 b3BroadPhase::GetPairCapacity() const
+{
+	return m_pairCapacity;
+}
+
 template<class T>
 inline void b3BroadPhase::QueryAABB(T* callback, const b3AABB& aabb) const 
 {
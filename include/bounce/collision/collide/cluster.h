@@ -59,6 +59,19 @@ struct b3Cluster
 	b3Vec3 centroid;
 };
 
+// Clustering state kept between two consecutive runs of the cluster solver.
+// The centroids of the previous run are used to seed k-means if the 
+// set of contributing manifolds didn't change.
+struct b3ClusterCache
+{
+	b3Vec3 centroids[B3_MAX_MANIFOLDS];
+	u32 centroidCount;
+	
+	// Key of the set of manifolds that contributed points.
+	u32 key;
+	u32 keyCount;
+};
+
 // This is used for simplifying contact manifolds.
 // It performs k-means for grouping contact points by their normals.
 // It also performs contact point reduction.
@@ -80,16 +93,25 @@ public:
 	const b3Array<b3Cluster>& GetClusters() const;
 
 	// Perform clustering on a set of manifolds.
+	// The cache is optional. If given, it is used to seed and store the clusters.
 	void Run(b3Manifold mOut[3], u32& numOut,
 	const b3Manifold* mIn, u32 numIn,
-		const b3Transform& xfA, scalar radiusA, const b3Transform& xfB, scalar radiusB);
+		const b3Transform& xfA, scalar radiusA, const b3Transform& xfB, scalar radiusB, 
+		b3ClusterCache* cache = nullptr);
 
 	// Run the cluster algorithm.
 	void Solve();
 private:
+	// Handle the cases that don't require k-means. 
+	// Return true if the observations were clustered.
+	bool SolveFast();
+
 	// Cluster initialization.
 	void InitializeClusters();
 	
+	// Run k-means from the current cluster centroids.
+	void SolveKMeans();
+	
 	// Adds a new cluster. This merges similar clusters.
 	void AddCluster(const b3Vec3& centroid);
 
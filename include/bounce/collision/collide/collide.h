@@ -103,10 +103,29 @@ void b3CollideHullAndCapsule(b3Manifold& manifold,
 	const b3Transform& xf2, const b3CapsuleShape* shape2);
 
 // Compute a manifold for two hulls. 
+// If the cache is not null the features found in the previous call are tested first.
 void b3CollideHullAndHull(b3Manifold& manifold, 
 	const b3Transform& xf1, const b3HullShape* shape1, 
 	const b3Transform& xf2, const b3HullShape* shape2,
 	b3ConvexCache* cache, 
 	const b3Transform& xf01, const b3Transform& xf02);
 
+// Compute a speculative manifold for two convex shapes that don't overlap 
+// but are closer than a given distance. The manifold points have a positive separation. 
+// The manifold must be empty.
+void b3CollideSpeculative(b3Manifold& manifold,
+	const b3Transform& xf1, const b3Shape* shape1,
+	const b3Transform& xf2, const b3Shape* shape2,
+	scalar distance);
+
+// Compute a manifold for two generic convex shapes. 
+// The shapes can be spheres, capsules, triangles, or hulls. 
+// The manifold is always expressed relative to the first shape.
+// The cache can be null.
+void b3CollideShapes(b3Manifold& manifold,
+	const b3Transform& xf1, const b3Shape* shape1,
+	const b3Transform& xf2, const b3Shape* shape2,
+	b3ConvexCache* cache,
+	const b3Transform& xf01, const b3Transform& xf02);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_COMPOUND_H
+#define B3_COMPOUND_H
+
+#include <bounce/collision/trees/static_tree.h>
+
+class b3Shape;
+
+// A child of a compound.
+struct b3CompoundChild
+{
+	// The child shape. 
+	// This must be a sphere, capsule, or hull shape.
+	const b3Shape* shape;
+
+	// The child frame relative to the compound frame.
+	b3Transform transform;
+};
+
+// A compound is a rigid set of convex shapes.
+// The child shapes must outlive the compound.
+struct b3Compound
+{
+	u32 childCount;
+	b3CompoundChild* children;
+
+	b3StaticTree tree;
+
+	b3Compound();
+	~b3Compound();
+
+	// Build the static AABB tree of the children. 
+	// This must be called after the children are set and before the compound is used.
+	void BuildTree();
+
+	const b3CompoundChild* GetChild(u32 index) const;
+	b3AABB GetChildAABB(u32 index) const;
+
+	u32 GetSize() const;
+};
+
+inline const b3CompoundChild* b3Compound::GetChild(u32 index) const
+{
+	B3_ASSERT(index < childCount);
+	return children + index;
+}
+
+#endif
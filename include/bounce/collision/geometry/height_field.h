@@ -0,0 +1,188 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_HEIGHT_FIELD_H
+#define B3_HEIGHT_FIELD_H
+
+#include <bounce/collision/geometry/aabb.h>
+
+// A height field is a regular grid of height samples in the x-z plane.
+// The sample (i, j) is located at (j, h(i, j), i), where i is the row 
+// and j is the column of the sample. 
+// Each grid cell is split into two triangles. 
+// The triangles of the cell (i, j) are 2 * (i * (columnCount - 1) + j) and 
+// 2 * (i * (columnCount - 1) + j) + 1.
+// The samples aren't owned by the height field. 
+struct b3HeightField
+{
+	b3HeightField();
+
+	// Number of samples along the x axis.
+	u32 columnCount;
+	
+	// Number of samples along the z axis.
+	u32 rowCount;
+
+	// The height samples stored in row-major order.
+	// Either the 16-bit or the floating point samples must be set.
+	const u16* shortHeights;
+	const float* floatHeights;
+
+	// The minimum and maximum sample height.
+	scalar minHeight;
+	scalar maxHeight;
+
+	// Compute the sample height range. 
+	// This must be called after setting the samples.
+	void ComputeBounds();
+
+	scalar GetHeight(u32 row, u32 column) const;
+	b3Vec3 GetVertex(u32 row, u32 column) const;
+	
+	u32 GetCellCount() const;
+	u32 GetTriangleCount() const;
+	
+	// Get the vertices of a triangle.
+	void GetTriangle(b3Vec3 vertices[3], u32 index) const;
+	
+	// Get the edge wing vertices of a triangle.
+	// An edge is a boundary if its wing vertex flag is set to false.
+	void GetTriangleWings(b3Vec3 wings[3], bool hasWings[3], u32 index) const;
+	
+	// Get the AABB of the grid.
+	b3AABB GetAABB() const;
+
+	u32 GetSize() const;
+
+	// Report the client callback all triangles whose cells are overlapping with the 
+	// given AABB. The client callback must return false if the query 
+	// must be stopped or true to continue looking for more overlapping triangles.
+	template<class T>
+	void QueryAABB(T* callback, const b3AABB& aabb) const;
+};
+
+inline scalar b3HeightField::GetHeight(u32 row, u32 column) const
+{
+	B3_ASSERT(row < rowCount);
+	B3_ASSERT(column < columnCount);
+	u32 index = row * columnCount + column;
+	if (shortHeights)
+	{
+		return scalar(shortHeights[index]);
+	}
+	return scalar(floatHeights[index]);
+}
+
+inline b3Vec3 b3HeightField::GetVertex(u32 row, u32 column) const
+{
+	return b3Vec3(scalar(column), GetHeight(row, column), scalar(row));
+}
+
+inline u32 b3HeightField::GetCellCount() const
+{
+	if (rowCount < 2 || columnCount < 2)
+	{
+		return 0;
+	}
+	return (rowCount - 1) * (columnCount - 1);
+}
+
+inline u32 b3HeightField::GetTriangleCount() const
+{
+	return 2 * GetCellCount();
+}
+
+inline b3AABB b3HeightField::GetAABB() const
+{
+	b3AABB aabb;
+	aabb.lowerBound.Set(scalar(0), minHeight, scalar(0));
+	aabb.upperBound.Set(scalar(columnCount - 1), maxHeight, scalar(rowCount - 1));
+	return aabb;
+}
+
+inline u32 b3HeightField::GetSize() const
+{
+	u32 size = 0;
+	size += sizeof(b3HeightField);
+	if (shortHeights)
+	{
+		size += sizeof(u16) * rowCount * columnCount;
+	}
+	else
+	{
+		size += sizeof(float) * rowCount * columnCount;
+	}
+	return size;
+}
+
+template<class T>
+inline void b3HeightField::QueryAABB(T* callback, const b3AABB& aabb) const
+{
+	if (rowCount < 2 || columnCount < 2)
+	{
+		return;
+	}
+
+	if (b3TestOverlap(aabb, GetAABB()) == false)
+	{
+		return;
+	}
+
+	// Compute the range of overlapping cells.
+	u32 lastColumn = columnCount - 2;
+	u32 lastRow = rowCount - 2;
+
+	u32 column1 = b3Min(u32(b3Max(aabb.lowerBound.x, scalar(0))), lastColumn);
+	u32 column2 = b3Min(u32(b3Max(aabb.upperBound.x, scalar(0))), lastColumn);
+	u32 row1 = b3Min(u32(b3Max(aabb.lowerBound.z, scalar(0))), lastRow);
+	u32 row2 = b3Min(u32(b3Max(aabb.upperBound.z, scalar(0))), lastRow);
+
+	for (u32 i = row1; i <= row2; ++i)
+	{
+		for (u32 j = column1; j <= column2; ++j)
+		{
+			scalar h1 = GetHeight(i, j);
+			scalar h2 = GetHeight(i, j + 1);
+			scalar h3 = GetHeight(i + 1, j);
+			scalar h4 = GetHeight(i + 1, j + 1);
+
+			// Skip the cell if the AABB is above or below it.
+			scalar lower = b3Min(b3Min(h1, h2), b3Min(h3, h4));
+			scalar upper = b3Max(b3Max(h1, h2), b3Max(h3, h4));
+
+			if (aabb.upperBound.y < lower || aabb.lowerBound.y > upper)
+			{
+				continue;
+			}
+
+			u32 cell = i * (columnCount - 1) + j;
+
+			if (callback->Report(2 * cell) == false)
+			{
+				return;
+			}
+
+			if (callback->Report(2 * cell + 1) == false)
+			{
+				return;
+			}
+		}
+	}
+}
+
+#endif
@@ -88,7 +88,9 @@ public:
 		e_triangle = 2,
 		e_hull = 3,
 		e_mesh = 4,
-		e_typeCount = 5
+		e_heightField = 5,
+		e_compound = 6,
+		e_typeCount = 7
 	};
 
 	// Default destructor does nothing.
@@ -97,6 +99,10 @@ public:
 	// Get the shape type.
 	Type GetType() const;
 
+	// Get the size in bytes of this shape object. 
+	// This doesn't include the hull, mesh, height field, or compound referenced by the shape.
+	u32 GetSize() const;
+
 	// Clone this shape using the given allocator.
 	virtual b3Shape* Clone(b3BlockAllocator* allocator) const = 0;
 
@@ -123,7 +129,7 @@ public:
 
 	// The shape types. 
 	// Types currently supported are spheres, capsules, 
-	// triangles, convex hulls, and triangle meshes.
+	// triangles, convex hulls, triangle meshes, height fields, and compounds.
 	Type m_type;
 
 	// Radius of the shape. For convex hulls this must be B3_HULL_RADIUS. There is no support for 
@@ -20,6 +20,7 @@
 #define B3_DYNAMIC_TREE_H
 
 #include <bounce/common/template/stack.h>
+#include <bounce/common/memory/state_buffer.h>
 #include <bounce/collision/geometry/aabb.h>
 
 class b3Draw;
@@ -44,6 +45,29 @@ public:
 	// Return true if the proxy has moved.
 	bool MoveProxy(u32 proxyId, const b3AABB& aabb, const b3Vec3& displacement);
 
+	// Begin a bulk load. Proxies created during a bulk load aren't inserted 
+	// into the hierarchy until EndBulkLoad is called, so queries and ray casts 
+	// don't report them until then.
+	void BeginBulkLoad();
+
+	// End a bulk load. If proxies were created during the bulk load then 
+	// the whole hierarchy is rebuilt top-down.
+	void EndBulkLoad();
+
+	// Is a bulk load in progress?
+	bool IsBulkLoading() const;
+
+	// Rebuild the whole hierarchy top-down from the proxies.
+	void Rebuild();
+
+	// Write the hierarchy to a buffer.
+	void SaveState(b3StateBuffer* buffer) const;
+
+	// Read a hierarchy written by SaveState. 
+	// The tree must have the same proxies as the saved tree. 
+	// The proxies keep their user data.
+	void RestoreState(b3StateBuffer* buffer);
+
 	// Get the (fat) AABB of a given proxy.
 	const b3AABB& GetAABB(u32 proxyId) const;
 
@@ -65,9 +89,24 @@ public:
 	template<class T>
 	void RayCast(T* callback, const b3RayCastInput& input) const;
 
+	// Validate this tree.
+	void Validate() const;
+
 	// Validate a given node of this tree.
 	void Validate(u32 node) const;
 
+	// Get the height of this tree. An empty tree has zero height.
+	u32 GetHeight() const;
+
+	// Get the number of allocated nodes.
+	u32 GetNodeCount() const;
+
+	// Get the number of nodes the node array can hold.
+	u32 GetNodeCapacity() const;
+
+	// Get the size in bytes of the node array of this tree.
+	u32 GetSize() const;
+
 	// Draw this tree.
 	void Draw(b3Draw* draw) const;
 private:
@@ -112,6 +151,12 @@ private:
 	// Pick the best node that can be merged with a given AABB.
 	u32 PickBest(const b3AABB& aabb) const;
 
+	// Build a subtree top-down from a set of leaves and return its root.
+	u32 BuildRecursively(u32* leaves, u32 count);
+
+	// Is a given leaf waiting to be inserted by a bulk load?
+	bool IsDetached(u32 leaf) const;
+
 	// Peel a node from the free list and insert into the node array. 
 	// Allocate a new node if necessary. The function returns the new node index.
 	u32 AllocateNode();
@@ -133,8 +178,46 @@ private:
 	u32 m_nodeCount;
 	u32 m_nodeCapacity;
 	u32 m_freeList;
+
+	// Bulk load.
+	bool m_bulkLoad;
+	u32 m_detachedCount;
 };
 
+inline bool b3DynamicTree::IsBulkLoading() const
+{
+	return m_bulkLoad;
+}
+
+inline bool b3DynamicTree::IsDetached(u32 leaf) const
+{
+	return leaf != m_root && m_nodes[leaf].parent == B3_NULL_NODE_D;
+}
+
+inline u32 b3DynamicTree::GetHeight() const
+{
+	if (m_root == B3_NULL_NODE_D)
+	{
+		return 0;
+	}
+	return m_nodes[m_root].height;
+}
+
+inline u32 b3DynamicTree::GetNodeCount() const
+{
+	return m_nodeCount;
+}
+
+inline u32 b3DynamicTree::GetNodeCapacity() const
+{
+	return m_nodeCapacity;
+}
+
+inline u32 b3DynamicTree::GetSize() const
+{
+	return m_nodeCapacity * sizeof(b3Node);
+}
+
 inline const b3AABB& b3DynamicTree::GetAABB(u32 proxyId) const
 {
 	B3_ASSERT(proxyId != B3_NULL_NODE_D && proxyId < m_nodeCapacity);
@@ -81,6 +81,15 @@
 #define B3_LINEAR_SLOP scalar(0.005)
 #define B3_ANGULAR_SLOP (scalar(2.0) / scalar(180) * B3_PI)
 
+// The relative motion of two shapes in a contact below which 
+// the contact points of the last step are reused instead of being rebuilt.
+#define B3_CONTACT_REUSE_LINEAR_TOLERANCE (scalar(0.1) * B3_LINEAR_SLOP)
+#define B3_CONTACT_REUSE_ANGULAR_TOLERANCE (scalar(0.02) * B3_ANGULAR_SLOP)
+
+// The distance below which separated shapes get speculative contact points, 
+// in addition to the relative motion of the shapes in a step.
+#define B3_SPECULATIVE_DISTANCE (scalar(4) * B3_LINEAR_SLOP)
+
 // The radius of the hull shape skin.
 #define B3_HULL_RADIUS (scalar(0.0) * B3_LINEAR_SLOP)
 
@@ -115,10 +124,28 @@
 // However values very close to 1 may lead to overshoot.
 #define B3_BAUMGARTE scalar(0.1)
 
+// The fraction of the overlap resolved per step by the split impulse solver and
+// the overlap it allows. The overlap is resolved with pseudo velocities that 
+// move the bodies but don't add energy, so this can be larger than the Baumgarte factor.
+#define B3_SPLIT_IMPULSE_BAUMGARTE scalar(0.2)
+#define B3_SPLIT_IMPULSE_LINEAR_SLOP B3_LINEAR_SLOP
+
 // If the relative velocity of a contact point is below 
 // the threshold then restitution is not applied.
 #define B3_VELOCITY_THRESHOLD scalar(1.0)
 
+// The stiffness in Hz and damping ratio of contacts in the sub-stepping solver. 
+// The stiffness is clamped to a quarter of the sub-step rate.
+#define B3_CONTACT_HERTZ scalar(30.0)
+#define B3_CONTACT_DAMPING_RATIO scalar(10.0)
+
+// The maximum speed at which the sub-stepping solver pushes overlapping shapes apart.
+#define B3_MAX_CONTACT_PUSH_SPEED scalar(3.0)
+
+// The maximum number of impacts of a body handled by the continuous collision in a step.
+// The body stops at the last impact found.
+#define B3_MAX_TOI_SUB_STEPS (8)
+
 // Time to sleep in seconds
 #define B3_TIME_TO_SLEEP scalar(0.2)
 
@@ -131,6 +158,6 @@ struct b3Version
 };
 
 // The current version of Bounce.
-extern b3Version b3_version;
+extern const b3Version b3_version;
 
 #endif
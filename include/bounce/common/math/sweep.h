@@ -29,6 +29,10 @@ struct b3Sweep
 	// Get this sweep transform at a given time in the interval [0, 1]
 	b3Transform GetTransform(scalar t) const;
 
+	// Move the start of this sweep to a given time in the interval [0, 1].
+	// The end of this sweep is kept.
+	void Advance(scalar t);
+
 	b3Vec3 localCenter; // local center
 
 	b3Quat orientation0; // last orientation
@@ -62,4 +66,11 @@ inline b3Transform b3Sweep::GetTransform(scalar t) const
 	return xf;
 }
 
+inline void b3Sweep::Advance(scalar t)
+{
+	b3Transform xf = GetTransform(t);
+	worldCenter0 = b3Mul(xf, localCenter);
+	orientation0 = xf.rotation;
+}
+
 #endif
\ No newline at end of file
@@ -26,6 +26,33 @@ class b3BlockPool;
 // Number of blocks pools.
 const u32 b3_blockSizeCount = 14;
 
+// Maximum size of a block. Larger allocations use b3Alloc.
+const u32 b3_maxBlockSize = 640;
+
+// These are the supported object sizes. Actual allocations are rounded up the next size.
+extern const u32 b3_blockSizes[b3_blockSizeCount];
+
+// Get the index of the smallest block size that fits the given size.
+// The size must be in the range [1, b3_maxBlockSize].
+u32 b3GetBlockSizeIndex(u32 size);
+
+// Occupancy of a block size class.
+struct b3BlockSizeStats
+{
+	u32 blockSize; // size of a block in bytes
+	u32 chunkCount; // number of chunks allocated with b3Alloc
+	u32 blockCount; // number of blocks in the chunks
+	u32 allocatedCount; // number of blocks in use
+};
+
+// Occupancy of a block allocator.
+struct b3BlockAllocatorStats
+{
+	b3BlockSizeStats sizes[b3_blockSizeCount];
+	u32 largeAllocationCount; // number of live allocations larger than b3_maxBlockSize
+	u32 largeAllocatedSize; // bytes of the live allocations larger than b3_maxBlockSize
+};
+
 /// This is a small object allocator used for allocating small
 /// objects that persist for more than one time step.
 /// See: http://www.codeproject.com/useritems/Small_Block_Allocator.asp
@@ -40,9 +67,16 @@ public:
 
 	// Free memory. This will use b3Free if the size is larger than b3_maxBlockSize.
 	void Free(void* p, u32 size);
+
+	// Get the occupancy of each block pool and the live large allocations.
+	void GetStats(b3BlockAllocatorStats* stats) const;
 private:
 	// One pool per block size.
 	b3BlockPool* m_blockPools;
+
+	// Allocations larger than b3_maxBlockSize.
+	u32 m_largeAllocationCount;
+	u32 m_largeAllocatedSize;
 };
 
 #endif
\ No newline at end of file
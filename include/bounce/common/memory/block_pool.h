@@ -33,6 +33,15 @@ public:
 
 	void* Allocate();
 	void Free(void* p);
+
+	// Get the size of a block in bytes.
+	u32 GetBlockSize() const { return m_blockSize; }
+
+	// Get the number of chunks allocated with b3Alloc.
+	u32 GetChunkCount() const { return m_chunkCount; }
+
+	// Get the number of blocks currently allocated from this pool.
+	u32 GetAllocatedCount() const { return m_allocatedCount; }
 private:
 	struct b3Block
 	{
@@ -50,6 +59,8 @@ private:
 
 	b3Chunk* m_chunks;
 	u32 m_chunkCount;
+
+	u32 m_allocatedCount;
 };
 
 #endif
@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_CONCURRENT_BLOCK_ALLOCATOR_H
+#define B3_CONCURRENT_BLOCK_ALLOCATOR_H
+
+#include <bounce/common/memory/block_allocator.h>
+#include <atomic>
+
+struct b3BlockSizeClass;
+struct b3ConcurrentBlock;
+
+// Maximum number of blocks per size class held by a block cache.
+const u32 b3_blockCacheCapacity = 64;
+
+// A block allocator that can be used from multiple threads.
+// Each size class has a shared free list and chunk list protected by a lock.
+// For frequent allocations use a b3BlockCache per thread, which
+// only touches the shared lists once every few allocations.
+class b3ConcurrentBlockAllocator
+{
+public:
+	b3ConcurrentBlockAllocator();
+	~b3ConcurrentBlockAllocator();
+
+	// Allocate memory. This will use b3Alloc if the size is larger than b3_maxBlockSize.
+	void* Allocate(u32 size);
+
+	// Free memory. This will use b3Free if the size is larger than b3_maxBlockSize.
+	void Free(void* p, u32 size);
+
+	// Get the occupancy of each size class.
+	// Blocks held by a block cache count as allocated.
+	void GetStats(b3BlockAllocatorStats* stats) const;
+private:
+	friend class b3BlockCache;
+
+	// Move up to count blocks of a size class from the shared free list to the given list.
+	// Return the number of blocks moved.
+	u32 Acquire(u32 index, b3ConcurrentBlock** blocks, u32 count);
+
+	// Move a list of blocks of a size class back to the shared free list.
+	void Release(u32 index, b3ConcurrentBlock* first, b3ConcurrentBlock* last, u32 count);
+
+	// One class per block size.
+	b3BlockSizeClass* m_sizeClasses;
+
+	// Allocations larger than b3_maxBlockSize.
+	std::atomic<u32> m_largeAllocationCount;
+	std::atomic<u32> m_largeAllocatedSize;
+};
+
+// A per-thread cache of blocks on top of a concurrent block allocator.
+// A cache must only be used by one thread at a time.
+// Blocks can be freed through a cache different from the one that allocated them.
+class b3BlockCache
+{
+public:
+	b3BlockCache(b3ConcurrentBlockAllocator* allocator);
+	~b3BlockCache();
+
+	// Allocate memory. This will use b3Alloc if the size is larger than b3_maxBlockSize.
+	void* Allocate(u32 size);
+
+	// Free memory. This will use b3Free if the size is larger than b3_maxBlockSize.
+	void Free(void* p, u32 size);
+
+	// Return all the cached blocks to the allocator.
+	void Flush();
+private:
+	struct b3BlockList
+	{
+		b3ConcurrentBlock* blocks;
+		u32 count;
+	};
+
+	b3ConcurrentBlockAllocator* m_allocator;
+	b3BlockList m_lists[b3_blockSizeCount];
+};
+
+#endif
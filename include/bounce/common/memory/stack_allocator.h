@@ -21,19 +21,51 @@
 
 #include <bounce/common/settings.h>
 
-// Allocate 1 MiB from the stack. 
-// Increase as you want.
-const u32 b3_maxStackSize = B3_MiB(1);
+// Default initial size of the stack memory.
+const u32 b3_defaultStackSize = B3_MiB(1);
+
+// The stack memory grows in multiples of this size.
+const u32 b3_stackPageSize = B3_KiB(64);
+
+// Stack allocator statistics.
+struct b3StackAllocatorStats
+{
+	u32 capacity; // size of the stack memory in bytes
+	u32 allocatedSize; // bytes currently allocated
+	u32 maxAllocatedSize; // high-water mark in bytes
+	u32 allocationCount; // number of allocations
+	u32 parentAllocationCount; // number of allocations that did not fit in the stack memory
+	u32 growCount; // number of times the stack memory grew
+};
 
 // A stack allocator.
+// Allocations that don't fit in the stack memory go to b3Alloc. 
+// When the stack becomes empty the stack memory grows to the high-water mark, 
+// so a repeated allocation pattern only uses the stack memory.
+// This allocator is not thread-safe. Each thread should use its own instance.
 class b3StackAllocator 
 {
 public :
-	b3StackAllocator();
+	b3StackAllocator(u32 size = b3_defaultStackSize);
 	~b3StackAllocator();
 
+	// Resize the stack memory. 
+	// The size is rounded up to a multiple of b3_stackPageSize.
+	// The stack must be empty.
+	void SetCapacity(u32 size);
+
+	// Get the size of the stack memory.
+	u32 GetCapacity() const;
+
 	void* Allocate(u32 size);
 	void Free(void* p);
+
+	// Get the allocator statistics.
+	void GetStats(b3StackAllocatorStats* stats) const;
+
+	// Reset the statistics counters.
+	// The high-water mark is reset to the current allocated size.
+	void ResetStats();
 private :
 	struct b3Block 
 	{
@@ -47,7 +79,19 @@ private :
 	u32 m_blockCount;
 
 	u32 m_allocatedSize; // marker
-	u8 m_memory[b3_maxStackSize];
+	u32 m_capacity;
+	u8* m_memory;
+
+	u32 m_totalSize; // including parent allocations
+	u32 m_maxTotalSize;
+	u32 m_allocationCount;
+	u32 m_parentAllocationCount;
+	u32 m_growCount;
 };
 
+inline u32 b3StackAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
+
 #endif
@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_STATE_BUFFER_H
+#define B3_STATE_BUFFER_H
+
+#include <bounce/common/settings.h>
+#include <string.h>
+
+// A growable byte buffer for binary snapshots.
+// Data is appended at the end of the buffer and read back in the same order.
+// Clearing the buffer keeps its memory so a buffer can be reused without allocations.
+class b3StateBuffer
+{
+public:
+	b3StateBuffer();
+	~b3StateBuffer();
+
+	// Remove all the data and move the read position to the beginning of the buffer.
+	void Clear();
+
+	// Replace the contents of this buffer with a copy of the given data, e.g. loaded from a file.
+	void SetData(const void* data, u32 size);
+
+	// Get the data written to this buffer.
+	const void* GetData() const;
+
+	// Get the number of bytes written to this buffer.
+	u32 GetSize() const;
+
+	// Append data at the end of the buffer.
+	void Write(const void* data, u32 size);
+
+	template <class T>
+	void Write(const T& value);
+
+	// Move the read position to the beginning of the buffer.
+	void Rewind();
+
+	// Get the read position.
+	u32 GetPosition() const;
+
+	// Return the data at the read position and advance the position.
+	// The data is valid until the buffer is written.
+	const void* ReadData(u32 size);
+
+	// Copy the data at the read position and advance the position.
+	void Read(void* data, u32 size);
+
+	template <class T>
+	void Read(T& value);
+private:
+	void Reserve(u32 capacity);
+
+	u8* m_data;
+	u32 m_capacity;
+	u32 m_size;
+	u32 m_position;
+};
+
+inline const void* b3StateBuffer::GetData() const
+{
+	return m_data;
+}
+
+inline u32 b3StateBuffer::GetSize() const
+{
+	return m_size;
+}
+
+inline u32 b3StateBuffer::GetPosition() const
+{
+	return m_position;
+}
+
+inline void b3StateBuffer::Write(const void* data, u32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		Reserve(m_size + size);
+	}
+	memcpy(m_data + m_size, data, size);
+	m_size += size;
+}
+
+inline const void* b3StateBuffer::ReadData(u32 size)
+{
+	B3_ASSERT(m_position + size <= m_size);
+	const void* data = m_data + m_position;
+	m_position += size;
+	return data;
+}
+
+inline void b3StateBuffer::Read(void* data, u32 size)
+{
+	memcpy(data, ReadData(size), size);
+}
+
+inline void b3StateBuffer::Rewind()
+{
+	m_position = 0;
+}
+
+template <class T>
+inline void b3StateBuffer::Write(const T& value)
+{
+	Write(&value, sizeof(T));
+}
+
+template <class T>
+inline void b3StateBuffer::Read(T& value)
+{
+	Read(&value, sizeof(T));
+}
+
+#endif
@@ -102,6 +102,12 @@ public:
 		return m_capacity;
 	}
 
+	// Are the elements stored in memory allocated by this array instead of the local storage?
+	bool IsHeapAllocated() const
+	{
+		return m_elements != m_localElements;
+	}
+
 	u32 Count() const
 	{
 		return m_count;
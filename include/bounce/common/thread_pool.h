@@ -0,0 +1,82 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_THREAD_POOL_H
+#define B3_THREAD_POOL_H
+
+#include <bounce/common/settings.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Maximum number of threads of a thread pool, including the calling thread.
+const u32 b3_maxThreadCount = 64;
+
+// A task of a parallel loop. 
+// Process the items in [begin, end). 
+// The thread index is in [0, thread count) and can be used for per-thread data.
+typedef void b3TaskFcn(void* context, u32 begin, u32 end, u32 threadIndex);
+
+// A pool of worker threads that run parallel loops. 
+// The thread that calls ParallelFor runs tasks too, as the thread of index zero.
+// A pool must be used by one thread at a time.
+class b3ThreadPool
+{
+public:
+	// Create a pool. The thread count includes the calling thread, 
+	// so a pool of one thread doesn't start any worker thread.
+	b3ThreadPool(u32 threadCount);
+	~b3ThreadPool();
+
+	// Get the number of threads, including the calling thread.
+	u32 GetThreadCount() const;
+
+	// Split [0, count) into ranges of up to rangeSize items and run the task on each range. 
+	// The ranges are taken by the threads as they become free. 
+	// Return when all ranges are done.
+	void ParallelFor(u32 count, u32 rangeSize, b3TaskFcn* task, void* context);
+private:
+	void WorkerMain(u32 threadIndex);
+
+	void RunRanges(u32 threadIndex);
+
+	u32 m_threadCount;
+	std::thread* m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_doneCondition;
+	u32 m_loopId;
+	u32 m_busyCount;
+	bool m_quit;
+
+	// The current loop
+	b3TaskFcn* m_task;
+	void* m_context;
+	u32 m_count;
+	u32 m_rangeSize;
+	std::atomic<u32> m_next;
+};
+
+inline u32 b3ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+#endif
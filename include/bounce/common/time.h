@@ -54,17 +54,8 @@ public:
     // Add the elapsed time since this function was called to this timer.
     void Update()
     {
-        static double inv_frequency = 0.0;
-        if (inv_frequency == 0.0)
-        {
-            LARGE_INTEGER c;
-            QueryPerformanceFrequency(&c);
-
-            double cycles_per_s = double(c.QuadPart);
-            double s_per_cycle = 1.0 / cycles_per_s;
-            double ms_per_cycle = 1000.0 * s_per_cycle;
-            inv_frequency = ms_per_cycle;
-        }
+        // The frequency is queried once. The initialization of a local static is thread-safe.
+        static const double inv_frequency = GetInverseFrequency();
 
         LARGE_INTEGER c;
         QueryPerformanceCounter(&c);
@@ -82,6 +73,17 @@ public:
     }
 
 private:
+    static double GetInverseFrequency()
+    {
+        LARGE_INTEGER c;
+        QueryPerformanceFrequency(&c);
+
+        double cycles_per_s = double(c.QuadPart);
+        double s_per_cycle = 1.0 / cycles_per_s;
+        double ms_per_cycle = 1000.0 * s_per_cycle;
+        return ms_per_cycle;
+    }
+
     u64 m_c0;
     double m_t0;
     double m_t;
@@ -118,13 +120,8 @@ public:
     // Add the elapsed time since this function was called to this timer.
     void Update()
     {
-        static double inv_frequency = 0.0;
-        if (inv_frequency == 0.0)
-        {
-            mach_timebase_info_data_t info;
-            mach_timebase_info(&info);
-            inv_frequency = double(info.numer) / (double(info.denom) * 1.0e6);
-        }
+        // The frequency is queried once. The initialization of a local static is thread-safe.
+        static const double inv_frequency = GetInverseFrequency();
 
         uint64_t c = mach_absolute_time();
         double dt = inv_frequency * (double)(c - m_c0);
@@ -140,6 +137,13 @@ public:
     }
 
 private:
+    static double GetInverseFrequency()
+    {
+        mach_timebase_info_data_t info;
+        mach_timebase_info(&info);
+        return double(info.numer) / (double(info.denom) * 1.0e6);
+    }
+
     uint64_t m_c0;
     double m_t0;
     double m_t;
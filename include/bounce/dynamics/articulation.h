@@ -0,0 +1,273 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_ARTICULATION_H
+#define B3_ARTICULATION_H
+
+#include <bounce/common/math/transform.h>
+#include <bounce/common/template/list.h>
+
+class b3World;
+class b3Body;
+class b3Draw;
+class b3StackAllocator;
+class b3StateBuffer;
+class b3ContactFilter;
+
+struct b3ArticulationLink;
+
+// The joint that connects an articulation link to its parent link.
+enum b3ArticulationJointType
+{
+	e_fixedArticulationJoint, // no relative motion
+	e_revoluteArticulationJoint, // rotation about the joint axis
+	e_prismaticArticulationJoint, // translation along the joint axis
+	e_sphericalArticulationJoint // rotation about the joint anchor
+};
+
+// Articulation link definition.
+struct b3ArticulationLinkDef
+{
+	b3ArticulationLinkDef()
+	{
+		body = nullptr;
+		parent = B3_MAX_U32;
+		jointType = e_fixedArticulationJoint;
+		anchor.SetZero();
+		axis.Set(scalar(1), scalar(0), scalar(0));
+		enableLimit = false;
+		lowerLimit = scalar(0);
+		upperLimit = scalar(0);
+	}
+
+	// Initialize the joint of this link from the index of the parent link 
+	// and a world anchor point and axis.
+	void Initialize(b3Body* body, u32 parent, b3ArticulationJointType jointType, const b3Vec3& anchor, const b3Vec3& axis);
+
+	// The body that carries the fixtures of this link. 
+	// The link mass is computed from the fixture densities. 
+	// The body becomes kinematic and is moved by the articulation. 
+	// It must not be connected to joints.
+	b3Body* body;
+
+	// The index of the parent link. It must be less than the index of this link.
+	// The root link has no parent.
+	u32 parent;
+
+	// The type of the joint connecting this link to its parent link.
+	b3ArticulationJointType jointType;
+
+	// The joint anchor point in world coordinates.
+	b3Vec3 anchor;
+
+	// The joint axis in world coordinates. Used by revolute and prismatic joints.
+	b3Vec3 axis;
+
+	// Limit the joint angle or translation.
+	bool enableLimit;
+	
+	// The lower joint limit in radians or meters.
+	scalar lowerLimit;
+
+	// The upper joint limit in radians or meters.
+	scalar upperLimit;
+};
+
+// Articulation definition.
+// The link definitions will not be used internally after the articulation creation. 
+// Therefore, you can create them on the stack.
+struct b3ArticulationDef
+{
+	b3ArticulationDef()
+	{
+		linkCount = 0;
+		links = nullptr;
+		fixedBase = false;
+		linearDamping = scalar(0.05);
+		angularDamping = scalar(0.05);
+	}
+
+	// Number of links. The first link is the root link.
+	u32 linkCount;
+
+	// Link definitions.
+	const b3ArticulationLinkDef* links;
+
+	// Fix the root link to the world.
+	bool fixedBase;
+
+	// Linear coefficient of damping of the links.
+	scalar linearDamping;
+
+	// Angular coefficient of damping of the links.
+	scalar angularDamping;
+};
+
+// An articulation is a tree of links simulated in reduced coordinates.
+// The state of each link is the position and velocity of the joint connecting 
+// it to its parent, so the joints never separate and need no solver iterations. 
+// The forward dynamics is computed with the articulated body algorithm in O(n). 
+// Contacts with the world are solved through the effective inverse mass of 
+// the articulation at each contact point. 
+// Contacts between links of the same articulation are ignored. 
+// Other articulations and kinematic bodies act as immovable bodies. 
+// The impulses of the joint limits and the contacts are kept for warm starting 
+// the next step. 
+// A moving articulation wakes up the bodies it touches. 
+// It falls asleep as a whole when all links come to rest and the bodies it touches 
+// are asleep, and wakes up when a moving body touches one of its links.
+// Suggestion: Keep some damping and take smaller time steps for improving the 
+// stability of long chains of fast spinning links.
+class b3Articulation
+{
+public:
+	// Get the number of links.
+	u32 GetLinkCount() const;
+
+	// Get the body of a link.
+	b3Body* GetLinkBody(u32 index) const;
+
+	// Get the index of the parent link of a link.
+	u32 GetLinkParent(u32 index) const;
+
+	// Get the type of the joint of a link.
+	b3ArticulationJointType GetJointType(u32 index) const;
+
+	// Get the angle or translation of a revolute or prismatic joint.
+	scalar GetJointPosition(u32 index) const;
+
+	// Get the angular or linear speed of a revolute or prismatic joint.
+	scalar GetJointSpeed(u32 index) const;
+
+	// Set the angular or linear speed of a revolute or prismatic joint.
+	void SetJointSpeed(u32 index, scalar speed);
+
+	// Get the linear velocity of the center of mass of the root link.
+	b3Vec3 GetLinearVelocity() const;
+
+	// Set the linear velocity of the center of mass of the root link.
+	void SetLinearVelocity(const b3Vec3& linearVelocity);
+
+	// Get the angular velocity of the root link.
+	b3Vec3 GetAngularVelocity() const;
+
+	// Set the angular velocity of the root link.
+	void SetAngularVelocity(const b3Vec3& angularVelocity);
+
+	// Set the sleep state of the articulation. 
+	// A sleeping articulation has zero velocities and isn't stepped.
+	void SetAwake(bool flag);
+
+	// Is this articulation awake?
+	bool IsAwake() const;
+
+	// Get the next articulation in the world articulation list.
+	const b3Articulation* GetNext() const;
+	b3Articulation* GetNext();
+
+	// Draw the joints of this articulation.
+	void Draw(b3Draw* draw) const;
+private:
+	friend class b3World;
+	friend class b3List<b3Articulation>;
+
+	b3Articulation(const b3ArticulationDef& def, b3World* world);
+	~b3Articulation();
+
+	// Compute the joint accelerations, integrate the joint velocities, 
+	// solve the joint limits and the contacts, and integrate the joint positions.
+	void Step(const b3Vec3& gravity, scalar dt, u32 velocityIterations, bool warmStart, bool sleep, 
+		b3StackAllocator* allocator, b3ContactFilter* filter);
+
+	// Return true if a link body was woken up or a moving body touches a link.
+	bool ShouldWakeUp() const;
+
+	// Update the sleep time from the link velocities and put the articulation to sleep 
+	// if the links were at rest long enough.
+	void UpdateSleep(scalar dt);
+
+	// Compute the link transforms and spatial transforms from the joint positions.
+	void ComputeTransforms();
+
+	// Compute the link velocities from the joint velocities.
+	void ComputeVelocities();
+
+	// Write the link transforms and velocities to the link bodies.
+	void SynchronizeBodies();
+
+	// Compute the accelerations from the current velocities and 
+	// integrate them over the step from the velocities at the beginning of the step.
+	void IntegrateVelocities(const b3Vec3& gravity, scalar dt);
+
+	// Solve the joint limits and the contacts of the links.
+	void SolveConstraints(const b3Vec3& gravity, scalar dt, u32 velocityIterations, bool warmStart, u32 rowCapacity, 
+		b3StackAllocator* allocator, b3ContactFilter* filter);
+
+	// Compute the Jacobian of a world impulse applied to a link at its center of mass 
+	// with respect to the articulation velocity.
+	void ComputeJacobian(u32 index, const b3Vec3& linearImpulse, const b3Vec3& angularImpulse, scalar* J) const;
+
+	// Compute the change of the articulation velocity due to an impulse 
+	// on the articulation velocity. 
+	void ComputeResponse(const scalar* impulse, scalar* response);
+
+	void SaveState(b3StateBuffer* buffer) const;
+	void RestoreState(b3StateBuffer* buffer);
+
+	b3World* m_world;
+
+	bool m_fixedBase;
+	scalar m_linearDamping;
+	scalar m_angularDamping;
+
+	u32 m_linkCount;
+	b3ArticulationLink* m_links;
+
+	bool m_awake;
+	scalar m_sleepTime;
+
+	// Number of entries in the articulation velocity vector. 
+	// This is the root velocity followed by the joint velocities.
+	u32 m_dofCount;
+
+	// Links to the world articulation list.
+	b3Articulation* m_prev;
+	b3Articulation* m_next;
+};
+
+inline u32 b3Articulation::GetLinkCount() const
+{
+	return m_linkCount;
+}
+
+inline bool b3Articulation::IsAwake() const
+{
+	return m_awake;
+}
+
+inline const b3Articulation* b3Articulation::GetNext() const
+{
+	return m_next;
+}
+
+inline b3Articulation* b3Articulation::GetNext()
+{
+	return m_next;
+}
+
+#endif
@@ -26,9 +26,11 @@
 #include <bounce/common/math/sweep.h>
 #include <bounce/common/template/list.h>
 #include <bounce/dynamics/time_step.h>
+#include <bounce/dynamics/body_storage.h>
 
 class b3World;
 class b3Fixture;
+class b3Articulation;
 
 struct b3FixtureDef;
 struct b3MassData;
@@ -57,6 +59,7 @@ struct b3BodyDef
 		fixedRotationX = false;
 		fixedRotationY = false;
 		fixedRotationZ = false;
+		bullet = false;
 		userData = nullptr;
 		position.SetZero();
 		orientation.SetIdentity();
@@ -87,6 +90,11 @@ struct b3BodyDef
 	
 	// If enabled the body is constrained to rotate only around the z-axis.
 	bool fixedRotationZ;
+
+	// Is this a fast moving body that should always be checked for tunneling 
+	// when the continuous collision is enabled in the world?
+	// This only applies to dynamic bodies. Other fast bodies are checked too.
+	bool bullet;
 	
 	// The user data. This pointer usually stores an address to a game entity.
 	void* userData;
@@ -151,6 +159,10 @@ public:
 	const b3World* GetWorld() const;
 	b3World* GetWorld();
 
+	// Get the index of this body in the world body arrays, such as the published transforms.
+	// The index changes when another body is destroyed.
+	u32 GetIndex() const;
+
 	// Get the fixtures associated with the body.
 	const b3List<b3Fixture>& GetFixtureList() const;
 	b3List<b3Fixture>& GetFixtureList();
@@ -169,10 +181,10 @@ public:
 	void DestroyFixture(b3Fixture* fixture);
 
 	// Get the body sweep.
-	const b3Sweep& GetSweep() const;
+	b3Sweep GetSweep() const;
 
 	// Get the body world transform.
-	const b3Transform& GetTransform() const;
+	b3Transform GetTransform() const;
 	
 	// Set the body world transform from a position and orientation quaternion.
 	// However, manipulating a body transform during the simulation may cause non-physical behaviour.
@@ -245,7 +257,7 @@ public:
 	const b3Mat33& GetInertia() const;
 
 	// Get the inverse of the rotational inertia of the body about the world center of mass. Typically in kg/m^3.
-	const b3Mat33& GetWorldInverseInertia() const;
+	b3Mat33 GetWorldInverseInertia() const;
 	
 	// Get this body mass data. 
 	// However, the mass data returned by this function contains the mass of the body, 
@@ -328,6 +340,12 @@ public:
 	// Set the fixed rotation along the world axes.
 	void SetFixedRotation(bool flagX, bool flagY, bool flagZ);
 
+	// Should this body be treated like a bullet for the continuous collision?
+	void SetBullet(bool flag);
+
+	// Is this body treated like a bullet for the continuous collision?
+	bool IsBullet() const;
+
 	// Set the linear sleep tolerance in meters per second.
 	void SetLinearSleepTolerance(scalar tolerance);
 
@@ -354,11 +372,14 @@ public:
 	void Dump() const;
 private:
 	friend class b3World;
+	friend class b3BodyStorage;
 	friend class b3Island;
 
 	friend class b3Contact;
 	friend class b3ConvexContact;
 	friend class b3MeshContact;
+	friend class b3HeightFieldContact;
+	friend class b3CompoundContact;
 	friend class b3ContactManager;
 	friend class b3ContactSolver;
 	
@@ -376,6 +397,10 @@ private:
 	friend class b3PrismaticJoint;
 	friend class b3WheelJoint;
 
+	friend class b3Articulation;
+
+	friend struct b3WorldTOIQueryWrapper;
+
 	friend class b3List<b3Body>;
 
 	// Flags
@@ -386,7 +411,8 @@ private:
 		e_autoSleepFlag = 0x0004,
 		e_fixedRotationX = 0x0008,
 		e_fixedRotationY = 0x0010,
-		e_fixedRotationZ = 0x0020
+		e_fixedRotationZ = 0x0020,
+		e_bulletFlag = 0x0040
 	};
 
 	b3Body(const b3BodyDef& def, b3World* world);
@@ -404,12 +430,52 @@ private:
 	void SynchronizeTransform();
 	void SynchronizeFixtures();
 
+	// Add this body to the world list of moved bodies of the next step.
+	void MarkMoved();
+
+	// Compute the extents of the fixtures about the center of mass.
+	void ComputeExtents();
+
 	// Check if this body should collide with another.
 	bool ShouldCollide(const b3Body* other) const;
 
+	// Motion proxy for CCD.
+	b3Sweep& Sweep();
+	const b3Sweep& Sweep() const;
+
+	// The body origin transform.
+	b3Transform& Transform();
+	const b3Transform& Transform() const;
+
+	b3Vec3& LinearVelocity();
+	const b3Vec3& LinearVelocity() const;
+
+	b3Vec3& AngularVelocity();
+	const b3Vec3& AngularVelocity() const;
+
+	b3Vec3& Force();
+	b3Vec3& Torque();
+
+	// Inverse body mass.
+	scalar& InvMass();
+	scalar InvMass() const;
+
+	// Inverse inertia about the body local center of mass.
+	b3Mat33& InvInertia();
+	const b3Mat33& InvInertia() const;
+
+	// Inverse inertia about the body world center of mass.
+	b3Mat33& WorldInvInertia();
+	const b3Mat33& WorldInvInertia() const;
+
 	b3BodyType m_type;
 	u32 m_islandID;
 	u32 m_flags;
+
+	// The last step that moved this body, 
+	// and the index of this body in the moved body list or B3_MAX_U32.
+	u32 m_movedStamp;
+	u32 m_movedIndex;
 	
 	// Body sleeping
 	scalar m_linearSleepTolerance;
@@ -422,47 +488,122 @@ private:
 	// Joint edges for this body joint graph.
 	b3List<b3JointEdge> m_jointEdges;
 
+	// The articulation that moves this body, if any.
+	b3Articulation* m_articulation;
+
 	// User associated data (usually an entity).
 	void* m_userData;
 
 	// Body mass.
 	scalar m_mass;
 
-	// Inverse body mass.
-	scalar m_invMass;
-	
 	// Inertia about the body local center of mass.
 	b3Mat33 m_I;	
-	
-	// Inverse inertia about the body local center of mass.
-	b3Mat33 m_invI;	
-	
-	// Inverse inertia about the body world center of mass.
-	b3Mat33 m_worldInvI;
-	
-	b3Vec3 m_force;
-	b3Vec3 m_torque;
-	b3Vec3 m_linearVelocity;
-	b3Vec3 m_angularVelocity;
+
+	// The smallest half extent of the fixtures and the largest distance 
+	// of a fixture point from the center of mass. 
+	// These tell if the body is fast enough to tunnel.
+	scalar m_minExtent;
+	scalar m_maxExtent;
 	
 	b3Vec3 m_linearDamping;
 	b3Vec3 m_angularDamping;
 	b3Vec3 m_gravityScale;
 	
-	// Motion proxy for CCD.
-	b3Sweep m_sweep;
-
-	// The body origin transform. 
-	b3Transform m_xf;
-		
 	// The parent world of this body.
 	b3World* m_world;
+
+	// The storage of the state that is touched every step.
+	b3BodyStorage* m_storage;
+
+	// The index of this body in the storage.
+	u32 m_index;
 	
 	// Links to the world body list.
 	b3Body* m_prev;
 	b3Body* m_next;
 };
 
+inline b3Sweep& b3Body::Sweep()
+{
+	return m_storage->m_sweeps[m_index];
+}
+
+inline const b3Sweep& b3Body::Sweep() const
+{
+	return m_storage->m_sweeps[m_index];
+}
+
+inline b3Transform& b3Body::Transform()
+{
+	return m_storage->m_transforms[m_index];
+}
+
+inline const b3Transform& b3Body::Transform() const
+{
+	return m_storage->m_transforms[m_index];
+}
+
+inline b3Vec3& b3Body::LinearVelocity()
+{
+	return m_storage->m_linearVelocities[m_index];
+}
+
+inline const b3Vec3& b3Body::LinearVelocity() const
+{
+	return m_storage->m_linearVelocities[m_index];
+}
+
+inline b3Vec3& b3Body::AngularVelocity()
+{
+	return m_storage->m_angularVelocities[m_index];
+}
+
+inline const b3Vec3& b3Body::AngularVelocity() const
+{
+	return m_storage->m_angularVelocities[m_index];
+}
+
+inline b3Vec3& b3Body::Force()
+{
+	return m_storage->m_forces[m_index];
+}
+
+inline b3Vec3& b3Body::Torque()
+{
+	return m_storage->m_torques[m_index];
+}
+
+inline scalar& b3Body::InvMass()
+{
+	return m_storage->m_invMasses[m_index];
+}
+
+inline scalar b3Body::InvMass() const
+{
+	return m_storage->m_invMasses[m_index];
+}
+
+inline b3Mat33& b3Body::InvInertia()
+{
+	return m_storage->m_invInertias[m_index];
+}
+
+inline const b3Mat33& b3Body::InvInertia() const
+{
+	return m_storage->m_invInertias[m_index];
+}
+
+inline b3Mat33& b3Body::WorldInvInertia()
+{
+	return m_storage->m_worldInvInertias[m_index];
+}
+
+inline const b3Mat33& b3Body::WorldInvInertia() const
+{
+	return m_storage->m_worldInvInertias[m_index];
+}
+
 inline const b3Body* b3Body::GetNext() const
 {
 	return m_next;
@@ -478,6 +619,11 @@ inline const b3World* b3Body::GetWorld() const
 	return m_world;
 }
 
+inline u32 b3Body::GetIndex() const
+{
+	return m_index;
+}
+
 inline b3World* b3Body::GetWorld() 
 {
 	return m_world;
@@ -518,106 +664,114 @@ inline b3List<b3JointEdge>& b3Body::GetJointList()
 	return m_jointEdges;
 }
 
-inline const b3Transform& b3Body::GetTransform() const
+inline b3Transform b3Body::GetTransform() const
 {
-	return m_xf;
+	return Transform();
 }
 
 inline void b3Body::SetTransform(const b3Vec3& position, const b3Quat& orientation)
 {
-	m_xf.translation = position;
-	m_xf.rotation = orientation;
+	b3Transform& xf = Transform();
+	xf.translation = position;
+	xf.rotation = orientation;
 
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.orientation = orientation;
+	b3Sweep& sweep = Sweep();
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.orientation = xf.rotation;
 
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
-	m_sweep.orientation0 = m_sweep.orientation;
+	sweep.worldCenter0 = sweep.worldCenter;
+	sweep.orientation0 = sweep.orientation;
 
-	m_worldInvI = b3RotateToFrame(m_invI, orientation);
+	WorldInvInertia() = b3RotateToFrame(InvInertia(), xf.rotation);
 
 	SynchronizeFixtures();
+
+	MarkMoved();
 }
 
 inline void b3Body::SetTransform(const b3Vec3& position, const b3Mat33& orientation)
 {
-	m_xf.translation = position;
-	m_xf.rotation = b3Mat33Quat(orientation);
+	b3Transform& xf = Transform();
+	xf.translation = position;
+	xf.rotation = b3Mat33Quat(orientation);
 
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.orientation = m_xf.rotation;
+	b3Sweep& sweep = Sweep();
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.orientation = xf.rotation;
 
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
-	m_sweep.orientation0 = m_sweep.orientation;
+	sweep.worldCenter0 = sweep.worldCenter;
+	sweep.orientation0 = sweep.orientation;
 
-	m_worldInvI = b3RotateToFrame(m_invI, m_xf.rotation);
+	WorldInvInertia() = b3RotateToFrame(InvInertia(), xf.rotation);
 
 	SynchronizeFixtures();
+
+	MarkMoved();
 }
 
 inline b3Vec3 b3Body::GetPosition() const
 {
-	return m_xf.translation;
+	return Transform().translation;
 }
 
 inline b3Quat b3Body::GetOrientation() const
 {
-	return m_sweep.orientation;
+	return Sweep().orientation;
 }
 
 inline b3Vec3 b3Body::GetWorldCenter() const
 {
-	return m_sweep.worldCenter;
+	return Sweep().worldCenter;
 }
 
 inline b3Vec3 b3Body::GetLocalCenter() const
 {
-	return m_sweep.localCenter;
+	return Sweep().localCenter;
 }
 
 inline b3Vec3 b3Body::GetLocalVector(const b3Vec3& vector) const
 {
-	return b3MulC(m_xf.rotation, vector);
+	return b3MulC(Transform().rotation, vector);
 }
 
 inline b3Vec3 b3Body::GetWorldVector(const b3Vec3& localVector) const
 {
-	return b3Mul(m_xf.rotation, localVector);
+	return b3Mul(Transform().rotation, localVector);
 }
 
 inline b3Vec3 b3Body::GetLocalPoint(const b3Vec3& point) const
 {
-	return b3MulT(m_xf, point);
+	return b3MulT(Transform(), point);
 }
 
 inline b3Vec3 b3Body::GetWorldPoint(const b3Vec3& point) const
 {
-	return b3Mul(m_xf, point);
+	return b3Mul(Transform(), point);
 }
 
 inline b3Quat b3Body::GetLocalFrame(const b3Quat& frame) const
 {
-	return b3MulC(m_sweep.orientation, frame);
+	return b3MulC(Sweep().orientation, frame);
 }
 
 inline b3Quat b3Body::GetWorldFrame(const b3Quat& localFrame) const
 {
-	return b3Mul(m_sweep.orientation, localFrame);
+	return b3Mul(Sweep().orientation, localFrame);
 }
 
 inline b3Transform b3Body::GetLocalFrame(const b3Transform& xf) const
 {
-	return b3MulT(m_xf, xf);
+	return b3MulT(Transform(), xf);
 }
 
 inline b3Transform b3Body::GetWorldFrame(const b3Transform& xf) const
 {
-	return b3Mul(m_xf, xf);
+	return b3Mul(Transform(), xf);
 }
 
-inline const b3Sweep& b3Body::GetSweep() const
+inline b3Sweep b3Body::GetSweep() const
 {
-	return m_sweep;
+	return Sweep();
 }
 
 inline bool b3Body::IsAwake() const
@@ -639,10 +793,10 @@ inline void b3Body::SetAwake(bool flag)
 	{
 		m_flags &= ~e_awakeFlag;
 		m_sleepTime = scalar(0);
-		m_force.SetZero();
-		m_torque.SetZero();
-		m_linearVelocity.SetZero();
-		m_angularVelocity.SetZero();		
+		Force().SetZero();
+		Torque().SetZero();
+		LinearVelocity().SetZero();
+		AngularVelocity().SetZero();		
 	}
 }
 
@@ -681,12 +835,12 @@ inline void b3Body::SetGravityScale(const b3Vec3& scale)
 
 inline b3Vec3 b3Body::GetPointVelocity(const b3Vec3& point) const
 {
-	return m_linearVelocity + b3Cross(m_angularVelocity, point - m_sweep.worldCenter);
+	return LinearVelocity() + b3Cross(AngularVelocity(), point - Sweep().worldCenter);
 }
 
 inline b3Vec3 b3Body::GetLinearVelocity() const
 {
-	return m_linearVelocity;
+	return LinearVelocity();
 }
 
 inline void b3Body::SetLinearVelocity(const b3Vec3& linearVelocity)
@@ -701,12 +855,12 @@ inline void b3Body::SetLinearVelocity(const b3Vec3& linearVelocity)
 		SetAwake(true);
 	}
 
-	m_linearVelocity = linearVelocity;
+	LinearVelocity() = linearVelocity;
 }
 
 inline b3Vec3 b3Body::GetAngularVelocity() const
 {
-	return m_angularVelocity;
+	return AngularVelocity();
 }
 
 inline void b3Body::SetAngularVelocity(const b3Vec3& angularVelocity) 
@@ -721,7 +875,7 @@ inline void b3Body::SetAngularVelocity(const b3Vec3& angularVelocity)
 		SetAwake(true);
 	}
 
-	m_angularVelocity = angularVelocity;
+	AngularVelocity() = angularVelocity;
 }
 
 inline scalar b3Body::GetMass() const
@@ -731,12 +885,12 @@ inline scalar b3Body::GetMass() const
 
 inline scalar b3Body::GetInverseMass() const
 {
-	return m_invMass;
+	return InvMass();
 }
 
-inline const b3Mat33& b3Body::GetWorldInverseInertia() const
+inline b3Mat33 b3Body::GetWorldInverseInertia() const
 {
-	return m_worldInvI;
+	return WorldInvInertia();
 }
 
 inline const b3Mat33& b3Body::GetInertia() const
@@ -746,15 +900,15 @@ inline const b3Mat33& b3Body::GetInertia() const
 
 inline scalar b3Body::GetLinearEnergy() const
 {
-	b3Vec3 P = m_mass * m_linearVelocity;
-	return b3Dot(P, m_linearVelocity);
+	b3Vec3 P = m_mass * LinearVelocity();
+	return b3Dot(P, LinearVelocity());
 }
 
 inline scalar b3Body::GetAngularEnergy() const
 {
-	b3Mat33 I = b3RotateToFrame(m_I, m_xf.rotation);
-	b3Vec3 L = I * m_angularVelocity;
-	return b3Dot(L, m_angularVelocity);
+	b3Mat33 I = b3RotateToFrame(m_I, Transform().rotation);
+	b3Vec3 L = I * AngularVelocity();
+	return b3Dot(L, AngularVelocity());
 }
 
 inline scalar b3Body::GetEnergy() const
@@ -778,8 +932,8 @@ inline void b3Body::ApplyForce(const b3Vec3& force, const b3Vec3& point, bool wa
 
 	if (IsAwake()) 
 	{
-		m_force += force;
-		m_torque += b3Cross(point - m_sweep.worldCenter, force);
+		Force() += force;
+		Torque() += b3Cross(point - Sweep().worldCenter, force);
 	}
 }
 
@@ -797,7 +951,7 @@ inline void b3Body::ApplyForceToCenter(const b3Vec3& force, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_force += force;
+		Force() += force;
 	}
 }
 
@@ -815,7 +969,7 @@ inline void b3Body::ApplyTorque(const b3Vec3& torque, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_torque += torque;
+		Torque() += torque;
 	}
 }
 
@@ -833,8 +987,8 @@ inline void b3Body::ApplyLinearImpulse(const b3Vec3& impulse, const b3Vec3& worl
 
 	if (IsAwake()) 
 	{
-		m_linearVelocity += m_invMass * impulse;
-		m_angularVelocity += b3Mul(m_worldInvI, b3Cross(worldPoint - m_sweep.worldCenter, impulse));
+		LinearVelocity() += InvMass() * impulse;
+		AngularVelocity() += b3Mul(WorldInvInertia(), b3Cross(worldPoint - Sweep().worldCenter, impulse));
 	}
 }
 
@@ -852,7 +1006,7 @@ inline void b3Body::ApplyAngularImpulse(const b3Vec3& impulse, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_angularVelocity += b3Mul(m_worldInvI, impulse);
+		AngularVelocity() += b3Mul(WorldInvInertia(), impulse);
 	}
 }
 
@@ -884,4 +1038,21 @@ inline bool b3Body::IsSleepingAllowed() const
 	return (m_flags & e_autoSleepFlag) == e_autoSleepFlag;
 }
 
+inline void b3Body::SetBullet(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_bulletFlag;
+	}
+	else
+	{
+		m_flags &= ~e_bulletFlag;
+	}
+}
+
+inline bool b3Body::IsBullet() const
+{
+	return (m_flags & e_bulletFlag) == e_bulletFlag;
+}
+
 #endif
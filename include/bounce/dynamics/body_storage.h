@@ -0,0 +1,85 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_BODY_STORAGE_H
+#define B3_BODY_STORAGE_H
+
+#include <bounce/common/math/mat33.h>
+#include <bounce/common/math/transform.h>
+#include <bounce/common/math/sweep.h>
+#include <bounce/common/memory/state_buffer.h>
+
+class b3Body;
+
+// Contiguous storage of the body state that is read and written every step.
+// Each array is indexed by the body index. 
+// Removing a body moves the last body into its slot so the arrays stay dense.
+// Don't keep pointers into the arrays across body creation or destruction.
+class b3BodyStorage
+{
+public:
+	b3BodyStorage();
+	~b3BodyStorage();
+
+	// Add a body and return its index.
+	u32 Add(b3Body* body);
+
+	// Remove the body at a given index.
+	void Remove(u32 index);
+
+	// Get the size in bytes of the arrays.
+	u32 GetSize() const;
+
+	// Write the state arrays to a buffer.
+	void SaveState(b3StateBuffer* buffer) const;
+
+	// Read the state arrays written by SaveState. 
+	// The number of bodies must be the same as the saved one.
+	void RestoreState(b3StateBuffer* buffer);
+
+	u32 m_capacity;
+	u32 m_count;
+
+	// The body of each index.
+	b3Body** m_bodies;
+
+	// Motion proxies for CCD.
+	b3Sweep* m_sweeps;
+
+	// The body origin transforms.
+	b3Transform* m_transforms;
+
+	b3Vec3* m_linearVelocities;
+	b3Vec3* m_angularVelocities;
+	
+	b3Vec3* m_forces;
+	b3Vec3* m_torques;
+
+	// Inverse body masses.
+	scalar* m_invMasses;
+
+	// Inverse inertias about the body local center of mass.
+	b3Mat33* m_invInertias;
+
+	// Inverse inertias about the body world center of mass.
+	b3Mat33* m_worldInvInertias;
+private:
+	void Reserve(u32 capacity);
+};
+
+#endif
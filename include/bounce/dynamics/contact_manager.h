@@ -20,13 +20,16 @@
 #define B3_CONTACT_MANAGER_H
 
 #include <bounce/common/template/list.h>
+#include <bounce/common/template/array.h>
 #include <bounce/collision/broad_phase.h>
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/common/thread_pool.h>
 
 class b3Shape;
 class b3ContactFilter;
 class b3ContactListener;
 class b3BlockAllocator;
+class b3StackAllocator;
 class b3Profiler;
 
 // Contact delegator for b3World.
@@ -34,6 +37,7 @@ class b3ContactManager
 {
 public:
 	b3ContactManager();
+	~b3ContactManager();
 
 	// The broad-phase callback.
 	void AddPair(void* proxyDataA, void* proxyDataB);
@@ -46,17 +50,49 @@ public:
 	void FindNewContacts();
 	
 	// Perform narrow-phase collision detection.
+	// The contacts are updated in parallel if there is a thread pool. 
+	// The bodies are woken and the listener is notified afterwards in the order of the contact arrays, 
+	// so the results don't depend on the number of threads.
 	void UpdateContacts();
 
+	// The narrow-phase task. Update a range of the gathered contacts.
+	static void UpdateContactRange(void* context, u32 begin, u32 end, u32 threadIndex);
+
+	// Create a contact between two fixtures and add it to the contact arrays, 
+	// the fixture edge arrays, and the contact list.
 	b3Contact* Create(b3Fixture* fixtureA, b3Fixture* fixtureB);
 	void Destroy(b3Contact* c);
 
+	// Write the broad-phase and the contacts to a buffer.
+	void SaveState(b3StateBuffer* buffer) const;
+
+	// Read the state written by SaveState. The fixtures must be the same as the saved ones.
+	// Contacts that don't exist in the saved state are destroyed and missing ones are created.
+	// The contact listener isn't notified.
+	void RestoreState(b3StateBuffer* buffer, b3StackAllocator* allocator);
+
 	b3BroadPhase m_broadPhase;	
+	
+	// The contact list exposed to the user.
 	b3List<b3Contact> m_contactList;
+	
+	// Dense arrays of contacts, one per pair of shape types. 
+	// Removing a contact moves the last contact of its array into its slot.
+	// The passes over all contacts iterate these arrays.
+	b3StackArray<b3Contact*, 16> m_contacts[b3Shape::e_typeCount][b3Shape::e_typeCount];
 	b3ContactFilter* m_contactFilter;
 	b3ContactListener* m_contactListener;
 	b3BlockAllocator* m_allocator;
+	b3StackAllocator* m_stackAllocator;
 	b3Profiler* m_profiler;
+
+	// Optional thread pool for the narrow-phase.
+	b3ThreadPool* m_threadPool;
+
+	// Stack allocators of the threads of the pool other than the calling thread.
+	// They are created on demand and grow to the high-water mark of each thread.
+	b3StackAllocator* m_threadStacks[b3_maxThreadCount];
+	u32 m_threadStackCount;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_COMPOUND_CONTACT_H
+#define B3_COMPOUND_CONTACT_H
+
+#include <bounce/dynamics/contacts/contact.h>
+#include <bounce/collision/collide/collide.h>
+#include <bounce/collision/collide/cluster.h>
+
+// A pair of children that are potentially overlapping.
+struct b3CompoundPair
+{
+	u32 indexA; // child index in the shape A
+	u32 indexB; // child index in the shape B
+	b3ConvexCache cache;
+};
+
+// A contact between a compound and another shape. 
+// The other shape can be convex, a compound, a mesh, or a height field.
+// The child manifolds are reduced by clustering.
+class b3CompoundContact : public b3Contact
+{
+public:
+	static b3Contact* Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAllocator* allocator);
+	static void Destroy(b3Contact* contact, b3BlockAllocator* allocator);
+
+	b3CompoundContact(b3Fixture* fixtureA, b3Fixture* fixtureB);
+	~b3CompoundContact();
+
+	bool TestOverlap() override;
+
+	void SynchronizeFixture() override;
+
+	void FindPairs() override;
+
+	void GetCacheStats(u32* count, u32* size) const override;
+
+	void SaveState(b3StateBuffer* buffer) const override;
+
+	void RestoreState(b3StateBuffer* buffer) override;
+
+	void Collide(b3StackAllocator* allocator) override;
+
+	// Compute the AABB B relative to the unscaled frame of the shape A.
+	void ComputeAABBB(b3AABB* aabb, const b3Transform& xf) const;
+
+	// Compute the AABB A relative to the frame of the shape B.
+	void ComputeAABBA(b3AABB* aabb, const b3Transform& xf) const;
+
+	// Add a child pair to the overlapping buffer.
+	void AddPair(u32 indexA, u32 indexB);
+
+	// Are the children of the shape A queried using the AABB B?
+	bool m_queryA;
+	
+	// Are the children of the shape B queried using the AABB A?
+	bool m_queryB;
+
+	// Did the AABBs move significantly?
+	bool m_aabbAMoved;
+	bool m_aabbBMoved;
+
+	// The AABB A relative to the frame of the shape B.
+	b3AABB m_aabbA;
+	
+	// The AABB B relative to the unscaled frame of the shape A.
+	b3AABB m_aabbB;
+
+	// Child pairs potentially overlapping.
+	u32 m_pairCapacity;
+	b3CompoundPair* m_pairs;
+	u32 m_pairCount;
+
+	// Contact manifolds.
+	b3Manifold m_clusterManifolds[B3_MAX_MANIFOLDS];
+
+	// Clusters of the last step.
+	b3ClusterCache m_clusterCache;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include <bounce/common/math/math.h>
 #include <bounce/common/template/list.h>
 #include <bounce/common/template/array.h>
+#include <bounce/common/memory/state_buffer.h>
 #include <bounce/dynamics/fixture.h>
 #include <bounce/collision/collide/manifold.h>
 
@@ -32,39 +33,31 @@ class b3Body;
 class b3Contact;
 class b3ContactListener;
 class b3BlockAllocator;
+class b3StackAllocator;
 struct b3ConvexCache;
 
-// A contact edge for the contact graph, 
-// where a fixture is a vertex and a contact 
-// an edge.
-struct b3ContactEdge
-{
-	b3Fixture* other;
-	b3Contact* contact;
-	// Links to the contact edge list.
-	b3ContactEdge* m_prev;
-	b3ContactEdge* m_next;
-};
-
 // This goes inside a contact.
 // It holds two shapes that are overlapping.
 struct b3OverlappingPair
 {
-	// To the fixture A edge list.
 	b3Fixture* fixtureA;
-	b3ContactEdge edgeA;
-	// To the fixture B edge list.
+	// Index of the edge in the fixture A edge array.
+	u32 edgeA;
 	b3Fixture* fixtureB;
-	b3ContactEdge edgeB;
+	// Index of the edge in the fixture B edge array.
+	u32 edgeB;
 };
 
 typedef b3Contact* b3ContactCreateFcn(b3Fixture* shapeA, b3Fixture* shapeB, b3BlockAllocator* allocator);
 typedef void b3ContactDestroyFcn(b3Contact* contact, b3BlockAllocator* allocator);
+typedef void b3ContactUpdateFcn(b3Contact** contacts, u32 count, b3StackAllocator* allocator);
 
 struct b3ContactRegister
 {
 	b3ContactCreateFcn* createFcn = nullptr;
 	b3ContactDestroyFcn* destroyFcn = nullptr;
+	b3ContactUpdateFcn* updateFcn = nullptr;
+	u32 size = 0;
 	bool primary;
 };
 
@@ -110,6 +103,7 @@ protected:
 	friend class b3Fixture;
 	friend class b3ContactManager;
 	friend class b3ContactSolver;
+	friend class b3Articulation;
 	friend class b3List<b3Contact>;
 
 	// Flags
@@ -117,18 +111,22 @@ protected:
 	{
 		e_overlapFlag = 0x0001,
 		e_islandFlag = 0x0002,
+		e_reuseFlag = 0x0004,
+		e_changedFlag = 0x0008,
 	};
 
 	b3Contact(b3Fixture* fixtureA, b3Fixture* fixtureB);
 	virtual ~b3Contact() { }
 
 	static b3ContactRegister s_registers[b3Shape::e_typeCount][b3Shape::e_typeCount];
-	static bool s_initialized;
 	
 	static void AddType(b3ContactCreateFcn* createFcn, b3ContactDestroyFcn* destoryFcn,
-		b3Shape::Type type1, b3Shape::Type type2);
+		b3ContactUpdateFcn* updateFcn, u32 size, b3Shape::Type type1, b3Shape::Type type2);
 	
-	static void InitializeRegisters();
+	static bool InitializeRegisters();
+
+	// Get the register of two shape types. The registers are initialized on the first call.
+	static const b3ContactRegister& GetRegister(b3Shape::Type type1, b3Shape::Type type2);
 
 	// Factory create.
 	static b3Contact* Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAllocator* allocator);
@@ -136,15 +134,41 @@ protected:
 	// Factory destroy.
 	static void Destroy(b3Contact* contact, b3BlockAllocator* allocator);
 
-	// Update the contact state.
-	void Update(b3ContactListener* listener);
+	// Get the size in bytes of the contact objects of the given shape types.
+	static u32 GetSize(b3Shape::Type type1, b3Shape::Type type2);
+
+	// Update the manifolds and the overlap state.
+	// This only writes to this contact, so different contacts can be updated 
+	// in parallel, each thread using its own stack allocator.
+	// Call Report afterwards to wake the bodies and notify the listener.
+	void Update(b3StackAllocator* allocator);
+
+	// Update the contact state without virtual calls. 
+	// T must be the dynamic type of this contact.
+	template <class T>
+	void Update(b3StackAllocator* allocator);
+
+	// Update a batch of contacts whose dynamic type is T.
+	template <class T>
+	static void UpdateBatch(b3Contact** contacts, u32 count, b3StackAllocator* allocator);
+
+	// Update a batch of contacts of the same shape types.
+	static void UpdateBatch(b3Contact** contacts, u32 count, b3StackAllocator* allocator);
+
+	// Wake the bodies if the overlap state has changed in the last update 
+	// and notify the listener.
+	void Report(b3ContactListener* listener);
 
 	// Collide function.
-	virtual void Collide() = 0;
+	virtual void Collide(b3StackAllocator* allocator) = 0;
 
 	// Test if the shapes in this contact are overlapping.
 	virtual bool TestOverlap() = 0;
 
+	// Return the given cache if the world of this contact uses the convex cache.
+	// Otherwise, return null.
+	b3ConvexCache* SelectConvexCache(b3ConvexCache* cache) const;
+
 	// Some contacts store reference AABBs for internal queries and therefore 
 	// need to synchronize with body transforms.
 	virtual void SynchronizeFixture() { }
@@ -153,9 +177,41 @@ protected:
 	// new internal overlapping pairs.
 	virtual void FindPairs() { }
 
+	// Write the state that persists across steps, such as the manifolds and collision caches.
+	virtual void SaveState(b3StateBuffer* buffer) const;
+
+	// Read the state written by SaveState.
+	virtual void RestoreState(b3StateBuffer* buffer);
+
+	// Get the number of cached internal pairs and the size in bytes of the cache.
+	// The cache is allocated with b3Alloc and isn't part of the contact object.
+	virtual void GetCacheStats(u32* count, u32* size) const
+	{
+		*count = 0;
+		*size = 0;
+	}
+
+	// Can the contact points of the last step be reused 
+	// given the current relative transform of the shapes?
+	bool CanReuseManifolds(const b3Transform& xf) const;
+
+	// Compute the distance below which separated shapes get speculative 
+	// contact points in this step. Return zero if the speculative contacts are disabled.
+	scalar ComputeSpeculativeDistance() const;
+
 	u32 m_flags;
 	b3OverlappingPair m_pair;
 
+	// Index of this contact in the contact manager array of its shape types.
+	u32 m_index;
+
+	// The transform of the shape B relative to the shape A 
+	// when the contact points were last built.
+	b3Transform m_xf;
+
+	// The speculative distance of the last update.
+	scalar m_speculativeDistance;
+
 	// Contact manifolds.
 	u32 m_manifoldCapacity;
 	b3Manifold* m_manifolds;
@@ -67,6 +67,12 @@ struct b3VelocityConstraintPoint
 	scalar normalMass;
 	scalar normalImpulse;
 	scalar velocityBias;
+	scalar separation;
+	scalar maxNormalImpulse;
+
+	// The split impulse
+	scalar pseudoBias;
+	scalar pseudoImpulse;
 };
 
 struct b3VelocityConstraintManifold
@@ -89,6 +95,11 @@ struct b3VelocityConstraintManifold
 
 	b3VelocityConstraintPoint* points;
 	u32 pointCount;
+
+	// The effective mass matrix of the normal constraints and 
+	// the points found active in the last iteration for the block solver
+	scalar normalK[B3_MAX_MANIFOLD_POINTS][B3_MAX_MANIFOLD_POINTS];
+	u32 activeSet;
 };
 
 struct b3ContactVelocityConstraint 
@@ -101,6 +112,7 @@ struct b3ContactVelocityConstraint
 	b3Mat33 invIB;
 	scalar friction;
 	scalar restitution;
+	b3Softness softness;
 	b3VelocityConstraintManifold* manifolds;
 	u32 manifoldCount;
 };
@@ -110,10 +122,14 @@ struct b3ContactSolverDef
 	b3Position* positions;
 	b3Velocity* velocities;
 	b3Mat33* invInertias;
+	b3Displacement* displacements; // only used by the sub-stepping solver
+	b3Velocity* pseudoVelocities; // only used by the split impulse solver
 	b3Contact** contacts;
 	u32 count;
 	b3StackAllocator* allocator;
 	scalar dt;
+	bool blockSolve;
+	bool speculative; // solve the points with a positive separation as speculative
 };
 
 // The idea is to allow anything to bounce off an inelastic surface.
@@ -137,19 +153,46 @@ public:
 	void InitializeConstraints();
 	void WarmStart();
 	
-	void SolveVelocityConstraints();
+	// Return the maximum magnitude of the incremental impulses applied.
+	scalar SolveVelocityConstraints();
 	void StoreImpulses();
 
 	bool SolvePositionConstraints();
+
+	// Push the overlapping shapes apart using the pseudo velocities.
+	// The pseudo velocities only move the bodies in the position integration 
+	// so the correction doesn't add energy to the velocities.
+	// Return the maximum magnitude of the incremental impulses applied.
+	scalar SolveSplitImpulses();
+
+	// Is the overlap found by the initialization within the tolerance?
+	// This replaces the result of the position solver when the split impulses are used.
+	bool IsOverlapSolved() const;
+
+	// Solve the soft contact constraints of a sub-step. 
+	// The separations are updated from the body displacements.
+	// Use the bias to push shapes apart, and relax without bias
+	// to remove the velocity added by the push.
+	void SolveSoftConstraints(bool useBias);
+	
+	// Apply restitution after all sub-steps.
+	void ApplyRestitution();
 protected:
 	b3Position* m_positions;
 	b3Velocity* m_velocities;
+	b3Displacement* m_displacements;
+	b3Velocity* m_pseudoVelocities;
 	b3Mat33* m_inertias;
 	b3Contact** m_contacts;
 	b3ContactPositionConstraint* m_positionConstraints;
 	b3ContactVelocityConstraint* m_velocityConstraints;
 	u32 m_count;
+	u32* m_splitIndices; // the contacts with overlaps to resolve
+	u32 m_splitCount;
 	scalar m_dt, m_invDt;
+	scalar m_minSeparation;
+	bool m_blockSolve;
+	bool m_speculative;
 	b3StackAllocator* m_allocator;
 };
 
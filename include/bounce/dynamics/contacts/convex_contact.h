@@ -20,6 +20,7 @@
 #define B3_CONVEX_CONTACT_H
 
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/body.h>
 #include <bounce/collision/collide/manifold.h>
 #include <bounce/collision/collide/collide.h>
 
@@ -31,12 +32,38 @@ public:
 
 	bool TestOverlap() override;
 
-	void Collide() override;
+	void Collide(b3StackAllocator* allocator) override;
+
+	void SaveState(b3StateBuffer* buffer) const override;
+
+	void RestoreState(b3StateBuffer* buffer) override;
 
 	virtual void Evaluate(b3Manifold& manifold, const b3Transform& xfA, const b3Transform& xfB) = 0;
 
+	// Collide without virtual calls. 
+	// T must be the dynamic type of this contact.
+	template <class T>
+	void Collide();
+
 	b3Manifold m_manifold;
 	b3ConvexCache m_cache;
 };
 
+template <class T>
+inline void b3ConvexContact::Collide()
+{
+	b3Transform xfA = GetFixtureA()->GetBody()->GetTransform();
+	b3Transform xfB = GetFixtureB()->GetBody()->GetTransform();
+
+	B3_ASSERT(m_manifoldCount == 0);
+	static_cast<T*>(this)->T::Evaluate(m_manifold, xfA, xfB);
+	
+	if (m_manifold.pointCount == 0 && m_speculativeDistance > scalar(0))
+	{
+		b3CollideSpeculative(m_manifold, xfA, GetFixtureA()->GetShape(), xfB, GetFixtureB()->GetShape(), m_speculativeDistance);
+	}
+
+	m_manifoldCount = 1;
+}
+
 #endif
@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_HEIGHT_FIELD_CONTACT_H
+#define B3_HEIGHT_FIELD_CONTACT_H
+
+#include <bounce/dynamics/contacts/mesh_contact.h>
+
+// A contact between a height field and a convex shape.
+// The overlapping triangles are found by indexing the grid cells directly.
+class b3HeightFieldContact : public b3Contact
+{
+public:
+	b3HeightFieldContact(b3Fixture* fixtureA, b3Fixture* fixtureB);
+	~b3HeightFieldContact();
+
+	bool TestOverlap() override;
+
+	void SynchronizeFixture() override;
+
+	void FindPairs() override;
+
+	void GetCacheStats(u32* count, u32* size) const override;
+
+	void SaveState(b3StateBuffer* buffer) const override;
+
+	void RestoreState(b3StateBuffer* buffer) override;
+
+	void Collide(b3StackAllocator* allocator) override;
+
+	virtual void Evaluate(b3Manifold& manifold, const b3Transform& xfA, const b3Transform& xfB, u32 cacheIndex) = 0;
+
+	bool MoveAABB(const b3AABB& aabb, const b3Vec3& displacement);
+
+	// Height field callback. 
+	bool Report(u32 triangleIndex);
+
+	// Did the AABB move significantly?
+	bool m_aabbBMoved;
+
+	// The AABB B relative to the unscaled grid of shape A.
+	b3AABB m_aabbB; 
+	
+	// Triangles potentially overlapping with the first shape.
+	u32 m_triangleCapacity;
+	b3TriangleCache* m_triangles;
+	u32 m_triangleCount;
+
+	// Contact manifolds.
+	b3Manifold m_clusterManifolds[B3_MAX_MANIFOLDS];
+
+	// Clusters of the last step.
+	b3ClusterCache m_clusterCache;
+};
+
+#endif
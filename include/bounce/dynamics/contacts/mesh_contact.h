@@ -22,6 +22,7 @@
 #include <bounce/dynamics/contacts/contact.h>
 #include <bounce/collision/collide/manifold.h>
 #include <bounce/collision/collide/collide.h>
+#include <bounce/collision/collide/cluster.h>
 #include <bounce/collision/geometry/aabb.h>
 
 // This structure holds an overlapping triangle. 
@@ -45,7 +46,13 @@ public:
 
 	void FindPairs() override;
 
-	void Collide() override;
+	void GetCacheStats(u32* count, u32* size) const override;
+
+	void SaveState(b3StateBuffer* buffer) const override;
+
+	void RestoreState(b3StateBuffer* buffer) override;
+
+	void Collide(b3StackAllocator* allocator) override;
 
 	virtual void Evaluate(b3Manifold& manifold, const b3Transform& xfA, const b3Transform& xfB, u32 cacheIndex) = 0;
 
@@ -67,6 +74,9 @@ public:
 
 	// Contact manifolds.
 	b3Manifold m_clusterManifolds[B3_MAX_MANIFOLDS];
+
+	// Clusters of the last step.
+	b3ClusterCache m_clusterCache;
 };
 
 #endif
\ No newline at end of file
@@ -20,11 +20,22 @@
 #define B3_FIXTURE_H
 
 #include <bounce/common/template/list.h>
+#include <bounce/common/template/array.h>
 #include <bounce/common/graphics/color.h>
 #include <bounce/collision/shapes/shape.h>
 #include <bounce/dynamics/body.h>
 
-struct b3ContactEdge;
+class b3Fixture;
+class b3Contact;
+
+// A contact edge for the contact graph, 
+// where a fixture is a vertex and a contact 
+// an edge.
+struct b3ContactEdge
+{
+	b3Fixture* other;
+	b3Contact* contact;
+};
 
 class b3Body;
 class b3Shape;
@@ -133,9 +144,9 @@ public:
 	// Get broadphase AABB.
 	const b3AABB& GetAABB() const;
 
-	// Get the list of contacts that contains this body.
-	const b3List<b3ContactEdge>& GetContactList() const;
-	b3List<b3ContactEdge>& GetContactList();
+	// Get the edges of the contacts that contain this fixture.
+	const b3Array<b3ContactEdge>& GetContactList() const;
+	b3Array<b3ContactEdge>& GetContactList();
 
 	// Dump this shape to the log file.
 	void Dump(u32 bodyIndex) const;
@@ -155,7 +166,10 @@ protected:
 	friend class b3Contact;
 	friend class b3ContactManager;
 	friend class b3MeshContact;
+	friend class b3HeightFieldContact;
+	friend class b3CompoundContact;
 	friend class b3ContactSolver;
+	friend class b3Articulation;
 	friend class b3List<b3Fixture>;
 	
 	b3Fixture();
@@ -168,6 +182,13 @@ protected:
 	// Convenience function.
 	// Destroy the contacts associated with this fixture.
 	void DestroyContacts();
+
+	// Add an edge to the contact graph and return its index.
+	u32 AddContactEdge(b3Contact* contact, b3Fixture* other);
+
+	// Remove an edge from the contact graph. 
+	// The last edge is moved into its slot.
+	void RemoveContactEdge(u32 index);
 	
 	b3Shape* m_shape;
 
@@ -182,7 +203,8 @@ protected:
 	void* m_userData;
 
 	// Contact edges for this fixture contact graph.
-	b3List<b3ContactEdge> m_contactEdges;
+	// A few edges are stored inside the fixture.
+	b3StackArray<b3ContactEdge, 4> m_contactEdges;
 	
 	// The parent body of this fixture.
 	b3Body* m_body;
@@ -262,12 +284,12 @@ inline b3Body* b3Fixture::GetBody()
 	return m_body;
 }
 
-inline const b3List<b3ContactEdge>& b3Fixture::GetContactList() const
+inline const b3Array<b3ContactEdge>& b3Fixture::GetContactList() const
 {
 	return m_contactEdges;
 }
 
-inline b3List<b3ContactEdge>& b3Fixture::GetContactList()
+inline b3Array<b3ContactEdge>& b3Fixture::GetContactList()
 {
 	return m_contactEdges;
 }
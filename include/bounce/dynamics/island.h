@@ -44,16 +44,26 @@ public :
 	void Add(b3Contact* contact);
 	void Add(b3Joint* joint);
 	
-	void Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u32 positionIterations, u32 flags);
+	void Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u32 positionIterations, scalar impulseTolerance, u32 subStepCount, u32 flags);
 private :
 	enum 
 	{
 		e_warmStartBit = 0x0001,
-		e_sleepBit = 0x0002
+		e_sleepBit = 0x0002,
+		e_blockSolveBit = 0x0004,
+		e_splitImpulseBit = 0x0008,
+		e_speculativeBit = 0x0010,
+		e_jointBatchBit = 0x0020
 	};
 
 	friend class b3World;
 
+	void IntegrateVelocities(const b3Vec3& gravity, scalar h);
+	void IntegratePositions(scalar h, const b3Velocity* pseudoVelocities);
+	
+	bool SolveIterations(const b3Vec3& gravity, scalar h, u32 velocityIterations, u32 positionIterations, scalar impulseTolerance, u32 flags);
+	bool SolveSubSteps(const b3Vec3& gravity, scalar dt, u32 subStepCount, u32 flags);
+
 	void Report();
 
 	b3StackAllocator* m_allocator;
@@ -75,6 +85,9 @@ private :
 	b3Velocity* m_velocities;
 	b3Mat33* m_invInertias;
 
+	// The number of velocity iterations performed by the last solve
+	u32 m_velocityIterationCount;
+
 	b3Profiler* m_profiler;
 };
 
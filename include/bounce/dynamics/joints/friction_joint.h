@@ -95,9 +95,12 @@ private:
 
 	virtual void InitializeConstraints(const b3SolverData* data);
 	virtual void WarmStart(const b3SolverData* data);
-	virtual void SolveVelocityConstraints(const b3SolverData* data);
+	virtual scalar SolveVelocityConstraints(const b3SolverData* data);
 	virtual bool SolvePositionConstraints(const b3SolverData* data);
 
+	virtual void SaveState(b3StateBuffer* buffer) const;
+	virtual void RestoreState(b3StateBuffer* buffer);
+
 	// Solver shared
 	b3Vec3 m_localAnchorA;
 	b3Vec3 m_localAnchorB;
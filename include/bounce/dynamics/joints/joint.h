@@ -23,6 +23,7 @@
 #include <bounce/common/math/mat22.h>
 #include <bounce/common/math/mat33.h>
 #include <bounce/common/template/list.h>
+#include <bounce/common/memory/state_buffer.h>
 #include <bounce/dynamics/time_step.h>
 
 class b3Body;
@@ -147,9 +148,23 @@ protected:
 	
 	virtual void InitializeConstraints(const b3SolverData* data) = 0;
 	virtual void WarmStart(const b3SolverData* data) = 0;
-	virtual void SolveVelocityConstraints(const b3SolverData* data) = 0;
+	
+	// Return the maximum magnitude of the incremental impulses applied.
+	virtual scalar SolveVelocityConstraints(const b3SolverData* data) = 0;
 	virtual bool SolvePositionConstraints(const b3SolverData* data) = 0;
 
+	// Write the solver state that persists across steps, such as accumulated impulses.
+	virtual void SaveState(b3StateBuffer* buffer) const
+	{
+		B3_NOT_USED(buffer);
+	}
+
+	// Read the state written by SaveState.
+	virtual void RestoreState(b3StateBuffer* buffer)
+	{
+		B3_NOT_USED(buffer);
+	}
+
 	enum 
 	{
 		e_islandFlag = 0x0001,
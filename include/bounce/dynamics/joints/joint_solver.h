@@ -22,39 +22,106 @@
 #include <bounce/dynamics/time_step.h>
 
 class b3Joint;
+class b3StackAllocator;
 
-// A 1x12 Jacobian row.
-struct b3Jacobian
+// Point-to-point constraints of sphere, cone, and revolute joints in SoA layout.
+// Each constraint is a 3x3 block solved directly.
+struct b3PointConstraintBatch
 {
-	b3Vec3 linearA;
-	b3Vec3 angularA;
-	b3Vec3 linearB;
-	b3Vec3 angularB;
+	u32 count;
+	u32* indexA;
+	u32* indexB;
+	scalar* mA;
+	scalar* mB;
+	b3Mat33* iA;
+	b3Mat33* iB;
+	b3Vec3* rA;
+	b3Vec3* rB;
+	b3Mat33* invMass;
+	b3Vec3* impulse;
+	b3Vec3** jointImpulse;
+};
+
+// One degree of freedom angular constraint rows in SoA layout.
+// These are the angular limits of cone joints and the angular constraints, 
+// motors, and limits of revolute joints.
+// A row only acts on the angular velocities, so its Jacobian is an axis.
+struct b3RowConstraintBatch
+{
+	u32 count;
+	u32* indexA;
+	u32* indexB;
+	b3Vec3* axis;
+	b3Vec3* invIAxisA;
+	b3Vec3* invIAxisB;
+	scalar* mass;
+	scalar* bias;
+	scalar* lower;
+	scalar* upper;
+	scalar* impulse;
+	scalar** jointImpulse;
 };
 
 struct b3JointSolverDef 
 {
+	b3StackAllocator* allocator;
 	scalar dt;
 	u32 count;
 	b3Joint** joints;
 	b3Position* positions;
 	b3Velocity* velocities;
 	b3Mat33* invInertias;
+	
+	// Solve sphere, cone, and revolute joints in batches grouped by constraint type. 
+	// Otherwise each joint solves all of its constraints in island order.
+	bool batch;
 };
 
 class b3JointSolver 
 {
 public :
 	b3JointSolver(const b3JointSolverDef* def);
+	~b3JointSolver();
 
 	void InitializeConstraints();
 	void WarmStart();
-	void SolveVelocityConstraints();	
+	
+	// Return the maximum magnitude of the incremental impulses applied.
+	scalar SolveVelocityConstraints();
+	
+	// Copy the impulses of the batched constraints back to their joints.
+	void StoreImpulses();
+	
 	bool SolvePositionConstraints();
 private :
+	void AddPointConstraint(u32 indexA, u32 indexB, scalar mA, scalar mB, 
+		const b3Mat33& iA, const b3Mat33& iB, const b3Vec3& rA, const b3Vec3& rB, 
+		const b3Mat33& mass, b3Vec3* impulse);
+
+	void AddAngularRow(u32 indexA, u32 indexB, const b3Mat33& iA, const b3Mat33& iB, 
+		const b3Vec3& axis, scalar bias, scalar lower, scalar upper, scalar* impulse);
+
+	// Return true if the constraints of a joint are solved by the batches.
+	bool IsBatched(const b3Joint* joint) const;
+
+	void SolvePointConstraints(scalar& maxImpulseDelta);
+	void SolveRowConstraints(scalar& maxImpulseDelta);
+
+	b3StackAllocator* m_allocator;
 	b3SolverData m_solverData;
 	b3Joint** m_joints;
 	u32 m_count;
+	bool m_batch;
+
+	// Joints that aren't batched, in island order.
+	b3Joint** m_genericJoints;
+	u32 m_genericCount;
+
+	u32 m_pointCapacity;
+	b3PointConstraintBatch m_points;
+	
+	u32 m_rowCapacity;
+	b3RowConstraintBatch m_rows;
 };
 
 #endif
@@ -105,9 +105,12 @@ private:
 
 	void InitializeConstraints(const b3SolverData* data);
 	void WarmStart(const b3SolverData* data);
-	void SolveVelocityConstraints(const b3SolverData* data);
+	scalar SolveVelocityConstraints(const b3SolverData* data);
 	bool SolvePositionConstraints(const b3SolverData* data);
 
+	void SaveState(b3StateBuffer* buffer) const;
+	void RestoreState(b3StateBuffer* buffer);
+
 	// Solver shared
 	b3Vec3 m_localAnchorA;
 	b3Vec3 m_localAnchorB;
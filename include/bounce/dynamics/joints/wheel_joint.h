@@ -145,9 +145,12 @@ protected:
 
 	void InitializeConstraints(const b3SolverData* data);
 	void WarmStart(const b3SolverData* data);
-	void SolveVelocityConstraints(const b3SolverData* data);
+	scalar SolveVelocityConstraints(const b3SolverData* data);
 	bool SolvePositionConstraints(const b3SolverData* data);
 
+	void SaveState(b3StateBuffer* buffer) const;
+	void RestoreState(b3StateBuffer* buffer);
+
 	scalar m_frequencyHz;
 	scalar m_dampingRatio;
 
@@ -35,6 +35,14 @@ struct b3Velocity
 	b3Vec3 w;
 };
 
+// The displacement of a body accumulated over the sub-steps of a time step.
+// The angular part is the sum of the angular velocities times the sub-step.
+struct b3Displacement
+{
+	b3Vec3 linear;
+	b3Vec3 angular;
+};
+
 struct b3SolverData
 {
 	b3Position* positions;
@@ -44,6 +52,40 @@ struct b3SolverData
 	scalar invdt;
 };
 
+// Soft constraint coefficients.
+// "Solver2D", Erin Catto
+struct b3Softness
+{
+	scalar biasRate;
+	scalar massScale;
+	scalar impulseScale;
+};
+
+// Compute the coefficients of a soft constraint given its stiffness in Hz, 
+// its damping ratio, and the time step.
+inline b3Softness b3MakeSoft(scalar hertz, scalar dampingRatio, scalar h)
+{
+	if (hertz == scalar(0))
+	{
+		b3Softness softness;
+		softness.biasRate = scalar(0);
+		softness.massScale = scalar(1);
+		softness.impulseScale = scalar(0);
+		return softness;
+	}
+
+	scalar omega = scalar(2) * B3_PI * hertz;
+	scalar a1 = scalar(2) * dampingRatio + h * omega;
+	scalar a2 = h * omega * a1;
+	scalar a3 = scalar(1) / (scalar(1) + a2);
+
+	b3Softness softness;
+	softness.biasRate = omega / a1;
+	softness.massScale = a2 * a3;
+	softness.impulseScale = a3;
+	return softness;
+}
+
 enum b3LimitState
 {
 	e_inactiveLimit,
@@ -21,12 +21,17 @@
 
 #include <bounce/common/memory/stack_allocator.h>
 #include <bounce/common/memory/block_allocator.h>
+#include <bounce/common/memory/state_buffer.h>
 #include <bounce/common/template/list.h>
+#include <bounce/common/template/array.h>
 #include <bounce/dynamics/time_step.h>
+#include <bounce/dynamics/body_storage.h>
 #include <bounce/dynamics/joint_manager.h>
 #include <bounce/dynamics/contact_manager.h>
+#include <bounce/dynamics/articulation.h>
 
 struct b3BodyDef;
+struct b3FixtureDef;
 
 class b3Body;
 
@@ -63,8 +68,81 @@ struct b3ShapeCastSingleOutput
 	scalar fraction; // time of intersection on displacement
 };
 
+// Memory usage of a world. Sizes are in bytes.
+struct b3WorldMemoryStats
+{
+	// Occupancy of the block allocator. 
+	// Bodies, fixtures, shapes, joints, and contacts are allocated from it.
+	b3BlockAllocatorStats blockStats;
+
+	// Usage of the stack allocator, including its high-water mark.
+	b3StackAllocatorStats stackStats;
+
+	u32 bodyCount;
+	u32 bodyStorageCapacity; // number of bodies the body state arrays can hold
+	u32 bodyStorageSize; // size of the body state arrays
+
+	u32 fixtureCount;
+	u32 fixtureEdgeSize; // contact edge arrays that outgrew their fixtures
+	u32 shapeSize; // shape objects owned by the fixtures
+	u32 shapeDataSize; // hulls, meshes, height fields, and compounds referenced by the shapes, each counted once
+
+	u32 jointCount;
+
+	u32 treeNodeCount; // allocated broad-phase tree nodes
+	u32 treeNodeCapacity; // broad-phase tree node array capacity
+	u32 treeSize; // broad-phase tree node array
+
+	u32 moveBufferCapacity;
+	u32 pairBufferCapacity;
+	u32 broadPhaseBufferSize; // move and pair buffers
+
+	u32 contactCount;
+	u32 contactSize; // contact objects, including their manifolds
+	u32 contactArraySize; // per shape type contact arrays that outgrew their local storage
+	u32 manifoldCount; // manifolds in use
+	u32 manifoldCapacity; // manifolds the contacts can hold
+	u32 manifoldSize; // manifold storage inside the contact objects
+	u32 contactCacheCount; // triangles and child pairs cached by mesh, height field, and compound contacts
+	u32 contactCacheSize; // triangle and child pair caches
+
+	// Memory allocated by the world from the system: block allocator chunks and large blocks, 
+	// the stacks, the body state arrays, the broad-phase, the contact arrays and caches, 
+	// and the overflown edge arrays. This excludes shape data, which is owned by the user.
+	u32 totalSize;
+};
+
+// Collision and solver statistics of the last step of a world.
+// The counters are kept per thread during a step and copied to the world 
+// at the end of the step, so worlds stepping on different threads don't share them.
+struct b3StepStats
+{
+	u32 gjkCalls; // number of GJK calls
+	u32 gjkIters; // total number of GJK iterations
+	u32 gjkMaxIters; // maximum number of GJK iterations in a call
+	u32 gjkCacheHits; // number of GJK calls that reused the cached simplex
+
+	u32 convexCalls; // number of hull collision calls
+	u32 convexCacheHits; // number of hull collision calls that reused the cached features
+
+	u32 contactUpdates; // number of contact updates
+	u32 contactReuses; // number of contact updates that reused the manifolds
+
+	u32 toiCalls; // number of time of impact calls
+	u32 toiMaxIters; // maximum number of time of impact iterations in a call
+
+	u32 islandCount; // number of islands solved
+	u32 velocityIters; // total number of velocity iterations performed by the islands
+	u32 maxVelocityIters; // maximum number of velocity iterations performed by an island
+
+	u32 allocCalls; // number of calls to b3Alloc
+	u32 maxAllocCalls; // maximum number of calls to b3Alloc in a step since the world was created
+};
+
 // Use a physics world to create/destroy rigid bodies and joints,
 // perform ray and shape casts and also perform volume queries.
+// Worlds don't share mutable state. Different worlds can be used on different threads 
+// at the same time but a world must be used by a single thread at a time.
 class b3World
 {
 public:
@@ -99,11 +177,100 @@ public:
 	// Set the world profiler.
 	void SetProfiler(b3Profiler* profiler);
 
+	// Set a thread pool to update the contacts in parallel. The pool can be null.
+	// The results of a step are identical for any number of threads, and without a pool.
+	// The contact listener is always called from the thread that calls Step.
+	void SetThreadPool(b3ThreadPool* pool);
+
 	// Enable body sleeping. This improves performance.
 	void SetSleeping(bool flag);
 
 	// Enable warm-starting for the constraint solvers. This improves stability significantly.
 	void SetWarmStart(bool flag);
+
+	// Enable the block solver for the normal constraints of contact manifolds with multiple points. 
+	// This solves the points of a manifold together instead of one at a time, so stacks need
+	// fewer velocity iterations. It isn't used by the sub-stepping solver.
+	void SetBlockSolve(bool flag);
+
+	// Is the block solver enabled?
+	bool GetBlockSolve() const;
+
+	// Enable the split impulse solver for the contact overlaps. 
+	// The overlaps are resolved during the velocity iterations using pseudo velocities 
+	// that move the bodies but aren't kept, and the position iterations only solve the joints. 
+	// This is cheaper than the position solver on large islands and doesn't add energy, 
+	// but it resolves overlaps with the contact points of the start of the step.
+	// It isn't used by the sub-stepping solver.
+	void SetSplitImpulse(bool flag);
+
+	// Is the split impulse solver enabled?
+	bool GetSplitImpulse() const;
+
+	// Set the impulse below which the velocity iterations of an island stop early.
+	// An island stops once the largest incremental impulse of an iteration falls below this value.
+	// Zero runs all velocity iterations. This is the default.
+	void SetImpulseTolerance(scalar tolerance);
+
+	// Get the impulse tolerance of the velocity iterations.
+	scalar GetImpulseTolerance() const;
+
+	// Enable the reuse of the separating or contact features found by the hull collision 
+	// in the previous step. This improves performance.
+	void SetConvexCache(bool flag);
+
+	// Is the convex cache enabled?
+	bool GetConvexCache() const;
+
+	// Enable the reuse of the contact points of the previous step when the shapes of a contact 
+	// barely moved relative to each other. This improves performance but the results differ 
+	// from rebuilding the points every step. It requires warm starting.
+	void SetContactReuse(bool flag);
+
+	// Is the contact point reuse enabled?
+	bool GetContactReuse() const;
+
+	// Set the number of sub-steps of the sub-stepping solver. 
+	// Each sub-step solves the constraints with a single iteration and soft contacts. 
+	// The solver iterations passed to Step are ignored when the count is greater than zero.
+	// Zero uses the iterative solver. This is the default.
+	void SetSubStepCount(u32 count);
+
+	// Get the number of sub-steps of the sub-stepping solver.
+	u32 GetSubStepCount() const;
+
+	// Enable the continuous collision of fast bodies against static and kinematic bodies.
+	// After the constraints are solved, the dynamic bodies that are flagged as bullets or 
+	// can move more than their smallest extent in a step are swept against the static and 
+	// kinematic fixtures, including the triangles of meshes and height fields. 
+	// The bodies that hit something are sub-stepped alone: they're moved to the time of 
+	// impact, lose their approach velocity, and move with the new velocity for the rest of the step.
+	// This prevents fast bodies from tunneling through thin geometry. It's disabled by default.
+	void SetContinuousPhysics(bool flag);
+
+	// Is the continuous collision enabled?
+	bool GetContinuousPhysics() const;
+
+	// Enable speculative contacts. 
+	// Separated shapes that can meet in the next step get contact points with a positive 
+	// separation. The solver lets the shapes approach until the gap is closed but not further. 
+	// This prevents most tunneling without the serial time of impact loop. 
+	// Contacts begin when the shapes are close enough to get speculative points. 
+	// It's disabled by default.
+	void SetSpeculativeContacts(bool flag);
+
+	// Are the speculative contacts enabled?
+	bool GetSpeculativeContacts() const;
+
+	// Enable joint batching. 
+	// Sphere, cone, and revolute joints are solved in batches grouped by constraint type 
+	// instead of one joint after another. This is faster for many joints but changes 
+	// the Gauss-Seidel order, so the results differ from the unbatched solver. 
+	// It's disabled by default.
+	void SetJointBatching(bool flag);
+
+	// Is the joint batching enabled?
+	bool GetJointBatching() const;
 	
 	// Set the acceleration due to the gravity force between this world and each dynamic 
 	// body in the world. 
@@ -113,23 +280,119 @@ public:
 	// Get the acceleration due to gravity force in m/s^2.
 	const b3Vec3& GetGravity() const;
 
+	// Set the initial size of the stack memory used during a step.
+	// The stack grows to the high-water mark of a step when it runs out of memory.
+	// Use the statistics of a previous run to pre-size it.
+	void SetStackSize(u32 size);
+
+	// Get the statistics of the stack allocator used during a step.
+	void GetStackStats(b3StackAllocatorStats* stats) const;
+
+	// Get the collision statistics of the last step.
+	const b3StepStats& GetStepStats() const;
+
+	// Get the memory usage of this world. 
+	// This walks all the fixtures and contacts, so don't call it every step.
+	void GetMemoryStats(b3WorldMemoryStats* stats) const;
+
+	// Write a binary image of the simulation state to a buffer. 
+	// This includes the body states, the joint impulses, the articulation joint states, the broad-phase tree, 
+	// and the contacts with their manifolds and collision caches. 
+	// The buffer is cleared first. Reuse the buffer to avoid allocations.
+	void SaveState(b3StateBuffer* buffer) const;
+
+	// Read a state written by SaveState. The world must have the same bodies, fixtures, joints, and articulations, 
+	// created in the same order, as the world that saved the state. 
+	// Stepping after a restore gives exactly the same results as stepping after the save.
+	// Contacts are created or destroyed as needed without notifying the contact listener.
+	// Return false and don't change the world if the bodies, fixtures, joints, or articulations don't match.
+	bool RestoreState(b3StateBuffer* buffer);
+
 	// Create a new rigid body.
 	b3Body* CreateBody(const b3BodyDef& def);
 	
 	// Destroy an existing rigid body.
 	void DestroyBody(b3Body* body);
+
+	// Begin a bulk load. Use this when creating many bodies and fixtures at once, e.g. when loading a level.
+	// Fixtures created until EndBulkLoad is called aren't inserted into the broad-phase one at a time 
+	// and aren't reported by queries and ray casts. Don't step the world during a bulk load.
+	void BeginBulkLoad();
+
+	// End a bulk load. This builds the broad-phase tree top-down and creates the new contacts.
+	void EndBulkLoad();
+
+	// Create many rigid bodies in a bulk load. 
+	// Each body gets a fixture from the fixture definition of the same index. 
+	// The fixture definitions can be null. The created bodies are written to the given array.
+	void CreateBodies(const b3BodyDef* bodyDefs, const b3FixtureDef* fixtureDefs, u32 count, b3Body** bodies);
 	
 	// Create a new joint.
 	b3Joint* CreateJoint(const b3JointDef& def);
 
 	// Remove a joint from the world and deallocate it from the memory.
 	void DestroyJoint(b3Joint* joint);
+
+	// Create a new articulation. The link bodies become kinematic.
+	b3Articulation* CreateArticulation(const b3ArticulationDef& def);
+
+	// Destroy an articulation. The link bodies are left kinematic.
+	void DestroyArticulation(b3Articulation* articulation);
 	 
 	// Simulate a physics step.
 	// The function parameters are the ammount of time to simulate, 
 	// and the number of constraint solver iterations.
+	// Don't call this while a step started by BeginStep runs or from a contact listener.
 	void Step(scalar dt, u32 velocityIterations, u32 positionIterations);
 
+	// Begin a physics step on a background thread owned by this world and return immediately.
+	// The transforms of the bodies are copied to the published transform array first, 
+	// so they can be read while the step runs. 
+	// Until WaitStep is called, don't call any other function of this world, its bodies, 
+	// fixtures, joints, articulations, or contacts, except GetPublishedTransforms. 
+	// The contact listener is called from the background thread.
+	void BeginStep(scalar dt, u32 velocityIterations, u32 positionIterations);
+
+	// Wait for the step started by BeginStep to finish. 
+	// Return immediately if there is no step running.
+	void WaitStep();
+
+	// Is a step started by BeginStep running?
+	bool IsStepping() const;
+
+	// Copy the body transforms published by the last call to BeginStep to a caller-owned array, 
+	// indexed by the body index, and return the number of published transforms. 
+	// At most capacity transforms are copied, so grow the array and call again if the 
+	// returned count is greater than the capacity. 
+	// This can be called from any thread at any time. 
+	// The copy is consistent: it never mixes the transforms of two calls to BeginStep. 
+	// The body indices are the ones of the time BeginStep was called.
+	u32 GetPublishedTransforms(b3Transform* transforms, u32 capacity) const;
+
+	// Get the bodies moved by the last step, and the bodies created, restored, moved by SetTransform, 
+	// or moved to another index by DestroyBody after it. 
+	// The bodies that stopped moving in the last step are in the list too, so their exported 
+	// transforms are updated once more. Other sleeping bodies and bodies that don't move aren't in the list. 
+	b3Body* const* GetMovedBodies(u32* count) const;
+
+	// Get the transforms of the bodies, indexed by the body index. 
+	// The array is owned by this world. Creating a body can reallocate it and destroying a body 
+	// moves the last body into the freed index, so don't keep the pointer across those calls.
+	const b3Transform* GetTransforms(u32* count) const;
+
+	// Write the transforms of the bodies to an array indexed by the body index. 
+	// The array must hold the number of bodies of this world. 
+	// If movedOnly is true then only the entries of the moved bodies are written, so an array 
+	// kept by the caller can be updated cheaply. Destroying a body marks the body moved into 
+	// its index as moved.
+	// The bodies moved by the last step are blended between their transforms before and after 
+	// the step by a factor in [0, 1], for interpolating the rendering between steps. 
+	// A factor of one gives the transforms after the step.
+	void ExportTransforms(b3Transform* transforms, bool movedOnly, scalar alpha) const;
+
+	// Same as ExportTransforms but write 4-by-4 transformation matrices.
+	void ExportMatrices(b3Mat44* matrices, bool movedOnly, scalar alpha) const;
+
 	// Perform a ray cast with the world.
 	// The given ray cast listener will be notified when a ray intersects a shape 
 	// in the world. 
@@ -171,6 +434,9 @@ public:
 	// Otherwise, it continues searching for new overlapping shape AABBs.
 	void QueryAABB(b3QueryListener* listener, b3QueryFilter* filter, const b3AABB& aabb) const;
 
+	// Get the broad-phase of this world.
+	const b3BroadPhase& GetBroadPhase() const;
+
 	// Get the list of bodies in this world.
 	const b3List<b3Body>& GetBodyList() const;
 	b3List<b3Body>& GetBodyList();
@@ -179,6 +445,10 @@ public:
 	const b3List<b3Joint>& GetJointList() const;
 	b3List<b3Joint>& GetJointList();
 
+	// Get the list of articulations in this world.
+	const b3List<b3Articulation>& GetArticulationList() const;
+	b3List<b3Articulation>& GetArticulationList();
+
 	// Get the list of contacts in this world.
 	const b3List<b3Contact>& GetContactList() const;
 	b3List<b3Contact>& GetContactList();
@@ -210,12 +480,31 @@ private:
 	friend class b3Contact;
 	friend class b3ConvexContact;
 	friend class b3MeshContact;
+	friend class b3HeightFieldContact;
+	friend class b3CompoundContact;
 	friend class b3Joint;
 
 	void Solve(scalar dt, u32 velocityIterations, u32 positionIterations);
+	void SolveTOI(scalar dt);
+
+	void Simulate(scalar dt, u32 velocityIterations, u32 positionIterations);
+	void PublishTransforms();
+	void StepThreadMain();
+
+	b3Transform GetExportTransform(const b3Body* body, scalar alpha) const;
 
 	bool m_sleeping;
 	bool m_warmStarting;
+	bool m_convexCache;
+	bool m_contactReuse;
+	bool m_blockSolve;
+	bool m_splitImpulse;
+	bool m_continuousPhysics;
+	bool m_speculativeContacts;
+	bool m_jointBatching;
+	scalar m_impulseTolerance;
+	u32 m_subStepCount;
+	scalar m_timeStep;
 	u32 m_flags;
 	b3Vec3 m_gravity;
 	
@@ -227,6 +516,16 @@ private:
 
 	// List of bodies
 	b3List<b3Body> m_bodyList;
+
+	// Contiguous body state
+	b3BodyStorage m_bodyStorage;
+
+	// Number of steps taken. 
+	// This is the stamp of the bodies moved by the last step.
+	u32 m_stepCount;
+
+	// Bodies moved by the last step or after it
+	b3StackArray<b3Body*, 32> m_movedBodies;
 	
 	// List of joints
 	b3JointManager m_jointManager;
@@ -234,6 +533,12 @@ private:
 	// List of contacts
 	b3ContactManager m_contactManager;
 
+	// List of articulations
+	b3List<b3Articulation> m_articulationList;
+
+	// Statistics of the last step.
+	b3StepStats m_stepStats;
+
 	// Debug draw flags.
 	u32 m_drawFlags;
 
@@ -242,6 +547,33 @@ private:
 
 	// Profiler.
 	b3Profiler* m_profiler;
+
+	// Published transforms. 
+	// The writer and the readers copy them under the mutex.
+	mutable std::mutex m_publishMutex;
+	b3Transform* m_publishedTransforms;
+	u32 m_publishedCapacity;
+	u32 m_publishedCount;
+
+	// Background step thread. 
+	// It is started by the first call to BeginStep.
+	std::thread* m_stepThread;
+	std::mutex m_stepMutex;
+	std::condition_variable m_stepCondition;
+	bool m_stepRequested;
+	bool m_stepDone;
+	bool m_stepQuit;
+	
+	// Is a step started by BeginStep running? 
+	// It is read by IsStepping from any thread.
+	std::atomic<bool> m_stepping;
+	
+	// Is a step being simulated? 
+	// It catches a call to Step from a contact listener.
+	bool m_locked;
+	scalar m_stepDt;
+	u32 m_stepVelocityIterations;
+	u32 m_stepPositionIterations;
 };
 
 inline void b3World::SetContactListener(b3ContactListener* listener)
@@ -259,6 +591,33 @@ inline void b3World::SetDebugDraw(b3Draw* draw)
 	m_debugDraw = draw;
 }
 
+inline void b3World::SetThreadPool(b3ThreadPool* pool)
+{
+	m_contactManager.m_threadPool = pool;
+}
+
+inline bool b3World::IsStepping() const
+{
+	return m_stepping.load();
+}
+
+inline const b3BroadPhase& b3World::GetBroadPhase() const
+{
+	return m_contactManager.m_broadPhase;
+}
+
+inline b3Body* const* b3World::GetMovedBodies(u32* count) const
+{
+	*count = m_movedBodies.Count();
+	return m_movedBodies.Begin();
+}
+
+inline const b3Transform* b3World::GetTransforms(u32* count) const
+{
+	*count = m_bodyStorage.m_count;
+	return m_bodyStorage.m_transforms;
+}
+
 inline void b3World::SetProfiler(b3Profiler* profiler)
 {
 	m_profiler = profiler;
@@ -275,11 +634,117 @@ inline const b3Vec3& b3World::GetGravity() const
 	return m_gravity;
 }
 
+inline void b3World::SetStackSize(u32 size)
+{
+	m_stackAllocator.SetCapacity(size);
+}
+
+inline void b3World::GetStackStats(b3StackAllocatorStats* stats) const
+{
+	m_stackAllocator.GetStats(stats);
+}
+
 inline void b3World::SetWarmStart(bool flag)
 {
 	m_warmStarting = flag;
 }
 
+inline void b3World::SetBlockSolve(bool flag)
+{
+	m_blockSolve = flag;
+}
+
+inline bool b3World::GetBlockSolve() const
+{
+	return m_blockSolve;
+}
+
+inline void b3World::SetSplitImpulse(bool flag)
+{
+	m_splitImpulse = flag;
+}
+
+inline bool b3World::GetSplitImpulse() const
+{
+	return m_splitImpulse;
+}
+
+inline void b3World::SetImpulseTolerance(scalar tolerance)
+{
+	B3_ASSERT(tolerance >= scalar(0));
+	m_impulseTolerance = tolerance;
+}
+
+inline scalar b3World::GetImpulseTolerance() const
+{
+	return m_impulseTolerance;
+}
+
+inline void b3World::SetConvexCache(bool flag)
+{
+	m_convexCache = flag;
+}
+
+inline bool b3World::GetConvexCache() const
+{
+	return m_convexCache;
+}
+
+inline void b3World::SetContactReuse(bool flag)
+{
+	m_contactReuse = flag;
+}
+
+inline bool b3World::GetContactReuse() const
+{
+	return m_contactReuse;
+}
+
+inline void b3World::SetSubStepCount(u32 count)
+{
+	m_subStepCount = count;
+}
+
+inline u32 b3World::GetSubStepCount() const
+{
+	return m_subStepCount;
+}
+
+inline void b3World::SetContinuousPhysics(bool flag)
+{
+	m_continuousPhysics = flag;
+}
+
+inline bool b3World::GetContinuousPhysics() const
+{
+	return m_continuousPhysics;
+}
+
+inline void b3World::SetSpeculativeContacts(bool flag)
+{
+	m_speculativeContacts = flag;
+}
+
+inline bool b3World::GetSpeculativeContacts() const
+{
+	return m_speculativeContacts;
+}
+
+inline void b3World::SetJointBatching(bool flag)
+{
+	m_jointBatching = flag;
+}
+
+inline bool b3World::GetJointBatching() const
+{
+	return m_jointBatching;
+}
+
+inline const b3StepStats& b3World::GetStepStats() const
+{
+	return m_stepStats;
+}
+
 inline const b3List<b3Body>& b3World::GetBodyList() const
 {
 	return m_bodyList;
@@ -300,6 +765,16 @@ inline b3List<b3Joint>& b3World::GetJointList()
 	return m_jointManager.m_jointList;
 }
 
+inline const b3List<b3Articulation>& b3World::GetArticulationList() const
+{
+	return m_articulationList;
+}
+
+inline b3List<b3Articulation>& b3World::GetArticulationList()
+{
+	return m_articulationList;
+}
+
 inline const b3List<b3Contact>& b3World::GetContactList() const
 {
 	return m_contactManager.m_contactList;
@@ -113,6 +113,7 @@ public:
 	}
 	
 	// Called after a dynamic contact is updated.
+	// The contact points may be the ones of the last step if the shapes barely moved.
 	virtual void PreSolve(b3Contact* contact)
 	{
 		B3_NOT_USED(contact);
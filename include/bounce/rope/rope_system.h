@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_ROPE_SYSTEM_H
+#define B3_ROPE_SYSTEM_H
+
+#include <bounce/rope/rope.h>
+
+class b3ThreadPool;
+
+// Rope system definition. 
+// This definition requires passing an array of rope definitions.
+// The arrays will not be used internally after the system creation. 
+// Therefore, you can create the arrays on the stack.
+struct b3RopeSystemDef
+{
+	b3RopeSystemDef()
+	{
+		ropeCount = 0;
+		ropes = nullptr;
+	}
+
+	// Number of ropes.
+	u32 ropeCount;
+
+	// Rope definitions.
+	const b3RopeDef* ropes;
+};
+
+// This class simulates many ropes together. 
+// Each rope behaves like a b3Rope created from the same definition, up to round-off. 
+// The link state is stored in per-field arrays, with the links of the same index 
+// of all ropes next to each other, and each pass of the articulated body algorithm 
+// loops over the ropes for one link index at a time.
+// The ropes are sorted by decreasing link count internally, 
+// so the ropes that have a given link are always a prefix of the ropes.
+// The passes are specialized for rope joints, which are spherical joints located 
+// at the parent link center. The articulated inertia sent to the parent link 
+// has only a linear block and the articulated force has no torque.
+class b3RopeSystem
+{
+public:
+	// Construct this system from a definition.
+	b3RopeSystem(const b3RopeSystemDef& def);
+
+	// Rope system destructor.
+	~b3RopeSystem();
+
+	// Set a thread pool to step batches of ropes in parallel. The pool can be null.
+	// The results of a step are identical for any number of threads, and without a pool.
+	void SetThreadPool(b3ThreadPool* pool);
+
+	// Set the acceleration of gravity.
+	void SetGravity(const b3Vec3& gravity);
+
+	// Get the acceleration of gravity.
+	const b3Vec3& GetGravity() const;
+
+	// Get the number of ropes.
+	u32 GetRopeCount() const;
+
+	// Get the number of links of a rope.
+	u32 GetLinkCount(u32 rope) const;
+
+	// Set the position of the base link of a rope.
+	void SetPosition(u32 rope, const b3Vec3& position);
+
+	// Get the position of the base link of a rope.
+	const b3Vec3& GetPosition(u32 rope) const;
+
+	// Set the linear velocity of the base link of a rope.
+	void SetLinearVelocity(u32 rope, const b3Vec3& linearVelocity);
+	
+	// Get the linear velocity of the base link of a rope.
+	b3Vec3 GetLinearVelocity(u32 rope) const;
+
+	// Set the angular velocity of the base link of a rope.
+	void SetAngularVelocity(u32 rope, const b3Vec3& angularVelocity);
+	
+	// Get the angular velocity of the base link of a rope.
+	b3Vec3 GetAngularVelocity(u32 rope) const;
+
+	// Get the transform of a link of a rope.
+	const b3Transform& GetLinkTransform(u32 rope, u32 link) const;
+
+	// Perform a time-step for all ropes.
+	void Step(scalar dt);
+
+	// Debug draw the links using their transforms.
+	void Draw(b3Draw* draw) const;
+private:
+	friend struct b3RopeSystemStepTask;
+
+	// Step the ropes in [begin, end).
+	void StepRopes(u32 begin, u32 end, scalar h);
+	
+	// Get the index of a link in the link arrays.
+	u32 GetLinkIndex(u32 slot, u32 link) const;
+
+	// Acceleration of gravity.
+	b3Vec3 m_gravity;
+
+	b3ThreadPool* m_threadPool;
+
+	// Ropes
+	u32 m_ropeCount;
+
+	// The slot of each rope. The slots are sorted by decreasing link count.
+	u32* m_ropeSlots;
+
+	// Per slot
+	u32* m_linkCounts;
+	scalar* m_linearDampings;
+	scalar* m_angularDampings;
+
+	// Links
+	u32 m_maxLinkCount;
+
+	// Number of ropes that have a link of a given index and 
+	// index of the first link of a given index in the link arrays.
+	u32* m_activeCounts;
+	u32* m_linkOffsets;
+
+	// Link arrays
+	u32 m_linkCount;
+
+	// Shared
+	scalar* m_masses;
+	scalar* m_inertias;
+	
+	// Joint position relative to the link.
+	b3Vec3* m_jointOffsets;
+	b3Quat* m_jointRotations;
+	b3Vec3* m_jointVelocities;
+	b3Transform* m_transforms;
+	
+	// Link velocities in the link frames. 
+	// Only the base link velocities persist between steps.
+	b3Vec3* m_angularVelocities;
+	b3Vec3* m_linearVelocities;
+
+	// Temp
+	b3Transform* m_invTransforms;
+	
+	// Parent to link rotation.
+	b3Mat33* m_rotations;
+	
+	// Velocity-product acceleration.
+	b3Vec3* m_angularBiases;
+	b3Vec3* m_linearBiases;
+
+	// Linear block of the articulated inertia and articulated force.
+	b3Mat33* m_articulatedMasses;
+	b3Vec3* m_articulatedForces;
+	
+	b3Mat33* m_invD;
+	b3Vec3* m_u;
+
+	b3Vec3* m_jointAccelerations;
+	b3Vec3* m_angularAccelerations;
+	b3Vec3* m_linearAccelerations;
+};
+
+inline void b3RopeSystem::SetThreadPool(b3ThreadPool* pool)
+{
+	m_threadPool = pool;
+}
+
+inline void b3RopeSystem::SetGravity(const b3Vec3& gravity)
+{
+	m_gravity = gravity;
+}
+
+inline const b3Vec3& b3RopeSystem::GetGravity() const
+{
+	return m_gravity;
+}
+
+inline u32 b3RopeSystem::GetRopeCount() const
+{
+	return m_ropeCount;
+}
+
+inline u32 b3RopeSystem::GetLinkCount(u32 rope) const
+{
+	B3_ASSERT(rope < m_ropeCount);
+	return m_linkCounts[m_ropeSlots[rope]];
+}
+
+inline u32 b3RopeSystem::GetLinkIndex(u32 slot, u32 link) const
+{
+	return m_linkOffsets[link] + slot;
+}
+
+#endif
@@ -105,6 +105,48 @@ void b3BroadPhase::TouchProxy(u32 proxyId)
 	BufferMove(proxyId);
 }
 
+void b3BroadPhase::BeginBulkLoad()
+{
+	m_tree.BeginBulkLoad();
+}
+
+void b3BroadPhase::EndBulkLoad()
+{
+	m_tree.EndBulkLoad();
+}
+
+void b3BroadPhase::SaveState(b3StateBuffer* buffer) const
+{
+	m_tree.SaveState(buffer);
+
+	buffer->Write(m_proxyCount);
+	buffer->Write(m_moveBufferCount);
+	buffer->Write(m_moveBuffer, m_moveBufferCount * sizeof(u32));
+}
+
+void b3BroadPhase::RestoreState(b3StateBuffer* buffer)
+{
+	m_tree.RestoreState(buffer);
+
+	u32 moveBufferCount;
+	buffer->Read(m_proxyCount);
+	buffer->Read(moveBufferCount);
+
+	if (moveBufferCount > m_moveBufferCapacity) 
+	{
+		while (m_moveBufferCapacity < moveBufferCount)
+		{
+			m_moveBufferCapacity *= 2;
+		}
+
+		b3Free(m_moveBuffer);
+		m_moveBuffer = (u32*)b3Alloc(m_moveBufferCapacity * sizeof(u32));
+	}
+
+	buffer->Read(m_moveBuffer, moveBufferCount * sizeof(u32));
+	m_moveBufferCount = moveBufferCount;
+}
+
 bool b3BroadPhase::Report(u32 proxyId) 
 {
 	if (proxyId == m_queryProxyId) 
@@ -388,12 +388,108 @@ static void b3MoveObservationsToCluster(b3Array<b3Observation>& observations, u3
 	}
 }
 
+bool b3ClusterSolver::SolveFast()
+{
+	B3_ASSERT(m_clusters.IsEmpty());
+
+	m_iterations = 0;
+
+	if (m_observations.IsEmpty())
+	{
+		return true;
+	}
+
+	// Same tolerance used for merging clusters.
+	const scalar kTol = scalar(0.05);
+
+	// Coplanar case. 
+	// All normals are similar to the first normal.
+	{
+		b3Vec3 A = m_observations[0].point;
+
+		b3Vec3 centroid;
+		centroid.SetZero();
+
+		bool shared = true;
+		for (u32 i = 0; i < m_observations.Count(); ++i)
+		{
+			b3Vec3 B = m_observations[i].point;
+			if (b3DistanceSquared(A, B) > kTol * kTol)
+			{
+				shared = false;
+				break;
+			}
+
+			centroid += B;
+		}
+
+		if (shared)
+		{
+			centroid.Normalize();
+
+			b3Cluster c;
+			c.centroid = centroid;
+			m_clusters.PushBack(c);
+
+			for (u32 i = 0; i < m_observations.Count(); ++i)
+			{
+				m_observations[i].cluster = 0;
+			}
+
+			return true;
+		}
+	}
+
+	// Small case. 
+	// There is no point to reduce. Merge similar normals.
+	if (m_observations.Count() <= B3_MAX_MANIFOLD_POINTS)
+	{
+		for (u32 i = 0; i < m_observations.Count(); ++i)
+		{
+			AddCluster(m_observations[i].point);
+		}
+
+		if (m_clusters.Count() > B3_MAX_MANIFOLDS)
+		{
+			// Fall back to k-means.
+			m_clusters.Resize(0);
+			return false;
+		}
+
+		for (u32 i = 0; i < m_observations.Count(); ++i)
+		{
+			b3Observation& obs = m_observations[i];
+			obs.cluster = FindCluster(obs.point);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
 void b3ClusterSolver::Solve()
 {
+	if (SolveFast())
+	{
+		return;
+	}
+
 	// Initialize clusters
 	InitializeClusters();
 
 	// Run k-means
+	SolveKMeans();
+}
+
+void b3ClusterSolver::SolveKMeans()
+{
+	B3_ASSERT(m_clusters.Count() > 0);
+
+	for (u32 i = 0; i < m_observations.Count(); ++i)
+	{
+		m_observations[i].cluster = B3_NULL_CLUSTER;
+	}
 
 	// Termination criteria 
 	const u32 kMaxIters = 10;
@@ -401,11 +497,25 @@ void b3ClusterSolver::Solve()
 	u32 iter = 0;
 	while (iter < kMaxIters)
 	{
+		++iter;
+
 		// Assign each observation to the closest cluster centroid.
+		bool changed = false;
 		for (u32 i = 0; i < m_observations.Count(); ++i)
 		{
 			b3Observation& obs = m_observations[i];
-			obs.cluster = FindCluster(obs.point);
+			u32 cluster = FindCluster(obs.point);
+			if (cluster != obs.cluster)
+			{
+				obs.cluster = cluster;
+				changed = true;
+			}
+		}
+
+		// The centroids are stable if no observation changed its cluster.
+		if (changed == false)
+		{
+			break;
 		}
 
 		// Compute the new cluster centroids.
@@ -434,8 +544,6 @@ void b3ClusterSolver::Solve()
 				cluster.centroid = centroid;
 			}
 		}
-
-		++iter;
 	}
 
 	m_iterations = iter;
@@ -469,13 +577,28 @@ void b3ClusterSolver::Solve()
 
 void b3ClusterSolver::Run(b3Manifold outManifolds[3], u32& numOut, 
 	const b3Manifold* inManifolds, u32 numIn,
-	const b3Transform& xfA, scalar radiusA, const b3Transform& xfB, scalar radiusB)
+	const b3Transform& xfA, scalar radiusA, const b3Transform& xfB, scalar radiusB, 
+	b3ClusterCache* cache)
 {
+	// Key of the contributing manifolds.
+	u32 key = 2166136261u;
+	u32 keyCount = 0;
+
 	// Initialize observations
 	for (u32 i = 0; i < numIn; ++i)
 	{
+		const b3Manifold* inManifold = inManifolds + i;
+		if (inManifold->pointCount == 0)
+		{
+			continue;
+		}
+
+		// FNV-1a
+		key = (key ^ inManifold->points[0].key.triangleKey) * 16777619u;
+		++keyCount;
+
 		b3WorldManifold wm;
-		wm.Initialize(inManifolds + i, radiusA, xfA, radiusB, xfB);
+		wm.Initialize(inManifold, radiusA, xfA, radiusB, xfB);
 
 		for (u32 j = 0; j < wm.pointCount; ++j)
 		{
@@ -490,7 +613,39 @@ void b3ClusterSolver::Run(b3Manifold outManifolds[3], u32& numOut,
 	}
 
 	// Solve
-	Solve();
+	if (SolveFast() == false)
+	{
+		if (cache && cache->centroidCount > 0 && cache->key == key && cache->keyCount == keyCount)
+		{
+			// The contributing manifolds didn't change.
+			// Seed k-means with the previous centroids.
+			for (u32 i = 0; i < cache->centroidCount; ++i)
+			{
+				b3Cluster c;
+				c.centroid = cache->centroids[i];
+				m_clusters.PushBack(c);
+			}
+		}
+		else
+		{
+			InitializeClusters();
+		}
+
+		SolveKMeans();
+	}
+
+	if (cache)
+	{
+		B3_ASSERT(m_clusters.Count() <= B3_MAX_MANIFOLDS);
+		
+		for (u32 i = 0; i < m_clusters.Count(); ++i)
+		{
+			cache->centroids[i] = m_clusters[i].centroid;
+		}
+		cache->centroidCount = m_clusters.Count();
+		cache->key = key;
+		cache->keyCount = keyCount;
+	}
 
 	// Reduce, weld, and output contact manifold
 
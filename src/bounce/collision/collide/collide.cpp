@@ -17,15 +17,18 @@
 */
 
 #include <bounce/collision/collide/collide.h>
+#include <bounce/collision/collide/manifold.h>
 #include <bounce/collision/shapes/sphere_shape.h>
 #include <bounce/collision/shapes/capsule_shape.h>
 #include <bounce/collision/shapes/triangle_shape.h>
 #include <bounce/collision/shapes/hull_shape.h>
 #include <bounce/collision/shapes/mesh_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
 #include <bounce/collision/geometry/sphere.h>
 #include <bounce/collision/geometry/capsule.h>
 #include <bounce/collision/geometry/hull.h>
 #include <bounce/collision/geometry/mesh.h>
+#include <bounce/collision/geometry/height_field.h>
 #include <bounce/collision/collision.h>
 
 void b3ShapeGJKProxy::Set(const b3Shape* shape, u32 index)
@@ -82,6 +85,24 @@ void b3ShapeGJKProxy::Set(const b3Shape* shape, u32 index)
 		radius = mesh->m_radius;
 		break;
 	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightFieldShape* heightField = (b3HeightFieldShape*)shape;
+
+		B3_ASSERT(index < heightField->m_heightField->GetTriangleCount());
+
+		b3Vec3 vs[3];
+		heightField->m_heightField->GetTriangle(vs, index);
+
+		vertexBuffer[0] = b3Mul(heightField->m_scale, vs[0]);
+		vertexBuffer[1] = b3Mul(heightField->m_scale, vs[1]);
+		vertexBuffer[2] = b3Mul(heightField->m_scale, vs[2]);
+
+		vertexCount = 3;
+		vertices = vertexBuffer;
+		radius = heightField->m_radius;
+		break;
+	}
 	default:
 	{
 		B3_ASSERT(false);
@@ -101,4 +122,153 @@ bool b3TestOverlap(const b3Transform& xfA, u32 indexA, const b3Shape* shapeA,
 
 	const scalar kTol = scalar(10) * B3_EPSILON;
 	return distance.distance <= kTol;
-}
\ No newline at end of file
+}
+
+// Is there a collision function for two convex shapes in this order?
+static bool b3HasCollideFunction(b3Shape::Type type1, b3Shape::Type type2)
+{
+	switch (type1)
+	{
+	case b3Shape::e_sphere:
+		return type2 == b3Shape::e_sphere;
+	case b3Shape::e_capsule:
+		return type2 == b3Shape::e_sphere || type2 == b3Shape::e_capsule;
+	case b3Shape::e_triangle:
+		return type2 == b3Shape::e_sphere || type2 == b3Shape::e_capsule || type2 == b3Shape::e_hull;
+	case b3Shape::e_hull:
+		return type2 == b3Shape::e_sphere || type2 == b3Shape::e_capsule || type2 == b3Shape::e_hull;
+	default:
+		return false;
+	}
+}
+
+static void b3CollideOrderedShapes(b3Manifold& manifold,
+	const b3Transform& xf1, const b3Shape* shape1,
+	const b3Transform& xf2, const b3Shape* shape2,
+	b3ConvexCache* cache,
+	const b3Transform& xf01, const b3Transform& xf02)
+{
+	switch (shape1->GetType())
+	{
+	case b3Shape::e_sphere:
+	{
+		b3CollideSphereAndSphere(manifold, xf1, (b3SphereShape*)shape1, xf2, (b3SphereShape*)shape2);
+		break;
+	}
+	case b3Shape::e_capsule:
+	{
+		if (shape2->GetType() == b3Shape::e_sphere)
+		{
+			b3CollideCapsuleAndSphere(manifold, xf1, (b3CapsuleShape*)shape1, xf2, (b3SphereShape*)shape2);
+		}
+		else
+		{
+			b3CollideCapsuleAndCapsule(manifold, xf1, (b3CapsuleShape*)shape1, xf2, (b3CapsuleShape*)shape2);
+		}
+		break;
+	}
+	case b3Shape::e_triangle:
+	{
+		if (shape2->GetType() == b3Shape::e_sphere)
+		{
+			b3CollideTriangleAndSphere(manifold, xf1, (b3TriangleShape*)shape1, xf2, (b3SphereShape*)shape2);
+		}
+		else if (shape2->GetType() == b3Shape::e_capsule)
+		{
+			b3CollideTriangleAndCapsule(manifold, xf1, (b3TriangleShape*)shape1, xf2, (b3CapsuleShape*)shape2);
+		}
+		else
+		{
+			b3CollideTriangleAndHull(manifold, xf1, (b3TriangleShape*)shape1, xf2, (b3HullShape*)shape2, cache, xf01, xf02);
+		}
+		break;
+	}
+	case b3Shape::e_hull:
+	{
+		if (shape2->GetType() == b3Shape::e_sphere)
+		{
+			b3CollideHullAndSphere(manifold, xf1, (b3HullShape*)shape1, xf2, (b3SphereShape*)shape2);
+		}
+		else if (shape2->GetType() == b3Shape::e_capsule)
+		{
+			b3CollideHullAndCapsule(manifold, xf1, (b3HullShape*)shape1, xf2, (b3CapsuleShape*)shape2);
+		}
+		else
+		{
+			b3CollideHullAndHull(manifold, xf1, (b3HullShape*)shape1, xf2, (b3HullShape*)shape2, cache, xf01, xf02);
+		}
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+		break;
+	}
+	}
+}
+
+void b3CollideShapes(b3Manifold& manifold,
+	const b3Transform& xf1, const b3Shape* shape1,
+	const b3Transform& xf2, const b3Shape* shape2,
+	b3ConvexCache* cache,
+	const b3Transform& xf01, const b3Transform& xf02)
+{
+	if (b3HasCollideFunction(shape1->GetType(), shape2->GetType()))
+	{
+		b3CollideOrderedShapes(manifold, xf1, shape1, xf2, shape2, cache, xf01, xf02);
+		return;
+	}
+
+	B3_ASSERT(b3HasCollideFunction(shape2->GetType(), shape1->GetType()));
+
+	b3CollideOrderedShapes(manifold, xf2, shape2, xf1, shape1, cache, xf02, xf01);
+
+	// Flip the manifold so that it is relative to the first shape.
+	for (u32 i = 0; i < manifold.pointCount; ++i)
+	{
+		b3ManifoldPoint* mp = manifold.points + i;
+
+		b3Vec3 normal = b3Mul(xf2.rotation, mp->localNormal1);
+		
+		b3Vec3 localPoint2 = mp->localPoint1;
+		
+		mp->localNormal1 = b3MulC(xf1.rotation, -normal);
+		mp->localPoint1 = mp->localPoint2;
+		mp->localPoint2 = localPoint2;
+	}
+}
+
+void b3CollideSpeculative(b3Manifold& manifold,
+	const b3Transform& xf1, const b3Shape* shape1,
+	const b3Transform& xf2, const b3Shape* shape2,
+	scalar distance)
+{
+	B3_ASSERT(manifold.pointCount == 0);
+
+	b3ShapeGJKProxy proxy1(shape1, 0);
+	b3ShapeGJKProxy proxy2(shape2, 0);
+
+	b3GJKOutput query = b3GJK(xf1, proxy1, xf2, proxy2, false);
+
+	// Overlapping cores are handled by the collide functions.
+	if (query.distance <= B3_EPSILON)
+	{
+		return;
+	}
+
+	scalar separation = query.distance - proxy1.radius - proxy2.radius;
+	if (separation <= scalar(0) || separation > distance)
+	{
+		return;
+	}
+
+	b3Vec3 normal = (query.point2 - query.point1) / query.distance;
+
+	// Collide the shapes with the shape 2 moved along the normal until it touches the shape 1.
+	// The local points are the same for the real shape 2 and have a positive separation.
+	// This keeps all the points of the features, which a single closest point would miss.
+	b3Transform xf = xf2;
+	xf.translation -= (separation + B3_LINEAR_SLOP) * normal;
+
+	b3CollideShapes(manifold, xf1, shape1, xf, shape2, nullptr, xf1, xf);
+}
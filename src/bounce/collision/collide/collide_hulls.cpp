@@ -23,8 +23,7 @@
 #include <bounce/collision/shapes/hull_shape.h>
 #include <bounce/collision/geometry/hull.h>
 
-bool b3_convexCache = true;
-u32 b3_convexCalls = 0, b3_convexCacheHits = 0;
+thread_local u32 b3_convexCalls = 0, b3_convexCacheHits = 0;
 
 static void b3BuildEdgeContact(b3Manifold& manifold,
 	const b3Transform& xf1, u32 index1, const b3HullShape* s1,
@@ -593,7 +592,7 @@ void b3CollideHullAndHull(b3Manifold& manifold,
 {
 	++b3_convexCalls;
 
-	if (b3_convexCache)
+	if (cache)
 	{
 		b3CollideHulls(manifold, xf1, s1, xf2, s2, &cache->featureCache, xf01, xf02);
 	}
@@ -0,0 +1,67 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/collision/geometry/compound.h>
+#include <bounce/collision/shapes/shape.h>
+
+b3Compound::b3Compound()
+{
+	childCount = 0;
+	children = nullptr;
+}
+
+b3Compound::~b3Compound()
+{
+}
+
+void b3Compound::BuildTree()
+{
+	B3_ASSERT(childCount > 0);
+
+	b3AABB* aabbs = (b3AABB*)b3Alloc(childCount * sizeof(b3AABB));
+	for (u32 i = 0; i < childCount; ++i)
+	{
+		aabbs[i] = GetChildAABB(i);
+	}
+
+	tree.Build(aabbs, childCount);
+
+	b3Free(aabbs);
+}
+
+b3AABB b3Compound::GetChildAABB(u32 index) const
+{
+	const b3CompoundChild* child = GetChild(index);
+	
+	B3_ASSERT(child->shape->GetType() == b3Shape::e_sphere ||
+		child->shape->GetType() == b3Shape::e_capsule ||
+		child->shape->GetType() == b3Shape::e_hull);
+
+	b3AABB aabb;
+	child->shape->ComputeAABB(&aabb, child->transform);
+	return aabb;
+}
+
+u32 b3Compound::GetSize() const
+{
+	u32 size = 0;
+	size += sizeof(b3Compound);
+	size += childCount * sizeof(b3CompoundChild);
+	size += tree.GetSize();
+	return size;
+}
@@ -0,0 +1,123 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/collision/geometry/height_field.h>
+
+b3HeightField::b3HeightField()
+{
+	columnCount = 0;
+	rowCount = 0;
+	shortHeights = nullptr;
+	floatHeights = nullptr;
+	minHeight = scalar(0);
+	maxHeight = scalar(0);
+}
+
+void b3HeightField::ComputeBounds()
+{
+	B3_ASSERT(shortHeights != nullptr || floatHeights != nullptr);
+
+	minHeight = B3_MAX_SCALAR;
+	maxHeight = -B3_MAX_SCALAR;
+
+	for (u32 i = 0; i < rowCount; ++i)
+	{
+		for (u32 j = 0; j < columnCount; ++j)
+		{
+			scalar h = GetHeight(i, j);
+			minHeight = b3Min(minHeight, h);
+			maxHeight = b3Max(maxHeight, h);
+		}
+	}
+}
+
+void b3HeightField::GetTriangle(b3Vec3 vertices[3], u32 index) const
+{
+	B3_ASSERT(index < GetTriangleCount());
+
+	u32 cell = index / 2;
+	u32 i = cell / (columnCount - 1);
+	u32 j = cell % (columnCount - 1);
+
+	// 1*----*3
+	//  |  / |
+	//  | /  |
+	// 2*----*4
+	if (index % 2 == 0)
+	{
+		vertices[0] = GetVertex(i, j);
+		vertices[1] = GetVertex(i + 1, j);
+		vertices[2] = GetVertex(i, j + 1);
+	}
+	else
+	{
+		vertices[0] = GetVertex(i, j + 1);
+		vertices[1] = GetVertex(i + 1, j);
+		vertices[2] = GetVertex(i + 1, j + 1);
+	}
+}
+
+void b3HeightField::GetTriangleWings(b3Vec3 wings[3], bool hasWings[3], u32 index) const
+{
+	B3_ASSERT(index < GetTriangleCount());
+
+	u32 cell = index / 2;
+	u32 i = cell / (columnCount - 1);
+	u32 j = cell % (columnCount - 1);
+
+	if (index % 2 == 0)
+	{
+		// Left edge.
+		hasWings[0] = j > 0;
+		if (hasWings[0])
+		{
+			wings[0] = GetVertex(i + 1, j - 1);
+		}
+
+		// Diagonal.
+		hasWings[1] = true;
+		wings[1] = GetVertex(i + 1, j + 1);
+
+		// Bottom edge.
+		hasWings[2] = i > 0;
+		if (hasWings[2])
+		{
+			wings[2] = GetVertex(i - 1, j + 1);
+		}
+	}
+	else
+	{
+		// Diagonal.
+		hasWings[0] = true;
+		wings[0] = GetVertex(i, j);
+
+		// Top edge.
+		hasWings[1] = i + 2 < rowCount;
+		if (hasWings[1])
+		{
+			wings[1] = GetVertex(i + 2, j);
+		}
+
+		// Right edge.
+		hasWings[2] = j + 2 < columnCount;
+		if (hasWings[2])
+		{
+			wings[2] = GetVertex(i, j + 2);
+		}
+	}
+}
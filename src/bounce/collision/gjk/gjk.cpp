@@ -24,7 +24,8 @@
 // Implementation of the GJK (Gilbert-Johnson-Keerthi) algorithm 
 // using Voronoi regions and Barycentric coordinates.
 
-u32 b3_gjkCalls = 0, b3_gjkIters = 0, b3_gjkMaxIters = 0;
+// The statistics are kept per thread so that worlds stepping on different threads don't share them.
+thread_local u32 b3_gjkCalls = 0, b3_gjkIters = 0, b3_gjkMaxIters = 0;
 
 // Convert a point Q from Cartesian coordinates to Barycentric coordinates (u, v) 
 // with respect to a segment AB.
@@ -737,7 +738,7 @@ b3GJKOutput b3GJK(const b3Transform& xf1, const b3GJKProxy& proxy1,
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-u32 b3_gjkCacheHits = 0;
+thread_local u32 b3_gjkCacheHits = 0;
 
 // Implements b3Simplex routines for a cached simplex.
 void b3Simplex::ReadCache(const b3SimplexCache* cache,
@@ -0,0 +1,173 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/collision/shapes/compound_shape.h>
+#include <bounce/collision/geometry/compound.h>
+#include <bounce/common/memory/block_allocator.h>
+
+b3CompoundShape::b3CompoundShape() 
+{
+	m_type = e_compound;
+	// The child radii are handled by the child shapes.
+	m_radius = scalar(0);
+	m_compound = nullptr;
+}
+
+b3Shape* b3CompoundShape::Clone(b3BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b3CompoundShape));
+	b3CompoundShape* clone = new (mem)b3CompoundShape;
+	*clone = *this;
+	return clone;
+}
+
+void b3CompoundShape::ComputeMass(b3MassData* massData, scalar density) const 
+{
+	scalar mass(0);
+	b3Vec3 center; center.SetZero();
+	b3Mat33 I; I.SetZero();
+
+	for (u32 i = 0; i < m_compound->childCount; ++i)
+	{
+		const b3CompoundChild* child = m_compound->children + i;
+
+		b3MassData childMass;
+		child->shape->ComputeMass(&childMass, density);
+
+		// Shift the child inertia to the child centroid.
+		b3Mat33 Ic = childMass.I - childMass.mass * b3Steiner(childMass.center);
+
+		// Rotate the child inertia to the compound frame.
+		b3Mat33 R = child->transform.rotation.GetRotationMatrix();
+		Ic = b3RotateToFrame(Ic, R);
+
+		// Shift the child inertia to the compound origin.
+		b3Vec3 c = child->transform * childMass.center;
+		I += Ic + childMass.mass * b3Steiner(c);
+		
+		center += childMass.mass * c;
+		mass += childMass.mass;
+	}
+
+	if (mass > scalar(0))
+	{
+		center /= mass;
+	}
+
+	massData->center = center;
+	massData->mass = mass;
+	massData->I = I;
+}
+
+void b3CompoundShape::ComputeAABB(b3AABB* output, const b3Transform& xf) const 
+{
+	ComputeAABB(output, xf, 0);
+	
+	for (u32 i = 1; i < m_compound->childCount; ++i)
+	{
+		b3AABB aabb;
+		ComputeAABB(&aabb, xf, i);
+		output->Combine(aabb);
+	}
+}
+
+void b3CompoundShape::ComputeAABB(b3AABB* output, const b3Transform& xf, u32 index) const
+{
+	const b3CompoundChild* child = m_compound->GetChild(index);
+	child->shape->ComputeAABB(output, xf * child->transform);
+}
+
+bool b3CompoundShape::TestSphere(const b3Sphere& sphere, const b3Transform& xf) const
+{
+	for (u32 i = 0; i < m_compound->childCount; ++i)
+	{
+		const b3CompoundChild* child = m_compound->children + i;
+		if (child->shape->TestSphere(sphere, xf * child->transform))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool b3CompoundShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf, u32 index) const
+{
+	const b3CompoundChild* child = m_compound->GetChild(index);
+	return child->shape->RayCast(output, input, xf * child->transform);
+}
+
+struct b3CompoundShapeRayCastCallback
+{
+	scalar Report(const b3RayCastInput& subInput, u32 proxyId)
+	{
+		u32 childIndex = compound->m_compound->tree.GetUserData(proxyId);
+		
+		b3RayCastInput childInput = input;
+		childInput.maxFraction = subInput.maxFraction;
+
+		b3RayCastOutput childOutput;
+		if (compound->RayCast(&childOutput, childInput, xf, childIndex))
+		{
+			if (childOutput.fraction < output.fraction)
+			{
+				hit = true;
+				output = childOutput;
+			}
+
+			// The compound frame is rigid so the ray can be clipped.
+			return childOutput.fraction;
+		}
+		
+		return subInput.maxFraction;
+	}
+
+	b3RayCastInput input;
+	const b3CompoundShape* compound;
+	b3Transform xf;
+	
+	bool hit;
+	b3RayCastOutput output;
+};
+
+bool b3CompoundShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf) const 
+{
+	b3CompoundShapeRayCastCallback callback;
+	callback.input = input;
+	callback.compound = this;
+	callback.xf = xf;
+	callback.hit = false;
+	callback.output.fraction = B3_MAX_SCALAR;
+	
+	b3RayCastInput treeInput;
+	treeInput.p1 = b3MulT(xf, input.p1);
+	treeInput.p2 = b3MulT(xf, input.p2);
+	treeInput.maxFraction = input.maxFraction;
+	m_compound->tree.RayCast(&callback, treeInput);
+
+	output->fraction = callback.output.fraction;
+	output->normal = callback.output.normal;
+
+	return callback.hit;
+}
+
+const b3Shape* b3CompoundShape::GetChildShape(b3Transform* childTransform, u32 index) const
+{
+	const b3CompoundChild* child = m_compound->GetChild(index);
+	*childTransform = child->transform;
+	return child->shape;
+}
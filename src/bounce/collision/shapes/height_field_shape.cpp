@@ -0,0 +1,299 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/geometry/height_field.h>
+#include <bounce/collision/shapes/triangle_shape.h>
+#include <bounce/common/memory/block_allocator.h>
+
+b3HeightFieldShape::b3HeightFieldShape() 
+{
+	m_type = e_heightField;
+	m_radius = B3_HULL_RADIUS;
+	m_heightField = nullptr;
+	m_scale.Set(scalar(1), scalar(1), scalar(1));
+}
+
+b3Shape* b3HeightFieldShape::Clone(b3BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b3HeightFieldShape));
+	b3HeightFieldShape* clone = new (mem)b3HeightFieldShape;
+	*clone = *this;
+	return clone;
+}
+
+void b3HeightFieldShape::ComputeMass(b3MassData* massData, scalar density) const 
+{
+	B3_NOT_USED(density);	
+	massData->center.SetZero();
+	massData->mass = scalar(0);
+	massData->I.SetZero();
+}
+
+void b3HeightFieldShape::ComputeAABB(b3AABB* output, const b3Transform& xf) const 
+{
+	b3AABB aabb = m_heightField->GetAABB();
+	aabb.Scale(m_scale);
+	aabb.Transform(xf);
+	aabb.Extend(m_radius);
+
+	*output = aabb;
+}
+
+void b3HeightFieldShape::ComputeAABB(b3AABB* output, const b3Transform& xf, u32 index) const
+{
+	b3Vec3 vs[3];
+	m_heightField->GetTriangle(vs, index);
+
+	b3Vec3 v1 = b3Mul(xf, b3Mul(m_scale, vs[0]));
+	b3Vec3 v2 = b3Mul(xf, b3Mul(m_scale, vs[1]));
+	b3Vec3 v3 = b3Mul(xf, b3Mul(m_scale, vs[2]));
+	
+	b3AABB aabb;
+	aabb.lowerBound = b3Min(v1, b3Min(v2, v3));
+	aabb.upperBound = b3Max(v1, b3Max(v2, v3));
+	aabb.Extend(m_radius);
+	
+	*output = aabb;
+}
+
+bool b3HeightFieldShape::TestSphere(const b3Sphere& sphere, const b3Transform& xf) const
+{
+	B3_NOT_USED(sphere);
+	B3_NOT_USED(xf);
+	return false;
+}
+
+bool b3HeightFieldShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf, u32 index) const
+{
+	b3TriangleShape triangle;
+	GetChildTriangle(&triangle, index);
+	return triangle.RayCast(output, input, xf);
+}
+
+bool b3HeightFieldShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf) const 
+{
+	const b3HeightField* hf = m_heightField;
+	
+	if (hf->GetCellCount() == 0)
+	{
+		return false;
+	}
+
+	B3_ASSERT(m_scale.x > scalar(0));
+	B3_ASSERT(m_scale.y > scalar(0));
+	B3_ASSERT(m_scale.z > scalar(0));
+
+	b3Vec3 inv_scale;
+	inv_scale.x = scalar(1) / m_scale.x;
+	inv_scale.y = scalar(1) / m_scale.y;
+	inv_scale.z = scalar(1) / m_scale.z;
+
+	// Put the ray into the frame of the unscaled grid.
+	// The fractions are preserved.
+	b3Vec3 p1 = b3Mul(inv_scale, b3MulT(xf, input.p1));
+	b3Vec3 p2 = b3Mul(inv_scale, b3MulT(xf, input.p2));
+	b3Vec3 d = p2 - p1;
+
+	// Clip the ray against the grid bounds.
+	b3AABB bounds = hf->GetAABB();
+
+	scalar lower = scalar(0);
+	scalar upper = input.maxFraction;
+
+	for (u32 i = 0; i < 3; ++i)
+	{
+		scalar p = p1[i];
+		scalar di = d[i];
+		scalar lo = bounds.lowerBound[i];
+		scalar hi = bounds.upperBound[i];
+
+		if (b3Abs(di) < B3_EPSILON)
+		{
+			if (p < lo || p > hi)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			scalar t1 = (lo - p) / di;
+			scalar t2 = (hi - p) / di;
+			if (t1 > t2)
+			{
+				b3Swap(t1, t2);
+			}
+
+			lower = b3Max(lower, t1);
+			upper = b3Min(upper, t2);
+
+			if (lower > upper)
+			{
+				return false;
+			}
+		}
+	}
+
+	// Walk the cells crossed by the ray using a 2D DDA.
+	i32 lastColumn = i32(hf->columnCount) - 2;
+	i32 lastRow = i32(hf->rowCount) - 2;
+
+	b3Vec3 q = p1 + lower * d;
+
+	i32 column = b3Clamp(i32(b3Max(q.x, scalar(0))), 0, lastColumn);
+	i32 row = b3Clamp(i32(b3Max(q.z, scalar(0))), 0, lastRow);
+
+	i32 columnStep = 0;
+	scalar columnDelta = B3_MAX_SCALAR;
+	scalar columnNext = B3_MAX_SCALAR;
+	if (d.x > B3_EPSILON)
+	{
+		columnStep = 1;
+		columnDelta = scalar(1) / d.x;
+		columnNext = (scalar(column + 1) - p1.x) / d.x;
+	}
+	else if (d.x < -B3_EPSILON)
+	{
+		columnStep = -1;
+		columnDelta = -scalar(1) / d.x;
+		columnNext = (scalar(column) - p1.x) / d.x;
+	}
+
+	i32 rowStep = 0;
+	scalar rowDelta = B3_MAX_SCALAR;
+	scalar rowNext = B3_MAX_SCALAR;
+	if (d.z > B3_EPSILON)
+	{
+		rowStep = 1;
+		rowDelta = scalar(1) / d.z;
+		rowNext = (scalar(row + 1) - p1.z) / d.z;
+	}
+	else if (d.z < -B3_EPSILON)
+	{
+		rowStep = -1;
+		rowDelta = -scalar(1) / d.z;
+		rowNext = (scalar(row) - p1.z) / d.z;
+	}
+
+	scalar enterFraction = lower;
+	for (;;)
+	{
+		scalar exitFraction = b3Min(upper, b3Min(columnNext, rowNext));
+
+		// Skip the cell if the ray passes above or below it.
+		scalar y1 = p1.y + enterFraction * d.y;
+		scalar y2 = p1.y + exitFraction * d.y;
+
+		u32 i = u32(row), j = u32(column);
+
+		scalar h1 = hf->GetHeight(i, j);
+		scalar h2 = hf->GetHeight(i, j + 1);
+		scalar h3 = hf->GetHeight(i + 1, j);
+		scalar h4 = hf->GetHeight(i + 1, j + 1);
+
+		scalar cellLower = b3Min(b3Min(h1, h2), b3Min(h3, h4));
+		scalar cellUpper = b3Max(b3Max(h1, h2), b3Max(h3, h4));
+
+		if (b3Max(y1, y2) >= cellLower && b3Min(y1, y2) <= cellUpper)
+		{
+			u32 cell = i * (hf->columnCount - 1) + j;
+
+			bool hit = false;
+			b3RayCastOutput bestOutput;
+			bestOutput.fraction = B3_MAX_SCALAR;
+
+			for (u32 k = 0; k < 2; ++k)
+			{
+				b3RayCastOutput childOutput;
+				if (RayCast(&childOutput, input, xf, 2 * cell + k))
+				{
+					if (childOutput.fraction < bestOutput.fraction)
+					{
+						hit = true;
+						bestOutput = childOutput;
+					}
+				}
+			}
+
+			// The cells are visited in order so this is the closest hit.
+			if (hit)
+			{
+				*output = bestOutput;
+				return true;
+			}
+		}
+
+		if (exitFraction >= upper)
+		{
+			break;
+		}
+
+		if (columnNext < rowNext)
+		{
+			column += columnStep;
+			enterFraction = columnNext;
+			columnNext += columnDelta;
+		}
+		else
+		{
+			row += rowStep;
+			enterFraction = rowNext;
+			rowNext += rowDelta;
+		}
+
+		if (column < 0 || column > lastColumn || row < 0 || row > lastRow)
+		{
+			break;
+		}
+	}
+
+	return false;
+}
+
+void b3HeightFieldShape::GetChildTriangle(b3TriangleShape* triangleShape, u32 index) const
+{
+	b3Vec3 vs[3];
+	m_heightField->GetTriangle(vs, index);
+
+	b3Vec3 ws[3];
+	bool hasWs[3];
+	m_heightField->GetTriangleWings(ws, hasWs, index);
+
+	triangleShape->m_vertex1 = b3Mul(m_scale, vs[0]);
+	triangleShape->m_vertex2 = b3Mul(m_scale, vs[1]);
+	triangleShape->m_vertex3 = b3Mul(m_scale, vs[2]);
+	triangleShape->m_radius = m_radius;
+
+	if (hasWs[0])
+	{
+		triangleShape->m_hasE1Vertex = true;
+		triangleShape->m_e1Vertex = b3Mul(m_scale, ws[0]);
+	}
+
+	if (hasWs[1])
+	{
+		triangleShape->m_hasE2Vertex = true;
+		triangleShape->m_e2Vertex = b3Mul(m_scale, ws[1]);
+	}
+
+	if (hasWs[2])
+	{
+		triangleShape->m_hasE3Vertex = true;
+		triangleShape->m_e3Vertex = b3Mul(m_scale, ws[2]);
+	}
+}
@@ -22,8 +22,12 @@
 #include <bounce/collision/shapes/triangle_shape.h>
 #include <bounce/collision/shapes/hull_shape.h>
 #include <bounce/collision/shapes/mesh_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/shapes/compound_shape.h>
 #include <bounce/collision/geometry/hull.h>
 #include <bounce/collision/geometry/mesh.h>
+#include <bounce/collision/geometry/height_field.h>
+#include <bounce/collision/geometry/compound.h>
 #include <bounce/common/memory/block_allocator.h>
 #include <bounce/common/draw.h>
 
@@ -66,9 +70,63 @@ void b3Shape::Destroy(b3Shape* shape, b3BlockAllocator* allocator)
 		allocator->Free(shape, sizeof(b3MeshShape));
 		break;
 	}
+	case e_heightField:
+	{
+		b3HeightFieldShape* heightField = (b3HeightFieldShape*)shape;
+		heightField->~b3HeightFieldShape();
+		allocator->Free(shape, sizeof(b3HeightFieldShape));
+		break;
+	}
+	case e_compound:
+	{
+		b3CompoundShape* compound = (b3CompoundShape*)shape;
+		compound->~b3CompoundShape();
+		allocator->Free(shape, sizeof(b3CompoundShape));
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+	}
+	}
+}
+
+u32 b3Shape::GetSize() const
+{
+	switch (m_type)
+	{
+	case e_sphere:
+	{
+		return sizeof(b3SphereShape);
+	}
+	case e_capsule:
+	{
+		return sizeof(b3CapsuleShape);
+	}
+	case e_triangle:
+	{
+		return sizeof(b3TriangleShape);
+	}
+	case e_hull:
+	{
+		return sizeof(b3HullShape);
+	}
+	case e_mesh:
+	{
+		return sizeof(b3MeshShape);
+	}
+	case e_heightField:
+	{
+		return sizeof(b3HeightFieldShape);
+	}
+	case e_compound:
+	{
+		return sizeof(b3CompoundShape);
+	}
 	default:
 	{
 		B3_ASSERT(false);
+		return 0;
 	}
 	}
 }
@@ -137,6 +195,34 @@ void b3Shape::Draw(b3Draw* draw, const b3Transform& xf, const b3Color& color) co
 		}
 		break;
 	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightFieldShape* hs = (b3HeightFieldShape*)this;
+		const b3HeightField* heightField = hs->m_heightField;
+		for (u32 i = 0; i < heightField->GetTriangleCount(); ++i)
+		{
+			b3Vec3 vs[3];
+			heightField->GetTriangle(vs, i);
+
+			b3Vec3 p1 = xf * b3Mul(hs->m_scale, vs[0]);
+			b3Vec3 p2 = xf * b3Mul(hs->m_scale, vs[1]);
+			b3Vec3 p3 = xf * b3Mul(hs->m_scale, vs[2]);
+
+			draw->DrawTriangle(p1, p2, p3, color);
+		}
+		break;
+	}
+	case b3Shape::e_compound:
+	{
+		const b3CompoundShape* cs = (b3CompoundShape*)this;
+		const b3Compound* compound = cs->m_compound;
+		for (u32 i = 0; i < compound->childCount; ++i)
+		{
+			const b3CompoundChild* child = compound->children + i;
+			child->shape->Draw(draw, xf * child->transform, color);
+		}
+		break;
+	}
 	default:
 	{
 		break;
@@ -241,6 +327,43 @@ void b3Shape::DrawSolid(b3Draw* draw, const b3Transform& xf, const b3Color& colo
 
 		break;
 	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightFieldShape* heightFieldShape = (b3HeightFieldShape*)this;
+
+		const b3HeightField* heightField = heightFieldShape->m_heightField;
+		for (u32 i = 0; i < heightField->GetTriangleCount(); ++i)
+		{
+			b3Vec3 vs[3];
+			heightField->GetTriangle(vs, i);
+
+			b3Vec3 p1 = xf * b3Mul(heightFieldShape->m_scale, vs[0]);
+			b3Vec3 p2 = xf * b3Mul(heightFieldShape->m_scale, vs[1]);
+			b3Vec3 p3 = xf * b3Mul(heightFieldShape->m_scale, vs[2]);
+
+			b3Vec3 n1 = b3Cross(p2 - p1, p3 - p1);
+			n1.Normalize();
+			draw->DrawSolidTriangle(n1, p1, p2, p3, color);
+
+			b3Vec3 n2 = -n1;
+			draw->DrawSolidTriangle(n2, p3, p2, p1, color);
+		}
+
+		break;
+	}
+	case b3Shape::e_compound:
+	{
+		const b3CompoundShape* compoundShape = (b3CompoundShape*)this;
+
+		const b3Compound* compound = compoundShape->m_compound;
+		for (u32 i = 0; i < compound->childCount; ++i)
+		{
+			const b3CompoundChild* child = compound->children + i;
+			child->shape->DrawSolid(draw, xf * child->transform, color);
+		}
+
+		break;
+	}
 	default:
 	{
 		break;
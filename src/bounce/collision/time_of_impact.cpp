@@ -19,8 +19,8 @@
 #include <bounce/collision/time_of_impact.h>
 #include <bounce/collision/gjk/gjk.h>
 
-u32 b3_toiCalls = 0;
-u32 b3_toiMaxIters = 0;
+thread_local u32 b3_toiCalls = 0;
+thread_local u32 b3_toiMaxIters = 0;
 
 // Compute the closest point on a segment to a point. 
 static b3Vec3 b3ClosestPointOnSegment(const b3Vec3& Q,
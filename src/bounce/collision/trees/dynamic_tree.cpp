@@ -19,6 +19,7 @@
 #include <bounce/collision/trees/dynamic_tree.h>
 #include <bounce/common/draw.h>
 #include <string.h>
+#include <algorithm>
 
 b3DynamicTree::b3DynamicTree()
 {
@@ -33,6 +34,9 @@ b3DynamicTree::b3DynamicTree()
 	// Link the allocated nodes and make the first node 
 	// available the the next allocation.
 	AddToFreeList(m_nodeCount);
+
+	m_bulkLoad = false;
+	m_detachedCount = 0;
 }
 
 b3DynamicTree::~b3DynamicTree()
@@ -120,6 +124,13 @@ u32 b3DynamicTree::CreateProxy(const b3AABB& aabb, void* userData)
 	m_nodes[proxyId].userData = userData;
 	m_nodes[proxyId].height = 0;
 	
+	if (m_bulkLoad)
+	{
+		// Leave the proxy detached until the end of the bulk load.
+		++m_detachedCount;
+		return proxyId;
+	}
+
 	// Insert into the tree.
 	InsertLeaf(proxyId);
 
@@ -129,6 +140,14 @@ u32 b3DynamicTree::CreateProxy(const b3AABB& aabb, void* userData)
 
 void b3DynamicTree::DestroyProxy(u32 proxyId)
 {
+	if (IsDetached(proxyId))
+	{
+		B3_ASSERT(m_detachedCount > 0);
+		--m_detachedCount;
+		FreeNode(proxyId);
+		return;
+	}
+
 	// Remove from the tree.
 	RemoveLeaf(proxyId);
 
@@ -194,6 +213,13 @@ bool b3DynamicTree::MoveProxy(u32 proxyId, const b3AABB& aabb, const b3Vec3& dis
 		// Otherwise the tree AABB is huge and needs to be shrunk
 	}
 
+	if (IsDetached(proxyId))
+	{
+		// The proxy gets inserted at the end of the bulk load.
+		m_nodes[proxyId].aabb = fatAABB;
+		return true;
+	}
+
 	// Remove old AABB from the tree.
 	RemoveLeaf(proxyId);
 
@@ -206,6 +232,204 @@ bool b3DynamicTree::MoveProxy(u32 proxyId, const b3AABB& aabb, const b3Vec3& dis
 	return true;
 }
 
+void b3DynamicTree::BeginBulkLoad()
+{
+	B3_ASSERT(m_bulkLoad == false);
+	m_bulkLoad = true;
+}
+
+void b3DynamicTree::EndBulkLoad()
+{
+	B3_ASSERT(m_bulkLoad == true);
+	m_bulkLoad = false;
+
+	if (m_detachedCount > 0)
+	{
+		Rebuild();
+	}
+}
+
+u32 b3DynamicTree::BuildRecursively(u32* leaves, u32 count)
+{
+	B3_ASSERT(count > 0);
+
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	// Split the leaves at the median along the longest axis of their centers.
+	b3Vec3 center = m_nodes[leaves[0]].aabb.GetCenter();
+	
+	b3AABB centerAABB;
+	centerAABB.lowerBound = center;
+	centerAABB.upperBound = center;
+	for (u32 i = 1; i < count; ++i)
+	{
+		b3Vec3 c = m_nodes[leaves[i]].aabb.GetCenter();
+		centerAABB.lowerBound = b3Min(centerAABB.lowerBound, c);
+		centerAABB.upperBound = b3Max(centerAABB.upperBound, c);
+	}
+
+	struct b3LeafSortPredicate
+	{
+		bool operator()(u32 a, u32 b) const
+		{
+			return nodes[a].aabb.GetCenter()[axis] < nodes[b].aabb.GetCenter()[axis];
+		}
+
+		const b3Node* nodes;
+		u32 axis;
+	};
+
+	b3LeafSortPredicate predicate;
+	predicate.nodes = m_nodes;
+	predicate.axis = centerAABB.GetLongestAxisIndex();
+
+	u32 middle = count / 2;
+	std::nth_element(leaves, leaves + middle, leaves + count, predicate);
+
+	u32 child1 = BuildRecursively(leaves, middle);
+	u32 child2 = BuildRecursively(leaves + middle, count - middle);
+
+	// The node array might be reallocated here.
+	u32 node = AllocateNode();
+	m_nodes[node].child1 = child1;
+	m_nodes[node].child2 = child2;
+	m_nodes[node].aabb = b3Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	m_nodes[node].height = 1 + b3Max(m_nodes[child1].height, m_nodes[child2].height);
+
+	m_nodes[child1].parent = node;
+	m_nodes[child2].parent = node;
+
+	return node;
+}
+
+void b3DynamicTree::Rebuild()
+{
+	// Free the internal nodes and collect the leaves.
+	u32* leaves = (u32*)b3Alloc(m_nodeCount * sizeof(u32));
+	u32 leafCount = 0;
+	for (u32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// Free node.
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			m_nodes[i].parent = B3_NULL_NODE_D;
+			leaves[leafCount++] = i;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	B3_ASSERT(leafCount == m_nodeCount);
+
+	m_root = B3_NULL_NODE_D;
+	m_detachedCount = 0;
+
+	if (leafCount > 0)
+	{
+		m_root = BuildRecursively(leaves, leafCount);
+		m_nodes[m_root].parent = B3_NULL_NODE_D;
+	}
+
+	b3Free(leaves);
+}
+
+void b3DynamicTree::SaveState(b3StateBuffer* buffer) const
+{
+	B3_ASSERT(m_bulkLoad == false);
+
+	buffer->Write(m_root);
+	buffer->Write(m_nodeCount);
+	buffer->Write(m_nodeCapacity);
+	buffer->Write(m_freeList);
+	buffer->Write(m_nodes, m_nodeCapacity * sizeof(b3Node));
+}
+
+void b3DynamicTree::RestoreState(b3StateBuffer* buffer)
+{
+	B3_ASSERT(m_bulkLoad == false);
+
+	u32 nodeCapacity;
+	buffer->Read(m_root);
+	buffer->Read(m_nodeCount);
+	buffer->Read(nodeCapacity);
+	buffer->Read(m_freeList);
+	const b3Node* nodes = (const b3Node*)buffer->ReadData(nodeCapacity * sizeof(b3Node));
+
+	if (nodeCapacity > m_nodeCapacity)
+	{
+		// Keep the current nodes for their user data.
+		b3Node* oldNodes = m_nodes;
+		m_nodes = (b3Node*)b3Alloc(nodeCapacity * sizeof(b3Node));
+		memcpy(m_nodes, oldNodes, m_nodeCapacity * sizeof(b3Node));
+		b3Free(oldNodes);
+		
+		for (u32 i = m_nodeCapacity; i < nodeCapacity; ++i)
+		{
+			m_nodes[i].height = -1;
+		}
+
+		m_nodeCapacity = nodeCapacity;
+	}
+
+	for (u32 i = 0; i < nodeCapacity; ++i)
+	{
+		void* userData = m_nodes[i].userData;
+		
+		m_nodes[i] = nodes[i];
+		
+		if (m_nodes[i].height == 0)
+		{
+			// The proxies are the same. Keep the user data. 
+			B3_ASSERT(m_nodes[i].IsLeaf());
+			m_nodes[i].userData = userData;
+		}
+		else
+		{
+			m_nodes[i].userData = nullptr;
+		}
+	}
+
+	if (m_nodeCapacity > nodeCapacity)
+	{
+		// Append the extra nodes to the free list. 
+		// This allocates the nodes in the same order as the saved tree would after growing.
+		for (u32 i = nodeCapacity; i < m_nodeCapacity - 1; ++i)
+		{
+			m_nodes[i].next = i + 1;
+			m_nodes[i].height = -1;
+		}
+
+		m_nodes[m_nodeCapacity - 1].next = B3_NULL_NODE_D;
+		m_nodes[m_nodeCapacity - 1].height = -1;
+
+		if (m_freeList == B3_NULL_NODE_D)
+		{
+			m_freeList = nodeCapacity;
+		}
+		else
+		{
+			u32 tail = m_freeList;
+			while (m_nodes[tail].next != B3_NULL_NODE_D)
+			{
+				tail = m_nodes[tail].next;
+			}
+			m_nodes[tail].next = nodeCapacity;
+		}
+	}
+
+	m_detachedCount = 0;
+}
+
 u32 b3DynamicTree::PickBest(const b3AABB& leafAABB) const
 {
 	u32 index = m_root;
@@ -534,6 +758,11 @@ u32 b3DynamicTree::Balance(u32 iA)
 
 	return iA;
 }
+void b3DynamicTree::Validate() const
+{
+	Validate(m_root);
+}
+
 void b3DynamicTree::Validate(u32 nodeID) const
 {
 	if (nodeID == B3_NULL_NODE_D)
@@ -569,6 +798,11 @@ void b3DynamicTree::Validate(u32 nodeID) const
 		B3_ASSERT(m_nodes[child1].parent == nodeID);
 		B3_ASSERT(m_nodes[child2].parent == nodeID);
 
+		// The node encloses its children and is one level above the highest child.
+		B3_ASSERT(node->aabb.Contains(m_nodes[child1].aabb));
+		B3_ASSERT(node->aabb.Contains(m_nodes[child2].aabb));
+		B3_ASSERT(node->height == 1 + b3Max(m_nodes[child1].height, m_nodes[child2].height));
+
 		// Walk down the tree.
 		Validate(child1);
 		Validate(child2);
@@ -20,10 +20,7 @@
 #include <bounce/common/memory/block_pool.h>
 #include <new>
 
-static const u32 b3_maxBlockSize = 640;
-
-// These are the supported object sizes. Actual allocations are rounded up the next size.
-static const u32 b3_blockSizes[b3_blockSizeCount] =
+const u32 b3_blockSizes[b3_blockSizeCount] =
 {
 	16,		// 0
 	32,		// 1
@@ -68,6 +65,12 @@ struct b3SizeMap
 
 static const b3SizeMap b3_sizeMap;
 
+u32 b3GetBlockSizeIndex(u32 size)
+{
+	B3_ASSERT(0 < size && size <= b3_maxBlockSize);
+	return b3_sizeMap.slots[size];
+}
+
 b3BlockAllocator::b3BlockAllocator()
 {
 	m_blockPools = (b3BlockPool*)b3Alloc(sizeof(b3BlockPool) * b3_blockSizeCount);
@@ -75,6 +78,8 @@ b3BlockAllocator::b3BlockAllocator()
 	{
 		new (m_blockPools + i) b3BlockPool(b3_blockSizes[i]);
 	}
+	m_largeAllocationCount = 0;
+	m_largeAllocatedSize = 0;
 }
 
 b3BlockAllocator::~b3BlockAllocator()
@@ -97,6 +102,8 @@ void* b3BlockAllocator::Allocate(u32 size)
 	
 	if (size > b3_maxBlockSize)
 	{
+		++m_largeAllocationCount;
+		m_largeAllocatedSize += size;
 		return b3Alloc(size);
 	}
 
@@ -117,6 +124,9 @@ void b3BlockAllocator::Free(void* p, u32 size)
 
 	if (size > b3_maxBlockSize)
 	{
+		B3_ASSERT(m_largeAllocationCount > 0);
+		--m_largeAllocationCount;
+		m_largeAllocatedSize -= size;
 		b3Free(p);
 		return;
 	}
@@ -125,4 +135,20 @@ void b3BlockAllocator::Free(void* p, u32 size)
 	B3_ASSERT(0 <= index && index < b3_blockSizeCount);
 
 	m_blockPools[index].Free(p);
-}
\ No newline at end of file
+}
+
+void b3BlockAllocator::GetStats(b3BlockAllocatorStats* stats) const
+{
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		const b3BlockPool* pool = m_blockPools + i;
+
+		b3BlockSizeStats* s = stats->sizes + i;
+		s->blockSize = pool->GetBlockSize();
+		s->chunkCount = pool->GetChunkCount();
+		s->blockCount = pool->GetChunkCount() * b3_blockCount;
+		s->allocatedCount = pool->GetAllocatedCount();
+	}
+	stats->largeAllocationCount = m_largeAllocationCount;
+	stats->largeAllocatedSize = m_largeAllocatedSize;
+}
@@ -26,6 +26,7 @@ b3BlockPool::b3BlockPool(u32 blockSize)
 
 	m_chunks = nullptr;
 	m_chunkCount = 0;
+	m_allocatedCount = 0;
 
 	// Pre-allocate some chunks
 	b3Chunk* chunk = (b3Chunk*)b3Alloc(sizeof(b3Chunk) + m_chunkSize);
@@ -71,6 +72,7 @@ void* b3BlockPool::Allocate()
 		{
 			b3Block* block = m_chunks->freeBlocks;
 			m_chunks->freeBlocks = block->next;
+			++m_allocatedCount;
 			return block;
 		}
 	}
@@ -100,6 +102,7 @@ void* b3BlockPool::Allocate()
 	// Make the free block of the chunk available for the next allocation.
 	b3Block* block = m_chunks->freeBlocks;
 	m_chunks->freeBlocks = block->next;
+	++m_allocatedCount;
 	return block;
 }
 
@@ -125,6 +128,9 @@ void b3BlockPool::Free(void* p)
 	memset(p, 0xfd, m_blockSize);
 #endif
 
+	B3_ASSERT(m_allocatedCount > 0);
+	--m_allocatedCount;
+
 	b3Block* block = (b3Block*)p;
 	block->next = m_chunks->freeBlocks;
 	m_chunks->freeBlocks = block;
@@ -0,0 +1,327 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/common/memory/concurrent_block_allocator.h>
+#include <mutex>
+#include <new>
+#include <string.h>
+
+// Number of blocks per shared chunk.
+static const u32 b3_concurrentBlockCount = 64;
+
+struct b3ConcurrentBlock
+{
+	b3ConcurrentBlock* next;
+};
+
+struct b3ConcurrentChunk
+{
+	b3ConcurrentChunk* next;
+	u32 padding[2];
+};
+
+struct b3BlockSizeClass
+{
+	std::mutex mutex;
+	u32 blockSize;
+	b3ConcurrentBlock* freeBlocks;
+	u32 freeCount;
+	b3ConcurrentChunk* chunks;
+	u32 chunkCount;
+};
+
+// Allocate a new chunk and push its blocks to the free list of a size class.
+// The class must be locked.
+static void b3AddChunk(b3BlockSizeClass* sizeClass)
+{
+	u32 blockSize = sizeClass->blockSize;
+	u32 chunkSize = b3_concurrentBlockCount * blockSize;
+
+	b3ConcurrentChunk* chunk = (b3ConcurrentChunk*)b3Alloc(sizeof(b3ConcurrentChunk) + chunkSize);
+	u8* blocks = (u8*)chunk + sizeof(b3ConcurrentChunk);
+
+#ifdef B3_DEBUG
+	memset(blocks, 0xcd, chunkSize);
+#endif
+
+	// Link the singly-linked list of the new blocks of the chunk.
+	for (u32 i = 0; i < b3_concurrentBlockCount - 1; ++i)
+	{
+		b3ConcurrentBlock* current = (b3ConcurrentBlock*)(blocks + i * blockSize);
+		current->next = (b3ConcurrentBlock*)(blocks + (i + 1) * blockSize);
+	}
+	b3ConcurrentBlock* last = (b3ConcurrentBlock*)(blocks + (b3_concurrentBlockCount - 1) * blockSize);
+	last->next = sizeClass->freeBlocks;
+	
+	sizeClass->freeBlocks = (b3ConcurrentBlock*)blocks;
+	sizeClass->freeCount += b3_concurrentBlockCount;
+
+	chunk->next = sizeClass->chunks;
+	sizeClass->chunks = chunk;
+	++sizeClass->chunkCount;
+}
+
+b3ConcurrentBlockAllocator::b3ConcurrentBlockAllocator()
+{
+	m_sizeClasses = (b3BlockSizeClass*)b3Alloc(sizeof(b3BlockSizeClass) * b3_blockSizeCount);
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		b3BlockSizeClass* sizeClass = new (m_sizeClasses + i) b3BlockSizeClass();
+		sizeClass->blockSize = b3_blockSizes[i];
+		sizeClass->freeBlocks = nullptr;
+		sizeClass->freeCount = 0;
+		sizeClass->chunks = nullptr;
+		sizeClass->chunkCount = 0;
+	}
+	m_largeAllocationCount = 0;
+	m_largeAllocatedSize = 0;
+}
+
+b3ConcurrentBlockAllocator::~b3ConcurrentBlockAllocator()
+{
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		b3BlockSizeClass* sizeClass = m_sizeClasses + i;
+		
+		b3ConcurrentChunk* c = sizeClass->chunks;
+		while (c)
+		{
+			b3ConcurrentChunk* quack = c;
+			c = c->next;
+			b3Free(quack);
+		}
+
+		sizeClass->~b3BlockSizeClass();
+	}
+	b3Free(m_sizeClasses);
+}
+
+u32 b3ConcurrentBlockAllocator::Acquire(u32 index, b3ConcurrentBlock** blocks, u32 count)
+{
+	B3_ASSERT(index < b3_blockSizeCount);
+	b3BlockSizeClass* sizeClass = m_sizeClasses + index;
+
+	std::lock_guard<std::mutex> lock(sizeClass->mutex);
+
+	if (sizeClass->freeCount == 0)
+	{
+		b3AddChunk(sizeClass);
+	}
+
+	// Detach the first blocks of the shared free list.
+	u32 n = 1;
+	b3ConcurrentBlock* first = sizeClass->freeBlocks;
+	b3ConcurrentBlock* last = first;
+	while (n < count && last->next)
+	{
+		last = last->next;
+		++n;
+	}
+
+	sizeClass->freeBlocks = last->next;
+	sizeClass->freeCount -= n;
+
+	last->next = *blocks;
+	*blocks = first;
+	return n;
+}
+
+void b3ConcurrentBlockAllocator::Release(u32 index, b3ConcurrentBlock* first, b3ConcurrentBlock* last, u32 count)
+{
+	B3_ASSERT(index < b3_blockSizeCount);
+	b3BlockSizeClass* sizeClass = m_sizeClasses + index;
+
+	std::lock_guard<std::mutex> lock(sizeClass->mutex);
+
+	last->next = sizeClass->freeBlocks;
+	sizeClass->freeBlocks = first;
+	sizeClass->freeCount += count;
+}
+
+void* b3ConcurrentBlockAllocator::Allocate(u32 size)
+{
+	if (size == 0)
+	{
+		return nullptr;
+	}
+
+	if (size > b3_maxBlockSize)
+	{
+		m_largeAllocationCount.fetch_add(1, std::memory_order_relaxed);
+		m_largeAllocatedSize.fetch_add(size, std::memory_order_relaxed);
+		return b3Alloc(size);
+	}
+
+	u32 index = b3GetBlockSizeIndex(size);
+
+	b3ConcurrentBlock* block = nullptr;
+	Acquire(index, &block, 1);
+	return block;
+}
+
+void b3ConcurrentBlockAllocator::Free(void* p, u32 size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	if (size > b3_maxBlockSize)
+	{
+		m_largeAllocationCount.fetch_sub(1, std::memory_order_relaxed);
+		m_largeAllocatedSize.fetch_sub(size, std::memory_order_relaxed);
+		b3Free(p);
+		return;
+	}
+
+	u32 index = b3GetBlockSizeIndex(size);
+
+#ifdef B3_DEBUG
+	memset(p, 0xfd, b3_blockSizes[index]);
+#endif
+
+	b3ConcurrentBlock* block = (b3ConcurrentBlock*)p;
+	Release(index, block, block, 1);
+}
+
+void b3ConcurrentBlockAllocator::GetStats(b3BlockAllocatorStats* stats) const
+{
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		b3BlockSizeClass* sizeClass = m_sizeClasses + i;
+		
+		std::lock_guard<std::mutex> lock(sizeClass->mutex);
+
+		b3BlockSizeStats* s = stats->sizes + i;
+		s->blockSize = sizeClass->blockSize;
+		s->chunkCount = sizeClass->chunkCount;
+		s->blockCount = sizeClass->chunkCount * b3_concurrentBlockCount;
+		s->allocatedCount = s->blockCount - sizeClass->freeCount;
+	}
+	stats->largeAllocationCount = m_largeAllocationCount.load(std::memory_order_relaxed);
+	stats->largeAllocatedSize = m_largeAllocatedSize.load(std::memory_order_relaxed);
+}
+
+b3BlockCache::b3BlockCache(b3ConcurrentBlockAllocator* allocator)
+{
+	m_allocator = allocator;
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		m_lists[i].blocks = nullptr;
+		m_lists[i].count = 0;
+	}
+}
+
+b3BlockCache::~b3BlockCache()
+{
+	Flush();
+}
+
+void* b3BlockCache::Allocate(u32 size)
+{
+	if (size == 0)
+	{
+		return nullptr;
+	}
+
+	if (size > b3_maxBlockSize)
+	{
+		return m_allocator->Allocate(size);
+	}
+
+	u32 index = b3GetBlockSizeIndex(size);
+	b3BlockList* list = m_lists + index;
+
+	if (list->count == 0)
+	{
+		// Refill half of the cache so the following frees don't overflow it.
+		list->count = m_allocator->Acquire(index, &list->blocks, b3_blockCacheCapacity / 2);
+	}
+
+	b3ConcurrentBlock* block = list->blocks;
+	list->blocks = block->next;
+	--list->count;
+	return block;
+}
+
+void b3BlockCache::Free(void* p, u32 size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	if (size > b3_maxBlockSize)
+	{
+		m_allocator->Free(p, size);
+		return;
+	}
+
+	u32 index = b3GetBlockSizeIndex(size);
+	b3BlockList* list = m_lists + index;
+
+#ifdef B3_DEBUG
+	memset(p, 0xfd, b3_blockSizes[index]);
+#endif
+
+	b3ConcurrentBlock* block = (b3ConcurrentBlock*)p;
+	block->next = list->blocks;
+	list->blocks = block;
+	++list->count;
+
+	if (list->count > b3_blockCacheCapacity)
+	{
+		// Return half of the cache to the allocator.
+		u32 n = b3_blockCacheCapacity / 2;
+		
+		b3ConcurrentBlock* first = list->blocks;
+		b3ConcurrentBlock* last = first;
+		for (u32 i = 1; i < n; ++i)
+		{
+			last = last->next;
+		}
+
+		list->blocks = last->next;
+		list->count -= n;
+
+		m_allocator->Release(index, first, last, n);
+	}
+}
+
+void b3BlockCache::Flush()
+{
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		b3BlockList* list = m_lists + i;
+		if (list->count == 0)
+		{
+			continue;
+		}
+
+		b3ConcurrentBlock* last = list->blocks;
+		while (last->next)
+		{
+			last = last->next;
+		}
+
+		m_allocator->Release(i, list->blocks, last, list->count);
+
+		list->blocks = nullptr;
+		list->count = 0;
+	}
+}
@@ -17,14 +17,27 @@
 */
 
 #include <bounce/common/memory/stack_allocator.h>
+#include <bounce/common/math/math.h>
 #include <string.h>
 
-b3StackAllocator::b3StackAllocator() 
+static inline u32 b3RoundUpToPage(u32 size)
+{
+	return ((size + b3_stackPageSize - 1) / b3_stackPageSize) * b3_stackPageSize;
+}
+
+b3StackAllocator::b3StackAllocator(u32 size) 
 {
 	m_blockCapacity = 256;
 	m_blocks = (b3Block*)b3Alloc(m_blockCapacity * sizeof(b3Block));
 	m_blockCount = 0;
 	m_allocatedSize = 0;
+	m_capacity = b3RoundUpToPage(size);
+	m_memory = m_capacity > 0 ? (u8*)b3Alloc(m_capacity) : nullptr;
+	m_totalSize = 0;
+	m_maxTotalSize = 0;
+	m_allocationCount = 0;
+	m_parentAllocationCount = 0;
+	m_growCount = 0;
 }
 
 b3StackAllocator::~b3StackAllocator() 
@@ -32,6 +45,29 @@ b3StackAllocator::~b3StackAllocator()
 	B3_ASSERT(m_allocatedSize == 0);
 	B3_ASSERT(m_blockCount == 0);
 	b3Free(m_blocks);
+	if (m_memory)
+	{
+		b3Free(m_memory);
+	}
+}
+
+void b3StackAllocator::SetCapacity(u32 size)
+{
+	B3_ASSERT(m_blockCount == 0);
+	
+	size = b3RoundUpToPage(size);
+	if (size == m_capacity)
+	{
+		return;
+	}
+
+	if (m_memory)
+	{
+		b3Free(m_memory);
+	}
+
+	m_capacity = size;
+	m_memory = m_capacity > 0 ? (u8*)b3Alloc(m_capacity) : nullptr;
 }
 
 void* b3StackAllocator::Allocate(u32 size) 
@@ -48,11 +84,12 @@ void* b3StackAllocator::Allocate(u32 size)
 
 	b3Block* block = m_blocks + m_blockCount;
 	block->size = size;
-	if (m_allocatedSize + size > b3_maxStackSize) 
+	if (m_allocatedSize + size > m_capacity) 
 	{
 		// Allocate with parent allocator.
 		block->data = (u8*) b3Alloc(size);
 		block->parent = true;
+		++m_parentAllocationCount;
 	}
 	else 
 	{
@@ -63,6 +100,10 @@ void* b3StackAllocator::Allocate(u32 size)
 	}
 	
 	++m_blockCount;
+	++m_allocationCount;
+
+	m_totalSize += size;
+	m_maxTotalSize = b3Max(m_maxTotalSize, m_totalSize);
 
 	return block->data;
 }
@@ -80,5 +121,31 @@ void b3StackAllocator::Free(void* p)
 	{
 		m_allocatedSize -= block->size;
 	}
+	m_totalSize -= block->size;
 	--m_blockCount;
+
+	if (m_blockCount == 0 && m_maxTotalSize > m_capacity)
+	{
+		// Grow to the high-water mark so the next pass fits in the stack memory.
+		SetCapacity(m_maxTotalSize);
+		++m_growCount;
+	}
+}
+
+void b3StackAllocator::GetStats(b3StackAllocatorStats* stats) const
+{
+	stats->capacity = m_capacity;
+	stats->allocatedSize = m_totalSize;
+	stats->maxAllocatedSize = m_maxTotalSize;
+	stats->allocationCount = m_allocationCount;
+	stats->parentAllocationCount = m_parentAllocationCount;
+	stats->growCount = m_growCount;
+}
+
+void b3StackAllocator::ResetStats()
+{
+	m_maxTotalSize = m_totalSize;
+	m_allocationCount = 0;
+	m_parentAllocationCount = 0;
+	m_growCount = 0;
 }
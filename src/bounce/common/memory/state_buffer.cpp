@@ -0,0 +1,69 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/common/memory/state_buffer.h>
+#include <string.h>
+
+b3StateBuffer::b3StateBuffer()
+{
+	m_data = nullptr;
+	m_capacity = 0;
+	m_size = 0;
+	m_position = 0;
+}
+
+b3StateBuffer::~b3StateBuffer()
+{
+	b3Free(m_data);
+}
+
+void b3StateBuffer::Reserve(u32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	// Grow geometrically so a sequence of writes doesn't allocate each time.
+	u32 newCapacity = m_capacity > 0 ? 2 * m_capacity : 1024;
+	while (newCapacity < capacity)
+	{
+		newCapacity *= 2;
+	}
+
+	u8* oldData = m_data;
+	m_data = (u8*)b3Alloc(newCapacity);
+	if (oldData)
+	{
+		memcpy(m_data, oldData, m_size);
+		b3Free(oldData);
+	}
+	m_capacity = newCapacity;
+}
+
+void b3StateBuffer::Clear()
+{
+	m_size = 0;
+	m_position = 0;
+}
+
+void b3StateBuffer::SetData(const void* data, u32 size)
+{
+	Clear();
+	Write(data, size);
+}
@@ -23,15 +23,13 @@
 #include <stdarg.h>
 #include <stdlib.h>
 
-u32 b3_allocCalls = 0;
-u32 b3_maxAllocCalls = 0;
+thread_local u32 b3_allocCalls = 0;
 
-b3Version b3_version = { 0, 0, 0 };
+const b3Version b3_version = { 0, 0, 0 };
 
 void* b3Alloc_Default(u32 size) 
 {
 	++b3_allocCalls;
-	b3_maxAllocCalls = b3Max(b3_maxAllocCalls, b3_allocCalls);
 	return malloc(size);
 }
 
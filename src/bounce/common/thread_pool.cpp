@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/common/thread_pool.h>
+#include <bounce/common/math/math.h>
+#include <new>
+
+b3ThreadPool::b3ThreadPool(u32 threadCount)
+{
+	B3_ASSERT(threadCount > 0);
+	B3_ASSERT(threadCount <= b3_maxThreadCount);
+	
+	m_threadCount = threadCount;
+	m_loopId = 0;
+	m_busyCount = 0;
+	m_quit = false;
+	m_task = nullptr;
+	m_context = nullptr;
+	m_count = 0;
+	m_rangeSize = 0;
+	m_next = 0;
+
+	m_workers = (std::thread*)b3Alloc((m_threadCount - 1) * sizeof(std::thread));
+	for (u32 i = 1; i < m_threadCount; ++i)
+	{
+		new (m_workers + i - 1) std::thread(&b3ThreadPool::WorkerMain, this, i);
+	}
+}
+
+b3ThreadPool::~b3ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (u32 i = 1; i < m_threadCount; ++i)
+	{
+		m_workers[i - 1].join();
+		m_workers[i - 1].~thread();
+	}
+
+	b3Free(m_workers);
+}
+
+void b3ThreadPool::WorkerMain(u32 threadIndex)
+{
+	u32 loopId = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_quit == false && m_loopId == loopId)
+			{
+				m_wakeCondition.wait(lock);
+			}
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			loopId = m_loopId;
+		}
+
+		RunRanges(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_busyCount;
+			if (m_busyCount == 0)
+			{
+				m_doneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void b3ThreadPool::RunRanges(u32 threadIndex)
+{
+	for (;;)
+	{
+		u32 begin = m_next.fetch_add(m_rangeSize);
+		if (begin >= m_count)
+		{
+			break;
+		}
+
+		u32 end = b3Min(begin + m_rangeSize, m_count);
+		m_task(m_context, begin, end, threadIndex);
+	}
+}
+
+void b3ThreadPool::ParallelFor(u32 count, u32 rangeSize, b3TaskFcn* task, void* context)
+{
+	B3_ASSERT(rangeSize > 0);
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Don't wake the workers for a single range.
+	if (m_threadCount == 1 || count <= rangeSize)
+	{
+		task(context, 0, count, 0);
+		return;
+	}
+
+	m_task = task;
+	m_context = context;
+	m_count = count;
+	m_rangeSize = rangeSize;
+	m_next = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_busyCount = m_threadCount - 1;
+		++m_loopId;
+	}
+	m_wakeCondition.notify_all();
+
+	RunRanges(0);
+
+	// Wait for the workers to finish their last range.
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_busyCount > 0)
+	{
+		m_doneCondition.wait(lock);
+	}
+}
@@ -0,0 +1,1549 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/articulation.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/fixture.h>
+#include <bounce/dynamics/world_callbacks.h>
+#include <bounce/dynamics/time_step.h>
+#include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/contact_solver.h>
+#include <bounce/collision/shapes/shape.h>
+#include <bounce/common/memory/stack_allocator.h>
+#include <bounce/common/memory/state_buffer.h>
+#include <bounce/common/draw.h>
+#include <bounce/rope/spatial.h>
+
+// "Rigid Body Dynamics Algorithms", Featherstone
+// The link frames are located at the link centers of mass. 
+// Spatial quantities are expressed in the frame of their link.
+struct b3ArticulationLink
+{
+	// Shared
+	b3Body* body;
+	u32 parent;
+	b3ArticulationJointType type;
+	u32 dofCount;
+	
+	// Offset of the joint velocity in the articulation velocity vector.
+	u32 dofOffset;
+
+	// Mass and rotational inertia about the center of mass.
+	scalar mass;
+	b3Mat33 I;
+	
+	// Center of mass relative to the body origin.
+	b3Vec3 localCenter;
+	
+	// Joint frame relative to the parent link frame.
+	b3Transform parentFrame;
+	
+	// Joint frame relative to this link frame.
+	b3Transform childFrame;
+	
+	// Motion subspace of the joint.
+	b3MotionVec S[3];
+
+	bool enableLimit;
+	scalar lowerLimit;
+	scalar upperLimit;
+
+	// Accumulated impulses of the lower and upper limits.
+	scalar limitImpulse[2];
+
+	// Joint position and velocity.
+	scalar q;
+	b3Quat p;
+	b3Vec3 qd;
+
+	// Link frame in world coordinates.
+	b3Transform xf;
+
+	// Link velocity.
+	b3MotionVec v;
+
+	// Temp
+
+	// Parent to link spatial transform.
+	b3SpTransform X;
+
+	// Velocity-product acceleration.
+	b3MotionVec c;
+
+	// Velocities at the beginning of the step.
+	b3Vec3 qd0;
+	b3MotionVec v0;
+
+	// Articulated inertia and bias force.
+	b3SpInertia IA;
+	b3ForceVec FA;
+
+	// Articulated inertia transmitted to the parent link.
+	b3SpInertia Ia;
+
+	b3ForceVec U[3];
+	b3Mat33 invD;
+	b3Vec3 u;
+
+	// Link acceleration.
+	b3MotionVec a;
+
+	// Impulse response.
+	b3ForceVec dF;
+	b3Vec3 du;
+	b3MotionVec dv;
+};
+
+// Joint transform.
+static b3Transform b3JointTransform(const b3ArticulationLink* link)
+{
+	b3Transform X;
+	X.translation.SetZero();
+	X.rotation.SetIdentity();
+
+	switch (link->type)
+	{
+	case e_revoluteArticulationJoint:
+		X.rotation = b3QuatRotationX(link->q);
+		break;
+	case e_prismaticArticulationJoint:
+		X.translation.Set(link->q, scalar(0), scalar(0));
+		break;
+	case e_sphericalArticulationJoint:
+		X.rotation = link->p;
+		break;
+	default:
+		break;
+	}
+
+	return X;
+}
+
+// S * x
+static b3MotionVec b3MulS(const b3ArticulationLink* link, const b3Vec3& x)
+{
+	b3MotionVec result;
+	result.SetZero();
+	for (u32 i = 0; i < link->dofCount; ++i)
+	{
+		result += x[i] * link->S[i];
+	}
+	return result;
+}
+
+// D^-1 * (u - U^T * a)
+static b3Vec3 b3SolveD(const b3ArticulationLink* link, const b3Vec3& u, const b3MotionVec& a)
+{
+	b3Vec3 b;
+	b.SetZero();
+	for (u32 i = 0; i < link->dofCount; ++i)
+	{
+		b[i] = u[i] - b3Dot(a, link->U[i]);
+	}
+	return link->invD * b;
+}
+
+// U * D^-1 * u
+static b3ForceVec b3MulUD(const b3ArticulationLink* link, const b3Vec3& u)
+{
+	b3Vec3 x = link->invD * u;
+	
+	b3ForceVec result;
+	result.SetZero();
+	for (u32 i = 0; i < link->dofCount; ++i)
+	{
+		result += x[i] * link->U[i];
+	}
+	return result;
+}
+
+// Rotation from the x-axis to a unit axis.
+static b3Quat b3AxisRotation(const b3Vec3& axis)
+{
+	if (b3Dot(axis, b3Vec3_x) < scalar(-1) + B3_EPSILON)
+	{
+		return b3QuatRotationY(B3_PI);
+	}
+	return b3QuatRotationBetween(b3Vec3_x, axis);
+}
+
+void b3ArticulationLinkDef::Initialize(b3Body* _body, u32 _parent, b3ArticulationJointType _jointType, const b3Vec3& _anchor, const b3Vec3& _axis)
+{
+	body = _body;
+	parent = _parent;
+	jointType = _jointType;
+	anchor = _anchor;
+	axis = b3Normalize(_axis);
+}
+
+b3Articulation::b3Articulation(const b3ArticulationDef& def, b3World* world)
+{
+	B3_ASSERT(def.linkCount > 0);
+
+	m_world = world;
+	m_fixedBase = def.fixedBase;
+	m_linearDamping = def.linearDamping;
+	m_angularDamping = def.angularDamping;
+	m_linkCount = def.linkCount;
+	m_awake = true;
+	m_sleepTime = scalar(0);
+	
+	// The root velocity is followed by the joint velocities.
+	m_dofCount = 6;
+	m_links = (b3ArticulationLink*)b3Alloc(m_linkCount * sizeof(b3ArticulationLink));
+
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		const b3ArticulationLinkDef* ld = def.links + i;
+		b3ArticulationLink* link = m_links + i;
+		b3Body* body = ld->body;
+
+		B3_ASSERT(body != nullptr);
+		B3_ASSERT(body->m_articulation == nullptr);
+		B3_ASSERT(body->m_jointEdges.m_count == 0);
+		B3_ASSERT(i == 0 ? ld->parent == B3_MAX_U32 : ld->parent < i);
+
+		link->body = body;
+		link->parent = ld->parent;
+		link->type = i == 0 ? e_fixedArticulationJoint : ld->jointType;
+		link->enableLimit = ld->enableLimit;
+		link->lowerLimit = ld->lowerLimit;
+		link->upperLimit = ld->upperLimit;
+		link->limitImpulse[0] = scalar(0);
+		link->limitImpulse[1] = scalar(0);
+		link->q = scalar(0);
+		link->p.SetIdentity();
+		link->qd.SetZero();
+		link->dF.SetZero();
+		link->du.SetZero();
+
+		switch (link->type)
+		{
+		case e_revoluteArticulationJoint:
+		case e_prismaticArticulationJoint:
+			link->dofCount = 1;
+			break;
+		case e_sphericalArticulationJoint:
+			link->dofCount = 3;
+			break;
+		default:
+			link->dofCount = 0;
+			break;
+		}
+
+		link->dofOffset = m_dofCount;
+		m_dofCount += link->dofCount;
+
+		// Accumulate the mass about the body origin of all fixtures.
+		link->mass = scalar(0);
+		link->I.SetZero();
+		link->localCenter.SetZero();
+		for (b3Fixture* f = body->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			if (f->m_density == scalar(0))
+			{
+				continue;
+			}
+
+			b3MassData massData;
+			f->ComputeMass(&massData);
+
+			link->localCenter += massData.mass * massData.center;
+			link->mass += massData.mass;
+			link->I += massData.I;
+		}
+
+		if (link->mass > scalar(0))
+		{
+			// Shift inertia about the body origin into the center of mass.
+			link->localCenter /= link->mass;
+			link->I = link->I - link->mass * b3Steiner(link->localCenter);
+		}
+		else
+		{
+			// Force all links to have positive mass.
+			link->mass = scalar(1);
+			link->I = b3Mat33Diagonal(scalar(1));
+		}
+
+		link->xf.rotation = body->GetOrientation();
+		link->xf.translation = body->GetWorldPoint(link->localCenter);
+
+		if (i == 0)
+		{
+			link->v.SetZero();
+			if (m_fixedBase == false)
+			{
+				// Keep the velocity of the root body.
+				b3Vec3 v = body->GetPointVelocity(link->xf.translation);
+				b3Vec3 w = body->GetAngularVelocity();
+				link->v.v = b3MulC(link->xf.rotation, v);
+				link->v.w = b3MulC(link->xf.rotation, w);
+			}
+		}
+		else
+		{
+			const b3ArticulationLink* parent = m_links + link->parent;
+
+			b3Transform jointFrame;
+			jointFrame.rotation = b3AxisRotation(ld->axis);
+			jointFrame.translation = ld->anchor;
+
+			link->parentFrame = b3MulT(parent->xf, jointFrame);
+			link->childFrame = b3MulT(link->xf, jointFrame);
+
+			// The motion subspace is constant in the link frame.
+			b3Mat33 R = link->childFrame.rotation.GetRotationMatrix();
+			b3Vec3 r = link->childFrame.translation;
+
+			if (link->type == e_prismaticArticulationJoint)
+			{
+				link->S[0].w.SetZero();
+				link->S[0].v = R.x;
+			}
+			else
+			{
+				for (u32 j = 0; j < link->dofCount; ++j)
+				{
+					link->S[j].w = R[j];
+					link->S[j].v = b3Cross(r, R[j]);
+				}
+			}
+		}
+
+		body->SetType(e_kinematicBody);
+		body->m_articulation = this;
+	}
+
+	ComputeTransforms();
+	ComputeVelocities();
+	SynchronizeBodies();
+}
+
+b3Articulation::~b3Articulation()
+{
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		m_links[i].body->m_articulation = nullptr;
+	}
+
+	b3Free(m_links);
+}
+
+b3Body* b3Articulation::GetLinkBody(u32 index) const
+{
+	B3_ASSERT(index < m_linkCount);
+	return m_links[index].body;
+}
+
+u32 b3Articulation::GetLinkParent(u32 index) const
+{
+	B3_ASSERT(index < m_linkCount);
+	return m_links[index].parent;
+}
+
+b3ArticulationJointType b3Articulation::GetJointType(u32 index) const
+{
+	B3_ASSERT(index < m_linkCount);
+	return m_links[index].type;
+}
+
+scalar b3Articulation::GetJointPosition(u32 index) const
+{
+	B3_ASSERT(index < m_linkCount);
+	B3_ASSERT(m_links[index].dofCount == 1);
+	return m_links[index].q;
+}
+
+scalar b3Articulation::GetJointSpeed(u32 index) const
+{
+	B3_ASSERT(index < m_linkCount);
+	B3_ASSERT(m_links[index].dofCount == 1);
+	return m_links[index].qd.x;
+}
+
+void b3Articulation::SetJointSpeed(u32 index, scalar speed)
+{
+	B3_ASSERT(index < m_linkCount);
+	B3_ASSERT(m_links[index].dofCount == 1);
+	SetAwake(true);
+	m_links[index].qd.x = speed;
+	ComputeVelocities();
+	SynchronizeBodies();
+}
+
+b3Vec3 b3Articulation::GetLinearVelocity() const
+{
+	return b3Mul(m_links->xf.rotation, m_links->v.v);
+}
+
+void b3Articulation::SetLinearVelocity(const b3Vec3& linearVelocity)
+{
+	if (m_fixedBase)
+	{
+		return;
+	}
+
+	SetAwake(true);
+	m_links->v.v = b3MulC(m_links->xf.rotation, linearVelocity);
+	ComputeVelocities();
+	SynchronizeBodies();
+}
+
+b3Vec3 b3Articulation::GetAngularVelocity() const
+{
+	return b3Mul(m_links->xf.rotation, m_links->v.w);
+}
+
+void b3Articulation::SetAngularVelocity(const b3Vec3& angularVelocity)
+{
+	if (m_fixedBase)
+	{
+		return;
+	}
+
+	SetAwake(true);
+	m_links->v.w = b3MulC(m_links->xf.rotation, angularVelocity);
+	ComputeVelocities();
+	SynchronizeBodies();
+}
+
+void b3Articulation::SetAwake(bool flag)
+{
+	if (flag)
+	{
+		if (m_awake == false)
+		{
+			m_awake = true;
+			m_sleepTime = scalar(0);
+			
+			for (u32 i = 0; i < m_linkCount; ++i)
+			{
+				m_links[i].body->SetAwake(true);
+			}
+		}
+	}
+	else
+	{
+		m_awake = false;
+		m_sleepTime = scalar(0);
+
+		for (u32 i = 0; i < m_linkCount; ++i)
+		{
+			b3ArticulationLink* link = m_links + i;
+			link->qd.SetZero();
+			link->v.SetZero();
+			link->body->SetAwake(false);
+		}
+	}
+}
+
+bool b3Articulation::ShouldWakeUp() const
+{
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		const b3ArticulationLink* link = m_links + i;
+		if (link->body->IsAwake())
+		{
+			// The link body was woken up, e.g. by the user.
+			return true;
+		}
+
+		for (b3Fixture* f = link->body->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			const b3ContactEdge* edges = f->m_contactEdges.Begin();
+			u32 edgeCount = f->m_contactEdges.Count();
+			for (u32 k = 0; k < edgeCount; ++k)
+			{
+				b3Contact* c = edges[k].contact;
+				if (c->IsOverlapping() == false || c->IsSensorContact())
+				{
+					continue;
+				}
+
+				b3Body* other = edges[k].other->m_body;
+				if (other->m_type == e_staticBody || other->IsAwake() == false)
+				{
+					continue;
+				}
+
+				if (other->m_sleepTime < B3_TIME_TO_SLEEP)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+void b3Articulation::UpdateSleep(scalar h)
+{
+	bool resting = true;
+	for (u32 i = 0; i < m_linkCount && resting; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3Body* body = link->body;
+
+		// The link velocity is the velocity of the center of mass in the link frame.
+		scalar sqrLinVel = b3Dot(link->v.v, link->v.v);
+		scalar sqrAngVel = b3Dot(link->v.w, link->v.w);
+
+		if (body->IsSleepingAllowed() == false ||
+			sqrLinVel > body->m_linearSleepTolerance * body->m_linearSleepTolerance ||
+			sqrAngVel > body->m_angularSleepTolerance * body->m_angularSleepTolerance)
+		{
+			resting = false;
+		}
+	}
+
+	if (resting)
+	{
+		m_sleepTime += h;
+	}
+	else
+	{
+		m_sleepTime = scalar(0);
+	}
+
+	// The link bodies report the sleep time to the bodies and articulations they touch.
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		m_links[i].body->m_sleepTime = m_sleepTime;
+	}
+
+	if (m_sleepTime < B3_TIME_TO_SLEEP)
+	{
+		return;
+	}
+
+	// Wait for the movable bodies touching the links to fall asleep. 
+	// They sleep with their islands.
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		for (b3Fixture* f = m_links[i].body->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			const b3ContactEdge* edges = f->m_contactEdges.Begin();
+			u32 edgeCount = f->m_contactEdges.Count();
+			for (u32 k = 0; k < edgeCount; ++k)
+			{
+				b3Contact* c = edges[k].contact;
+				b3Body* other = edges[k].other->m_body;
+				
+				if (c->IsOverlapping() && other->m_type == e_dynamicBody && 
+					other->m_articulation == nullptr && other->IsAwake())
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	SetAwake(false);
+}
+
+void b3Articulation::ComputeTransforms()
+{
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		const b3ArticulationLink* parent = m_links + link->parent;
+
+		// Link frame relative to the parent link frame.
+		b3Transform X = link->parentFrame * b3JointTransform(link) * b3Inverse(link->childFrame);
+
+		link->xf = parent->xf * X;
+
+		// r is the vector from the parent link origin to this link origin in this link frame.
+		b3Transform invX = b3Inverse(X);
+		link->X.E = invX.rotation.GetRotationMatrix();
+		link->X.r = -invX.translation;
+	}
+}
+
+void b3Articulation::ComputeVelocities()
+{
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		const b3ArticulationLink* parent = m_links + link->parent;
+
+		link->v = b3Mul(link->X, parent->v) + b3MulS(link, link->qd);
+	}
+}
+
+void b3Articulation::SynchronizeBodies()
+{
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3Body* body = link->body;
+
+		b3Quat q = link->xf.rotation;
+		b3Vec3 x = link->xf.translation - b3Mul(q, link->localCenter);
+
+		// Kinematic bodies have the center of mass at the origin.
+		b3Sweep& sweep = body->Sweep();
+		sweep.worldCenter0 = sweep.worldCenter;
+		sweep.orientation0 = sweep.orientation;
+		sweep.worldCenter = x;
+		sweep.orientation = q;
+		body->SynchronizeTransform();
+
+		b3Vec3 v = b3Mul(q, link->v.v);
+		b3Vec3 w = b3Mul(q, link->v.w);
+
+		body->LinearVelocity() = v + b3Cross(w, x - link->xf.translation);
+		body->AngularVelocity() = w;
+
+		// The link bodies don't join islands but their fixtures are synchronized with them.
+		body->m_flags |= b3Body::e_awakeFlag | b3Body::e_islandFlag;
+	}
+}
+
+void b3Articulation::ComputeJacobian(u32 index, const b3Vec3& linearImpulse, const b3Vec3& angularImpulse, scalar* J) const
+{
+	B3_ASSERT(index < m_linkCount);
+
+	for (u32 i = 0; i < m_dofCount; ++i)
+	{
+		J[i] = scalar(0);
+	}
+
+	const b3ArticulationLink* link = m_links + index;
+
+	b3ForceVec F;
+	F.n = b3MulC(link->xf.rotation, linearImpulse);
+	F.f = b3MulC(link->xf.rotation, angularImpulse);
+
+	// The power of the impulse is the dot product of the Jacobian and the joint velocities.
+	for (u32 i = index; i != 0; i = m_links[i].parent)
+	{
+		const b3ArticulationLink* L = m_links + i;
+		
+		for (u32 j = 0; j < L->dofCount; ++j)
+		{
+			J[L->dofOffset + j] = b3Dot(L->S[j], F);
+		}
+
+		F = b3MulT(L->X, F);
+	}
+
+	if (m_fixedBase == false)
+	{
+		J[0] = F.f.x;
+		J[1] = F.f.y;
+		J[2] = F.f.z;
+		J[3] = F.n.x;
+		J[4] = F.n.y;
+		J[5] = F.n.z;
+	}
+}
+
+void b3Articulation::ComputeResponse(const scalar* impulse, scalar* response)
+{
+	// Propagate the joint impulses up to the root.
+	for (u32 i = m_linkCount - 1; i > 0; --i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		
+		b3Vec3 du;
+		du.SetZero();
+		for (u32 j = 0; j < link->dofCount; ++j)
+		{
+			du[j] = impulse[link->dofOffset + j] - b3Dot(link->S[j], link->dF);
+		}
+		link->du = du;
+
+		b3ForceVec Fa = link->dF + b3MulUD(link, du);
+
+		m_links[link->parent].dF += b3MulT(link->X, Fa);
+	}
+
+	b3ArticulationLink* root = m_links;
+	if (m_fixedBase)
+	{
+		root->dv.SetZero();
+	}
+	else
+	{
+		b3ForceVec F;
+		F.f.Set(impulse[0], impulse[1], impulse[2]);
+		F.n.Set(impulse[3], impulse[4], impulse[5]);
+		
+		root->dv = root->IA.Solve(F - root->dF);
+	}
+	root->dF.SetZero();
+
+	response[0] = root->dv.w.x;
+	response[1] = root->dv.w.y;
+	response[2] = root->dv.w.z;
+	response[3] = root->dv.v.x;
+	response[4] = root->dv.v.y;
+	response[5] = root->dv.v.z;
+
+	// Propagate the velocity changes down.
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3MotionVec a = b3Mul(link->X, m_links[link->parent].dv);
+		b3Vec3 dqd = b3SolveD(link, link->du, a);
+		link->dv = a + b3MulS(link, dqd);
+		link->dF.SetZero();
+
+		for (u32 j = 0; j < link->dofCount; ++j)
+		{
+			response[link->dofOffset + j] = dqd[j];
+		}
+	}
+}
+
+// A joint limit or contact constraint row of an articulation. 
+// The rows act on the joint velocities of the articulation and on the velocity of 
+// a movable body. The velocity change of the articulation due to a unit impulse 
+// is computed once so each iteration is a dot product and an update of the joint velocities.
+struct b3ArticulationRow
+{
+	scalar* J;
+	scalar* response;
+	
+	// Movable body.
+	b3Body* body;
+	b3Vec3 linearB;
+	b3Vec3 angularB;
+
+	// Velocity of an immovable body or gravity of a movable body in this step.
+	scalar velocityB;
+
+	// Normal rows of a friction row. 
+	// The normal rows of the points of a manifold are three rows apart.
+	u32 normalIndex;
+	u32 normalCount;
+	scalar friction;
+
+	scalar mass;
+	scalar bias;
+	scalar lower;
+	scalar upper;
+	scalar impulse;
+
+	// Where the impulse is accumulated for warm starting the next step, if anywhere.
+	scalar* storedImpulse;
+};
+
+static scalar b3DotN(const scalar* a, const scalar* b, u32 n)
+{
+	scalar result = scalar(0);
+	for (u32 i = 0; i < n; ++i)
+	{
+		result += a[i] * b[i];
+	}
+	return result;
+}
+
+void b3Articulation::Step(const b3Vec3& gravity, scalar h, u32 velocityIterations, bool warmStart, bool sleep, 
+	b3StackAllocator* allocator, b3ContactFilter* filter)
+{
+	if (m_awake == false)
+	{
+		if (sleep && ShouldWakeUp() == false)
+		{
+			return;
+		}
+
+		SetAwake(true);
+	}
+
+	if (sleep == false)
+	{
+		m_sleepTime = scalar(0);
+	}
+
+	ComputeVelocities();
+
+	// The articulated inertias don't depend on the velocities.
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		link->IA.SetLocalInertia(link->mass, link->I);
+	}
+
+	// Propagate up articulated inertias.
+	for (u32 i = m_linkCount - 1; i > 0; --i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3ArticulationLink* parent = m_links + link->parent;
+		u32 n = link->dofCount;
+
+		link->Ia = link->IA;
+		link->invD.SetZero();
+
+		if (n > 0)
+		{
+			b3Mat33 D;
+			D.SetIdentity();
+			for (u32 j = 0; j < n; ++j)
+			{
+				link->U[j] = link->IA * link->S[j];
+			}
+
+			for (u32 j = 0; j < n; ++j)
+			{
+				for (u32 k = 0; k < n; ++k)
+				{
+					D[j][k] = b3Dot(link->S[k], link->U[j]);
+				}
+			}
+
+			if (n == 1)
+			{
+				link->invD.x.x = D.x.x > scalar(0) ? scalar(1) / D.x.x : scalar(0);
+			}
+			else
+			{
+				link->invD = b3SymInverse(D);
+			}
+
+			// I_a = I_A - U * D^-1 * U^T
+			for (u32 j = 0; j < n; ++j)
+			{
+				b3ForceVec UD;
+				UD.SetZero();
+				for (u32 k = 0; k < n; ++k)
+				{
+					UD += link->invD[j][k] * link->U[k];
+				}
+
+				link->Ia -= b3Outer(link->U[j], UD);
+			}
+		}
+
+		parent->IA += b3MulT(link->X, link->Ia);
+	}
+
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		link->qd0 = link->qd;
+		link->v0 = link->v;
+	}
+
+	// Explicit velocity-product forces add energy at every step, 
+	// which makes fast spinning chains blow up. 
+	// Predict the velocities, then integrate again using the 
+	// velocity-product forces at the middle of the step.
+	IntegrateVelocities(gravity, h);
+
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		link->qd = scalar(0.5) * (link->qd0 + link->qd);
+	}
+	
+	b3ArticulationLink* root = m_links;
+	root->v = scalar(0.5) * (root->v0 + root->v);
+	
+	ComputeVelocities();
+	
+	IntegrateVelocities(gravity, h);
+
+	// Count the constraint rows.
+	u32 rowCapacity = 0;
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		if (link->enableLimit)
+		{
+			rowCapacity += 2;
+		}
+
+		for (b3Fixture* f = link->body->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			const b3ContactEdge* edges = f->m_contactEdges.Begin();
+			u32 edgeCount = f->m_contactEdges.Count();
+			for (u32 k = 0; k < edgeCount; ++k)
+			{
+				b3Contact* c = edges[k].contact;
+				for (u32 m = 0; m < c->m_manifoldCount; ++m)
+				{
+					rowCapacity += 3 * c->m_manifolds[m].pointCount + 1;
+				}
+			}
+		}
+	}
+
+	if (rowCapacity > 0)
+	{
+		SolveConstraints(gravity, h, velocityIterations, warmStart, rowCapacity, allocator, filter);
+	}
+
+	ComputeVelocities();
+
+	// Integrate the root velocity.
+	if (m_fixedBase == false)
+	{
+		b3Vec3 v = b3Mul(root->xf.rotation, root->v.v);
+		b3Vec3 w = b3Mul(root->xf.rotation, root->v.w);
+
+		root->xf.translation += h * v;
+		root->xf.rotation = b3Integrate(root->xf.rotation, w, h);
+
+		// Keep the world velocity in the new root frame.
+		root->v.v = b3MulC(root->xf.rotation, v);
+		root->v.w = b3MulC(root->xf.rotation, w);
+	}
+
+	// Integrate the joint velocities.
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		if (link->type == e_sphericalArticulationJoint)
+		{
+			// The joint velocity is the angular velocity in the joint frame of this link.
+			link->p = b3Integrate(link->p, b3Mul(link->p, link->qd), h);
+		}
+		else if (link->dofCount == 1)
+		{
+			link->q += h * link->qd.x;
+		}
+	}
+
+	ComputeTransforms();
+	ComputeVelocities();
+	SynchronizeBodies();
+
+	if (sleep)
+	{
+		UpdateSleep(h);
+	}
+}
+
+void b3Articulation::IntegrateVelocities(const b3Vec3& gravity, scalar h)
+{
+	// Propagate down velocity products and bias forces.
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3MotionVec vJ = b3MulS(link, link->qd);
+
+		// v x vJ
+		link->c = b3Cross(link->v, vJ);
+
+		b3Vec3 w = link->v.w;
+		b3Vec3 v = link->v.v;
+
+		// v x* I * v
+		b3ForceVec Pdot;
+		Pdot.n = b3Cross(w, link->mass * v);
+		Pdot.f = b3Cross(w, link->I * w);
+
+		// External forces in the link frame.
+		b3ForceVec F;
+		F.n = link->mass * b3MulC(link->xf.rotation, gravity) - m_linearDamping * link->mass * v;
+		F.f = -m_angularDamping * (link->I * w);
+
+		link->FA = Pdot - F;
+	}
+
+	// Propagate up bias forces.
+	for (u32 i = m_linkCount - 1; i > 0; --i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3ArticulationLink* parent = m_links + link->parent;
+
+		link->u.SetZero();
+		for (u32 j = 0; j < link->dofCount; ++j)
+		{
+			link->u[j] = -b3Dot(link->S[j], link->FA);
+		}
+
+		// F_a = F_A + I_a * c + U * D^-1 * u
+		b3ForceVec Fa = link->FA + link->Ia * link->c + b3MulUD(link, link->u);
+
+		parent->FA += b3MulT(link->X, Fa);
+	}
+
+	// Propagate down accelerations.
+	b3ArticulationLink* root = m_links;
+	if (m_fixedBase)
+	{
+		root->a.SetZero();
+	}
+	else
+	{
+		root->a = root->IA.Solve(-root->FA);
+	}
+
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		b3MotionVec a = b3Mul(link->X, m_links[link->parent].a) + link->c;
+		b3Vec3 qdd = b3SolveD(link, link->u, a);
+		link->a = a + b3MulS(link, qdd);
+
+		// Integrate the joint acceleration.
+		link->qd = link->qd0 + h * qdd;
+	}
+
+	// Integrate the root acceleration. 
+	// The root velocity is expressed in the rotating root frame. Integrate the 
+	// acceleration of the center of mass, which is not the spatial acceleration, 
+	// or a free body spinning off its center of mass would gain energy.
+	if (m_fixedBase == false)
+	{
+		root->v.v = root->v0.v + h * (root->a.v + b3Cross(root->v.w, root->v.v));
+		root->v.w = root->v0.w + h * root->a.w;
+	}
+}
+
+void b3Articulation::SolveConstraints(const b3Vec3& gravity, scalar h, u32 velocityIterations, bool warmStart, u32 rowCapacity, 
+	b3StackAllocator* allocator, b3ContactFilter* filter)
+{
+	scalar inv_h = scalar(1) / h;
+	u32 n = m_dofCount;
+
+	// An articulation that was at rest in the last steps doesn't wake up the bodies 
+	// it touches, so they can fall asleep. The sleeping ones act as immovable bodies.
+	bool moving = m_sleepTime < B3_TIME_TO_SLEEP;
+
+	b3ArticulationRow* rows = (b3ArticulationRow*)allocator->Allocate(rowCapacity * sizeof(b3ArticulationRow));
+	scalar* Js = (scalar*)allocator->Allocate(rowCapacity * n * sizeof(scalar));
+	scalar* responses = (scalar*)allocator->Allocate(rowCapacity * n * sizeof(scalar));
+	u32 rowCount = 0;
+
+	// Joint limits.
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		if (link->enableLimit == false)
+		{
+			continue;
+		}
+
+		B3_ASSERT(link->dofCount == 1);
+
+		scalar slop = link->type == e_revoluteArticulationJoint ? B3_ANGULAR_SLOP : B3_LINEAR_SLOP;
+		
+		// Skip a limit that can't be reached in this step.
+		scalar reach = h * b3Abs(link->qd.x) + slop;
+
+		// A limit that is not reached lets the joint approach it in this step.
+		for (u32 j = 0; j < 2; ++j)
+		{
+			scalar sign = j == 0 ? scalar(1) : scalar(-1);
+			scalar C = j == 0 ? link->q - link->lowerLimit : link->upperLimit - link->q;
+			if (C > reach)
+			{
+				link->limitImpulse[j] = scalar(0);
+				continue;
+			}
+
+			b3ArticulationRow* row = rows + rowCount;
+			row->J = Js + rowCount * n;
+			row->response = responses + rowCount * n;
+			++rowCount;
+
+			for (u32 k = 0; k < n; ++k)
+			{
+				row->J[k] = scalar(0);
+			}
+			row->J[link->dofOffset] = sign;
+
+			row->body = nullptr;
+			row->velocityB = scalar(0);
+			row->normalIndex = B3_MAX_U32;
+			row->normalCount = 0;
+			row->friction = scalar(0);
+			row->mass = scalar(0);
+			row->lower = scalar(0);
+			row->upper = B3_MAX_SCALAR;
+			row->impulse = warmStart ? link->limitImpulse[j] : scalar(0);
+			row->storedImpulse = link->limitImpulse + j;
+			
+			if (C > scalar(0))
+			{
+				row->bias = -C * inv_h;
+			}
+			else
+			{
+				row->bias = -B3_BAUMGARTE * inv_h * b3Min(C + slop, scalar(0));
+			}
+		}
+	}
+
+	// Contacts.
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+
+		for (b3Fixture* f = link->body->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			const b3ContactEdge* edges = f->m_contactEdges.Begin();
+			u32 edgeCount = f->m_contactEdges.Count();
+			for (u32 k = 0; k < edgeCount; ++k)
+			{
+				b3Contact* c = edges[k].contact;
+				b3Fixture* other = edges[k].other;
+				b3Body* otherBody = other->m_body;
+
+				if (c->IsOverlapping() == false || c->IsSensorContact())
+				{
+					continue;
+				}
+
+				if (filter && filter->ShouldRespond(c->GetFixtureA(), c->GetFixtureB()) == false)
+				{
+					continue;
+				}
+
+				bool movable = otherBody->m_type == e_dynamicBody && otherBody->m_articulation == nullptr;
+				if (movable)
+				{
+					if (moving)
+					{
+						otherBody->SetAwake(true);
+					}
+					else
+					{
+						movable = otherBody->IsAwake();
+					}
+				}
+
+				// Contacts between articulations are solved by both, so they aren't warm started.
+				bool cached = otherBody->m_articulation == nullptr;
+
+				scalar friction = b3MixFriction(f->m_friction, other->m_friction);
+				bool linkIsA = c->GetFixtureA() == f;
+
+				for (u32 m = 0; m < c->m_manifoldCount; ++m)
+				{
+					b3Manifold* manifold = c->m_manifolds + m;
+
+					b3WorldManifold wm;
+					c->GetWorldManifold(&wm, m);
+
+					// The normal points from A to B.
+					b3Vec3 normal = linkIsA ? -wm.normal : wm.normal;
+
+					u32 manifoldIndex = rowCount;
+
+					for (u32 p = 0; p < wm.pointCount; ++p)
+					{
+						const b3WorldManifoldPoint* wp = wm.points + p;
+						b3ManifoldPoint* mp = manifold->points + p;
+
+						b3Vec3 rA = wp->point - link->xf.translation;
+						b3Vec3 rB = wp->point - otherBody->Sweep().worldCenter;
+
+						b3Vec3 vB;
+						if (movable)
+						{
+							// The island adds the gravity to the body velocity after the articulations are solved.
+							b3Vec3 g = otherBody->m_gravityScale;
+							vB.Set(g.x * gravity.x, g.y * gravity.y, g.z * gravity.z);
+							vB *= h;
+						}
+						else
+						{
+							vB = otherBody->GetPointVelocity(wp->point);
+						}
+
+						scalar s = wp->separation;
+						scalar bias;
+						if (s > scalar(0))
+						{
+							bias = -s * inv_h;
+						}
+						else
+						{
+							bias = -B3_BAUMGARTE * inv_h * b3Min(s + B3_LINEAR_SLOP, scalar(0));
+						}
+
+						u32 normalIndex = rowCount;
+
+						// Normal and tangents.
+						b3Vec3 axes[3] = { normal, wm.tangent1, wm.tangent2 };
+						for (u32 j = 0; j < 3; ++j)
+						{
+							b3Vec3 d = axes[j];
+							b3Vec3 rAd = b3Cross(rA, d);
+
+							b3ArticulationRow* row = rows + rowCount;
+							row->J = Js + rowCount * n;
+							row->response = responses + rowCount * n;
+							++rowCount;
+
+							ComputeJacobian(i, d, rAd, row->J);
+
+							// The body part of the effective mass.
+							row->mass = scalar(0);
+							if (movable)
+							{
+								row->body = otherBody;
+								row->linearB = d;
+								row->angularB = b3Cross(rB, d);
+								row->mass = otherBody->InvMass() + b3Dot(otherBody->WorldInvInertia() * row->angularB, row->angularB);
+							}
+							else
+							{
+								row->body = nullptr;
+							}
+
+							row->velocityB = b3Dot(vB, d);
+
+							// The friction impulses are kept per manifold and shared by its points.
+							if (j == 0)
+							{
+								row->storedImpulse = &mp->normalImpulse;
+							}
+							else
+							{
+								row->storedImpulse = j == 1 ? &manifold->tangentImpulse.x : &manifold->tangentImpulse.y;
+							}
+
+							row->impulse = scalar(0);
+							if (cached == false)
+							{
+								row->storedImpulse = nullptr;
+							}
+							else if (warmStart)
+							{
+								row->impulse = j == 0 ? *row->storedImpulse : *row->storedImpulse / scalar(wm.pointCount);
+							}
+
+							if (j == 0)
+							{
+								row->normalIndex = B3_MAX_U32;
+								row->normalCount = 0;
+								row->friction = scalar(0);
+								row->bias = bias;
+								row->lower = scalar(0);
+								row->upper = B3_MAX_SCALAR;
+							}
+							else
+							{
+								row->normalIndex = normalIndex;
+								row->normalCount = 1;
+								row->friction = friction;
+								row->bias = scalar(0);
+								row->lower = scalar(0);
+								row->upper = scalar(0);
+							}
+						}
+					}
+
+					if (wm.pointCount > 0)
+					{
+						// Spin friction about the normal, bounded by the normal impulses of the manifold 
+						// as in the contact solver. Without it a link rolling on a pivot never stops.
+						b3ArticulationRow* row = rows + rowCount;
+						row->J = Js + rowCount * n;
+						row->response = responses + rowCount * n;
+						++rowCount;
+
+						ComputeJacobian(i, b3Vec3_zero, normal, row->J);
+
+						row->mass = scalar(0);
+						if (movable)
+						{
+							row->body = otherBody;
+							row->linearB.SetZero();
+							row->angularB = normal;
+							row->mass = b3Dot(otherBody->WorldInvInertia() * normal, normal);
+							row->velocityB = scalar(0);
+						}
+						else
+						{
+							row->body = nullptr;
+							row->velocityB = b3Dot(otherBody->GetAngularVelocity(), normal);
+						}
+
+						row->normalIndex = manifoldIndex;
+						row->normalCount = wm.pointCount;
+						row->friction = friction;
+						row->bias = scalar(0);
+						row->lower = scalar(0);
+						row->upper = scalar(0);
+						row->impulse = scalar(0);
+						row->storedImpulse = cached ? &manifold->motorImpulse : nullptr;
+						
+						if (cached && warmStart)
+						{
+							row->impulse = manifold->motorImpulse;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Compute the responses of the articulation to the row impulses, M^-1 * J^T.
+	// Each response costs a pass over the links. If there are more rows than 
+	// velocities then compute the inverse mass matrix and multiply it by the Jacobians.
+	if (rowCount > n)
+	{
+		scalar* invM = (scalar*)allocator->Allocate(n * n * sizeof(scalar));
+		scalar* e = (scalar*)allocator->Allocate(n * sizeof(scalar));
+		
+		for (u32 i = 0; i < n; ++i)
+		{
+			e[i] = scalar(0);
+		}
+
+		for (u32 i = 0; i < n; ++i)
+		{
+			e[i] = scalar(1);
+			ComputeResponse(e, invM + i * n);
+			e[i] = scalar(0);
+		}
+
+		for (u32 i = 0; i < rowCount; ++i)
+		{
+			b3ArticulationRow* row = rows + i;
+			
+			for (u32 k = 0; k < n; ++k)
+			{
+				row->response[k] = scalar(0);
+			}
+
+			for (u32 j = 0; j < n; ++j)
+			{
+				scalar Jj = row->J[j];
+				if (Jj == scalar(0))
+				{
+					continue;
+				}
+
+				const scalar* column = invM + j * n;
+				for (u32 k = 0; k < n; ++k)
+				{
+					row->response[k] += Jj * column[k];
+				}
+			}
+		}
+
+		allocator->Free(e);
+		allocator->Free(invM);
+	}
+	else
+	{
+		for (u32 i = 0; i < rowCount; ++i)
+		{
+			b3ArticulationRow* row = rows + i;
+			ComputeResponse(row->J, row->response);
+		}
+	}
+
+	for (u32 i = 0; i < rowCount; ++i)
+	{
+		b3ArticulationRow* row = rows + i;
+		scalar K = row->mass + b3DotN(row->J, row->response, n);
+		row->mass = K > scalar(0) ? scalar(1) / K : scalar(0);
+	}
+
+	// Gather the joint velocities.
+	scalar* qd = (scalar*)allocator->Allocate(n * sizeof(scalar));
+	
+	b3ArticulationLink* root = m_links;
+	qd[0] = root->v.w.x;
+	qd[1] = root->v.w.y;
+	qd[2] = root->v.w.z;
+	qd[3] = root->v.v.x;
+	qd[4] = root->v.v.y;
+	qd[5] = root->v.v.z;
+	
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		for (u32 j = 0; j < link->dofCount; ++j)
+		{
+			qd[link->dofOffset + j] = link->qd[j];
+		}
+	}
+
+	// Warm start.
+	if (warmStart)
+	{
+		for (u32 i = 0; i < rowCount; ++i)
+		{
+			b3ArticulationRow* row = rows + i;
+			scalar impulse = row->impulse;
+			if (impulse == scalar(0))
+			{
+				continue;
+			}
+
+			for (u32 k = 0; k < n; ++k)
+			{
+				qd[k] += impulse * row->response[k];
+			}
+
+			b3Body* body = row->body;
+			if (body)
+			{
+				body->LinearVelocity() -= impulse * body->InvMass() * row->linearB;
+				body->AngularVelocity() -= impulse * (body->WorldInvInertia() * row->angularB);
+			}
+		}
+	}
+
+	// Sequential impulses.
+	u32 iterations = b3Max(velocityIterations, u32(1));
+	for (u32 iteration = 0; iteration < iterations; ++iteration)
+	{
+		for (u32 i = 0; i < rowCount; ++i)
+		{
+			b3ArticulationRow* row = rows + i;
+			b3Body* body = row->body;
+
+			scalar Cdot = b3DotN(row->J, qd, n) - row->velocityB;
+			if (body)
+			{
+				Cdot -= b3Dot(row->linearB, body->LinearVelocity()) + b3Dot(row->angularB, body->AngularVelocity());
+			}
+
+			if (row->normalIndex != B3_MAX_U32)
+			{
+				scalar normalImpulse = scalar(0);
+				for (u32 k = 0; k < row->normalCount; ++k)
+				{
+					normalImpulse += rows[row->normalIndex + 3 * k].impulse;
+				}
+
+				scalar maxImpulse = row->friction * normalImpulse;
+				row->lower = -maxImpulse;
+				row->upper = maxImpulse;
+			}
+
+			scalar impulse = -row->mass * (Cdot - row->bias);
+			scalar oldImpulse = row->impulse;
+			row->impulse = b3Clamp(oldImpulse + impulse, row->lower, row->upper);
+			impulse = row->impulse - oldImpulse;
+
+			if (impulse == scalar(0))
+			{
+				continue;
+			}
+
+			for (u32 k = 0; k < n; ++k)
+			{
+				qd[k] += impulse * row->response[k];
+			}
+
+			if (body)
+			{
+				body->LinearVelocity() -= impulse * body->InvMass() * row->linearB;
+				body->AngularVelocity() -= impulse * (body->WorldInvInertia() * row->angularB);
+			}
+		}
+	}
+
+	// Keep the impulses for the next step.
+	for (u32 i = 0; i < rowCount; ++i)
+	{
+		if (rows[i].storedImpulse)
+		{
+			*rows[i].storedImpulse = scalar(0);
+		}
+	}
+
+	for (u32 i = 0; i < rowCount; ++i)
+	{
+		if (rows[i].storedImpulse)
+		{
+			*rows[i].storedImpulse += rows[i].impulse;
+		}
+	}
+
+	// Scatter the joint velocities.
+	root->v.w.Set(qd[0], qd[1], qd[2]);
+	root->v.v.Set(qd[3], qd[4], qd[5]);
+	
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		for (u32 j = 0; j < link->dofCount; ++j)
+		{
+			link->qd[j] = qd[link->dofOffset + j];
+		}
+	}
+
+	allocator->Free(qd);
+	allocator->Free(responses);
+	allocator->Free(Js);
+	allocator->Free(rows);
+}
+
+void b3Articulation::SaveState(b3StateBuffer* buffer) const
+{
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		const b3ArticulationLink* link = m_links + i;
+		buffer->Write(link->q);
+		buffer->Write(link->p);
+		buffer->Write(link->qd);
+		buffer->Write(link->limitImpulse);
+	}
+
+	buffer->Write(m_links->xf);
+	buffer->Write(m_links->v);
+	buffer->Write(m_awake);
+	buffer->Write(m_sleepTime);
+}
+
+void b3Articulation::RestoreState(b3StateBuffer* buffer)
+{
+	for (u32 i = 0; i < m_linkCount; ++i)
+	{
+		b3ArticulationLink* link = m_links + i;
+		buffer->Read(link->q);
+		buffer->Read(link->p);
+		buffer->Read(link->qd);
+		buffer->Read(link->limitImpulse);
+	}
+
+	buffer->Read(m_links->xf);
+	buffer->Read(m_links->v);
+	buffer->Read(m_awake);
+	buffer->Read(m_sleepTime);
+
+	ComputeTransforms();
+	ComputeVelocities();
+}
+
+void b3Articulation::Draw(b3Draw* draw) const
+{
+	for (u32 i = 1; i < m_linkCount; ++i)
+	{
+		const b3ArticulationLink* link = m_links + i;
+		const b3ArticulationLink* parent = m_links + link->parent;
+
+		b3Transform jointFrame = link->xf * link->childFrame;
+
+		draw->DrawSegment(parent->xf.translation, jointFrame.translation, b3Color_yellow);
+		draw->DrawSegment(jointFrame.translation, link->xf.translation, b3Color_yellow);
+		draw->DrawPoint(jointFrame.translation, scalar(4), b3Color_red);
+		
+		if (link->dofCount == 1)
+		{
+			b3Vec3 axis = b3Mul(jointFrame.rotation, b3Vec3_x);
+			draw->DrawSegment(jointFrame.translation, jointFrame.translation + axis, b3Color_red);
+		}
+	}
+}
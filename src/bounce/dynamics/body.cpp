@@ -25,8 +25,13 @@
 b3Body::b3Body(const b3BodyDef& def, b3World* world) 
 {
 	m_world = world;
+	m_storage = &world->m_bodyStorage;
+	m_index = m_storage->Add(this);
 	m_type = def.type;
 	m_flags = 0;
+	m_movedStamp = 0;
+	m_movedIndex = B3_MAX_U32;
+	m_articulation = nullptr;
 	
 	if (def.awake)
 	{
@@ -38,10 +43,15 @@ b3Body::b3Body(const b3BodyDef& def, b3World* world)
 		m_flags |= e_autoSleepFlag;
 	}
 
+	if (def.bullet)
+	{
+		m_flags |= e_bulletFlag;
+	}
+
 	if (m_type == e_dynamicBody) 
 	{
 		m_mass = scalar(1);
-		m_invMass = scalar(1);
+		InvMass() = scalar(1);
 
 		if (def.fixedRotationX)
 		{
@@ -61,28 +71,29 @@ b3Body::b3Body(const b3BodyDef& def, b3World* world)
 	else 
 	{
 		m_mass = scalar(0);
-		m_invMass = scalar(0);
+		InvMass() = scalar(0);
 	}
 		
 	m_I.SetZero();
-	m_invI.SetZero();
-	m_worldInvI.SetZero();
+	InvInertia().SetZero();
+	WorldInvInertia().SetZero();
 
-	m_force.SetZero();
-	m_torque.SetZero();
+	Force().SetZero();
+	Torque().SetZero();
 	
-	m_linearVelocity = def.linearVelocity;
-	m_angularVelocity = def.angularVelocity;
-
-	m_sweep.localCenter.SetZero();
-	m_sweep.worldCenter = def.position;
-	m_sweep.orientation = def.orientation;
-	m_sweep.worldCenter0 = def.position;
-	m_sweep.orientation0 = def.orientation;
-	m_sweep.t0 = scalar(0);
-
-	m_xf.translation = m_sweep.worldCenter;
-	m_xf.rotation = m_sweep.orientation;
+	LinearVelocity() = def.linearVelocity;
+	AngularVelocity() = def.angularVelocity;
+
+	b3Sweep& sweep = Sweep();
+	sweep.localCenter.SetZero();
+	sweep.worldCenter = def.position;
+	sweep.orientation = def.orientation;
+	sweep.worldCenter0 = def.position;
+	sweep.orientation0 = def.orientation;
+	sweep.t0 = scalar(0);
+
+	Transform().translation = sweep.worldCenter;
+	Transform().rotation = sweep.orientation;
 	
 	m_linearDamping = def.linearDamping;
 	m_angularDamping = def.angularDamping;
@@ -92,6 +103,9 @@ b3Body::b3Body(const b3BodyDef& def, b3World* world)
 	m_linearSleepTolerance = def.linearSleepTolerance;
 	m_angularSleepTolerance = def.angularSleepTolerance;
 	m_sleepTime = scalar(0);	
+
+	m_minExtent = B3_MAX_SCALAR;
+	m_maxExtent = scalar(0);
 }
 
 b3Fixture* b3Body::CreateFixture(const b3FixtureDef& def) 
@@ -110,6 +124,10 @@ b3Fixture* b3Body::CreateFixture(const b3FixtureDef& def)
 	{
 		ResetMass();
 	}
+	else
+	{
+		ComputeExtents();
+	}
 
 	// Compute the world AABB of the new fixture and assign a broad-phase proxy to it.
 	b3AABB aabb;
@@ -185,14 +203,24 @@ void b3Body::DestroyFixtures()
 
 void b3Body::SynchronizeTransform()
 {
-	m_xf = m_sweep.GetTransform(scalar(1));
+	Transform() = Sweep().GetTransform(scalar(1));
+}
+
+void b3Body::MarkMoved()
+{
+	m_movedStamp = m_world->m_stepCount + 1;
+	if (m_movedIndex == B3_MAX_U32)
+	{
+		m_movedIndex = m_world->m_movedBodies.Count();
+		m_world->m_movedBodies.PushBack(this);
+	}
 }
 
 void b3Body::SynchronizeFixtures() 
 {
-	b3Transform xf1 = m_sweep.GetTransform(scalar(0));
+	b3Transform xf1 = Sweep().GetTransform(scalar(0));
 
-	b3Transform xf2 = m_xf;
+	b3Transform xf2 = Transform();
 	
 	b3Vec3 displacement = xf2.translation - xf1.translation;
 
@@ -207,6 +235,14 @@ void b3Body::SynchronizeFixtures()
 		
 		b3AABB aabb = b3Combine(aabb1, aabb2);
 
+		if (m_world->m_speculativeContacts)
+		{
+			// Include the motion predicted for the next step so the 
+			// speculative contacts are created before the shapes meet.
+			aabb2.Translate(displacement);
+			aabb.Combine(aabb2);
+		}
+
 		broadPhase->MoveProxy(f->m_broadPhaseID, aabb, displacement);
 	}
 }
@@ -219,6 +255,12 @@ bool b3Body::ShouldCollide(const b3Body* other) const
 		return false;
 	}
 
+	// Links of the same articulation don't collide.
+	if (m_articulation != nullptr && m_articulation == other->m_articulation)
+	{
+		return false;
+	}
+
 	// Check if there are joints that connects this body with the other body 
 	// and if the joint was configured to let not their collision occur.
 	for (b3JointEdge* je = m_jointEdges.m_head; je; je = je->m_next)
@@ -238,19 +280,26 @@ bool b3Body::ShouldCollide(const b3Body* other) const
 
 void b3Body::ResetMass() 
 {
+	scalar& invMass = InvMass();
+	b3Mat33& invI = InvInertia();
+	b3Mat33& worldInvI = WorldInvInertia();
+	b3Sweep& sweep = Sweep();
+	const b3Transform& xf = Transform();
+
 	m_mass = scalar(0);
-	m_invMass = scalar(0);
+	invMass = scalar(0);
 	m_I.SetZero();
-	m_invI.SetZero();
-	m_worldInvI.SetZero();
-	m_sweep.localCenter.SetZero();
+	invI.SetZero();
+	worldInvI.SetZero();
+	sweep.localCenter.SetZero();
 
 	// Static and kinematic bodies have zero mass.
 	if (m_type == e_staticBody || m_type == e_kinematicBody)
 	{
-		m_sweep.worldCenter0 = m_xf.translation;
-		m_sweep.worldCenter = m_xf.translation;
-		m_sweep.orientation0 = m_sweep.orientation;
+		sweep.worldCenter0 = xf.translation;
+		sweep.worldCenter = xf.translation;
+		sweep.orientation0 = sweep.orientation;
+		ComputeExtents();
 		return;
 	}
 
@@ -275,8 +324,8 @@ void b3Body::ResetMass()
 	if (m_mass > scalar(0)) 
 	{
 		// Compute local center of mass.
-		m_invMass = scalar(1) / m_mass;
-		localCenter *= m_invMass;
+		invMass = scalar(1) / m_mass;
+		localCenter *= invMass;
 
 		// Shift inertia about the body origin into the body local center of mass.
 		m_I = m_I - m_mass * b3Steiner(localCenter);
@@ -287,153 +336,194 @@ void b3Body::ResetMass()
 		//B3_ASSERT(m_I.z.z > scalar(0));
 
 		// Compute inverse inertia about the body local center of mass.
-		m_invI = b3Inverse(m_I);
+		invI = b3Inverse(m_I);
 
 		// Align the inverse inertia with the world frame of the body.
-		m_worldInvI = b3RotateToFrame(m_invI, m_xf.rotation);
+		worldInvI = b3RotateToFrame(invI, xf.rotation);
 
 		// Fix rotation.
 		if (m_flags & e_fixedRotationX)
 		{
-			m_invI.y.y = scalar(0);
-			m_invI.z.y = scalar(0);
-			m_invI.y.z = scalar(0);
-			m_invI.z.z = scalar(0);
-
-			m_worldInvI.y.y = scalar(0);
-			m_worldInvI.z.y = scalar(0);
-			m_worldInvI.y.z = scalar(0);
-			m_worldInvI.z.z = scalar(0);
+			invI.y.y = scalar(0);
+			invI.z.y = scalar(0);
+			invI.y.z = scalar(0);
+			invI.z.z = scalar(0);
+
+			worldInvI.y.y = scalar(0);
+			worldInvI.z.y = scalar(0);
+			worldInvI.y.z = scalar(0);
+			worldInvI.z.z = scalar(0);
 		}
 
 		if (m_flags & e_fixedRotationY)
 		{
-			m_invI.x.x = scalar(0);
-			m_invI.x.z = scalar(0);
-			m_invI.z.x = scalar(0);
-			m_invI.z.z = scalar(0);
-
-			m_worldInvI.x.x = scalar(0);
-			m_worldInvI.x.z = scalar(0);
-			m_worldInvI.z.x = scalar(0);
-			m_worldInvI.z.z = scalar(0);
+			invI.x.x = scalar(0);
+			invI.x.z = scalar(0);
+			invI.z.x = scalar(0);
+			invI.z.z = scalar(0);
+
+			worldInvI.x.x = scalar(0);
+			worldInvI.x.z = scalar(0);
+			worldInvI.z.x = scalar(0);
+			worldInvI.z.z = scalar(0);
 		}
 
 		if (m_flags & e_fixedRotationZ)
 		{
-			m_invI.x.x = scalar(0);
-			m_invI.x.y = scalar(0);
-			m_invI.y.x = scalar(0);
-			m_invI.y.y = scalar(0);
-
-			m_worldInvI.x.x = scalar(0);
-			m_worldInvI.x.y = scalar(0);
-			m_worldInvI.y.x = scalar(0);
-			m_worldInvI.y.y = scalar(0);
+			invI.x.x = scalar(0);
+			invI.x.y = scalar(0);
+			invI.y.x = scalar(0);
+			invI.y.y = scalar(0);
+
+			worldInvI.x.x = scalar(0);
+			worldInvI.x.y = scalar(0);
+			worldInvI.y.x = scalar(0);
+			worldInvI.y.y = scalar(0);
 		}
 	}
 	else 
 	{
 		// Force all dynamic bodies to have positive mass.
 		m_mass = scalar(1);
-		m_invMass = scalar(1);
+		invMass = scalar(1);
 	}
 
 	// Move center of mass.
-	b3Vec3 oldCenter = m_sweep.worldCenter;
-	m_sweep.localCenter = localCenter;
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
+	b3Vec3 oldCenter = sweep.worldCenter;
+	sweep.localCenter = localCenter;
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.worldCenter0 = sweep.worldCenter;
 
 	// Update center of mass velocity.
-	m_linearVelocity += b3Cross(m_angularVelocity, m_sweep.worldCenter - oldCenter);
+	LinearVelocity() += b3Cross(AngularVelocity(), sweep.worldCenter - oldCenter);
+
+	ComputeExtents();
+}
+
+void b3Body::ComputeExtents()
+{
+	const b3Vec3& localCenter = Sweep().localCenter;
+
+	m_minExtent = B3_MAX_SCALAR;
+	m_maxExtent = scalar(0);
+	for (b3Fixture* f = m_fixtureList.m_head; f; f = f->m_next)
+	{
+		if (f->IsSensor())
+		{
+			continue;
+		}
+
+		// Compute the AABB in the body frame.
+		b3AABB aabb;
+		f->GetShape()->ComputeAABB(&aabb, b3Transform_identity);
+
+		b3Vec3 extents = aabb.GetExtents();
+		m_minExtent = b3Min(m_minExtent, b3Min(extents.x, b3Min(extents.y, extents.z)));
+
+		b3Vec3 lower = aabb.lowerBound - localCenter;
+		b3Vec3 upper = aabb.upperBound - localCenter;
+		
+		b3Vec3 farthest;
+		farthest.x = b3Max(b3Abs(lower.x), b3Abs(upper.x));
+		farthest.y = b3Max(b3Abs(lower.y), b3Abs(upper.y));
+		farthest.z = b3Max(b3Abs(lower.z), b3Abs(upper.z));
+		m_maxExtent = b3Max(m_maxExtent, b3Length(farthest));
+	}
 }
 
 void b3Body::GetMassData(b3MassData* data) const
 {
 	data->mass = m_mass;
 	data->I = m_I;
-	data->center = m_sweep.localCenter;
+	data->center = Sweep().localCenter;
 }
 
 void b3Body::SetMassData(const b3MassData* massData)
 {
+	scalar& invMass = InvMass();
+	b3Mat33& invI = InvInertia();
+	b3Mat33& worldInvI = WorldInvInertia();
+	b3Sweep& sweep = Sweep();
+	const b3Transform& xf = Transform();
+
 	if (m_type != e_dynamicBody)
 	{
 		return;
 	}
 
-	m_invMass = scalar(0);
+	invMass = scalar(0);
 	m_I.SetZero();
-	m_invI.SetZero();
-	m_worldInvI.SetZero();
+	invI.SetZero();
+	worldInvI.SetZero();
 
 	m_mass = massData->mass;
 	if (m_mass > scalar(0))
 	{
-		m_invMass = scalar(1) / m_mass;
+		invMass = scalar(1) / m_mass;
 		m_I = massData->I - m_mass * b3Steiner(massData->center);
 		
 		//B3_ASSERT(m_I.x.x > scalar(0));
 		//B3_ASSERT(m_I.y.y > scalar(0));
 		//B3_ASSERT(m_I.z.z > scalar(0));
 
-		m_invI = b3Inverse(m_I);
-		m_worldInvI = b3RotateToFrame(m_invI, m_xf.rotation);
+		invI = b3Inverse(m_I);
+		worldInvI = b3RotateToFrame(invI, xf.rotation);
 
 		if (m_flags & e_fixedRotationX)
 		{
-			m_invI.y.y = scalar(0);
-			m_invI.z.y = scalar(0);
-			m_invI.y.z = scalar(0);
-			m_invI.z.z = scalar(0);
-
-			m_worldInvI.y.y = scalar(0);
-			m_worldInvI.z.y = scalar(0);
-			m_worldInvI.y.z = scalar(0);
-			m_worldInvI.z.z = scalar(0);
+			invI.y.y = scalar(0);
+			invI.z.y = scalar(0);
+			invI.y.z = scalar(0);
+			invI.z.z = scalar(0);
+
+			worldInvI.y.y = scalar(0);
+			worldInvI.z.y = scalar(0);
+			worldInvI.y.z = scalar(0);
+			worldInvI.z.z = scalar(0);
 		}
 
 		if (m_flags & e_fixedRotationY)
 		{
-			m_invI.x.x = scalar(0);
-			m_invI.x.z = scalar(0);
-			m_invI.z.x = scalar(0);
-			m_invI.z.z = scalar(0);
-
-			m_worldInvI.x.x = scalar(0);
-			m_worldInvI.x.z = scalar(0);
-			m_worldInvI.z.x = scalar(0);
-			m_worldInvI.z.z = scalar(0);
+			invI.x.x = scalar(0);
+			invI.x.z = scalar(0);
+			invI.z.x = scalar(0);
+			invI.z.z = scalar(0);
+
+			worldInvI.x.x = scalar(0);
+			worldInvI.x.z = scalar(0);
+			worldInvI.z.x = scalar(0);
+			worldInvI.z.z = scalar(0);
 		}
 
 		if (m_flags & e_fixedRotationZ)
 		{
-			m_invI.x.x = scalar(0);
-			m_invI.x.y = scalar(0);
-			m_invI.y.x = scalar(0);
-			m_invI.y.y = scalar(0);
-
-			m_worldInvI.x.x = scalar(0);
-			m_worldInvI.x.y = scalar(0);
-			m_worldInvI.y.x = scalar(0);
-			m_worldInvI.y.y = scalar(0);
+			invI.x.x = scalar(0);
+			invI.x.y = scalar(0);
+			invI.y.x = scalar(0);
+			invI.y.y = scalar(0);
+
+			worldInvI.x.x = scalar(0);
+			worldInvI.x.y = scalar(0);
+			worldInvI.y.x = scalar(0);
+			worldInvI.y.y = scalar(0);
 		}
 	}
 	else
 	{
 		m_mass = scalar(1);
-		m_invMass = scalar(1);
+		invMass = scalar(1);
 	}
 
 	// Move center of mass.
-	b3Vec3 oldCenter = m_sweep.worldCenter;
-	m_sweep.localCenter = massData->center;
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
+	b3Vec3 oldCenter = sweep.worldCenter;
+	sweep.localCenter = massData->center;
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.worldCenter0 = sweep.worldCenter;
 
 	// Update center of mass velocity.
-	m_linearVelocity += b3Cross(m_angularVelocity, m_sweep.worldCenter - oldCenter);
+	LinearVelocity() += b3Cross(AngularVelocity(), sweep.worldCenter - oldCenter);
+
+	ComputeExtents();
 }
 
 void b3Body::SetType(b3BodyType type)
@@ -447,15 +537,17 @@ void b3Body::SetType(b3BodyType type)
 
 	ResetMass();
 
-	m_force.SetZero();
-	m_torque.SetZero();
+	Force().SetZero();
+	Torque().SetZero();
 
 	if (m_type == e_staticBody)
 	{
-		m_linearVelocity.SetZero();
-		m_angularVelocity.SetZero();
-		m_sweep.worldCenter0 = m_sweep.worldCenter;
-		m_sweep.orientation0 = m_sweep.orientation;
+		LinearVelocity().SetZero();
+		AngularVelocity().SetZero();
+		
+		b3Sweep& sweep = Sweep();
+		sweep.worldCenter0 = sweep.worldCenter;
+		sweep.orientation0 = sweep.orientation;
 		SynchronizeFixtures();
 	}
 
@@ -509,7 +601,7 @@ void b3Body::SetFixedRotation(bool flagX, bool flagY, bool flagZ)
 		m_flags &= ~e_fixedRotationZ;
 	}
 	
-	m_angularVelocity.SetZero();
+	AngularVelocity().SetZero();
 
 	ResetMass();
 }
@@ -528,15 +620,19 @@ void b3Body::SetAngularSleepTolerance(scalar tolerance)
 
 void b3Body::Dump() const
 {
+	const b3Sweep& sweep = Sweep();
+	const b3Vec3& v = LinearVelocity();
+	const b3Vec3& w = AngularVelocity();
+
 	u32 bodyIndex = m_islandID;
 
 	b3Log("		{\n");
 	b3Log("		b3BodyDef bd;\n");
 	b3Log("		bd.type = (b3BodyType) %d;\n", m_type);
-	b3Log("		bd.position.Set(%f, %f, %f);\n", m_sweep.worldCenter.x, m_sweep.worldCenter.y, m_sweep.worldCenter.z);
-	b3Log("		bd.orientation.Set(%f, %f, %f, %f);\n", m_sweep.orientation.v.x, m_sweep.orientation.v.y, m_sweep.orientation.v.z, m_sweep.orientation.s);
-	b3Log("		bd.linearVelocity.Set(%f, %f, %f);\n", m_linearVelocity.x, m_linearVelocity.y, m_linearVelocity.z);
-	b3Log("		bd.angularVelocity.Set(%f, %f, %f);\n", m_angularVelocity.x, m_angularVelocity.y, m_angularVelocity.z);
+	b3Log("		bd.position.Set(%f, %f, %f);\n", sweep.worldCenter.x, sweep.worldCenter.y, sweep.worldCenter.z);
+	b3Log("		bd.orientation.Set(%f, %f, %f, %f);\n", sweep.orientation.v.x, sweep.orientation.v.y, sweep.orientation.v.z, sweep.orientation.s);
+	b3Log("		bd.linearVelocity.Set(%f, %f, %f);\n", v.x, v.y, v.z);
+	b3Log("		bd.angularVelocity.Set(%f, %f, %f);\n", w.x, w.y, w.z);
 	b3Log("		bd.gravityScale.Set(%f, %f, %f);\n", m_gravityScale.x, m_gravityScale.y, m_gravityScale.z);
 	b3Log("		bd.linearDamping.Set(%f, %f, %f);\n", m_linearDamping.x, m_linearDamping.y, m_linearDamping.z);
 	b3Log("		bd.angularDamping.Set(%f, %f, %f);\n", m_angularDamping.x, m_angularDamping.y, m_angularDamping.z);
@@ -545,6 +641,7 @@ void b3Body::Dump() const
 	b3Log("		bd.fixedRotationX = %d;\n", m_flags & e_fixedRotationX);
 	b3Log("		bd.fixedRotationY = %d;\n", m_flags & e_fixedRotationY);
 	b3Log("		bd.fixedRotationZ = %d;\n", m_flags & e_fixedRotationZ);
+	b3Log("		bd.bullet = %d;\n", m_flags & e_bulletFlag);
 	b3Log("		bd.linearSleepTolerance = %f;\n", m_linearSleepTolerance);
 	b3Log("		bd.angularSleepTolerance = %f;\n", m_angularSleepTolerance);
 	b3Log("		\n");
@@ -0,0 +1,160 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/body_storage.h>
+#include <bounce/dynamics/body.h>
+#include <string.h>
+
+template <class T>
+static inline void b3Grow(T*& data, u32 count, u32 capacity)
+{
+	T* old = data;
+	data = (T*)b3Alloc(capacity * sizeof(T));
+	if (old)
+	{
+		memcpy(data, old, count * sizeof(T));
+		b3Free(old);
+	}
+}
+
+b3BodyStorage::b3BodyStorage()
+{
+	m_capacity = 0;
+	m_count = 0;
+	m_bodies = nullptr;
+	m_sweeps = nullptr;
+	m_transforms = nullptr;
+	m_linearVelocities = nullptr;
+	m_angularVelocities = nullptr;
+	m_forces = nullptr;
+	m_torques = nullptr;
+	m_invMasses = nullptr;
+	m_invInertias = nullptr;
+	m_worldInvInertias = nullptr;
+	Reserve(32);
+}
+
+b3BodyStorage::~b3BodyStorage()
+{
+	b3Free(m_bodies);
+	b3Free(m_sweeps);
+	b3Free(m_transforms);
+	b3Free(m_linearVelocities);
+	b3Free(m_angularVelocities);
+	b3Free(m_forces);
+	b3Free(m_torques);
+	b3Free(m_invMasses);
+	b3Free(m_invInertias);
+	b3Free(m_worldInvInertias);
+}
+
+u32 b3BodyStorage::GetSize() const
+{
+	u32 elementSize = 0;
+	elementSize += sizeof(b3Body*);
+	elementSize += sizeof(b3Sweep);
+	elementSize += sizeof(b3Transform);
+	elementSize += 4 * sizeof(b3Vec3);
+	elementSize += sizeof(scalar);
+	elementSize += 2 * sizeof(b3Mat33);
+	return m_capacity * elementSize;
+}
+
+void b3BodyStorage::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_sweeps, m_count * sizeof(b3Sweep));
+	buffer->Write(m_transforms, m_count * sizeof(b3Transform));
+	buffer->Write(m_linearVelocities, m_count * sizeof(b3Vec3));
+	buffer->Write(m_angularVelocities, m_count * sizeof(b3Vec3));
+	buffer->Write(m_forces, m_count * sizeof(b3Vec3));
+	buffer->Write(m_torques, m_count * sizeof(b3Vec3));
+	buffer->Write(m_invMasses, m_count * sizeof(scalar));
+	buffer->Write(m_invInertias, m_count * sizeof(b3Mat33));
+	buffer->Write(m_worldInvInertias, m_count * sizeof(b3Mat33));
+}
+
+void b3BodyStorage::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_sweeps, m_count * sizeof(b3Sweep));
+	buffer->Read(m_transforms, m_count * sizeof(b3Transform));
+	buffer->Read(m_linearVelocities, m_count * sizeof(b3Vec3));
+	buffer->Read(m_angularVelocities, m_count * sizeof(b3Vec3));
+	buffer->Read(m_forces, m_count * sizeof(b3Vec3));
+	buffer->Read(m_torques, m_count * sizeof(b3Vec3));
+	buffer->Read(m_invMasses, m_count * sizeof(scalar));
+	buffer->Read(m_invInertias, m_count * sizeof(b3Mat33));
+	buffer->Read(m_worldInvInertias, m_count * sizeof(b3Mat33));
+}
+
+void b3BodyStorage::Reserve(u32 capacity)
+{
+	B3_ASSERT(capacity > m_capacity);
+	
+	b3Grow(m_bodies, m_count, capacity);
+	b3Grow(m_sweeps, m_count, capacity);
+	b3Grow(m_transforms, m_count, capacity);
+	b3Grow(m_linearVelocities, m_count, capacity);
+	b3Grow(m_angularVelocities, m_count, capacity);
+	b3Grow(m_forces, m_count, capacity);
+	b3Grow(m_torques, m_count, capacity);
+	b3Grow(m_invMasses, m_count, capacity);
+	b3Grow(m_invInertias, m_count, capacity);
+	b3Grow(m_worldInvInertias, m_count, capacity);
+
+	m_capacity = capacity;
+}
+
+u32 b3BodyStorage::Add(b3Body* body)
+{
+	if (m_count == m_capacity)
+	{
+		Reserve(2 * m_capacity);
+	}
+
+	u32 index = m_count;
+	++m_count;
+	
+	m_bodies[index] = body;
+	
+	return index;
+}
+
+void b3BodyStorage::Remove(u32 index)
+{
+	B3_ASSERT(index < m_count);
+	
+	u32 last = m_count - 1;
+	if (index != last)
+	{
+		// Move the last body into the free slot.
+		m_bodies[index] = m_bodies[last];
+		m_sweeps[index] = m_sweeps[last];
+		m_transforms[index] = m_transforms[last];
+		m_linearVelocities[index] = m_linearVelocities[last];
+		m_angularVelocities[index] = m_angularVelocities[last];
+		m_forces[index] = m_forces[last];
+		m_torques[index] = m_torques[last];
+		m_invMasses[index] = m_invMasses[last];
+		m_invInertias[index] = m_invInertias[last];
+		m_worldInvInertias[index] = m_worldInvInertias[last];
+
+		m_bodies[index]->m_index = index;
+	}
+
+	--m_count;
+}
@@ -20,13 +20,90 @@
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/fixture.h>
 #include <bounce/dynamics/world_callbacks.h>
+#include <bounce/common/memory/stack_allocator.h>
 #include <bounce/common/profiler.h>
 
+extern thread_local u32 b3_allocCalls;
+extern thread_local u32 b3_convexCalls, b3_convexCacheHits;
+extern thread_local u32 b3_contactUpdates, b3_contactReuses;
+extern thread_local u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters, b3_gjkCacheHits;
+extern thread_local u32 b3_toiCalls, b3_toiMaxIters;
+
+// The collision statistics of a thread.
+struct b3ThreadCounters
+{
+	// Move the statistics of this thread into the counters and clear them.
+	void Take()
+	{
+		allocCalls = b3_allocCalls; b3_allocCalls = 0;
+		convexCalls = b3_convexCalls; b3_convexCalls = 0;
+		convexCacheHits = b3_convexCacheHits; b3_convexCacheHits = 0;
+		contactUpdates = b3_contactUpdates; b3_contactUpdates = 0;
+		contactReuses = b3_contactReuses; b3_contactReuses = 0;
+		gjkCalls = b3_gjkCalls; b3_gjkCalls = 0;
+		gjkIters = b3_gjkIters; b3_gjkIters = 0;
+		gjkMaxIters = b3_gjkMaxIters; b3_gjkMaxIters = 0;
+		gjkCacheHits = b3_gjkCacheHits; b3_gjkCacheHits = 0;
+		toiCalls = b3_toiCalls; b3_toiCalls = 0;
+		toiMaxIters = b3_toiMaxIters; b3_toiMaxIters = 0;
+	}
+
+	// Add other counters to the counters.
+	void Accumulate(const b3ThreadCounters& other)
+	{
+		allocCalls += other.allocCalls;
+		convexCalls += other.convexCalls;
+		convexCacheHits += other.convexCacheHits;
+		contactUpdates += other.contactUpdates;
+		contactReuses += other.contactReuses;
+		gjkCalls += other.gjkCalls;
+		gjkIters += other.gjkIters;
+		gjkMaxIters = b3Max(gjkMaxIters, other.gjkMaxIters);
+		gjkCacheHits += other.gjkCacheHits;
+		toiCalls += other.toiCalls;
+		toiMaxIters = b3Max(toiMaxIters, other.toiMaxIters);
+	}
+
+	// Add the counters to the statistics of this thread.
+	void Give() const
+	{
+		b3_allocCalls += allocCalls;
+		b3_convexCalls += convexCalls;
+		b3_convexCacheHits += convexCacheHits;
+		b3_contactUpdates += contactUpdates;
+		b3_contactReuses += contactReuses;
+		b3_gjkCalls += gjkCalls;
+		b3_gjkIters += gjkIters;
+		b3_gjkMaxIters = b3Max(b3_gjkMaxIters, gjkMaxIters);
+		b3_gjkCacheHits += gjkCacheHits;
+		b3_toiCalls += toiCalls;
+		b3_toiMaxIters = b3Max(b3_toiMaxIters, toiMaxIters);
+	}
+
+	u32 allocCalls;
+	u32 convexCalls, convexCacheHits;
+	u32 contactUpdates, contactReuses;
+	u32 gjkCalls, gjkIters, gjkMaxIters, gjkCacheHits;
+	u32 toiCalls, toiMaxIters;
+};
+
 b3ContactManager::b3ContactManager()
 {
 	m_contactListener = nullptr;
 	m_contactFilter = nullptr;
+	m_stackAllocator = nullptr;
 	m_profiler = nullptr;
+	m_threadPool = nullptr;
+	m_threadStackCount = 0;
+}
+
+b3ContactManager::~b3ContactManager()
+{
+	for (u32 i = 0; i < m_threadStackCount; ++i)
+	{
+		m_threadStacks[i]->~b3StackAllocator();
+		b3Free(m_threadStacks[i]);
+	}
 }
 
 void b3ContactManager::AddPair(void* dataA, void* dataB)
@@ -44,27 +121,23 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 	}
 
 	// Check if there is a contact between the two fixtures.
-	// Search the list A or B. The shorter if possible.
-	for (b3ContactEdge* ce = fixtureB->m_contactEdges.m_head; ce; ce = ce->m_next)
+	// Search the shorter edge array.
+	b3Fixture* fixture = fixtureA;
+	b3Fixture* other = fixtureB;
+	if (fixtureB->m_contactEdges.Count() < fixtureA->m_contactEdges.Count())
 	{
-		if (ce->other == fixtureA)
-		{
-			b3Contact* c = ce->contact;
-
-			b3Fixture* fA = c->GetFixtureA();
-			b3Fixture* fB = c->GetFixtureB();
-
-			if (fA == fixtureA && fB == fixtureB)
-			{
-				// A contact already exists.
-				return;
-			}
+		fixture = fixtureB;
+		other = fixtureA;
+	}
 
-			if (fB == fixtureA && fA == fixtureB)
-			{
-				// A contact already exists.
-				return;
-			}
+	const b3ContactEdge* edges = fixture->m_contactEdges.Begin();
+	u32 edgeCount = fixture->m_contactEdges.Count();
+	for (u32 i = 0; i < edgeCount; ++i)
+	{
+		if (edges[i].other == other)
+		{
+			// A contact already exists.
+			return;
 		}
 	}
 
@@ -86,34 +159,249 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 	}
 
 	// Create contact.
-	b3Contact* c = Create(fixtureA, fixtureB);
+	Create(fixtureA, fixtureB);
+}
+
+void b3ContactManager::SynchronizeFixtures()
+{
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
+	{
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			b3Contact** contacts = m_contacts[i][j].Begin();
+			u32 count = m_contacts[i][j].Count();
+			for (u32 k = 0; k < count; ++k)
+			{
+				contacts[k]->SynchronizeFixture();
+			}
+		}
+	}
+}
+
+void b3ContactManager::FindNewContacts()
+{
+	m_broadPhase.FindPairs(this);
+
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
+	{
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			b3Contact** contacts = m_contacts[i][j].Begin();
+			u32 count = m_contacts[i][j].Count();
+			for (u32 k = 0; k < count; ++k)
+			{
+				contacts[k]->FindPairs();
+			}
+		}
+	}
+}
+
+// The narrow-phase task.
+struct b3ContactUpdateTask
+{
+	// The contacts are grouped by shape types. 
+	b3Contact** contacts;
+	u32* groupEnds;
+	u32 groupCount;
+	b3StackAllocator** stacks;
+	b3ThreadCounters* counters;
+};
+
+void b3ContactManager::UpdateContactRange(void* context, u32 begin, u32 end, u32 threadIndex)
+{
+	b3ContactUpdateTask* task = (b3ContactUpdateTask*)context;
+	b3StackAllocator* stack = task->stacks[threadIndex];
+
+	// The statistics of the worker threads are collected by the calling thread.
+	b3ThreadCounters saved = {};
+	if (threadIndex > 0)
+	{
+		saved.Take();
+	}
+
+	// Update the contacts of the same shape types in batches to avoid virtual calls.
+	u32 group = 0;
+	while (group < task->groupCount && task->groupEnds[group] <= begin)
+	{
+		++group;
+	}
+
+	u32 batchBegin = begin;
+	while (batchBegin < end)
+	{
+		B3_ASSERT(group < task->groupCount);
+		u32 batchEnd = b3Min(end, task->groupEnds[group]);
+
+		b3Contact::UpdateBatch(task->contacts + batchBegin, batchEnd - batchBegin, stack);
+		
+		batchBegin = batchEnd;
+		++group;
+	}
+
+	if (threadIndex > 0)
+	{
+		b3ThreadCounters counters;
+		counters.Take();
+		task->counters[threadIndex].Accumulate(counters);
+		saved.Give();
+	}
+}
+
+void b3ContactManager::UpdateContacts()
+{
+	B3_PROFILE(m_profiler, "Update Contacts");
+
+	// Destroy the contacts that must not exist anymore and gather the contacts to update.
+	// This is serial because destroying a contact changes the contact arrays and the fixture edges.
+	u32 count = 0;
+	b3Contact** contacts = (b3Contact**)m_stackAllocator->Allocate(m_contactList.m_count * sizeof(b3Contact*));
+	
+	u32 groupCount = 0;
+	u32 groupEnds[b3Shape::e_typeCount * b3Shape::e_typeCount];
+	
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
+	{
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			b3Array<b3Contact*>& typeContacts = m_contacts[i][j];
+			
+			// Destroying a contact moves the last contact into the current slot.
+			u32 k = 0;
+			while (k < typeContacts.Count())
+			{
+				b3Contact* c = typeContacts[k];
+
+				b3OverlappingPair* pair = &c->m_pair;
+
+				b3Fixture* fixtureA = pair->fixtureA;
+				u32 proxyA = fixtureA->m_broadPhaseID;
+				b3Body* bodyA = fixtureA->m_body;
+
+				b3Fixture* fixtureB = pair->fixtureB;
+				u32 proxyB = fixtureB->m_broadPhaseID;
+				b3Body* bodyB = fixtureB->m_body;
+
+				// Check if the bodies must not collide with each other.
+				if (bodyA->ShouldCollide(bodyB) == false)
+				{
+					Destroy(c);
+					continue;
+				}
+
+				// Check for external filtering.
+				if (m_contactFilter)
+				{
+					if (m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+					{
+						// The user has stopped the contact.
+						Destroy(c);
+						continue;
+					}
+				}
+
+				// At least one body must be dynamic or kinematic.
+				bool activeA = bodyA->IsAwake() && bodyA->m_type != e_staticBody;
+				bool activeB = bodyB->IsAwake() && bodyB->m_type != e_staticBody;
+				if (activeA == false && activeB == false)
+				{
+					++k;
+					continue;
+				}
+
+				// Destroy the contact if the shape AABBs are not overlapping.
+				bool overlap = m_broadPhase.TestOverlap(proxyA, proxyB);
+				if (overlap == false)
+				{
+					Destroy(c);
+					continue;
+				}
+
+				// The contact persists.
+				++k;
+
+				contacts[count++] = c;
+			}
+
+			if (groupCount == 0 || groupEnds[groupCount - 1] < count)
+			{
+				groupEnds[groupCount++] = count;
+			}
+		}
+	}
+
+	// Update the manifolds. A contact update only writes to its contact.
+	b3StackAllocator* stacks[b3_maxThreadCount];
+	stacks[0] = m_stackAllocator;
+
+	b3ThreadCounters counters[b3_maxThreadCount];
+	
+	b3ContactUpdateTask task;
+	task.contacts = contacts;
+	task.groupEnds = groupEnds;
+	task.groupCount = groupCount;
+	task.stacks = stacks;
+	task.counters = counters;
+
+	const u32 kRangeSize = 64;
+
+	if (m_threadPool && m_threadPool->GetThreadCount() > 1)
+	{
+		u32 threadCount = m_threadPool->GetThreadCount();
+
+		// Create the stacks of the other threads on the first use.
+		while (m_threadStackCount < threadCount - 1)
+		{
+			void* mem = b3Alloc(sizeof(b3StackAllocator));
+			m_threadStacks[m_threadStackCount++] = new (mem) b3StackAllocator(0);
+		}
+
+		for (u32 i = 1; i < threadCount; ++i)
+		{
+			stacks[i] = m_threadStacks[i - 1];
+			memset(counters + i, 0, sizeof(b3ThreadCounters));
+		}
+
+		m_threadPool->ParallelFor(count, kRangeSize, UpdateContactRange, &task);
+
+		for (u32 i = 1; i < threadCount; ++i)
+		{
+			counters[i].Give();
+		}
+	}
+	else
+	{
+		UpdateContactRange(&task, 0, count, 0);
+	}
+
+	// Wake the bodies and notify the listener in a fixed order.
+	for (u32 i = 0; i < count; ++i)
+	{
+		contacts[i]->Report(m_contactListener);
+	}
+
+	m_stackAllocator->Free(contacts);
+}
+
+b3Contact* b3ContactManager::Create(b3Fixture* fixtureA, b3Fixture* fixtureB)
+{
+	b3Contact* c = b3Contact::Create(fixtureA, fixtureB, m_allocator);
 	if (c == nullptr)
 	{
-		return;
+		return nullptr;
 	}
 
 	// Get the fixtures from the contact again because contact creation can swap the fixtures.
 	fixtureA = c->GetFixtureA();
 	fixtureB = c->GetFixtureB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	b3Body* bodyA = fixtureA->GetBody();
+	b3Body* bodyB = fixtureB->GetBody();
 
 	c->m_flags = 0;
 	b3OverlappingPair* pair = &c->m_pair;
 
-	// Initialize edge A
-	pair->edgeA.contact = c;
-	pair->edgeA.other = fixtureB;
-
-	// Add edge A to fixture A's contact list.
-	fixtureA->m_contactEdges.PushFront(&pair->edgeA);
-
-	// Initialize edge B
-	pair->edgeB.contact = c;
-	pair->edgeB.other = fixtureA;
-
-	// Add edge B to fixture B's contact list.
-	fixtureB->m_contactEdges.PushFront(&pair->edgeB);
+	// Add the edges to the fixture edge arrays.
+	pair->edgeA = fixtureA->AddContactEdge(c, fixtureB);
+	pair->edgeB = fixtureB->AddContactEdge(c, fixtureA);
 
 	// Awake the bodies if both are not sensors.
 	if (!fixtureA->IsSensor() && !fixtureB->IsSensor())
@@ -122,125 +410,256 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 		bodyB->SetAwake(true);
 	}
 
+	// Add the contact to the array of its shape types.
+	b3Array<b3Contact*>& contacts = m_contacts[fixtureA->GetType()][fixtureB->GetType()];
+	c->m_index = contacts.Count();
+	contacts.PushBack(c);
+
 	// Add the contact to the world contact list.
 	m_contactList.PushFront(c);
+
+	return c;
 }
 
-void b3ContactManager::SynchronizeFixtures()
+void b3ContactManager::Destroy(b3Contact* c)
 {
-	b3Contact* c = m_contactList.m_head;
-	while (c)
+	// Report to the contact listener the contact will be destroyed.
+	if (m_contactListener)
 	{
-		c->SynchronizeFixture();
-		c = c->m_next;
+		if (c->IsOverlapping())
+		{
+			m_contactListener->EndContact(c);
+		}
 	}
-}
 
-void b3ContactManager::FindNewContacts()
+	b3OverlappingPair* pair = &c->m_pair;
+
+	b3Fixture* fixtureA = c->GetFixtureA();
+	b3Fixture* fixtureB = c->GetFixtureB();
+
+	fixtureA->RemoveContactEdge(pair->edgeA);
+	fixtureB->RemoveContactEdge(pair->edgeB);
+
+	// Remove the contact from the array of its shape types.
+	b3Array<b3Contact*>& contacts = m_contacts[fixtureA->GetType()][fixtureB->GetType()];
+	B3_ASSERT(contacts[c->m_index] == c);
+	
+	b3Contact* last = contacts.Back();
+	contacts[c->m_index] = last;
+	last->m_index = c->m_index;
+	contacts.PopBack();
+
+	// Remove the contact from the world contact list.
+	m_contactList.Remove(c);
+
+	// Free the contact.
+	b3Contact::Destroy(c, m_allocator);
+}
+// The identity and the position of a contact in the contact arrays.
+struct b3ContactHeader
 {
-	m_broadPhase.FindPairs(this);
+	u32 proxyA; // proxy of the fixture A
+	u32 proxyB; // proxy of the fixture B
+	u32 typeA; // shape type of the fixture A
+	u32 typeB; // shape type of the fixture B
+	u32 index; // index in the array of its shape types
+	u32 edgeA; // index of the edge in the fixture A edge array
+	u32 edgeB; // index of the edge in the fixture B edge array
+};
+
+void b3ContactManager::SaveState(b3StateBuffer* buffer) const
+{
+	m_broadPhase.SaveState(buffer);
+
+	// The headers come first so the restore can match the contacts before reading their state.
+	buffer->Write(m_contactList.m_count);
+	for (b3Contact* c = m_contactList.m_head; c; c = c->m_next)
+	{
+		b3ContactHeader header;
+		header.proxyA = c->m_pair.fixtureA->m_broadPhaseID;
+		header.proxyB = c->m_pair.fixtureB->m_broadPhaseID;
+		header.typeA = c->m_pair.fixtureA->GetType();
+		header.typeB = c->m_pair.fixtureB->GetType();
+		header.index = c->m_index;
+		header.edgeA = c->m_pair.edgeA;
+		header.edgeB = c->m_pair.edgeB;
+		buffer->Write(header);
+	}
 
-	b3Contact* c = m_contactList.m_head;
-	while (c)
+	for (b3Contact* c = m_contactList.m_head; c; c = c->m_next)
 	{
-		c->FindPairs();
-		c = c->m_next;
+		c->SaveState(buffer);
 	}
 }
 
-void b3ContactManager::UpdateContacts()
+void b3ContactManager::RestoreState(b3StateBuffer* buffer, b3StackAllocator* allocator)
 {
-	B3_PROFILE(m_profiler, "Update Contacts");
+	m_broadPhase.RestoreState(buffer);
 
-	// Update the state of all contacts.
-	b3Contact* c = m_contactList.m_head;
-	while (c)
+	u32 contactCount;
+	buffer->Read(contactCount);
+	const b3ContactHeader* headers = (const b3ContactHeader*)buffer->ReadData(contactCount * sizeof(b3ContactHeader));
+
+	b3Contact** contacts = (b3Contact**)allocator->Allocate(contactCount * sizeof(b3Contact*));
+
+	// One flag per slot in the contact arrays tells which contacts were matched, 
+	// so the unmatched ones are found without visiting every contact.
+	u32 slotOffsets[b3Shape::e_typeCount][b3Shape::e_typeCount];
+	u32 slotCounts[b3Shape::e_typeCount][b3Shape::e_typeCount];
+	u32 slotCount = 0;
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
 	{
-		b3OverlappingPair* pair = &c->m_pair;
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			slotOffsets[i][j] = slotCount;
+			slotCounts[i][j] = m_contacts[i][j].Count();
+			slotCount += slotCounts[i][j];
+		}
+	}
 
-		b3Fixture* fixtureA = pair->fixtureA;
-		u32 proxyA = fixtureA->m_broadPhaseID;
-		b3Body* bodyA = fixtureA->m_body;
+	u8* matched = (u8*)allocator->Allocate(slotCount * sizeof(u8));
+	memset(matched, 0, slotCount * sizeof(u8));
+	
+	u32 matchCount = 0;
 
-		b3Fixture* fixtureB = pair->fixtureB;
-		u32 proxyB = fixtureB->m_broadPhaseID;
-		b3Body* bodyB = fixtureB->m_body;
+	// Don't report the contacts destroyed by the restore.
+	b3ContactListener* listener = m_contactListener;
+	m_contactListener = nullptr;
+
+	// Find the saved contacts and create the missing ones. 
+	// Contacts that weren't moved in the contact arrays since the save are found 
+	// at their saved index without touching the fixtures.
+	for (u32 i = 0; i < contactCount; ++i)
+	{
+		const b3ContactHeader* header = headers + i;
+
+		b3Fixture* fixtureA = (b3Fixture*)m_broadPhase.GetUserData(header->proxyA);
+		b3Fixture* fixtureB = (b3Fixture*)m_broadPhase.GetUserData(header->proxyB);
 
-		// Check if the bodies must not collide with each other.
-		if (bodyA->ShouldCollide(bodyB) == false)
+		b3Contact* contact = nullptr;
+
+		const b3Array<b3Contact*>& typeContacts = m_contacts[header->typeA][header->typeB];
+		if (header->index < typeContacts.Count())
 		{
-			b3Contact* quack = c;
-			c = c->m_next;
-			Destroy(quack);
-			continue;
+			b3Contact* c = typeContacts[header->index];
+			if (c->m_pair.fixtureA == fixtureA && c->m_pair.fixtureB == fixtureB)
+			{
+				contact = c;
+			}
 		}
 
-		// Check for external filtering.
-		if (m_contactFilter)
+		if (contact == nullptr)
 		{
-			if (m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			// Search the fixture with fewer contacts, e.g. not a mesh touched by many bodies.
+			b3Fixture* fixture = fixtureA;
+			b3Fixture* other = fixtureB;
+			if (fixtureB->m_contactEdges.Count() < fixtureA->m_contactEdges.Count())
 			{
-				// The user has stopped the contact.
-				b3Contact* quack = c;
-				c = c->m_next;
-				Destroy(quack);
-				continue;
+				fixture = fixtureB;
+				other = fixtureA;
+			}
+
+			const b3ContactEdge* edges = fixture->m_contactEdges.Begin();
+			u32 edgeCount = fixture->m_contactEdges.Count();
+			for (u32 j = 0; j < edgeCount; ++j)
+			{
+				if (edges[j].other == other)
+				{
+					contact = edges[j].contact;
+					break;
+				}
 			}
 		}
 
-		// At least one body must be dynamic or kinematic.
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != e_staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != e_staticBody;
-		if (activeA == false && activeB == false)
+		if (contact)
 		{
-			c = c->m_next;
-			continue;
+			// Contacts created below are appended to the arrays and have no slot flag.
+			matched[slotOffsets[header->typeA][header->typeB] + contact->m_index] = 1;
+			++matchCount;
+		}
+		else
+		{
+			contact = Create(fixtureA, fixtureB);
+			B3_ASSERT(contact->m_pair.fixtureA == fixtureA);
 		}
 
-		// Destroy the contact if the shape AABBs are not overlapping.
-		bool overlap = m_broadPhase.TestOverlap(proxyA, proxyB);
-		if (overlap == false)
+		contacts[i] = contact;
+	}
+
+	// Destroy the contacts created after the state was saved.
+	// These are the contacts that existed before the restore and weren't matched.
+	if (matchCount < slotCount)
+	{
+		b3Contact** unmatched = (b3Contact**)allocator->Allocate((slotCount - matchCount) * sizeof(b3Contact*));
+		u32 unmatchedCount = 0;
+
+		for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
 		{
-			b3Contact* quack = c;
-			c = c->m_next;
-			Destroy(quack);
-			continue;
+			for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+			{
+				const u8* typeMatched = matched + slotOffsets[i][j];
+				for (u32 k = 0; k < slotCounts[i][j]; ++k)
+				{
+					if (typeMatched[k] == 0)
+					{
+						unmatched[unmatchedCount++] = m_contacts[i][j][k];
+					}
+				}
+			}
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
+		B3_ASSERT(unmatchedCount == slotCount - matchCount);
+
+		for (u32 i = 0; i < unmatchedCount; ++i)
+		{
+			Destroy(unmatched[i]);
+		}
 
-		c = c->m_next;
+		allocator->Free(unmatched);
 	}
-}
 
-b3Contact* b3ContactManager::Create(b3Fixture* fixtureA, b3Fixture* fixtureB)
-{
-	return b3Contact::Create(fixtureA, fixtureB, m_allocator);
-}
+	allocator->Free(matched);
 
-void b3ContactManager::Destroy(b3Contact* c)
-{
-	// Report to the contact listener the contact will be destroyed.
-	if (m_contactListener)
+	B3_ASSERT(m_contactList.m_count == contactCount);
+
+	m_contactListener = listener;
+
+	// Now the contact arrays, the edge arrays, and the contact list have the saved sizes. 
+	// Put each contact that moved back at its saved position and read its state. 
+	// The slots of the contacts that didn't move already point to them.
+	for (u32 i = 0; i < contactCount; ++i)
 	{
-		if (c->IsOverlapping())
+		const b3ContactHeader* header = headers + i;
+		b3Contact* c = contacts[i];
+		b3OverlappingPair* pair = &c->m_pair;
+
+		if (c->m_index != header->index)
 		{
-			m_contactListener->EndContact(c);
+			c->m_index = header->index;
+			m_contacts[header->typeA][header->typeB][header->index] = c;
 		}
-	}
 
-	b3OverlappingPair* pair = &c->m_pair;
+		if (pair->edgeA != header->edgeA)
+		{
+			pair->edgeA = header->edgeA;
+			pair->fixtureA->m_contactEdges[header->edgeA].other = pair->fixtureB;
+			pair->fixtureA->m_contactEdges[header->edgeA].contact = c;
+		}
 
-	b3Fixture* fixtureA = c->GetFixtureA();
-	b3Fixture* fixtureB = c->GetFixtureB();
+		if (pair->edgeB != header->edgeB)
+		{
+			pair->edgeB = header->edgeB;
+			pair->fixtureB->m_contactEdges[header->edgeB].other = pair->fixtureA;
+			pair->fixtureB->m_contactEdges[header->edgeB].contact = c;
+		}
 
-	fixtureA->m_contactEdges.Remove(&pair->edgeA);
-	fixtureB->m_contactEdges.Remove(&pair->edgeB);
+		c->m_prev = i > 0 ? contacts[i - 1] : nullptr;
+		c->m_next = i + 1 < contactCount ? contacts[i + 1] : nullptr;
 
-	// Remove the contact from the world contact list.
-	m_contactList.Remove(c);
+		c->RestoreState(buffer);
+	}
 
-	// Free the contact.
-	b3Contact::Destroy(c, m_allocator);
-}
\ No newline at end of file
+	m_contactList.m_head = contactCount > 0 ? contacts[0] : nullptr;
+
+	allocator->Free(contacts);
+}
@@ -0,0 +1,628 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/contacts/compound_contact.h>
+#include <bounce/dynamics/fixture.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
+#include <bounce/collision/shapes/triangle_shape.h>
+#include <bounce/collision/shapes/mesh_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/shapes/compound_shape.h>
+#include <bounce/collision/geometry/mesh.h>
+#include <bounce/collision/geometry/height_field.h>
+#include <bounce/collision/geometry/compound.h>
+#include <bounce/common/memory/block_allocator.h>
+
+// A convex child of a shape in a compound contact.
+struct b3CompoundContactChild
+{
+	// The convex shape.
+	const b3Shape* shape;
+	
+	// The child frame relative to the body frame.
+	b3Transform transform;
+	
+	// The radius of the child that is not included in the fixture radius.
+	scalar radius;
+
+	// Storage for mesh and height field triangles.
+	b3TriangleShape triangle;
+};
+
+static void b3GetContactChild(b3CompoundContactChild* child, const b3Shape* shape, u32 index)
+{
+	switch (shape->GetType())
+	{
+	case b3Shape::e_compound:
+	{
+		const b3CompoundShape* compound = (b3CompoundShape*)shape;
+		child->shape = compound->GetChildShape(&child->transform, index);
+		child->radius = child->shape->m_radius;
+		break;
+	}
+	case b3Shape::e_mesh:
+	{
+		const b3MeshShape* mesh = (b3MeshShape*)shape;
+		mesh->GetChildTriangle(&child->triangle, index);
+		child->shape = &child->triangle;
+		child->transform.SetIdentity();
+		child->radius = scalar(0);
+		break;
+	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightFieldShape* heightField = (b3HeightFieldShape*)shape;
+		heightField->GetChildTriangle(&child->triangle, index);
+		child->shape = &child->triangle;
+		child->transform.SetIdentity();
+		child->radius = scalar(0);
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(index == 0);
+		child->shape = shape;
+		child->transform.SetIdentity();
+		child->radius = scalar(0);
+		break;
+	}
+	}
+}
+
+// Compute the world AABB of a convex child given its world frame.
+static void b3ComputeChildAABB(b3AABB* aabb, const b3CompoundContactChild& child, const b3Transform& xf)
+{
+	if (child.shape->GetType() == b3Shape::e_triangle)
+	{
+		const b3TriangleShape* triangle = (b3TriangleShape*)child.shape;
+
+		b3Vec3 v1 = xf * triangle->m_vertex1;
+		b3Vec3 v2 = xf * triangle->m_vertex2;
+		b3Vec3 v3 = xf * triangle->m_vertex3;
+
+		aabb->lowerBound = b3Min(v1, b3Min(v2, v3));
+		aabb->upperBound = b3Max(v1, b3Max(v2, v3));
+		aabb->Extend(triangle->m_radius);
+		return;
+	}
+
+	child.shape->ComputeAABB(aabb, xf);
+}
+
+// Get the inverse scale of the frame used for querying the children of a shape.
+static b3Vec3 b3GetInverseScale(const b3Shape* shape)
+{
+	b3Vec3 scale(scalar(1), scalar(1), scalar(1));
+	
+	if (shape->GetType() == b3Shape::e_mesh)
+	{
+		scale = ((b3MeshShape*)shape)->m_scale;
+	}
+	else if (shape->GetType() == b3Shape::e_heightField)
+	{
+		scale = ((b3HeightFieldShape*)shape)->m_scale;
+	}
+
+	B3_ASSERT(scale.x != scalar(0));
+	B3_ASSERT(scale.y != scalar(0));
+	B3_ASSERT(scale.z != scalar(0));
+
+	b3Vec3 inv_scale;
+	inv_scale.x = scalar(1) / scale.x;
+	inv_scale.y = scalar(1) / scale.y;
+	inv_scale.z = scalar(1) / scale.z;
+	return inv_scale;
+}
+
+// Update a fat AABB if the given AABB is not contained in it.
+static bool b3MoveAABB(b3AABB* fatAABB, const b3AABB& aabb, const b3Vec3& displacement)
+{
+	// Do nothing if the new AABB is contained in the old AABB.
+	if (fatAABB->Contains(aabb))
+	{
+		return false;
+	}
+
+	// Extend the new (original) AABB.
+	b3AABB newAABB = aabb;
+	newAABB.Extend(B3_AABB_EXTENSION);
+
+	// Predict the motion.
+	b3Vec3 d = B3_AABB_MULTIPLIER * displacement;
+
+	if (d.x < scalar(0))
+	{
+		newAABB.lowerBound.x += d.x;
+	}
+	else
+	{
+		newAABB.upperBound.x += d.x;
+	}
+
+	if (d.y < scalar(0))
+	{
+		newAABB.lowerBound.y += d.y;
+	}
+	else
+	{
+		newAABB.upperBound.y += d.y;
+	}
+
+	if (d.z < scalar(0))
+	{
+		newAABB.lowerBound.z += d.z;
+	}
+	else
+	{
+		newAABB.upperBound.z += d.z;
+	}
+
+	*fatAABB = newAABB;
+
+	return true;
+}
+
+b3Contact* b3CompoundContact::Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b3CompoundContact));
+	return new (mem) b3CompoundContact(fixtureA, fixtureB);
+}
+
+void b3CompoundContact::Destroy(b3Contact* contact, b3BlockAllocator* allocator)
+{
+	((b3CompoundContact*)contact)->~b3CompoundContact();
+	allocator->Free(contact, sizeof(b3CompoundContact));
+}
+
+b3CompoundContact::b3CompoundContact(b3Fixture* fixtureA, b3Fixture* fixtureB) : b3Contact(fixtureA, fixtureB)
+{
+	B3_ASSERT(fixtureA->GetType() == b3Shape::e_compound || fixtureB->GetType() == b3Shape::e_compound);
+
+	m_manifoldCapacity = B3_MAX_MANIFOLDS;
+	m_manifolds = m_clusterManifolds;
+	m_manifoldCount = 0;
+
+	b3Shape::Type typeA = fixtureA->GetType();
+	b3Shape::Type typeB = fixtureB->GetType();
+
+	bool terrainA = typeA == b3Shape::e_mesh || typeA == b3Shape::e_heightField;
+
+	// A terrain is never queried using its own AABB. 
+	// Instead, all children of a compound colliding with a terrain are used.
+	m_queryA = terrainA || typeA == b3Shape::e_compound;
+	m_queryB = terrainA == false && typeB == b3Shape::e_compound;
+
+	b3Transform xfA = fixtureA->GetBody()->GetTransform();
+	b3Transform xfB = fixtureB->GetBody()->GetTransform();
+
+	if (m_queryA)
+	{
+		ComputeAABBB(&m_aabbB, b3MulT(xfA, xfB));
+		m_aabbB.Extend(B3_AABB_EXTENSION);
+	}
+
+	if (m_queryB)
+	{
+		ComputeAABBA(&m_aabbA, b3MulT(xfB, xfA));
+		m_aabbA.Extend(B3_AABB_EXTENSION);
+	}
+
+	if (fixtureA->GetBody()->GetWorld()->m_speculativeContacts)
+	{
+		// Include the motion predicted for the next step.
+		SynchronizeFixture();
+	}
+
+	m_aabbAMoved = true;
+	m_aabbBMoved = true;
+
+	// Pre-allocate some pairs
+	m_pairCapacity = 16;
+	m_pairs = (b3CompoundPair*)b3Alloc(m_pairCapacity * sizeof(b3CompoundPair));
+	m_pairCount = 0;
+
+	m_clusterCache.centroidCount = 0;
+	m_clusterCache.key = 0;
+	m_clusterCache.keyCount = 0;
+}
+
+b3CompoundContact::~b3CompoundContact()
+{
+	b3Free(m_pairs);
+}
+
+void b3CompoundContact::ComputeAABBB(b3AABB* aabb, const b3Transform& xf) const
+{
+	const b3Shape* shapeA = GetFixtureA()->GetShape();
+	const b3Shape* shapeB = GetFixtureB()->GetShape();
+
+	shapeB->ComputeAABB(aabb, xf);
+	aabb->Scale(b3GetInverseScale(shapeA));
+}
+
+void b3CompoundContact::ComputeAABBA(b3AABB* aabb, const b3Transform& xf) const
+{
+	const b3Shape* shapeA = GetFixtureA()->GetShape();
+	
+	shapeA->ComputeAABB(aabb, xf);
+}
+
+void b3CompoundContact::SynchronizeFixture()
+{
+	b3Body* bodyA = GetFixtureA()->GetBody();
+	b3Transform xfA = bodyA->GetTransform();
+	b3Transform xfA0 = bodyA->GetSweep().GetTransform(scalar(0));
+
+	b3Body* bodyB = GetFixtureB()->GetBody();
+	b3Transform xfB = bodyB->GetTransform();
+	b3Transform xfB0 = bodyB->GetSweep().GetTransform(scalar(0));
+
+	m_aabbAMoved = false;
+	m_aabbBMoved = false;
+
+	if (m_queryA)
+	{
+		// Calculate the displacement of body B relative to body A 
+		// using their positions at the last time step and the current positions.
+		b3Transform xf = b3MulT(xfA, xfB);
+		b3Transform xf0 = b3MulT(xfA0, xfB0);
+
+		b3Vec3 inv_scale = b3GetInverseScale(GetFixtureA()->GetShape());
+		b3Vec3 displacement = b3Mul(inv_scale, xf.translation - xf0.translation);
+
+		b3AABB aabbB;
+		ComputeAABBB(&aabbB, xf);
+
+		if (bodyA->GetWorld()->m_speculativeContacts)
+		{
+			// Include the motion predicted for the next step.
+			b3AABB aabbB2 = aabbB;
+			aabbB2.Translate(displacement);
+			aabbB.Combine(aabbB2);
+		}
+
+		m_aabbBMoved = b3MoveAABB(&m_aabbB, aabbB, displacement);
+	}
+
+	if (m_queryB)
+	{
+		// Calculate the displacement of body A relative to body B.
+		b3Transform xf = b3MulT(xfB, xfA);
+		b3Transform xf0 = b3MulT(xfB0, xfA0);
+
+		b3Vec3 displacement = xf.translation - xf0.translation;
+
+		b3AABB aabbA;
+		ComputeAABBA(&aabbA, xf);
+
+		if (bodyA->GetWorld()->m_speculativeContacts)
+		{
+			// Include the motion predicted for the next step.
+			b3AABB aabbA2 = aabbA;
+			aabbA2.Translate(displacement);
+			aabbA.Combine(aabbA2);
+		}
+
+		m_aabbAMoved = b3MoveAABB(&m_aabbA, aabbA, displacement);
+	}
+}
+
+// Collects the children reported by a static tree.
+struct b3CompoundContactTreeCallback
+{
+	bool Report(u32 proxyId)
+	{
+		children->PushBack(tree->GetUserData(proxyId));
+		return true;
+	}
+
+	const b3StaticTree* tree;
+	b3Array<u32>* children;
+};
+
+// Collects the children reported by a height field.
+struct b3CompoundContactHeightFieldCallback
+{
+	bool Report(u32 triangleIndex)
+	{
+		children->PushBack(triangleIndex);
+		return true;
+	}
+
+	b3Array<u32>* children;
+};
+
+static void b3QueryChildren(b3Array<u32>* children, const b3Shape* shape, const b3AABB& aabb)
+{
+	switch (shape->GetType())
+	{
+	case b3Shape::e_compound:
+	{
+		const b3CompoundShape* compound = (b3CompoundShape*)shape;
+
+		b3CompoundContactTreeCallback callback;
+		callback.tree = &compound->m_compound->tree;
+		callback.children = children;
+
+		compound->m_compound->tree.QueryAABB(&callback, aabb);
+		break;
+	}
+	case b3Shape::e_mesh:
+	{
+		const b3MeshShape* mesh = (b3MeshShape*)shape;
+
+		b3CompoundContactTreeCallback callback;
+		callback.tree = &mesh->m_mesh->tree;
+		callback.children = children;
+
+		mesh->m_mesh->tree.QueryAABB(&callback, aabb);
+		break;
+	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightFieldShape* heightField = (b3HeightFieldShape*)shape;
+
+		b3CompoundContactHeightFieldCallback callback;
+		callback.children = children;
+
+		heightField->m_heightField->QueryAABB(&callback, aabb);
+		break;
+	}
+	default:
+	{
+		children->PushBack(0);
+		break;
+	}
+	}
+}
+
+void b3CompoundContact::FindPairs()
+{
+	// Reuse the overlapping buffer if the AABBs didn't move
+	// significantly.
+	if (m_aabbAMoved == false && m_aabbBMoved == false)
+	{
+		return;
+	}
+
+	// Clear the pair cache.
+	m_pairCount = 0;
+
+	const b3Shape* shapeA = GetFixtureA()->GetShape();
+	const b3Shape* shapeB = GetFixtureB()->GetShape();
+
+	b3StackArray<u32, 256> childrenA;
+	if (m_queryA)
+	{
+		b3QueryChildren(&childrenA, shapeA, m_aabbB);
+	}
+	else
+	{
+		childrenA.PushBack(0);
+	}
+
+	b3StackArray<u32, 256> childrenB;
+	if (m_queryB)
+	{
+		b3QueryChildren(&childrenB, shapeB, m_aabbA);
+	}
+	else if (shapeB->GetType() == b3Shape::e_compound)
+	{
+		const b3CompoundShape* compoundB = (b3CompoundShape*)shapeB;
+		for (u32 i = 0; i < compoundB->m_compound->childCount; ++i)
+		{
+			childrenB.PushBack(i);
+		}
+	}
+	else
+	{
+		childrenB.PushBack(0);
+	}
+
+	for (u32 i = 0; i < childrenA.Count(); ++i)
+	{
+		for (u32 j = 0; j < childrenB.Count(); ++j)
+		{
+			AddPair(childrenA[i], childrenB[j]);
+		}
+	}
+}
+
+void b3CompoundContact::AddPair(u32 indexA, u32 indexB)
+{
+	// Add the pair to the overlapping buffer.
+	if (m_pairCount == m_pairCapacity)
+	{
+		b3CompoundPair* oldElements = m_pairs;
+		m_pairCapacity *= 2;
+		m_pairs = (b3CompoundPair*)b3Alloc(m_pairCapacity * sizeof(b3CompoundPair));
+		memcpy(m_pairs, oldElements, m_pairCount * sizeof(b3CompoundPair));
+		b3Free(oldElements);
+	}
+
+	B3_ASSERT(m_pairCount < m_pairCapacity);
+
+	b3CompoundPair* pair = m_pairs + m_pairCount;
+	pair->indexA = indexA;
+	pair->indexB = indexB;
+	pair->cache.simplexCache.count = 0;
+	pair->cache.featureCache.featurePair.state = b3SATCacheType::e_empty;
+
+	++m_pairCount;
+}
+
+bool b3CompoundContact::TestOverlap()
+{
+	b3Shape* shapeA = GetFixtureA()->GetShape();
+	b3Transform xfA = GetFixtureA()->GetBody()->GetTransform();
+
+	b3Shape* shapeB = GetFixtureB()->GetShape();
+	b3Transform xfB = GetFixtureB()->GetBody()->GetTransform();
+
+	// Test if at least one child pair is overlapping.
+	for (u32 i = 0; i < m_pairCount; ++i)
+	{
+		b3CompoundPair* pair = m_pairs + i;
+
+		b3CompoundContactChild childA, childB;
+		b3GetContactChild(&childA, shapeA, pair->indexA);
+		b3GetContactChild(&childB, shapeB, pair->indexB);
+
+		bool overlap = b3TestOverlap(xfA * childA.transform, 0, childA.shape, xfB * childB.transform, 0, childB.shape, &pair->cache);
+		if (overlap == true)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void b3CompoundContact::Collide(b3StackAllocator* allocator)
+{
+	b3Fixture* fixtureA = GetFixtureA();
+	b3Shape* shapeA = fixtureA->GetShape();
+	b3Body* bodyA = fixtureA->GetBody();
+	b3Transform xfA = bodyA->GetTransform();
+	b3Transform xfA0 = bodyA->GetSweep().GetTransform(scalar(0));
+
+	b3Fixture* fixtureB = GetFixtureB();
+	b3Shape* shapeB = fixtureB->GetShape();
+	b3Body* bodyB = fixtureB->GetBody();
+	b3Transform xfB = bodyB->GetTransform();
+	b3Transform xfB0 = bodyB->GetSweep().GetTransform(scalar(0));
+
+	u32 childCountB = 1;
+	if (shapeB->GetType() == b3Shape::e_compound)
+	{
+		childCountB = ((b3CompoundShape*)shapeB)->m_compound->childCount;
+	}
+
+	// Create one temporary manifold per overlapping pair.
+	b3Manifold* manifolds = (b3Manifold*)allocator->Allocate(m_pairCount * sizeof(b3Manifold));
+	u32 manifoldCount = 0;
+
+	for (u32 i = 0; i < m_pairCount; ++i)
+	{
+		b3CompoundPair* pair = m_pairs + i;
+
+		b3CompoundContactChild childA, childB;
+		b3GetContactChild(&childA, shapeA, pair->indexA);
+		b3GetContactChild(&childB, shapeB, pair->indexB);
+
+		b3Transform xfChildA = xfA * childA.transform;
+		b3Transform xfChildB = xfB * childB.transform;
+
+		// Skip the narrow phase if the children are not overlapping.
+		b3AABB aabbA, aabbB;
+		b3ComputeChildAABB(&aabbA, childA, xfChildA);
+		b3ComputeChildAABB(&aabbB, childB, xfChildB);
+		aabbA.Extend(m_speculativeDistance);
+		if (b3TestOverlap(aabbA, aabbB) == false)
+		{
+			continue;
+		}
+
+		b3Manifold* manifold = manifolds + manifoldCount;
+		manifold->Initialize();
+
+		b3CollideShapes(*manifold, xfChildA, childA.shape, xfChildB, childB.shape, SelectConvexCache(&pair->cache),
+			xfA0 * childA.transform, xfB0 * childB.transform);
+
+		if (manifold->pointCount == 0 && m_speculativeDistance > scalar(0))
+		{
+			b3CollideSpeculative(*manifold, xfChildA, childA.shape, xfChildB, childB.shape, m_speculativeDistance);
+		}
+
+		// Convert the points to the body frames.
+		// The child radii are included in the points since the solver 
+		// only knows the fixture radii.
+		b3Quat qBA = b3MulC(xfB.rotation, xfA.rotation);
+		u32 key = pair->indexA * childCountB + pair->indexB;
+
+		for (u32 j = 0; j < manifold->pointCount; ++j)
+		{
+			b3ManifoldPoint* mp = manifold->points + j;
+
+			b3Vec3 nA = b3Mul(childA.transform.rotation, mp->localNormal1);
+			b3Vec3 nB = b3Mul(qBA, nA);
+
+			mp->localNormal1 = nA;
+			mp->localPoint1 = childA.transform * mp->localPoint1 + childA.radius * nA;
+			mp->localPoint2 = childB.transform * mp->localPoint2 - childB.radius * nB;
+			mp->key.triangleKey = key;
+		}
+
+		++manifoldCount;
+	}
+
+	B3_ASSERT(m_manifoldCount == 0);
+
+	// Perform clustering. 
+	b3ClusterSolver cluster;
+	cluster.Run(m_clusterManifolds, m_manifoldCount, manifolds, manifoldCount, xfA, shapeA->m_radius, xfB, shapeB->m_radius, &m_clusterCache);
+
+	allocator->Free(manifolds);
+}
+
+void b3CompoundContact::GetCacheStats(u32* count, u32* size) const
+{
+	*count = m_pairCount;
+	*size = m_pairCapacity * sizeof(b3CompoundPair);
+}
+
+void b3CompoundContact::SaveState(b3StateBuffer* buffer) const
+{
+	b3Contact::SaveState(buffer);
+	buffer->Write(m_queryA);
+	buffer->Write(m_queryB);
+	buffer->Write(m_aabbAMoved);
+	buffer->Write(m_aabbBMoved);
+	buffer->Write(m_aabbA);
+	buffer->Write(m_aabbB);
+	buffer->Write(m_pairCount);
+	buffer->Write(m_pairs, m_pairCount * sizeof(b3CompoundPair));
+	buffer->Write(m_clusterCache);
+}
+
+void b3CompoundContact::RestoreState(b3StateBuffer* buffer)
+{
+	b3Contact::RestoreState(buffer);
+	buffer->Read(m_queryA);
+	buffer->Read(m_queryB);
+	buffer->Read(m_aabbAMoved);
+	buffer->Read(m_aabbBMoved);
+	buffer->Read(m_aabbA);
+	buffer->Read(m_aabbB);
+	buffer->Read(m_pairCount);
+
+	if (m_pairCount > m_pairCapacity)
+	{
+		while (m_pairCapacity < m_pairCount)
+		{
+			m_pairCapacity *= 2;
+		}
+
+		b3Free(m_pairs);
+		m_pairs = (b3CompoundPair*)b3Alloc(m_pairCapacity * sizeof(b3CompoundPair));
+	}
+
+	buffer->Read(m_pairs, m_pairCount * sizeof(b3CompoundPair));
+	buffer->Read(m_clusterCache);
+}
@@ -29,68 +29,91 @@
 #include <bounce/dynamics/contacts/mesh_sphere_contact.h>
 #include <bounce/dynamics/contacts/mesh_capsule_contact.h>
 #include <bounce/dynamics/contacts/mesh_hull_contact.h>
+#include <bounce/dynamics/contacts/height_field_sphere_contact.h>
+#include <bounce/dynamics/contacts/height_field_capsule_contact.h>
+#include <bounce/dynamics/contacts/height_field_hull_contact.h>
+#include <bounce/dynamics/contacts/compound_contact.h>
 #include <bounce/dynamics/fixture.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world.h>
 #include <bounce/dynamics/world_callbacks.h>
 
-bool b3Contact::s_initialized = false;
 b3ContactRegister b3Contact::s_registers[b3Shape::e_typeCount][b3Shape::e_typeCount];
 
 void b3Contact::AddType(b3ContactCreateFcn* createFcn, b3ContactDestroyFcn* destoryFcn,
-	b3Shape::Type type1, b3Shape::Type type2)
+	b3ContactUpdateFcn* updateFcn, u32 size, b3Shape::Type type1, b3Shape::Type type2)
 {
 	B3_ASSERT(0 <= type1 && type1 < b3Shape::e_typeCount);
 	B3_ASSERT(0 <= type2 && type2 < b3Shape::e_typeCount);
 
 	s_registers[type1][type2].createFcn = createFcn;
 	s_registers[type1][type2].destroyFcn = destoryFcn;
+	s_registers[type1][type2].updateFcn = updateFcn;
+	s_registers[type1][type2].size = size;
 	s_registers[type1][type2].primary = true;
 	
 	if (type1 != type2)
 	{
 		s_registers[type2][type1].createFcn = createFcn;
 		s_registers[type2][type1].destroyFcn = destoryFcn;
+		s_registers[type2][type1].updateFcn = updateFcn;
+		s_registers[type2][type1].size = size;
 		s_registers[type2][type1].primary = false;
 	}
 }
 
-void b3Contact::InitializeRegisters()
+bool b3Contact::InitializeRegisters()
 {
-	AddType(b3SphereContact::Create, b3SphereContact::Destroy, b3Shape::e_sphere, b3Shape::e_sphere);
-	AddType(b3CapsuleAndSphereContact::Create, b3CapsuleAndSphereContact::Destroy, b3Shape::e_capsule, b3Shape::e_sphere);
-	AddType(b3CapsuleContact::Create, b3CapsuleContact::Destroy, b3Shape::e_capsule, b3Shape::e_capsule);
-	AddType(b3TriangleAndSphereContact::Create, b3TriangleAndSphereContact::Destroy, b3Shape::e_triangle, b3Shape::e_sphere);
-	AddType(b3TriangleAndCapsuleContact::Create, b3TriangleAndCapsuleContact::Destroy, b3Shape::e_triangle, b3Shape::e_capsule);
-	AddType(b3TriangleAndHullContact::Create, b3TriangleAndHullContact::Destroy, b3Shape::e_triangle, b3Shape::e_hull);
-	AddType(b3HullAndSphereContact::Create, b3HullAndSphereContact::Destroy, b3Shape::e_hull, b3Shape::e_sphere);
-	AddType(b3HullAndCapsuleContact::Create, b3HullAndCapsuleContact::Destroy, b3Shape::e_hull, b3Shape::e_capsule);
-	AddType(b3HullContact::Create, b3HullContact::Destroy, b3Shape::e_hull, b3Shape::e_hull);
-	AddType(b3MeshAndSphereContact::Create, b3MeshAndSphereContact::Destroy, b3Shape::e_mesh, b3Shape::e_sphere);
-	AddType(b3MeshAndCapsuleContact::Create, b3MeshAndCapsuleContact::Destroy, b3Shape::e_mesh, b3Shape::e_capsule);
-	AddType(b3MeshAndHullContact::Create, b3MeshAndHullContact::Destroy, b3Shape::e_mesh, b3Shape::e_hull);
+	AddType(b3SphereContact::Create, b3SphereContact::Destroy, UpdateBatch<b3SphereContact>, sizeof(b3SphereContact), b3Shape::e_sphere, b3Shape::e_sphere);
+	AddType(b3CapsuleAndSphereContact::Create, b3CapsuleAndSphereContact::Destroy, UpdateBatch<b3CapsuleAndSphereContact>, sizeof(b3CapsuleAndSphereContact), b3Shape::e_capsule, b3Shape::e_sphere);
+	AddType(b3CapsuleContact::Create, b3CapsuleContact::Destroy, UpdateBatch<b3CapsuleContact>, sizeof(b3CapsuleContact), b3Shape::e_capsule, b3Shape::e_capsule);
+	AddType(b3TriangleAndSphereContact::Create, b3TriangleAndSphereContact::Destroy, UpdateBatch<b3TriangleAndSphereContact>, sizeof(b3TriangleAndSphereContact), b3Shape::e_triangle, b3Shape::e_sphere);
+	AddType(b3TriangleAndCapsuleContact::Create, b3TriangleAndCapsuleContact::Destroy, UpdateBatch<b3TriangleAndCapsuleContact>, sizeof(b3TriangleAndCapsuleContact), b3Shape::e_triangle, b3Shape::e_capsule);
+	AddType(b3TriangleAndHullContact::Create, b3TriangleAndHullContact::Destroy, UpdateBatch<b3TriangleAndHullContact>, sizeof(b3TriangleAndHullContact), b3Shape::e_triangle, b3Shape::e_hull);
+	AddType(b3HullAndSphereContact::Create, b3HullAndSphereContact::Destroy, UpdateBatch<b3HullAndSphereContact>, sizeof(b3HullAndSphereContact), b3Shape::e_hull, b3Shape::e_sphere);
+	AddType(b3HullAndCapsuleContact::Create, b3HullAndCapsuleContact::Destroy, UpdateBatch<b3HullAndCapsuleContact>, sizeof(b3HullAndCapsuleContact), b3Shape::e_hull, b3Shape::e_capsule);
+	AddType(b3HullContact::Create, b3HullContact::Destroy, UpdateBatch<b3HullContact>, sizeof(b3HullContact), b3Shape::e_hull, b3Shape::e_hull);
+	AddType(b3MeshAndSphereContact::Create, b3MeshAndSphereContact::Destroy, UpdateBatch<b3MeshAndSphereContact>, sizeof(b3MeshAndSphereContact), b3Shape::e_mesh, b3Shape::e_sphere);
+	AddType(b3MeshAndCapsuleContact::Create, b3MeshAndCapsuleContact::Destroy, UpdateBatch<b3MeshAndCapsuleContact>, sizeof(b3MeshAndCapsuleContact), b3Shape::e_mesh, b3Shape::e_capsule);
+	AddType(b3MeshAndHullContact::Create, b3MeshAndHullContact::Destroy, UpdateBatch<b3MeshAndHullContact>, sizeof(b3MeshAndHullContact), b3Shape::e_mesh, b3Shape::e_hull);
+	AddType(b3HeightFieldAndSphereContact::Create, b3HeightFieldAndSphereContact::Destroy, UpdateBatch<b3HeightFieldAndSphereContact>, sizeof(b3HeightFieldAndSphereContact), b3Shape::e_heightField, b3Shape::e_sphere);
+	AddType(b3HeightFieldAndCapsuleContact::Create, b3HeightFieldAndCapsuleContact::Destroy, UpdateBatch<b3HeightFieldAndCapsuleContact>, sizeof(b3HeightFieldAndCapsuleContact), b3Shape::e_heightField, b3Shape::e_capsule);
+	AddType(b3HeightFieldAndHullContact::Create, b3HeightFieldAndHullContact::Destroy, UpdateBatch<b3HeightFieldAndHullContact>, sizeof(b3HeightFieldAndHullContact), b3Shape::e_heightField, b3Shape::e_hull);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_compound, b3Shape::e_sphere);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_compound, b3Shape::e_capsule);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_compound, b3Shape::e_triangle);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_compound, b3Shape::e_hull);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_compound, b3Shape::e_compound);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_mesh, b3Shape::e_compound);
+	AddType(b3CompoundContact::Create, b3CompoundContact::Destroy, UpdateBatch<b3CompoundContact>, sizeof(b3CompoundContact), b3Shape::e_heightField, b3Shape::e_compound);
+	return true;
 }
 
-b3Contact* b3Contact::Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAllocator* allocator)
+const b3ContactRegister& b3Contact::GetRegister(b3Shape::Type type1, b3Shape::Type type2)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
-
-	b3Shape::Type type1 = fixtureA->GetType();
-	b3Shape::Type type2 = fixtureB->GetType();
+	// The registers are written once, on first use, and are read-only afterwards.
+	// The initialization of a local static is thread-safe, so worlds 
+	// in different threads can get here at the same time.
+	static const bool s_initialized = InitializeRegisters();
+	B3_NOT_USED(s_initialized);
 
 	B3_ASSERT(0 <= type1 && type1 < b3Shape::e_typeCount);
 	B3_ASSERT(0 <= type2 && type2 < b3Shape::e_typeCount);
 
-	const b3ContactRegister& contactRegister = s_registers[type1][type2];
+	return s_registers[type1][type2];
+}
+
+b3Contact* b3Contact::Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAllocator* allocator)
+{
+	b3Shape::Type type1 = fixtureA->GetType();
+	b3Shape::Type type2 = fixtureB->GetType();
+
+	const b3ContactRegister& contactRegister = GetRegister(type1, type2);
 
 	b3ContactCreateFcn* createFcn = contactRegister.createFcn;
 	if (createFcn)
 	{
-		if (s_registers[type1][type2].primary)
+		if (contactRegister.primary)
 		{
 			return createFcn(fixtureA, fixtureB, allocator);
 		}
@@ -105,10 +128,46 @@ b3Contact* b3Contact::Create(b3Fixture* fixtureA, b3Fixture* fixtureB, b3BlockAl
 	}
 }
 
-void b3Contact::Destroy(b3Contact* contact, b3BlockAllocator* allocator)
+u32 b3Contact::GetSize(b3Shape::Type type1, b3Shape::Type type2)
 {
-	B3_ASSERT(s_initialized == true);
+	return GetRegister(type1, type2).size;
+}
 
+void b3Contact::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_flags);
+	buffer->Write(m_xf);
+	buffer->Write(m_manifoldCount);
+	
+	// Only the used points of each manifold are saved.
+	const u32 tailSize = sizeof(b3Manifold) - offsetof(b3Manifold, pointCount);
+	for (u32 i = 0; i < m_manifoldCount; ++i)
+	{
+		const b3Manifold* m = m_manifolds + i;
+		buffer->Write(&m->pointCount, tailSize);
+		buffer->Write(m->points, m->pointCount * sizeof(b3ManifoldPoint));
+	}
+}
+
+void b3Contact::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_flags);
+	buffer->Read(m_xf);
+	buffer->Read(m_manifoldCount);
+	B3_ASSERT(m_manifoldCount <= m_manifoldCapacity);
+
+	const u32 tailSize = sizeof(b3Manifold) - offsetof(b3Manifold, pointCount);
+	for (u32 i = 0; i < m_manifoldCount; ++i)
+	{
+		b3Manifold* m = m_manifolds + i;
+		buffer->Read(&m->pointCount, tailSize);
+		B3_ASSERT(m->pointCount <= B3_MAX_MANIFOLD_POINTS);
+		buffer->Read(m->points, m->pointCount * sizeof(b3ManifoldPoint));
+	}
+}
+
+void b3Contact::Destroy(b3Contact* contact, b3BlockAllocator* allocator)
+{
 	b3Fixture* fixtureA = contact->m_pair.fixtureA;
 	b3Fixture* fixtureB = contact->m_pair.fixtureB;
 
@@ -131,16 +190,19 @@ void b3Contact::Destroy(b3Contact* contact, b3BlockAllocator* allocator)
 	B3_ASSERT(0 <= type1 && type1 < b3Shape::e_typeCount);
 	B3_ASSERT(0 <= type2 && type2 < b3Shape::e_typeCount);
 
-	const b3ContactRegister& contactRegister = s_registers[type1][type2];
+	const b3ContactRegister& contactRegister = GetRegister(type1, type2);
 	
 	b3ContactDestroyFcn* destroyFcn = contactRegister.destroyFcn;
 	destroyFcn(contact, allocator);
 }
 
+thread_local u32 b3_contactUpdates = 0, b3_contactReuses = 0;
+
 b3Contact::b3Contact(b3Fixture* fixtureA, b3Fixture* fixtureB)
 {
 	m_pair.fixtureA = fixtureA;
 	m_pair.fixtureB = fixtureB;
+	m_speculativeDistance = scalar(0);
 }
 
 void b3Contact::GetWorldManifold(b3WorldManifold* out, u32 index) const
@@ -161,64 +223,182 @@ void b3Contact::GetWorldManifold(b3WorldManifold* out, u32 index) const
 	out->Initialize(m, shapeA->m_radius, xfA, shapeB->m_radius, xfB);
 }
 
-void b3Contact::Update(b3ContactListener* listener)
+bool b3Contact::CanReuseManifolds(const b3Transform& xf) const
+{
+	if ((m_flags & e_reuseFlag) == 0)
+	{
+		return false;
+	}
+
+	// Check if the relative translation has changed.
+	const scalar kLinearTol = B3_CONTACT_REUSE_LINEAR_TOLERANCE;
+	if (b3LengthSquared(xf.translation - m_xf.translation) > kLinearTol * kLinearTol)
+	{
+		return false;
+	}
+
+	// Check if the relative orientation has changed.
+	// The vector part of the rotation between the old and new relative 
+	// orientations has length sin(angle / 2).
+	b3Quat dq = b3Conjugate(m_xf.rotation) * xf.rotation;
+	const scalar kAngularTol = scalar(0.5) * B3_CONTACT_REUSE_ANGULAR_TOLERANCE;
+	if (b3LengthSquared(dq.v) > kAngularTol * kAngularTol)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+scalar b3Contact::ComputeSpeculativeDistance() const
+{
+	const b3Body* bodyA = GetFixtureA()->GetBody();
+	const b3Body* bodyB = GetFixtureB()->GetBody();
+
+	const b3World* world = bodyA->GetWorld();
+	if (world->m_speculativeContacts == false)
+	{
+		return scalar(0);
+	}
+
+	// Bound the relative motion of the shapes in the step.
+	scalar speed = b3Length(bodyB->GetLinearVelocity() - bodyA->GetLinearVelocity());
+	speed += b3Length(bodyA->GetAngularVelocity()) * bodyA->m_maxExtent;
+	speed += b3Length(bodyB->GetAngularVelocity()) * bodyB->m_maxExtent;
+
+	return B3_SPECULATIVE_DISTANCE + world->m_timeStep * speed;
+}
+
+// Generate the contact points of a contact whose dynamic type is T.
+template <class T>
+inline void b3CollideContact(T* contact, b3Contact*, b3StackAllocator* allocator)
+{
+	contact->T::Collide(allocator);
+}
+
+// Generate the contact points of a convex contact whose dynamic type is T.
+template <class T>
+inline void b3CollideContact(T* contact, b3ConvexContact*, b3StackAllocator* allocator)
+{
+	B3_NOT_USED(allocator);
+	contact->template Collide<T>();
+}
+
+void b3Contact::Update(b3StackAllocator* allocator)
+{
+	b3Contact* contact = this;
+	UpdateBatch(&contact, 1, allocator);
+}
+
+template <class T>
+void b3Contact::UpdateBatch(b3Contact** contacts, u32 count, b3StackAllocator* allocator)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		contacts[i]->Update<T>(allocator);
+	}
+}
+
+void b3Contact::UpdateBatch(b3Contact** contacts, u32 count, b3StackAllocator* allocator)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	b3Shape::Type type1 = contacts[0]->GetFixtureA()->GetType();
+	b3Shape::Type type2 = contacts[0]->GetFixtureB()->GetType();
+
+	const b3ContactRegister& contactRegister = GetRegister(type1, type2);
+	B3_ASSERT(contactRegister.primary == true);
+
+	contactRegister.updateFcn(contacts, count, allocator);
+}
+
+template <class T>
+void b3Contact::Update(b3StackAllocator* allocator)
 {
 	b3Fixture* fixtureA = GetFixtureA();
-	b3Shape* shapeA = fixtureA->GetShape();
 	b3Body* bodyA = fixtureA->GetBody();
 	b3Transform xfA = bodyA->GetTransform();
 
 	b3Fixture* fixtureB = GetFixtureB();
-	b3Shape* shapeB = fixtureB->GetShape();
 	b3Body* bodyB = fixtureB->GetBody();
 	b3Transform xfB = bodyB->GetTransform();
 
 	b3World* world = bodyA->GetWorld();
 
-	b3StackAllocator* stack = &world->m_stackAllocator;
-
 	bool wasOverlapping = IsOverlapping();
 	bool isOverlapping = false;
 	bool isSensorContact = IsSensorContact();
-	bool isDynamicContact = HasDynamicBody();
 
 	if (isSensorContact == true)
 	{
 		isOverlapping = TestOverlap();
 		m_manifoldCount = 0;
+		m_flags &= ~e_reuseFlag;
 	}
 	else
 	{
-		// Copy the old contact points.
-		u32 oldManifoldCount = m_manifoldCount;
-		b3Manifold* oldManifolds = (b3Manifold*)stack->Allocate(oldManifoldCount * sizeof(b3Manifold));
-		memcpy(oldManifolds, m_manifolds, oldManifoldCount * sizeof(b3Manifold));
+		++b3_contactUpdates;
 
-		// Clear all contact points.
-		m_manifoldCount = 0;
-		for (u32 i = 0; i < m_manifoldCapacity; ++i)
-		{
-			m_manifolds[i].Initialize();
-		}
-
-		// Generate new contact points for the solver.
-		Collide();
+		b3Transform xf = b3MulT(xfA, xfB);
 
-		// Initialize the new built contact points for warm starting the solver.
-		if (world->m_warmStarting == true)
+		// The reused points keep their impulses so reuse requires warm starting.
+		if (world->m_contactReuse == true && world->m_warmStarting == true && CanReuseManifolds(xf) == true)
 		{
+			// The shapes barely moved relative to each other.
+			// Keep the contact points. They are stored in the body frames.
+			++b3_contactReuses;
+
 			for (u32 i = 0; i < m_manifoldCount; ++i)
 			{
-				b3Manifold* m2 = m_manifolds + i;
-				for (u32 j = 0; j < oldManifoldCount; ++j)
+				b3Manifold* m = m_manifolds + i;
+				for (u32 j = 0; j < m->pointCount; ++j)
 				{
-					const b3Manifold* m1 = oldManifolds + j;
-					m2->Initialize(*m1);
+					++m->points[j].persistCount;
 				}
 			}
 		}
+		else
+		{
+			// Copy the old contact points.
+			u32 oldManifoldCount = m_manifoldCount;
+			b3Manifold* oldManifolds = (b3Manifold*)allocator->Allocate(oldManifoldCount * sizeof(b3Manifold));
+			memcpy(oldManifolds, m_manifolds, oldManifoldCount * sizeof(b3Manifold));
+
+			// Clear all contact points.
+			m_manifoldCount = 0;
+			for (u32 i = 0; i < m_manifoldCapacity; ++i)
+			{
+				m_manifolds[i].Initialize();
+			}
+
+			m_speculativeDistance = ComputeSpeculativeDistance();
+
+			// Generate new contact points for the solver.
+			T* contact = static_cast<T*>(this);
+			b3CollideContact(contact, contact, allocator);
+
+			// Initialize the new built contact points for warm starting the solver.
+			if (world->m_warmStarting == true)
+			{
+				for (u32 i = 0; i < m_manifoldCount; ++i)
+				{
+					b3Manifold* m2 = m_manifolds + i;
+					for (u32 j = 0; j < oldManifoldCount; ++j)
+					{
+						const b3Manifold* m1 = oldManifolds + j;
+						m2->Initialize(*m1);
+					}
+				}
+			}
 
-		stack->Free(oldManifolds);
+			allocator->Free(oldManifolds);
+
+			m_xf = xf;
+			m_flags |= e_reuseFlag;
+		}
 
 		// The shapes are overlapping if at least one contact 
 		// point was built.
@@ -232,13 +412,6 @@ void b3Contact::Update(b3ContactListener* listener)
 		}
 	}
 
-	// Wake the bodies associated with the shapes if the contact has began.
-	if (isOverlapping != wasOverlapping)
-	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
-	}
-
 	// Update the contact state.
 	if (isOverlapping == true)
 	{
@@ -249,20 +422,43 @@ void b3Contact::Update(b3ContactListener* listener)
 		m_flags &= ~e_overlapFlag;
 	}
 
+	// Remember if the contact has began or ended for Report.
+	if (isOverlapping != wasOverlapping)
+	{
+		m_flags |= e_changedFlag;
+	}
+	else
+	{
+		m_flags &= ~e_changedFlag;
+	}
+}
+
+void b3Contact::Report(b3ContactListener* listener)
+{
+	bool isOverlapping = IsOverlapping();
+	bool hasChanged = (m_flags & e_changedFlag) != 0;
+
+	// Wake the bodies associated with the shapes if the contact has began or ended.
+	if (hasChanged)
+	{
+		m_pair.fixtureA->m_body->SetAwake(true);
+		m_pair.fixtureB->m_body->SetAwake(true);
+	}
+
 	// Notify the contact listener the new contact state.
 	if (listener != nullptr)
 	{
-		if (wasOverlapping == false && isOverlapping == true)
+		if (hasChanged == true && isOverlapping == true)
 		{
 			listener->BeginContact(this);
 		}
 
-		if (wasOverlapping == true && isOverlapping == false)
+		if (hasChanged == true && isOverlapping == false)
 		{
 			listener->EndContact(this);
 		}
 
-		if (isOverlapping == true && isDynamicContact == true && isSensorContact == false)
+		if (isOverlapping == true && HasDynamicBody() == true && IsSensorContact() == false)
 		{
 			listener->PreSolve(this);
 		}
@@ -274,6 +470,15 @@ bool b3Contact::IsSensorContact() const
 	return m_pair.fixtureA->IsSensor() || m_pair.fixtureB->IsSensor();
 }
 
+b3ConvexCache* b3Contact::SelectConvexCache(b3ConvexCache* cache) const
+{
+	if (m_pair.fixtureA->m_body->m_world->m_convexCache)
+	{
+		return cache;
+	}
+	return nullptr;
+}
+
 bool b3Contact::HasDynamicBody() const
 {
 	return m_pair.fixtureA->m_body->m_type == e_dynamicBody || m_pair.fixtureB->m_body->m_type == e_dynamicBody;
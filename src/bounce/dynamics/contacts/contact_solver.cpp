@@ -24,6 +24,9 @@
 
 // This solver implements PGS for solving velocity constraints and 
 // NGS for solving position constraints.
+// The sub-stepping solver uses soft contacts instead of NGS.
+// The split impulse solver pushes shapes apart with pseudo velocities instead of NGS.
+// "Solver2D", Erin Catto
 
 b3ContactSolver::b3ContactSolver(const b3ContactSolverDef* def)
 {
@@ -31,12 +34,19 @@ b3ContactSolver::b3ContactSolver(const b3ContactSolverDef* def)
 	m_count = def->count;
 	m_positions = def->positions;
 	m_velocities = def->velocities;
+	m_displacements = def->displacements;
+	m_pseudoVelocities = def->pseudoVelocities;
 	m_inertias = def->invInertias;
 	m_contacts = def->contacts;
 	m_positionConstraints = (b3ContactPositionConstraint*)m_allocator->Allocate(m_count * sizeof(b3ContactPositionConstraint));
 	m_velocityConstraints = (b3ContactVelocityConstraint*)m_allocator->Allocate(m_count * sizeof(b3ContactVelocityConstraint));
+	m_splitIndices = m_pseudoVelocities ? (u32*)m_allocator->Allocate(m_count * sizeof(u32)) : nullptr;
+	m_splitCount = 0;
 	m_dt = def->dt;
 	m_invDt = m_dt != scalar(0) ? scalar(1) / m_dt : scalar(0);
+	m_minSeparation = scalar(0);
+	m_blockSolve = def->blockSolve;
+	m_speculative = def->speculative;
 }
 
 b3ContactSolver::~b3ContactSolver()
@@ -62,12 +72,22 @@ b3ContactSolver::~b3ContactSolver()
 		m_allocator->Free(pc->manifolds);
 	}
 
+	if (m_splitIndices)
+	{
+		m_allocator->Free(m_splitIndices);
+	}
+
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
 
 void b3ContactSolver::InitializeConstraints()
 {
+	// Contacts against static or kinematic bodies are stiffer.
+	scalar contactHertz = b3Min(B3_CONTACT_HERTZ, scalar(0.25) * m_invDt);
+	b3Softness softness = b3MakeSoft(contactHertz, B3_CONTACT_DAMPING_RATIO, m_dt);
+	b3Softness staticSoftness = b3MakeSoft(scalar(2) * contactHertz, B3_CONTACT_DAMPING_RATIO, m_dt);
+
 	for (u32 i = 0; i < m_count; ++i)
 	{
 		b3Contact* c = m_contacts[i];
@@ -88,30 +108,31 @@ void b3ContactSolver::InitializeConstraints()
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
 		pc->indexA = bodyA->m_islandID;
-		pc->invMassA = bodyA->m_invMass;
-		pc->localInvIA = bodyA->m_invI;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
+		pc->invMassA = bodyA->InvMass();
+		pc->localInvIA = bodyA->InvInertia();
+		pc->localCenterA = bodyA->Sweep().localCenter;
 		pc->radiusA = shapeA->m_radius;
 
 		pc->indexB = bodyB->m_islandID;
-		pc->invMassB = bodyB->m_invMass;
-		pc->localInvIB = bodyB->m_invI;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
+		pc->invMassB = bodyB->InvMass();
+		pc->localInvIB = bodyB->InvInertia();
+		pc->localCenterB = bodyB->Sweep().localCenter;
 		pc->radiusB = shapeB->m_radius;
 
 		pc->manifoldCount = manifoldCount;
 		pc->manifolds = (b3PositionConstraintManifold*)m_allocator->Allocate(manifoldCount * sizeof(b3PositionConstraintManifold));
 
 		vc->indexA = bodyA->m_islandID;
-		vc->invMassA = bodyA->m_invMass;
+		vc->invMassA = bodyA->InvMass();
 		vc->invIA = m_inertias[vc->indexA];
 
 		vc->indexB = bodyB->m_islandID;
-		vc->invMassB = bodyB->m_invMass;
+		vc->invMassB = bodyB->InvMass();
 		vc->invIB = m_inertias[vc->indexB];
 
 		vc->friction = b3MixFriction(fixtureA->m_friction, fixtureB->m_friction);
 		vc->restitution = b3MixRestitution(fixtureA->m_restitution, fixtureB->m_restitution);
+		vc->softness = vc->invMassA == scalar(0) || vc->invMassB == scalar(0) ? staticSoftness : softness;
 
 		vc->manifoldCount = manifoldCount;
 		vc->manifolds = (b3VelocityConstraintManifold*)m_allocator->Allocate(manifoldCount * sizeof(b3VelocityConstraintManifold));
@@ -145,6 +166,9 @@ void b3ContactSolver::InitializeConstraints()
 				pcp->localPointB = cp->localPoint2;
 
 				vcp->normalImpulse = cp->normalImpulse;
+				vcp->maxNormalImpulse = scalar(0);
+				vcp->pseudoBias = scalar(0);
+				vcp->pseudoImpulse = scalar(0);
 			}
 		}
 	}
@@ -189,6 +213,8 @@ void b3ContactSolver::InitializeConstraints()
 		xfB.rotation = qB;
 		xfB.translation = xB - b3Mul(qB, localCenterB);
 
+		bool overlapping = false;
+
 		for (u32 j = 0; j < manifoldCount; ++j)
 		{
 			b3Manifold* m = c->m_manifolds + j;
@@ -217,6 +243,9 @@ void b3ContactSolver::InitializeConstraints()
 
 				vcp->rA = rA;
 				vcp->rB = rB;
+				vcp->separation = mp->separation;
+
+				m_minSeparation = b3Min(m_minSeparation, mp->separation);
 
 				// Add normal constraint.
 				{
@@ -232,10 +261,48 @@ void b3ContactSolver::InitializeConstraints()
 					b3Vec3 dv = vB + b3Cross(wB, rB) - vA - b3Cross(wA, rA);
 					scalar vn = b3Dot(normal, dv);
 					vcp->velocityBias = scalar(0);
-					if (vn < -B3_VELOCITY_THRESHOLD)
+					if (m_speculative && mp->separation > scalar(0))
+					{
+						// Speculative point. Allow the approach that closes the gap in this step.
+						vcp->velocityBias = -mp->separation * m_invDt;
+					}
+					else if (vn < -B3_VELOCITY_THRESHOLD)
 					{
 						vcp->velocityBias = -vc->restitution * vn;
 					}
+
+					// Allow some slop and prevent large corrections.
+					if (m_pseudoVelocities)
+					{
+						scalar C = b3Clamp(B3_SPLIT_IMPULSE_BAUMGARTE * (mp->separation + B3_SPLIT_IMPULSE_LINEAR_SLOP), -B3_MAX_LINEAR_CORRECTION, scalar(0));
+						vcp->pseudoBias = -C * m_invDt;
+						overlapping = overlapping || C < scalar(0);
+					}
+				}
+			}
+
+			// Add the coupled normal constraints for the block solver.
+			if (m_blockSolve && pointCount > 1)
+			{
+				vcm->activeSet = (1 << pointCount) - 1;
+
+				for (u32 k1 = 0; k1 < pointCount; ++k1)
+				{
+					b3VelocityConstraintPoint* vcp1 = vcm->points + k1;
+					b3Vec3 rnA1 = b3Cross(vcp1->rA, vcp1->normal);
+					b3Vec3 rnB1 = b3Cross(vcp1->rB, vcp1->normal);
+
+					for (u32 k2 = k1; k2 < pointCount; ++k2)
+					{
+						b3VelocityConstraintPoint* vcp2 = vcm->points + k2;
+						b3Vec3 rnA2 = b3Cross(vcp2->rA, vcp2->normal);
+						b3Vec3 rnB2 = b3Cross(vcp2->rB, vcp2->normal);
+
+						scalar K = (mA + mB) * b3Dot(vcp1->normal, vcp2->normal) + b3Dot(rnA1, iA * rnA2) + b3Dot(rnB1, iB * rnB2);
+
+						vcm->normalK[k1][k2] = K;
+						vcm->normalK[k2][k1] = K;
+					}
 				}
 			}
 
@@ -279,6 +346,11 @@ void b3ContactSolver::InitializeConstraints()
 				}
 			}
 		}
+
+		if (overlapping)
+		{
+			m_splitIndices[m_splitCount++] = i;
+		}
 	}
 }
 
@@ -342,8 +414,220 @@ void b3ContactSolver::WarmStart()
 	}
 }
 
-void b3ContactSolver::SolveVelocityConstraints()
+// The active sets of a manifold with up to four points, largest first. 
+static const u32 b3_activeSets[16] = 
+{
+	0xF, 
+	0x7, 0xB, 0xD, 0xE, 
+	0x3, 0x5, 0x6, 0x9, 0xA, 0xC, 
+	0x1, 0x2, 0x4, 0x8, 
+	0x0
+};
+
+// Find the impulses x >= 0 of a manifold such that the velocities w = K * x + b >= 0 
+// and x_i * w_i = 0, assuming the given points are active. 
+// Return false if the active set is ill-conditioned or doesn't give a valid solution.
+static bool b3SolveActiveSet(const scalar K[B3_MAX_MANIFOLD_POINTS][B3_MAX_MANIFOLD_POINTS], const scalar* b, u32 n, u32 set, scalar* x)
 {
+	// Gather the active points.
+	u32 indices[B3_MAX_MANIFOLD_POINTS];
+	u32 m = 0;
+	for (u32 i = 0; i < n; ++i)
+	{
+		x[i] = scalar(0);
+		if (set & (1 << i))
+		{
+			indices[m++] = i;
+		}
+	}
+
+	if (m > 0)
+	{
+		// Solve K_SS * x_S = -b_S using Gaussian elimination with partial pivoting.
+		scalar A[B3_MAX_MANIFOLD_POINTS][B3_MAX_MANIFOLD_POINTS + 1];
+		scalar maxDiagonal = scalar(0);
+		for (u32 i = 0; i < m; ++i)
+		{
+			for (u32 j = 0; j < m; ++j)
+			{
+				A[i][j] = K[indices[i]][indices[j]];
+			}
+			A[i][m] = -b[indices[i]];
+
+			maxDiagonal = b3Max(maxDiagonal, A[i][i]);
+		}
+
+		// Reject the active set if the matrix is ill-conditioned. 
+		// This is the case of four coplanar points, which only constrain three degrees of freedom.
+		const scalar kMaxCondition = scalar(1000);
+		scalar tolerance = maxDiagonal / kMaxCondition;
+
+		for (u32 i = 0; i < m; ++i)
+		{
+			u32 pivot = i;
+			for (u32 j = i + 1; j < m; ++j)
+			{
+				if (b3Abs(A[j][i]) > b3Abs(A[pivot][i]))
+				{
+					pivot = j;
+				}
+			}
+
+			if (b3Abs(A[pivot][i]) <= tolerance)
+			{
+				return false;
+			}
+
+			if (pivot != i)
+			{
+				for (u32 j = i; j <= m; ++j)
+				{
+					b3Swap(A[i][j], A[pivot][j]);
+				}
+			}
+
+			for (u32 j = i + 1; j < m; ++j)
+			{
+				scalar factor = A[j][i] / A[i][i];
+				for (u32 k = i; k <= m; ++k)
+				{
+					A[j][k] -= factor * A[i][k];
+				}
+			}
+		}
+
+		for (u32 index = m; index > 0; --index)
+		{
+			u32 i = index - 1;
+			
+			scalar sum = A[i][m];
+			for (u32 j = i + 1; j < m; ++j)
+			{
+				sum -= A[i][j] * x[indices[j]];
+			}
+
+			scalar xi = sum / A[i][i];
+			if (xi < scalar(0))
+			{
+				return false;
+			}
+
+			x[indices[i]] = xi;
+		}
+	}
+
+	// The inactive points must not approach.
+	// Coplanar points make K rank deficient so the velocity of a dependent
+	// point is only zero up to rounding. Compare against the magnitude of its terms.
+	const scalar kVelocityTolerance = scalar(1.0e-4);
+	for (u32 i = 0; i < n; ++i)
+	{
+		if (set & (1 << i))
+		{
+			continue;
+		}
+
+		scalar w = b[i];
+		scalar magnitude = b3Abs(b[i]);
+		for (u32 j = 0; j < n; ++j)
+		{
+			w += K[i][j] * x[j];
+			magnitude += b3Abs(K[i][j] * x[j]);
+		}
+
+		if (w < -kVelocityTolerance * magnitude)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Solve the normal constraints of a manifold together by total enumeration of the active sets.
+// "Iterative Dynamics with Temporal Coherence", Erin Catto
+// Return false if no active set gives a valid solution.
+static bool b3SolveNormalBlock(b3VelocityConstraintManifold* vcm, 
+	scalar mA, const b3Mat33& iA, b3Vec3& vA, b3Vec3& wA,
+	scalar mB, const b3Mat33& iB, b3Vec3& vB, b3Vec3& wB, 
+	scalar& maxImpulseDelta)
+{
+	u32 n = vcm->pointCount;
+
+	// The accumulated impulses
+	scalar a[B3_MAX_MANIFOLD_POINTS];
+
+	// The velocities at the points if the accumulated impulses were removed
+	scalar b[B3_MAX_MANIFOLD_POINTS];
+
+	for (u32 i = 0; i < n; ++i)
+	{
+		b3VelocityConstraintPoint* vcp = vcm->points + i;
+		B3_ASSERT(vcp->normalImpulse >= scalar(0));
+
+		b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+		
+		a[i] = vcp->normalImpulse;
+		b[i] = b3Dot(vcp->normal, dv) - vcp->velocityBias;
+	}
+
+	for (u32 i = 0; i < n; ++i)
+	{
+		for (u32 j = 0; j < n; ++j)
+		{
+			b[i] -= vcm->normalK[i][j] * a[j];
+		}
+	}
+
+	scalar x[B3_MAX_MANIFOLD_POINTS];
+	
+	// The active set changes rarely between iterations, so try the last one first.
+	bool solved = b3SolveActiveSet(vcm->normalK, b, n, vcm->activeSet, x);
+	for (u32 i = 0; i < 16 && solved == false; ++i)
+	{
+		u32 set = b3_activeSets[i];
+		if ((set >> n) || set == vcm->activeSet)
+		{
+			continue;
+		}
+
+		if (b3SolveActiveSet(vcm->normalK, b, n, set, x))
+		{
+			vcm->activeSet = set;
+			solved = true;
+		}
+	}
+
+	if (solved == false)
+	{
+		return false;
+	}
+
+	for (u32 i = 0; i < n; ++i)
+	{
+		b3VelocityConstraintPoint* vcp = vcm->points + i;
+
+		scalar impulse = x[i] - a[i];
+		vcp->normalImpulse = x[i];
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
+
+		b3Vec3 P = impulse * vcp->normal;
+
+		vA -= mA * P;
+		wA -= iA * b3Cross(vcp->rA, P);
+
+		vB += mB * P;
+		wB += iB * b3Cross(vcp->rB, P);
+	}
+
+	return true;
+}
+
+scalar b3ContactSolver::SolveVelocityConstraints()
+{
+	scalar maxImpulseDelta = scalar(0);
+
 	for (u32 i = 0; i < m_count; ++i)
 	{
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -372,31 +656,44 @@ void b3ContactSolver::SolveVelocityConstraints()
 			scalar tangentSpeed2 = vcm->tangentSpeed2;
 
 			scalar normalImpulse = scalar(0);
-			for (u32 k = 0; k < pointCount; ++k)
+			if (m_blockSolve && pointCount > 1 && 
+				b3SolveNormalBlock(vcm, mA, iA, vA, wA, mB, iB, vB, wB, maxImpulseDelta))
 			{
-				b3VelocityConstraintPoint* vcp = vcm->points + k;
-				B3_ASSERT(vcp->normalImpulse >= scalar(0));
-
-				// Solve normal constraints.
+				for (u32 k = 0; k < pointCount; ++k)
 				{
-					b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
-					scalar Cdot = b3Dot(vcp->normal, dv);
+					normalImpulse += vcm->points[k].normalImpulse;
+				}
+			}
+			else
+			{
+				for (u32 k = 0; k < pointCount; ++k)
+				{
+					b3VelocityConstraintPoint* vcp = vcm->points + k;
+					B3_ASSERT(vcp->normalImpulse >= scalar(0));
 
-					scalar impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
+					// Solve normal constraints.
+					{
+						b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+						scalar Cdot = b3Dot(vcp->normal, dv);
 
-					scalar oldImpulse = vcp->normalImpulse;
-					vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, scalar(0));
-					impulse = vcp->normalImpulse - oldImpulse;
+						scalar impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
 
-					b3Vec3 P = impulse * vcp->normal;
+						scalar oldImpulse = vcp->normalImpulse;
+						vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, scalar(0));
+						impulse = vcp->normalImpulse - oldImpulse;
 
-					vA -= mA * P;
-					wA -= iA * b3Cross(vcp->rA, P);
+						maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 
-					vB += mB * P;
-					wB += iB * b3Cross(vcp->rB, P);
+						b3Vec3 P = impulse * vcp->normal;
 
-					normalImpulse += vcp->normalImpulse;
+						vA -= mA * P;
+						wA -= iA * b3Cross(vcp->rA, P);
+
+						vB += mB * P;
+						wB += iB * b3Cross(vcp->rB, P);
+
+						normalImpulse += vcp->normalImpulse;
+					}
 				}
 			}
 			
@@ -423,6 +720,8 @@ void b3ContactSolver::SolveVelocityConstraints()
 					
 					impulse = vcm->tangentImpulse - oldImpulse;
 
+					maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
+
 					b3Vec3 P1 = impulse.x * vcm->tangent1;
 					b3Vec3 P2 = impulse.y * vcm->tangent2;
 					b3Vec3 P = P1 + P2;
@@ -443,6 +742,8 @@ void b3ContactSolver::SolveVelocityConstraints()
 					vcm->motorImpulse = b3Clamp(vcm->motorImpulse + impulse, -maxImpulse, maxImpulse);
 					impulse = vcm->motorImpulse - oldImpulse;
 
+					maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
+
 					b3Vec3 P = impulse * vcm->normal;
 
 					wA -= iA * P;
@@ -456,6 +757,8 @@ void b3ContactSolver::SolveVelocityConstraints()
 		m_velocities[indexB].v = vB;
 		m_velocities[indexB].w = wB;
 	}
+
+	return maxImpulseDelta;
 }
 
 void b3ContactSolver::StoreImpulses()
@@ -595,3 +898,292 @@ bool b3ContactSolver::SolvePositionConstraints()
 
 	return minSeparation >= scalar(-3) * B3_LINEAR_SLOP;
 }
+
+scalar b3ContactSolver::SolveSplitImpulses()
+{
+	B3_ASSERT(m_pseudoVelocities != nullptr);
+
+	scalar maxImpulseDelta = scalar(0);
+
+	// Only the contacts with overlaps beyond the slop are solved.
+	for (u32 i = 0; i < m_splitCount; ++i)
+	{
+		b3ContactVelocityConstraint* vc = m_velocityConstraints + m_splitIndices[i];
+		u32 manifoldCount = vc->manifoldCount;
+
+		u32 indexA = vc->indexA;
+		scalar mA = vc->invMassA;
+		b3Mat33 iA = vc->invIA;
+
+		u32 indexB = vc->indexB;
+		scalar mB = vc->invMassB;
+		b3Mat33 iB = vc->invIB;
+
+		b3Vec3 vA = m_pseudoVelocities[indexA].v;
+		b3Vec3 wA = m_pseudoVelocities[indexA].w;
+		b3Vec3 vB = m_pseudoVelocities[indexB].v;
+		b3Vec3 wB = m_pseudoVelocities[indexB].w;
+
+		for (u32 j = 0; j < manifoldCount; ++j)
+		{
+			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+			u32 pointCount = vcm->pointCount;
+
+			for (u32 k = 0; k < pointCount; ++k)
+			{
+				b3VelocityConstraintPoint* vcp = vcm->points + k;
+				if (vcp->pseudoBias == scalar(0))
+				{
+					continue;
+				}
+
+				b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+				scalar Cdot = b3Dot(vcp->normal, dv);
+
+				scalar impulse = -vcp->normalMass * (Cdot - vcp->pseudoBias);
+
+				scalar oldImpulse = vcp->pseudoImpulse;
+				vcp->pseudoImpulse = b3Max(vcp->pseudoImpulse + impulse, scalar(0));
+				impulse = vcp->pseudoImpulse - oldImpulse;
+
+				maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
+
+				b3Vec3 P = impulse * vcp->normal;
+
+				vA -= mA * P;
+				wA -= iA * b3Cross(vcp->rA, P);
+
+				vB += mB * P;
+				wB += iB * b3Cross(vcp->rB, P);
+			}
+		}
+
+		m_pseudoVelocities[indexA].v = vA;
+		m_pseudoVelocities[indexA].w = wA;
+		m_pseudoVelocities[indexB].v = vB;
+		m_pseudoVelocities[indexB].w = wB;
+	}
+
+	return maxImpulseDelta;
+}
+
+bool b3ContactSolver::IsOverlapSolved() const
+{
+	return m_minSeparation >= scalar(-3) * B3_LINEAR_SLOP;
+}
+
+void b3ContactSolver::SolveSoftConstraints(bool useBias)
+{
+	B3_ASSERT(m_displacements != nullptr);
+
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		u32 manifoldCount = vc->manifoldCount;
+
+		u32 indexA = vc->indexA;
+		scalar mA = vc->invMassA;
+		b3Mat33 iA = vc->invIA;
+
+		u32 indexB = vc->indexB;
+		scalar mB = vc->invMassB;
+		b3Mat33 iB = vc->invIB;
+
+		b3Vec3 vA = m_velocities[indexA].v;
+		b3Vec3 wA = m_velocities[indexA].w;
+		b3Vec3 vB = m_velocities[indexB].v;
+		b3Vec3 wB = m_velocities[indexB].w;
+
+		b3Vec3 dpA = m_displacements[indexA].linear;
+		b3Vec3 dqA = m_displacements[indexA].angular;
+		b3Vec3 dpB = m_displacements[indexB].linear;
+		b3Vec3 dqB = m_displacements[indexB].angular;
+
+		b3Softness softness = vc->softness;
+
+		for (u32 j = 0; j < manifoldCount; ++j)
+		{
+			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+			u32 pointCount = vcm->pointCount;
+
+			scalar motorSpeed = vcm->motorSpeed;
+			scalar tangentSpeed1 = vcm->tangentSpeed1;
+			scalar tangentSpeed2 = vcm->tangentSpeed2;
+
+			scalar normalImpulse = scalar(0);
+			for (u32 k = 0; k < pointCount; ++k)
+			{
+				b3VelocityConstraintPoint* vcp = vcm->points + k;
+				B3_ASSERT(vcp->normalImpulse >= scalar(0));
+
+				// Solve normal constraints.
+				{
+					b3Vec3 normal = vcp->normal;
+					b3Vec3 rnA = b3Cross(vcp->rA, normal);
+					b3Vec3 rnB = b3Cross(vcp->rB, normal);
+
+					// Update the separation using the linearized body displacements.
+					scalar s = vcp->separation + b3Dot(normal, dpB - dpA) + b3Dot(rnB, dqB) - b3Dot(rnA, dqA);
+
+					scalar bias = scalar(0);
+					scalar massScale = scalar(1);
+					scalar impulseScale = scalar(0);
+					if (s > scalar(0))
+					{
+						// Speculative contact.
+						bias = s * m_invDt;
+					}
+					else if (useBias)
+					{
+						bias = b3Max(softness.biasRate * s, -B3_MAX_CONTACT_PUSH_SPEED);
+						massScale = softness.massScale;
+						impulseScale = softness.impulseScale;
+					}
+
+					b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+					scalar Cdot = b3Dot(normal, dv);
+
+					scalar impulse = -vcp->normalMass * massScale * (Cdot + bias) - impulseScale * vcp->normalImpulse;
+
+					scalar oldImpulse = vcp->normalImpulse;
+					vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, scalar(0));
+					impulse = vcp->normalImpulse - oldImpulse;
+
+					vcp->maxNormalImpulse = b3Max(vcp->maxNormalImpulse, impulse);
+
+					b3Vec3 P = impulse * normal;
+
+					vA -= mA * P;
+					wA -= iA * b3Cross(vcp->rA, P);
+
+					vB += mB * P;
+					wB += iB * b3Cross(vcp->rB, P);
+
+					normalImpulse += vcp->normalImpulse;
+				}
+			}
+
+			if (pointCount > 0)
+			{
+				// Solve tangent constraints.
+				{
+					b3Vec3 dv = vB + b3Cross(wB, vcm->rB) - vA - b3Cross(wA, vcm->rA);
+
+					b3Vec2 Cdot;
+					Cdot.x = b3Dot(dv, vcm->tangent1) - tangentSpeed1;
+					Cdot.y = b3Dot(dv, vcm->tangent2) - tangentSpeed2;
+
+					b3Vec2 impulse = vcm->tangentMass * -Cdot;
+					b3Vec2 oldImpulse = vcm->tangentImpulse;
+					vcm->tangentImpulse += impulse;
+
+					scalar maxImpulse = vc->friction * normalImpulse;
+					if (b3Dot(vcm->tangentImpulse, vcm->tangentImpulse) > maxImpulse * maxImpulse)
+					{
+						vcm->tangentImpulse.Normalize();
+						vcm->tangentImpulse *= maxImpulse;
+					}
+
+					impulse = vcm->tangentImpulse - oldImpulse;
+
+					b3Vec3 P1 = impulse.x * vcm->tangent1;
+					b3Vec3 P2 = impulse.y * vcm->tangent2;
+					b3Vec3 P = P1 + P2;
+
+					vA -= mA * P;
+					wA -= iA * b3Cross(vcm->rA, P);
+
+					vB += mB * P;
+					wB += iB * b3Cross(vcm->rB, P);
+				}
+
+				// Solve motor constraint.
+				{
+					scalar Cdot = b3Dot(vcm->normal, wB - wA) - motorSpeed;
+					scalar impulse = -vcm->motorMass * Cdot;
+					scalar oldImpulse = vcm->motorImpulse;
+					scalar maxImpulse = vc->friction * normalImpulse;
+					vcm->motorImpulse = b3Clamp(vcm->motorImpulse + impulse, -maxImpulse, maxImpulse);
+					impulse = vcm->motorImpulse - oldImpulse;
+
+					b3Vec3 P = impulse * vcm->normal;
+
+					wA -= iA * P;
+					wB += iB * P;
+				}
+			}
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
+void b3ContactSolver::ApplyRestitution()
+{
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		if (vc->restitution == scalar(0))
+		{
+			continue;
+		}
+
+		u32 manifoldCount = vc->manifoldCount;
+
+		u32 indexA = vc->indexA;
+		scalar mA = vc->invMassA;
+		b3Mat33 iA = vc->invIA;
+
+		u32 indexB = vc->indexB;
+		scalar mB = vc->invMassB;
+		b3Mat33 iB = vc->invIB;
+
+		b3Vec3 vA = m_velocities[indexA].v;
+		b3Vec3 wA = m_velocities[indexA].w;
+		b3Vec3 vB = m_velocities[indexB].v;
+		b3Vec3 wB = m_velocities[indexB].w;
+
+		for (u32 j = 0; j < manifoldCount; ++j)
+		{
+			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+			u32 pointCount = vcm->pointCount;
+
+			for (u32 k = 0; k < pointCount; ++k)
+			{
+				b3VelocityConstraintPoint* vcp = vcm->points + k;
+
+				// Only bounce if the points were approaching and pushed apart.
+				// Speculative points don't bounce.
+				if (vcp->velocityBias <= scalar(0) || vcp->maxNormalImpulse == scalar(0))
+				{
+					continue;
+				}
+
+				b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+				scalar Cdot = b3Dot(vcp->normal, dv);
+
+				scalar impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
+
+				scalar oldImpulse = vcp->normalImpulse;
+				vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, scalar(0));
+				impulse = vcp->normalImpulse - oldImpulse;
+
+				b3Vec3 P = impulse * vcp->normal;
+
+				vA -= mA * P;
+				wA -= iA * b3Cross(vcp->rA, P);
+
+				vB += mB * P;
+				wB += iB * b3Cross(vcp->rB, P);
+			}
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
@@ -46,12 +46,25 @@ bool b3ConvexContact::TestOverlap()
 	return b3TestOverlap(xfA, 0, shapeA, xfB, 0, shapeB, &m_cache);
 }
 
-void b3ConvexContact::Collide() 
+void b3ConvexContact::Collide(b3StackAllocator* allocator) 
 {
+	B3_NOT_USED(allocator);
+
 	b3Transform xfA = GetFixtureA()->GetBody()->GetTransform();
 	b3Transform xfB = GetFixtureB()->GetBody()->GetTransform();
 
 	B3_ASSERT(m_manifoldCount == 0);
 	Evaluate(m_manifold, xfA, xfB);
 	m_manifoldCount = 1;
-}
\ No newline at end of file
+}
+void b3ConvexContact::SaveState(b3StateBuffer* buffer) const
+{
+	b3Contact::SaveState(buffer);
+	buffer->Write(m_cache);
+}
+
+void b3ConvexContact::RestoreState(b3StateBuffer* buffer)
+{
+	b3Contact::RestoreState(buffer);
+	buffer->Read(m_cache);
+}
@@ -0,0 +1,338 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/contacts/height_field_contact.h>
+#include <bounce/dynamics/fixture.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
+#include <bounce/collision/shapes/triangle_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/geometry/height_field.h>
+
+b3HeightFieldContact::b3HeightFieldContact(b3Fixture* fixtureA, b3Fixture* fixtureB) : b3Contact(fixtureA, fixtureB)
+{
+	m_manifoldCapacity = B3_MAX_MANIFOLDS;
+	m_manifolds = m_clusterManifolds;
+	m_manifoldCount = 0;
+	
+	b3Transform xfA = fixtureA->GetBody()->GetTransform();
+	b3Transform xfB = fixtureB->GetBody()->GetTransform();
+
+	b3Transform xf = b3MulT(xfA, xfB);
+
+	// The aabb B relative to the height field frame.
+	b3AABB fatAABB;
+	fixtureB->GetShape()->ComputeAABB(&fatAABB, xf);
+
+	B3_ASSERT(fixtureA->GetType() == b3Shape::e_heightField);
+
+	b3HeightFieldShape* heightFieldShapeA = (b3HeightFieldShape*)fixtureA->m_shape;
+
+	B3_ASSERT(heightFieldShapeA->m_scale.x > scalar(0));
+	B3_ASSERT(heightFieldShapeA->m_scale.y > scalar(0));
+	B3_ASSERT(heightFieldShapeA->m_scale.z > scalar(0));
+
+	b3Vec3 inv_scale;
+	inv_scale.x = scalar(1) / heightFieldShapeA->m_scale.x;
+	inv_scale.y = scalar(1) / heightFieldShapeA->m_scale.y;
+	inv_scale.z = scalar(1) / heightFieldShapeA->m_scale.z;
+
+	fatAABB.Scale(inv_scale);
+
+	fatAABB.Extend(B3_AABB_EXTENSION);
+
+	m_aabbB = fatAABB;
+
+	if (fixtureB->GetBody()->GetWorld()->m_speculativeContacts)
+	{
+		// Include the motion predicted for the next step.
+		SynchronizeFixture();
+	}
+
+	m_aabbBMoved = true;
+
+	// Pre-allocate some indices
+	m_triangleCapacity = 16;
+	m_triangles = (b3TriangleCache*)b3Alloc(m_triangleCapacity * sizeof(b3TriangleCache));
+	m_triangleCount = 0;
+
+	m_clusterCache.centroidCount = 0;
+	m_clusterCache.key = 0;
+	m_clusterCache.keyCount = 0;
+}
+
+b3HeightFieldContact::~b3HeightFieldContact()
+{
+	b3Free(m_triangles);
+}
+
+void b3HeightFieldContact::SynchronizeFixture()
+{
+	b3Fixture* fixtureA = GetFixtureA();
+	b3Shape* shapeA = fixtureA->GetShape();
+	b3Body* bodyA = fixtureA->GetBody();
+	b3Transform xfA = bodyA->GetTransform();
+
+	b3Fixture* fixtureB = GetFixtureB();
+	b3Shape* shapeB = fixtureB->GetShape();
+	b3Body* bodyB = fixtureB->GetBody();
+	b3Transform xfB = bodyB->GetTransform();
+
+	b3Sweep* sweepB = &bodyB->Sweep();
+	b3Transform xfB0;
+	xfB0.translation = sweepB->worldCenter0;
+	xfB0.rotation = sweepB->orientation0;
+
+	// Calculate the displacement of body B using its position at the last 
+	// time step and the current position.
+	b3Vec3 displacement = xfB.translation - xfB0.translation;
+
+	// Compute the AABB B in the reference frame of the height field.
+	b3Transform xf = b3MulT(xfA, xfB);
+
+	b3AABB aabbB;
+	shapeB->ComputeAABB(&aabbB, xf);
+
+	b3HeightFieldShape* heightFieldShapeA = (b3HeightFieldShape*)shapeA;
+
+	B3_ASSERT(heightFieldShapeA->m_scale.x > scalar(0));
+	B3_ASSERT(heightFieldShapeA->m_scale.y > scalar(0));
+	B3_ASSERT(heightFieldShapeA->m_scale.z > scalar(0));
+
+	b3Vec3 inv_scale;
+	inv_scale.x = scalar(1) / heightFieldShapeA->m_scale.x;
+	inv_scale.y = scalar(1) / heightFieldShapeA->m_scale.y;
+	inv_scale.z = scalar(1) / heightFieldShapeA->m_scale.z;
+
+	aabbB.Scale(inv_scale);
+
+	if (bodyB->GetWorld()->m_speculativeContacts)
+	{
+		// Include the motion predicted for the next step.
+		b3AABB aabbB2 = aabbB;
+		aabbB2.Translate(b3Mul(inv_scale, b3MulC(xfA.rotation, displacement)));
+		aabbB.Combine(aabbB2);
+	}
+
+	// Update the AABB with the new (transformed) AABB and buffer move.
+	m_aabbBMoved = MoveAABB(aabbB, displacement);
+}
+
+bool b3HeightFieldContact::MoveAABB(const b3AABB& aabb, const b3Vec3& displacement)
+{
+	// Do nothing if the new AABB is contained in the old AABB.
+	if (m_aabbB.Contains(aabb))
+	{
+		// Do nothing if the new AABB is contained in the old AABB.
+		return false;
+	}
+
+	// Update the AABB with a fat and motion predicted AABB.
+
+	// Extend the new (original) AABB.
+	b3AABB fatAABB = aabb;
+	fatAABB.Extend(B3_AABB_EXTENSION);
+
+	if (displacement.x < scalar(0))
+	{
+		fatAABB.lowerBound.x += B3_AABB_MULTIPLIER * displacement.x;
+	}
+	else
+	{
+		fatAABB.upperBound.x += B3_AABB_MULTIPLIER * displacement.x;
+	}
+
+	if (displacement.y < scalar(0))
+	{
+		fatAABB.lowerBound.y += B3_AABB_MULTIPLIER * displacement.y;
+	}
+	else
+	{
+		fatAABB.upperBound.y += B3_AABB_MULTIPLIER * displacement.y;
+	}
+
+	if (displacement.z < scalar(0))
+	{
+		fatAABB.lowerBound.z += B3_AABB_MULTIPLIER * displacement.z;
+	}
+	else
+	{
+		fatAABB.upperBound.z += B3_AABB_MULTIPLIER * displacement.z;
+	}
+
+	// Update proxy with the extented AABB.
+	m_aabbB = fatAABB;
+
+	// Notify the proxy has moved.
+	return true;
+}
+
+void b3HeightFieldContact::FindPairs()
+{
+	// Reuse the overlapping buffer if the AABB didn't move
+	// significantly.
+	if (m_aabbBMoved == false)
+	{
+		return;
+	}
+
+	// Clear the index cache.
+	m_triangleCount = 0;
+
+	const b3HeightFieldShape* heightFieldShapeA = (b3HeightFieldShape*)GetFixtureA()->GetShape();
+	const b3HeightField* heightFieldA = heightFieldShapeA->m_heightField;
+
+	// Query the grid cells and update the overlapping buffer.
+	heightFieldA->QueryAABB(this, m_aabbB);
+}
+
+bool b3HeightFieldContact::Report(u32 triangleIndex)
+{
+	// Add the triangle to the overlapping buffer.
+	if (m_triangleCount == m_triangleCapacity)
+	{
+		b3TriangleCache* oldElements = m_triangles;
+		m_triangleCapacity *= 2;
+		m_triangles = (b3TriangleCache*)b3Alloc(m_triangleCapacity * sizeof(b3TriangleCache));
+		memcpy(m_triangles, oldElements, m_triangleCount * sizeof(b3TriangleCache));
+		b3Free(oldElements);
+	}
+
+	B3_ASSERT(m_triangleCount < m_triangleCapacity);
+
+	b3TriangleCache* cache = m_triangles + m_triangleCount;
+	cache->index = triangleIndex;
+	cache->cache.simplexCache.count = 0;
+	cache->cache.featureCache.featurePair.state = b3SATCacheType::e_empty;
+
+	++m_triangleCount;
+
+	// Keep looking for triangles.
+	return true;
+}
+
+bool b3HeightFieldContact::TestOverlap()
+{
+	b3Fixture* fixtureA = GetFixtureA();
+	b3Shape* shapeA = fixtureA->GetShape();
+	b3Body* bodyA = fixtureA->GetBody();
+	b3Transform xfA = bodyA->GetTransform();
+
+	b3Fixture* fixtureB = GetFixtureB();
+	b3Shape* shapeB = fixtureB->GetShape();
+	b3Body* bodyB = fixtureB->GetBody();
+	b3Transform xfB = bodyB->GetTransform();
+
+	// Test if at least one triangle of the shape B overlaps the shape A.
+	for (u32 i = 0; i < m_triangleCount; ++i)
+	{
+		b3TriangleCache* cache = m_triangles + i;
+		u32 indexA = cache->index;
+		bool overlap = b3TestOverlap(xfA, indexA, shapeA, xfB, 0, shapeB, &cache->cache);
+		if (overlap == true)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void b3HeightFieldContact::Collide(b3StackAllocator* allocator)
+{
+	b3Fixture* fixtureA = GetFixtureA();
+	b3Shape* shapeA = fixtureA->GetShape();
+	b3Body* bodyA = fixtureA->GetBody();
+	b3Transform xfA = bodyA->GetTransform();
+
+	b3Fixture* fixtureB = GetFixtureB();
+	b3Shape* shapeB = fixtureB->GetShape();
+	b3Body* bodyB = fixtureB->GetBody();
+	b3Transform xfB = bodyB->GetTransform();
+
+	// Create one temporary manifold per overlapping triangle.
+	b3Manifold* manifolds = (b3Manifold*)allocator->Allocate(m_triangleCount * sizeof(b3Manifold));
+	u32 manifoldCount = 0;
+
+	for (u32 i = 0; i < m_triangleCount; ++i)
+	{
+		b3Manifold* manifold = manifolds + manifoldCount;
+		manifold->Initialize();
+
+		Evaluate(*manifold, xfA, xfB, i);
+
+		if (manifold->pointCount == 0 && m_speculativeDistance > scalar(0))
+		{
+			b3TriangleShape triangle;
+			((b3HeightFieldShape*)shapeA)->GetChildTriangle(&triangle, m_triangles[i].index);
+			b3CollideSpeculative(*manifold, xfA, &triangle, xfB, shapeB, m_speculativeDistance);
+		}
+
+		for (u32 j = 0; j < manifold->pointCount; ++j)
+		{
+			manifold->points[j].key.triangleKey = m_triangles[i].index;
+		}
+
+		++manifoldCount;
+	}
+
+	B3_ASSERT(m_manifoldCount == 0);
+
+	// Perform clustering. 
+	b3ClusterSolver cluster;
+	cluster.Run(m_clusterManifolds, m_manifoldCount, manifolds, manifoldCount, xfA, shapeA->m_radius, xfB, shapeB->m_radius, &m_clusterCache);
+
+	allocator->Free(manifolds);
+}
+void b3HeightFieldContact::GetCacheStats(u32* count, u32* size) const
+{
+	*count = m_triangleCount;
+	*size = m_triangleCapacity * sizeof(b3TriangleCache);
+}
+
+void b3HeightFieldContact::SaveState(b3StateBuffer* buffer) const
+{
+	b3Contact::SaveState(buffer);
+	buffer->Write(m_aabbBMoved);
+	buffer->Write(m_aabbB);
+	buffer->Write(m_triangleCount);
+	buffer->Write(m_triangles, m_triangleCount * sizeof(b3TriangleCache));
+	buffer->Write(m_clusterCache);
+}
+
+void b3HeightFieldContact::RestoreState(b3StateBuffer* buffer)
+{
+	b3Contact::RestoreState(buffer);
+	buffer->Read(m_aabbBMoved);
+	buffer->Read(m_aabbB);
+	buffer->Read(m_triangleCount);
+	
+	if (m_triangleCount > m_triangleCapacity)
+	{
+		while (m_triangleCapacity < m_triangleCount)
+		{
+			m_triangleCapacity *= 2;
+		}
+
+		b3Free(m_triangles);
+		m_triangles = (b3TriangleCache*)b3Alloc(m_triangleCapacity * sizeof(b3TriangleCache));
+	}
+
+	buffer->Read(m_triangles, m_triangleCount * sizeof(b3TriangleCache));
+	buffer->Read(m_clusterCache);
+}
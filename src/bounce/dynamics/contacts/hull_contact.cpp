@@ -43,5 +43,5 @@ void b3HullContact::Evaluate(b3Manifold& manifold, const b3Transform& xfA, const
 	b3Transform xf0A = GetFixtureA()->GetBody()->GetSweep().GetTransform(scalar(0));
 	b3Transform xf0B = GetFixtureB()->GetBody()->GetSweep().GetTransform(scalar(0));
 
-	b3CollideHullAndHull(m_manifold, xfA, (b3HullShape*)GetFixtureA()->GetShape(), xfB, (b3HullShape*)GetFixtureB()->GetShape(), &m_cache, xf0A, xf0B);
+	b3CollideHullAndHull(m_manifold, xfA, (b3HullShape*)GetFixtureA()->GetShape(), xfB, (b3HullShape*)GetFixtureB()->GetShape(), SelectConvexCache(&m_cache), xf0A, xf0B);
 }
\ No newline at end of file
@@ -20,9 +20,9 @@
 #include <bounce/dynamics/fixture.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world.h>
+#include <bounce/collision/shapes/triangle_shape.h>
 #include <bounce/collision/shapes/mesh_shape.h>
 #include <bounce/collision/geometry/mesh.h>
-#include <bounce/collision/collide/cluster.h>
 
 b3MeshContact::b3MeshContact(b3Fixture* fixtureA, b3Fixture* fixtureB) : b3Contact(fixtureA, fixtureB)
 {
@@ -57,12 +57,23 @@ b3MeshContact::b3MeshContact(b3Fixture* fixtureA, b3Fixture* fixtureB) : b3Conta
 	fatAABB.Extend(B3_AABB_EXTENSION);
 
 	m_aabbB = fatAABB;
+
+	if (fixtureB->GetBody()->GetWorld()->m_speculativeContacts)
+	{
+		// Include the motion predicted for the next step.
+		SynchronizeFixture();
+	}
+
 	m_aabbBMoved = true;
 
 	// Pre-allocate some indices
 	m_triangleCapacity = 16;
 	m_triangles = (b3TriangleCache*)b3Alloc(m_triangleCapacity * sizeof(b3TriangleCache));
 	m_triangleCount = 0;
+
+	m_clusterCache.centroidCount = 0;
+	m_clusterCache.key = 0;
+	m_clusterCache.keyCount = 0;
 }
 
 b3MeshContact::~b3MeshContact()
@@ -82,7 +93,7 @@ void b3MeshContact::SynchronizeFixture()
 	b3Body* bodyB = fixtureB->GetBody();
 	b3Transform xfB = bodyB->GetTransform();
 
-	b3Sweep* sweepB = &bodyB->m_sweep;
+	b3Sweep* sweepB = &bodyB->Sweep();
 	b3Transform xfB0;
 	xfB0.translation = sweepB->worldCenter0;
 	xfB0.rotation = sweepB->orientation0;
@@ -110,6 +121,14 @@ void b3MeshContact::SynchronizeFixture()
 
 	aabbB.Scale(inv_scale);
 
+	if (bodyB->GetWorld()->m_speculativeContacts)
+	{
+		// Include the motion predicted for the next step.
+		b3AABB aabbB2 = aabbB;
+		aabbB2.Translate(b3Mul(inv_scale, b3MulC(xfA.rotation, displacement)));
+		aabbB.Combine(aabbB2);
+	}
+
 	// Update the AABB with the new (transformed) AABB and buffer move.
 	m_aabbBMoved = MoveAABB(aabbB, displacement);
 }
@@ -241,7 +260,7 @@ bool b3MeshContact::TestOverlap()
 	return false;
 }
 
-void b3MeshContact::Collide()
+void b3MeshContact::Collide(b3StackAllocator* allocator)
 {
 	b3Fixture* fixtureA = GetFixtureA();
 	b3Shape* shapeA = fixtureA->GetShape();
@@ -253,8 +272,6 @@ void b3MeshContact::Collide()
 	b3Body* bodyB = fixtureB->GetBody();
 	b3Transform xfB = bodyB->GetTransform();
 
-	b3StackAllocator* allocator = &bodyA->m_world->m_stackAllocator;
-
 	// Create one temporary manifold per overlapping triangle.
 	b3Manifold* manifolds = (b3Manifold*)allocator->Allocate(m_triangleCount * sizeof(b3Manifold));
 	u32 manifoldCount = 0;
@@ -266,6 +283,13 @@ void b3MeshContact::Collide()
 
 		Evaluate(*manifold, xfA, xfB, i);
 
+		if (manifold->pointCount == 0 && m_speculativeDistance > scalar(0))
+		{
+			b3TriangleShape triangle;
+			((b3MeshShape*)shapeA)->GetChildTriangle(&triangle, m_triangles[i].index);
+			b3CollideSpeculative(*manifold, xfA, &triangle, xfB, shapeB, m_speculativeDistance);
+		}
+
 		for (u32 j = 0; j < manifold->pointCount; ++j)
 		{
 			manifold->points[j].key.triangleKey = m_triangles[i].index;
@@ -278,7 +302,44 @@ void b3MeshContact::Collide()
 
 	// Perform clustering. 
 	b3ClusterSolver cluster;
-	cluster.Run(m_clusterManifolds, m_manifoldCount, manifolds, manifoldCount, xfA, shapeA->m_radius, xfB, shapeB->m_radius);
+	cluster.Run(m_clusterManifolds, m_manifoldCount, manifolds, manifoldCount, xfA, shapeA->m_radius, xfB, shapeB->m_radius, &m_clusterCache);
 
 	allocator->Free(manifolds);
-}
\ No newline at end of file
+}
+void b3MeshContact::GetCacheStats(u32* count, u32* size) const
+{
+	*count = m_triangleCount;
+	*size = m_triangleCapacity * sizeof(b3TriangleCache);
+}
+
+void b3MeshContact::SaveState(b3StateBuffer* buffer) const
+{
+	b3Contact::SaveState(buffer);
+	buffer->Write(m_aabbBMoved);
+	buffer->Write(m_aabbB);
+	buffer->Write(m_triangleCount);
+	buffer->Write(m_triangles, m_triangleCount * sizeof(b3TriangleCache));
+	buffer->Write(m_clusterCache);
+}
+
+void b3MeshContact::RestoreState(b3StateBuffer* buffer)
+{
+	b3Contact::RestoreState(buffer);
+	buffer->Read(m_aabbBMoved);
+	buffer->Read(m_aabbB);
+	buffer->Read(m_triangleCount);
+	
+	if (m_triangleCount > m_triangleCapacity)
+	{
+		while (m_triangleCapacity < m_triangleCount)
+		{
+			m_triangleCapacity *= 2;
+		}
+
+		b3Free(m_triangles);
+		m_triangles = (b3TriangleCache*)b3Alloc(m_triangleCapacity * sizeof(b3TriangleCache));
+	}
+
+	buffer->Read(m_triangles, m_triangleCount * sizeof(b3TriangleCache));
+	buffer->Read(m_clusterCache);
+}
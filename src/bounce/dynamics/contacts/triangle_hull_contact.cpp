@@ -44,5 +44,5 @@ void b3TriangleAndHullContact::Evaluate(b3Manifold& manifold, const b3Transform&
 	b3Transform xf0A = GetFixtureA()->GetBody()->GetSweep().GetTransform(scalar(0));
 	b3Transform xf0B = GetFixtureB()->GetBody()->GetSweep().GetTransform(scalar(0));
 
-	b3CollideTriangleAndHull(manifold, xfA, (b3TriangleShape*)GetFixtureA()->GetShape(), xfB, (b3HullShape*)GetFixtureB()->GetShape(), &m_cache, xf0A, xf0B);
+	b3CollideTriangleAndHull(manifold, xfA, (b3TriangleShape*)GetFixtureA()->GetShape(), xfB, (b3HullShape*)GetFixtureB()->GetShape(), SelectConvexCache(&m_cache), xf0A, xf0B);
 }
\ No newline at end of file
@@ -25,10 +25,14 @@
 #include <bounce/collision/shapes/triangle_shape.h>
 #include <bounce/collision/shapes/hull_shape.h>
 #include <bounce/collision/shapes/mesh_shape.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/shapes/compound_shape.h>
 #include <bounce/collision/geometry/sphere.h>
 #include <bounce/collision/geometry/capsule.h>
 #include <bounce/collision/geometry/hull.h>
+#include <bounce/collision/geometry/height_field.h>
 #include <bounce/collision/geometry/mesh.h>
+#include <bounce/collision/geometry/compound.h>
 #include <bounce/common/memory/block_allocator.h>
 
 b3Fixture::b3Fixture()
@@ -73,20 +77,106 @@ void b3Fixture::SetSensor(bool flag)
 void b3Fixture::DestroyContacts()
 {
 	b3World* world = m_body->GetWorld();
-	b3ContactEdge* ce = m_contactEdges.m_head;
-	while (ce)
+	while (m_contactEdges.Count() > 0)
 	{
-		b3ContactEdge* tmp = ce;
-		ce = ce->m_next;
-		world->m_contactManager.Destroy(tmp->contact);
+		world->m_contactManager.Destroy(m_contactEdges.Back().contact);
 	}
 }
 
+u32 b3Fixture::AddContactEdge(b3Contact* contact, b3Fixture* other)
+{
+	b3ContactEdge edge;
+	edge.other = other;
+	edge.contact = contact;
+	
+	m_contactEdges.PushBack(edge);
+	
+	return m_contactEdges.Count() - 1;
+}
+
+void b3Fixture::RemoveContactEdge(u32 index)
+{
+	u32 last = m_contactEdges.Count() - 1;
+	if (index != last)
+	{
+		// Move the last edge into the free slot.
+		b3ContactEdge* edge = m_contactEdges.Get(index);
+		*edge = m_contactEdges[last];
+		
+		b3OverlappingPair* pair = &edge->contact->m_pair;
+		if (pair->fixtureA == this)
+		{
+			pair->edgeA = index;
+		}
+		else
+		{
+			B3_ASSERT(pair->fixtureB == this);
+			pair->edgeB = index;
+		}
+	}
+	
+	m_contactEdges.PopBack();
+}
+
 const b3AABB& b3Fixture::GetAABB() const
 {
 	return m_body->GetWorld()->m_contactManager.m_broadPhase.GetAABB(m_broadPhaseID);
 }
 
+// Log a hull allocation named h.
+static void b3DumpHull(const b3Hull* h)
+{
+	b3Log("		u8* marker = (u8*) b3Alloc(%d);\n", h->GetSize());
+	b3Log("		\n");
+	b3Log("		b3Hull* h = (b3Hull*)marker;\n");
+	b3Log("		marker += 1 * sizeof(b3Hull);\n");
+	b3Log("		h->vertices = (b3Vec3*)marker;\n");
+	b3Log("		marker += %d * sizeof(b3Vec3);\n", h->vertexCount);
+	b3Log("		h->edges = (b3HalfEdge*)marker;\n");
+	b3Log("		marker += %d * sizeof(b3HalfEdge);\n", h->edgeCount);
+	b3Log("		h->faces = (b3Face*)marker;\n");
+	b3Log("		marker += %d * sizeof(b3Face);\n", h->faceCount);
+	b3Log("		h->planes = (b3Plane*)marker;\n");
+	b3Log("		marker += %d * sizeof(b3Plane);\n", h->faceCount);
+	b3Log("		\n");
+	b3Log("		h->centroid.Set(%f, %f, %f);\n", h->centroid.x, h->centroid.y, h->centroid.z);
+	b3Log("		\n");
+	b3Log("		h->vertexCount = %d;\n", h->vertexCount);
+	for (u32 i = 0; i < h->vertexCount; ++i)
+	{
+		const b3Vec3* v = h->vertices + i;
+		b3Log("		h->vertices[%d].Set(%f, %f, %f);\n", i, v->x, v->y, v->z);
+	}
+	b3Log("		\n");
+	b3Log("		h->edgeCount = %d;\n", h->edgeCount);
+	for (u32 i = 0; i < h->edgeCount; ++i)
+	{
+		const b3HalfEdge* e = h->edges + i;
+		b3Log("		h->edges[%d].origin = %d;\n", i, e->origin);
+		b3Log("		h->edges[%d].twin = %d;\n", i, e->twin);
+		b3Log("		h->edges[%d].face = %d;\n", i, e->face);
+		b3Log("		h->edges[%d].prev = %d;\n", i, e->prev);
+		b3Log("		h->edges[%d].next = %d;\n", i, e->next);
+	}
+	b3Log("		\n");
+	b3Log("		h->faceCount = %d;\n", h->faceCount);
+	for (u32 i = 0; i < h->faceCount; ++i)
+	{
+		const b3Face* f = h->faces + i;
+		b3Log("		h->faces[%d].edge = %d;\n", i, f->edge);
+	}
+	b3Log("		\n");
+	for (u32 i = 0; i < h->faceCount; ++i)
+	{
+		const b3Plane* p = h->planes + i;
+		b3Log("		h->planes[%d].normal.Set(%f, %f, %f);\n", i, p->normal.x, p->normal.y, p->normal.z);
+		b3Log("		h->planes[%d].offset = %f;\n", i, p->offset);
+	}
+	b3Log("		\n");
+	b3Log("		h->Validate();\n");
+	b3Log("		\n");
+}
+
 void b3Fixture::Dump(u32 bodyIndex) const
 {
 	switch (GetType())
@@ -123,55 +213,7 @@ void b3Fixture::Dump(u32 bodyIndex) const
 		b3HullShape* hs = (b3HullShape*)m_shape;
 		const b3Hull* h = hs->m_hull;
 		
-		b3Log("		u8* marker = (u8*) b3Alloc(%d);\n", h->GetSize());
-		b3Log("		\n");
-		b3Log("		b3Hull* h = (b3Hull*)marker;\n");
-		b3Log("		marker += 1 * sizeof(b3Hull);\n");
-		b3Log("		h->vertices = (b3Vec3*)marker;\n");
-		b3Log("		marker += %d * sizeof(b3Vec3);\n", h->vertexCount);
-		b3Log("		h->edges = (b3HalfEdge*)marker;\n");
-		b3Log("		marker += %d * sizeof(b3HalfEdge);\n", h->edgeCount);
-		b3Log("		h->faces = (b3Face*)marker;\n");
-		b3Log("		marker += %d * sizeof(b3Face);\n", h->faceCount);
-		b3Log("		h->planes = (b3Plane*)marker;\n");
-		b3Log("		marker += %d * sizeof(b3Plane);\n", h->faceCount);
-		b3Log("		\n");
-		b3Log("		h->centroid.Set(%f, %f, %f);\n", h->centroid.x, h->centroid.y, h->centroid.z);
-		b3Log("		\n");
-		b3Log("		h->vertexCount = %d;\n", h->vertexCount);
-		for (u32 i = 0; i < h->vertexCount; ++i)
-		{
-			const b3Vec3* v = h->vertices + i;
-			b3Log("		h->vertices[%d].Set(%f, %f, %f);\n", i, v->x, v->y, v->z);
-		}
-		b3Log("		\n");
-		b3Log("		h->edgeCount = %d;\n", h->edgeCount);
-		for (u32 i = 0; i < h->edgeCount; ++i)
-		{
-			const b3HalfEdge* e = h->edges + i;
-			b3Log("		h->edges[%d].origin = %d;\n", i, e->origin);
-			b3Log("		h->edges[%d].twin = %d;\n", i, e->twin);
-			b3Log("		h->edges[%d].face = %d;\n", i, e->face);
-			b3Log("		h->edges[%d].prev = %d;\n", i, e->prev);
-			b3Log("		h->edges[%d].next = %d;\n", i, e->next);
-		}
-		b3Log("		\n");
-		b3Log("		h->faceCount = %d;\n", h->faceCount);
-		for (u32 i = 0; i < h->faceCount; ++i)
-		{
-			const b3Face* f = h->faces + i;
-			b3Log("		h->faces[%d].edge = %d;\n", i, f->edge);
-		}
-		b3Log("		\n");
-		for (u32 i = 0; i < h->faceCount; ++i)
-		{
-			const b3Plane* p = h->planes + i;
-			b3Log("		h->planes[%d].normal.Set(%f, %f, %f);\n", i, p->normal.x, p->normal.y, p->normal.z);
-			b3Log("		h->planes[%d].offset = %f;\n", i, p->offset);
-		}
-		b3Log("		\n");
-		b3Log("		h->Validate();\n");
-		b3Log("		\n");
+		b3DumpHull(h);
 		b3Log("		b3HullShape shape;\n");
 		b3Log("		shape.m_hull = h;\n");
 		b3Log("		shape.m_radius = %f;\n", hs->m_radius);
@@ -215,6 +257,116 @@ void b3Fixture::Dump(u32 bodyIndex) const
 		b3Log("		shape.m_radius = %f;\n", ms->m_radius);
 		break;
 	}
+	case b3Shape::e_heightField:
+	{
+		b3HeightFieldShape* hs = (b3HeightFieldShape*)m_shape;
+		const b3HeightField* h = hs->m_heightField;
+
+		b3Log("		b3HeightField* h = (b3HeightField*)b3Alloc(sizeof(b3HeightField));\n");
+		b3Log("		new (h) b3HeightField();\n");
+		b3Log("		\n");
+		b3Log("		h->rowCount = %d;\n", h->rowCount);
+		b3Log("		h->columnCount = %d;\n", h->columnCount);
+		if (h->shortHeights)
+		{
+			b3Log("		u16* heights = (u16*)b3Alloc(%d * sizeof(u16));\n", h->rowCount * h->columnCount);
+		}
+		else
+		{
+			b3Log("		float* heights = (float*)b3Alloc(%d * sizeof(float));\n", h->rowCount * h->columnCount);
+		}
+		for (u32 i = 0; i < h->rowCount; ++i)
+		{
+			for (u32 j = 0; j < h->columnCount; ++j)
+			{
+				u32 index = i * h->columnCount + j;
+				if (h->shortHeights)
+				{
+					b3Log("		heights[%d] = %d;\n", index, h->shortHeights[index]);
+				}
+				else
+				{
+					b3Log("		heights[%d] = %f;\n", index, h->floatHeights[index]);
+				}
+			}
+		}
+		if (h->shortHeights)
+		{
+			b3Log("		h->shortHeights = heights;\n");
+		}
+		else
+		{
+			b3Log("		h->floatHeights = heights;\n");
+		}
+		b3Log("		h->ComputeBounds();\n");
+		b3Log("		\n");
+		b3Log("		b3HeightFieldShape shape;\n");
+		b3Log("		shape.m_heightField = h;\n");
+		b3Log("		shape.m_scale.Set(%f, %f, %f);\n", hs->m_scale.x, hs->m_scale.y, hs->m_scale.z);
+		b3Log("		shape.m_radius = %f;\n", hs->m_radius);
+		break;
+	}
+	case b3Shape::e_compound:
+	{
+		b3CompoundShape* cs = (b3CompoundShape*)m_shape;
+		const b3Compound* c = cs->m_compound;
+
+		b3Log("		b3CompoundChild* children = (b3CompoundChild*)b3Alloc(%d * sizeof(b3CompoundChild));\n", c->childCount);
+		for (u32 i = 0; i < c->childCount; ++i)
+		{
+			const b3CompoundChild* child = c->children + i;
+			const b3Transform& xf = child->transform;
+
+			b3Log("		{\n");
+			switch (child->shape->GetType())
+			{
+			case b3Shape::e_sphere:
+			{
+				b3SphereShape* sphere = (b3SphereShape*)child->shape;
+				b3Log("		b3SphereShape* s = new (b3Alloc(sizeof(b3SphereShape))) b3SphereShape();\n");
+				b3Log("		s->m_center.Set(%f, %f, %f);\n", sphere->m_center.x, sphere->m_center.y, sphere->m_center.z);
+				b3Log("		s->m_radius = %f;\n", sphere->m_radius);
+				break;
+			}
+			case b3Shape::e_capsule:
+			{
+				b3CapsuleShape* capsule = (b3CapsuleShape*)child->shape;
+				b3Log("		b3CapsuleShape* s = new (b3Alloc(sizeof(b3CapsuleShape))) b3CapsuleShape();\n");
+				b3Log("		s->m_vertex1.Set(%f, %f, %f);\n", capsule->m_vertex1.x, capsule->m_vertex1.y, capsule->m_vertex1.z);
+				b3Log("		s->m_vertex2.Set(%f, %f, %f);\n", capsule->m_vertex2.x, capsule->m_vertex2.y, capsule->m_vertex2.z);
+				b3Log("		s->m_radius = %f;\n", capsule->m_radius);
+				break;
+			}
+			case b3Shape::e_hull:
+			{
+				b3HullShape* hs = (b3HullShape*)child->shape;
+				b3DumpHull(hs->m_hull);
+				b3Log("		b3HullShape* s = new (b3Alloc(sizeof(b3HullShape))) b3HullShape();\n");
+				b3Log("		s->m_hull = h;\n");
+				b3Log("		s->m_radius = %f;\n", hs->m_radius);
+				break;
+			}
+			default:
+			{
+				B3_ASSERT(false);
+				break;
+			}
+			}
+			b3Log("		children[%d].shape = s;\n", i);
+			b3Log("		children[%d].transform.translation.Set(%f, %f, %f);\n", i, xf.translation.x, xf.translation.y, xf.translation.z);
+			b3Log("		children[%d].transform.rotation.Set(%f, %f, %f, %f);\n", i, xf.rotation.v.x, xf.rotation.v.y, xf.rotation.v.z, xf.rotation.s);
+			b3Log("		}\n");
+		}
+		b3Log("		\n");
+		b3Log("		b3Compound* c = new (b3Alloc(sizeof(b3Compound))) b3Compound();\n");
+		b3Log("		c->childCount = %d;\n", c->childCount);
+		b3Log("		c->children = children;\n");
+		b3Log("		c->BuildTree();\n");
+		b3Log("		\n");
+		b3Log("		b3CompoundShape shape;\n");
+		b3Log("		shape.m_compound = c;\n");
+		break;
+	}
 	default:
 	{
 		B3_ASSERT(false);
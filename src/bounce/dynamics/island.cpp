@@ -46,6 +46,8 @@ b3Island::b3Island(b3StackAllocator* allocator, u32 bodyCapacity, u32 contactCap
 	m_contactCount = 0;
 	m_jointCount = 0;
 
+	m_velocityIterationCount = 0;
+
 	m_profiler = profiler;
 }
 
@@ -111,191 +113,159 @@ static B3_FORCE_INLINE b3Vec3 b3SolveGyro(const b3Quat& q, const b3Mat33& Ib, co
 	return w2;
 }
 
-void b3Island::Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u32 positionIterations, u32 flags)
+void b3Island::IntegrateVelocities(const b3Vec3& gravity, scalar h)
 {
-	scalar h = dt;
-
-	// 1. Integrate velocities
 	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
 		b3Body* b = m_bodies[i];
-
-		b3Vec3 v = b->m_linearVelocity;
-		b3Vec3 w = b->m_angularVelocity;
-		b3Vec3 x = b->m_sweep.worldCenter;
-		b3Quat q = b->m_sweep.orientation;
-
-		// Remember the positions for CCD
-		b->m_sweep.worldCenter0 = b->m_sweep.worldCenter;
-		b->m_sweep.orientation0 = b->m_sweep.orientation;
-
-		if (b->m_type == e_dynamicBody) 
+		if (b->m_type != e_dynamicBody)
 		{
-			// Integrate forces
-			v += h * (b3Mul(b->m_gravityScale, gravity) + b->m_invMass * b->m_force);
-			
-			// Clear forces
-			b->m_force.SetZero();
-			
-			// Integrate torques
-			b3Vec3 dw1 = h * b->m_worldInvI * b->m_torque;
-			
-			// "Numerical Methods", (Erin, p71)
-			// Implicit Euler on next inertia and angular velocity
-			b3Vec3 w2 = b3SolveGyro(q, b->m_I, w, h);
-			b3Vec3 dw2 = w2 - w;
+			continue;
+		}
 
-			w += dw1 + dw2;
+		b3Vec3 v = m_velocities[i].v;
+		b3Vec3 w = m_velocities[i].w;
+		b3Quat q = m_positions[i].q;
 
-			// Clear torques
-			b->m_torque.SetZero();
-			
-			// Apply local damping.
-			// ODE: dv/dt + c * v = 0
-			// Solution: v(t) = v0 * exp(-c * t)
-			// Step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
-			// v2 = exp(-c * dt) * v1
-			// Padé approximation:
-			// 1 / (1 + c * dt) 
-			v.x *= scalar(1) / (scalar(1) + h * b->m_linearDamping.x);
-			v.y *= scalar(1) / (scalar(1) + h * b->m_linearDamping.y);
-			v.z *= scalar(1) / (scalar(1) + h * b->m_linearDamping.z);
-
-			w.x *= scalar(1) / (scalar(1) + h * b->m_angularDamping.x);
-			w.y *= scalar(1) / (scalar(1) + h * b->m_angularDamping.y);
-			w.z *= scalar(1) / (scalar(1) + h * b->m_angularDamping.z);
-		}
+		// Integrate forces
+		v += h * (b3Mul(b->m_gravityScale, gravity) + b->InvMass() * b->Force());
+		
+		// Integrate torques
+		b3Vec3 dw1 = h * m_invInertias[i] * b->Torque();
+		
+		// "Numerical Methods", (Erin, p71)
+		// Implicit Euler on next inertia and angular velocity
+		b3Vec3 w2 = b3SolveGyro(q, b->m_I, w, h);
+		b3Vec3 dw2 = w2 - w;
+
+		w += dw1 + dw2;
+
+		// Apply local damping.
+		// ODE: dv/dt + c * v = 0
+		// Solution: v(t) = v0 * exp(-c * t)
+		// Step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+		// v2 = exp(-c * dt) * v1
+		// Padé approximation:
+		// 1 / (1 + c * dt) 
+		v.x *= scalar(1) / (scalar(1) + h * b->m_linearDamping.x);
+		v.y *= scalar(1) / (scalar(1) + h * b->m_linearDamping.y);
+		v.z *= scalar(1) / (scalar(1) + h * b->m_linearDamping.z);
+
+		w.x *= scalar(1) / (scalar(1) + h * b->m_angularDamping.x);
+		w.y *= scalar(1) / (scalar(1) + h * b->m_angularDamping.y);
+		w.z *= scalar(1) / (scalar(1) + h * b->m_angularDamping.z);
 
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
-		m_positions[i].x = x;
-		m_positions[i].q = q;
-		m_invInertias[i] = b->m_worldInvI;
 	}
+}
 
-	b3JointSolverDef jointSolverDef;
-	jointSolverDef.joints = m_joints;
-	jointSolverDef.count = m_jointCount;
-	jointSolverDef.positions = m_positions;
-	jointSolverDef.velocities = m_velocities;
-	jointSolverDef.invInertias = m_invInertias;
-	jointSolverDef.dt = h;
-	b3JointSolver jointSolver(&jointSolverDef);
-
-	b3ContactSolverDef contactSolverDef;
-	contactSolverDef.allocator = m_allocator;
-	contactSolverDef.contacts = m_contacts;
-	contactSolverDef.count = m_contactCount;
-	contactSolverDef.positions = m_positions;
-	contactSolverDef.velocities = m_velocities;
-	contactSolverDef.invInertias = m_invInertias;
-	contactSolverDef.dt = h;
-	b3ContactSolver contactSolver(&contactSolverDef);
-
-	// 2. Initialize constraints
+void b3Island::IntegratePositions(scalar h, const b3Velocity* pseudoVelocities)
+{
+	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
-		B3_PROFILE(m_profiler, "Initialize Constraints");
-		
-		contactSolver.InitializeConstraints();
-
-		if (flags & e_warmStartBit)
+		b3Body* b = m_bodies[i];
+		if (b->m_type == e_staticBody)
 		{
-			contactSolver.WarmStart();
+			continue;
 		}
 
-		jointSolver.InitializeConstraints();
+		b3Vec3 x = m_positions[i].x;
+		b3Quat q = m_positions[i].q;
+		b3Vec3 v = m_velocities[i].v;
+		b3Vec3 w = m_velocities[i].w;
 
-		if (flags & e_warmStartBit)
+		// Prevent numerical instability due to large velocity changes.		
+		b3Vec3 translation = h * v;
+		if (b3Dot(translation, translation) > B3_MAX_TRANSLATION_SQUARED)
 		{
-			jointSolver.WarmStart();
+			scalar ratio = B3_MAX_TRANSLATION / b3Length(translation);
+			v *= ratio;
 		}
-	}
-
-	// 3. Solve velocity constraints
-	{
-		B3_PROFILE(m_profiler, "Solve Velocity Constraints");
 
-		for (u32 i = 0; i < velocityIterations; ++i)
+		b3Vec3 rotation = h * w;
+		if (b3Dot(rotation, rotation) > B3_MAX_ROTATION_SQUARED)
 		{
-			jointSolver.SolveVelocityConstraints();
-			contactSolver.SolveVelocityConstraints();
+			scalar ratio = B3_MAX_ROTATION / b3Length(rotation);
+			w *= ratio;
 		}
 
-		if (flags & e_warmStartBit)
+		// Integrate
+		if (pseudoVelocities)
 		{
-			contactSolver.StoreImpulses();
+			// The pseudo velocities move the body but aren't kept.
+			x += h * (v + pseudoVelocities[i].v);
+			q = b3Integrate(q, w + pseudoVelocities[i].w, h);
 		}
-	}
-
-	// 4. Integrate positions
-	for (u32 i = 0; i < m_bodyCount; ++i) 
-	{
-		b3Body* b = m_bodies[i];
-		
-		b3Vec3 x = m_positions[i].x;
-		b3Quat q = m_positions[i].q;
-		b3Vec3 v = m_velocities[i].v;
-		b3Vec3 w = m_velocities[i].w;
-		b3Mat33 invI = m_invInertias[i];
-
-		if (b->m_type != e_staticBody)
+		else
 		{
-			// Prevent numerical instability due to large velocity changes.		
-			b3Vec3 translation = h * v;
-			if (b3Dot(translation, translation) > B3_MAX_TRANSLATION_SQUARED)
-			{
-				scalar ratio = B3_MAX_TRANSLATION / b3Length(translation);
-				v *= ratio;
-			}
-
-			b3Vec3 rotation = h * w;
-			if (b3Dot(rotation, rotation) > B3_MAX_ROTATION_SQUARED)
-			{
-				scalar ratio = B3_MAX_ROTATION / b3Length(rotation);
-				w *= ratio;
-			}
-
-			// Integrate
 			x += h * v;
 			q = b3Integrate(q, w, h);
-			invI = b3RotateToFrame(b->m_invI, q);
 		}
 
 		m_positions[i].x = x;
 		m_positions[i].q = q;
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
-		m_invInertias[i] = invI;
+		m_invInertias[i] = b3RotateToFrame(b->InvInertia(), q);
 	}
+}
 
-	// 5. Solve position constraints
-	bool positionsSolved = false;
-	
+void b3Island::Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u32 positionIterations, scalar impulseTolerance, u32 subStepCount, u32 flags)
+{
+	scalar h = dt;
+
+	// 1. Copy the body state to the state buffers
+	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
-		B3_PROFILE(m_profiler, "Solve Position Constraints");
-		
-		for (u32 i = 0; i < positionIterations; ++i) 
+		b3Body* b = m_bodies[i];
+
+		b3Sweep& sweep = b->Sweep();
+
+		// Remember the positions for CCD
+		sweep.worldCenter0 = sweep.worldCenter;
+		sweep.orientation0 = sweep.orientation;
+
+		m_velocities[i].v = b->LinearVelocity();
+		m_velocities[i].w = b->AngularVelocity();
+		m_positions[i].x = sweep.worldCenter;
+		m_positions[i].q = sweep.orientation;
+		m_invInertias[i] = b->WorldInvInertia();
+	}
+
+	// 2. Solve the constraints and integrate the positions
+	bool positionsSolved;
+	if (subStepCount > 0)
+	{
+		positionsSolved = SolveSubSteps(gravity, h, subStepCount, flags);
+		m_velocityIterationCount = subStepCount;
+	}
+	else
+	{
+		positionsSolved = SolveIterations(gravity, h, velocityIterations, positionIterations, impulseTolerance, flags);
+	}
+
+	// Clear forces and torques
+	for (u32 i = 0; i < m_bodyCount; ++i)
+	{
+		b3Body* b = m_bodies[i];
+		if (b->m_type == e_dynamicBody)
 		{
-			bool contactsSolved = contactSolver.SolvePositionConstraints();
-			bool jointsSolved = jointSolver.SolvePositionConstraints();
-			if (contactsSolved && jointsSolved)
-			{
-				// Early out if the position errors are small.
-				positionsSolved = true;
-				break;
-			}
+			b->Force().SetZero();
+			b->Torque().SetZero();
 		}
 	}
 
-	// 6. Copy state buffers back to the bodies
+	// 3. Copy state buffers back to the bodies
 	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
 		b3Body* b = m_bodies[i];
-		b->m_sweep.worldCenter = m_positions[i].x;
-		b->m_sweep.orientation = m_positions[i].q;
-		b->m_linearVelocity = m_velocities[i].v;
-		b->m_angularVelocity = m_velocities[i].w;	
-		b->m_worldInvI = m_invInertias[i];
+		b3Sweep& sweep = b->Sweep();
+		sweep.worldCenter = m_positions[i].x;
+		sweep.orientation = m_positions[i].q;
+		b->LinearVelocity() = m_velocities[i].v;
+		b->AngularVelocity() = m_velocities[i].w;	
+		b->WorldInvInertia() = m_invInertias[i];
 		
 		b->SynchronizeTransform();
 	}
@@ -303,7 +273,7 @@ void b3Island::Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u
 	// Post solve callback report
 	Report();
 
-	// 7. Put bodies under unconsiderable motion to sleep
+	// 4. Put bodies under unconsiderable motion to sleep
 	if (flags & e_sleepBit) 
 	{
 		scalar minSleepTime = B3_MAX_SCALAR;
@@ -317,8 +287,8 @@ void b3Island::Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u
 			}
 
 			// Compute the linear and angular speed of the body.
-			scalar sqrLinVel = b3Dot(b->m_linearVelocity, b->m_linearVelocity);
-			scalar sqrAngVel = b3Dot(b->m_angularVelocity, b->m_angularVelocity);
+			scalar sqrLinVel = b3Dot(b->LinearVelocity(), b->LinearVelocity());
+			scalar sqrAngVel = b3Dot(b->AngularVelocity(), b->AngularVelocity());
 
 			if (b->IsSleepingAllowed() == false ||
 				sqrLinVel > b->m_linearSleepTolerance * b->m_linearSleepTolerance || 
@@ -346,6 +316,270 @@ void b3Island::Solve(const b3Vec3& gravity, scalar dt, u32 velocityIterations, u
 	}
 }
 
+bool b3Island::SolveIterations(const b3Vec3& gravity, scalar h, u32 velocityIterations, u32 positionIterations, scalar impulseTolerance, u32 flags)
+{
+	// 1. Integrate velocities
+	IntegrateVelocities(gravity, h);
+
+	// The split impulse solver corrects the overlaps using pseudo velocities 
+	// instead of solving the position constraints of the contacts.
+	bool splitImpulse = (flags & e_splitImpulseBit) != 0;
+	
+	b3Velocity* pseudoVelocities = nullptr;
+	if (splitImpulse)
+	{
+		pseudoVelocities = (b3Velocity*)m_allocator->Allocate(m_bodyCount * sizeof(b3Velocity));
+		for (u32 i = 0; i < m_bodyCount; ++i)
+		{
+			pseudoVelocities[i].v.SetZero();
+			pseudoVelocities[i].w.SetZero();
+		}
+	}
+
+	bool positionsSolved = false;
+
+	{
+		b3JointSolverDef jointSolverDef;
+		jointSolverDef.allocator = m_allocator;
+		jointSolverDef.joints = m_joints;
+		jointSolverDef.count = m_jointCount;
+		jointSolverDef.positions = m_positions;
+		jointSolverDef.velocities = m_velocities;
+		jointSolverDef.invInertias = m_invInertias;
+		jointSolverDef.dt = h;
+		jointSolverDef.batch = (flags & e_jointBatchBit) != 0;
+		b3JointSolver jointSolver(&jointSolverDef);
+
+		b3ContactSolverDef contactSolverDef;
+		contactSolverDef.allocator = m_allocator;
+		contactSolverDef.contacts = m_contacts;
+		contactSolverDef.count = m_contactCount;
+		contactSolverDef.positions = m_positions;
+		contactSolverDef.velocities = m_velocities;
+		contactSolverDef.displacements = nullptr;
+		contactSolverDef.pseudoVelocities = pseudoVelocities;
+		contactSolverDef.invInertias = m_invInertias;
+		contactSolverDef.dt = h;
+		contactSolverDef.blockSolve = (flags & e_blockSolveBit) != 0;
+		contactSolverDef.speculative = (flags & e_speculativeBit) != 0;
+		b3ContactSolver contactSolver(&contactSolverDef);
+
+		// 2. Initialize constraints
+		{
+			B3_PROFILE(m_profiler, "Initialize Constraints");
+		
+			contactSolver.InitializeConstraints();
+
+			if (flags & e_warmStartBit)
+			{
+				contactSolver.WarmStart();
+			}
+
+			jointSolver.InitializeConstraints();
+
+			if (flags & e_warmStartBit)
+			{
+				jointSolver.WarmStart();
+			}
+		}
+
+		// 3. Solve velocity constraints
+		{
+			B3_PROFILE(m_profiler, "Solve Velocity Constraints");
+
+			m_velocityIterationCount = 0;
+
+			// The pseudo velocities don't depend on the velocities, 
+			// so stop solving them once they converge.
+			bool splitSolved = splitImpulse == false;
+
+			for (u32 i = 0; i < velocityIterations; ++i)
+			{
+				scalar jointImpulse = jointSolver.SolveVelocityConstraints();
+				scalar contactImpulse = contactSolver.SolveVelocityConstraints();
+			
+				if (splitSolved == false)
+				{
+					scalar pseudoImpulse = contactSolver.SolveSplitImpulses();
+					splitSolved = pseudoImpulse <= impulseTolerance;
+					contactImpulse = b3Max(contactImpulse, pseudoImpulse);
+				}
+
+				++m_velocityIterationCount;
+
+				if (b3Max(jointImpulse, contactImpulse) < impulseTolerance)
+				{
+					// Early out if the impulses applied are small.
+					break;
+				}
+			}
+
+			jointSolver.StoreImpulses();
+
+			if (flags & e_warmStartBit)
+			{
+				contactSolver.StoreImpulses();
+			}
+		}
+
+		// 4. Integrate positions
+		IntegratePositions(h, pseudoVelocities);
+
+		// 5. Solve position constraints
+		if (splitImpulse)
+		{
+			B3_PROFILE(m_profiler, "Solve Position Constraints");
+
+			// Only the joints need position iterations.
+			bool contactsSolved = contactSolver.IsOverlapSolved();
+			bool jointsSolved = m_jointCount == 0;
+			for (u32 i = 0; i < positionIterations && jointsSolved == false; ++i)
+			{
+				jointsSolved = jointSolver.SolvePositionConstraints();
+			}
+		
+			positionsSolved = contactsSolved && jointsSolved;
+		}
+		else
+		{
+			B3_PROFILE(m_profiler, "Solve Position Constraints");
+		
+			for (u32 i = 0; i < positionIterations; ++i) 
+			{
+				bool contactsSolved = contactSolver.SolvePositionConstraints();
+				bool jointsSolved = jointSolver.SolvePositionConstraints();
+				if (contactsSolved && jointsSolved)
+				{
+					// Early out if the position errors are small.
+					positionsSolved = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (pseudoVelocities)
+	{
+		m_allocator->Free(pseudoVelocities);
+	}
+
+	return positionsSolved;
+}
+
+// "Solver2D", Erin Catto
+// Each sub-step integrates the velocities, solves the joints and the soft contacts 
+// with one iteration, integrates the positions, and relaxes the velocities.
+// The contact points of the collision pass are reused by all sub-steps. 
+// Their separations are updated from the body displacements.
+// The joints are linearized at the positions of each sub-step and get one position iteration in the last sub-step.
+bool b3Island::SolveSubSteps(const b3Vec3& gravity, scalar dt, u32 subStepCount, u32 flags)
+{
+	scalar h = dt / scalar(subStepCount);
+
+	b3Position* positions0 = (b3Position*)m_allocator->Allocate(m_bodyCount * sizeof(b3Position));
+	b3Displacement* displacements = (b3Displacement*)m_allocator->Allocate(m_bodyCount * sizeof(b3Displacement));
+	for (u32 i = 0; i < m_bodyCount; ++i)
+	{
+		positions0[i] = m_positions[i];
+		displacements[i].linear.SetZero();
+		displacements[i].angular.SetZero();
+	}
+
+	bool jointsSolved = true;
+
+	{
+		b3JointSolverDef jointSolverDef;
+		jointSolverDef.allocator = m_allocator;
+		jointSolverDef.joints = m_joints;
+		jointSolverDef.count = m_jointCount;
+		jointSolverDef.positions = m_positions;
+		jointSolverDef.velocities = m_velocities;
+		jointSolverDef.invInertias = m_invInertias;
+		jointSolverDef.dt = h;
+		jointSolverDef.batch = (flags & e_jointBatchBit) != 0;
+		b3JointSolver jointSolver(&jointSolverDef);
+
+		b3ContactSolverDef contactSolverDef;
+		contactSolverDef.allocator = m_allocator;
+		contactSolverDef.contacts = m_contacts;
+		contactSolverDef.count = m_contactCount;
+		contactSolverDef.positions = m_positions;
+		contactSolverDef.velocities = m_velocities;
+		contactSolverDef.displacements = displacements;
+		contactSolverDef.pseudoVelocities = nullptr;
+		contactSolverDef.invInertias = m_invInertias;
+		contactSolverDef.dt = h;
+		contactSolverDef.blockSolve = false;
+		contactSolverDef.speculative = (flags & e_speculativeBit) != 0;
+		b3ContactSolver contactSolver(&contactSolverDef);
+
+		{
+			B3_PROFILE(m_profiler, "Initialize Constraints");
+
+			contactSolver.InitializeConstraints();
+		}
+
+		{
+			B3_PROFILE(m_profiler, "Solve Sub-Steps");
+
+			for (u32 i = 0; i < subStepCount; ++i)
+			{
+				IntegrateVelocities(gravity, h);
+
+				jointSolver.InitializeConstraints();
+
+				if (flags & e_warmStartBit)
+				{
+					contactSolver.WarmStart();
+					jointSolver.WarmStart();
+				}
+
+				jointSolver.SolveVelocityConstraints();
+				contactSolver.SolveSoftConstraints(true);
+
+				IntegratePositions(h, nullptr);
+
+				if (i + 1 == subStepCount)
+				{
+					// Remove the joint drift left by the sub-steps.
+					jointsSolved = jointSolver.SolvePositionConstraints();
+				}
+
+				// Update the displacements for the next contact solve.
+				for (u32 j = 0; j < m_bodyCount; ++j)
+				{
+					b3Quat dq = m_positions[j].q * b3Conjugate(positions0[j].q);
+					if (dq.s < scalar(0))
+					{
+						dq = -dq;
+					}
+
+					displacements[j].linear = m_positions[j].x - positions0[j].x;
+					displacements[j].angular = scalar(2) * dq.v;
+				}
+
+				// Relax
+				jointSolver.SolveVelocityConstraints();
+				contactSolver.SolveSoftConstraints(false);
+
+				jointSolver.StoreImpulses();
+			}
+
+			contactSolver.ApplyRestitution();
+
+			if (flags & e_warmStartBit)
+			{
+				contactSolver.StoreImpulses();
+			}
+		}
+	}
+
+	m_allocator->Free(displacements);
+	m_allocator->Free(positions0);
+
+	return jointsSolved;
+}
+
 void b3Island::Report()
 {
 	if (m_listener == nullptr)
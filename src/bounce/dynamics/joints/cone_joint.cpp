@@ -89,14 +89,14 @@ void b3ConeJoint::InitializeConstraints(const b3SolverData* data)
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
 
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
 
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
@@ -253,13 +253,15 @@ void b3ConeJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3ConeJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3ConeJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
 	b3Vec3 vB = data->velocities[m_indexB].v;
 	b3Vec3 wB = data->velocities[m_indexB].w;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	// Solve linear constraint.
 	{
 		b3Vec3 Cdot = vB + b3Cross(wB, m_rB) - vA - b3Cross(wA, m_rA);
@@ -272,6 +274,8 @@ void b3ConeJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += m_mB * P;
 		wB += m_iB * b3Cross(m_rB, P);
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(P));
 	}
 
 	// Solve cone constraint.
@@ -287,6 +291,8 @@ void b3ConeJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * P;
 		wB += m_iB * P;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	// Solve twist constraint.
@@ -316,12 +322,16 @@ void b3ConeJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * P;
 		wB += m_iB * P;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3ConeJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -527,6 +537,24 @@ bool b3ConeJoint::SolvePositionConstraints(const b3SolverData* data)
 	return linearError <= B3_LINEAR_SLOP && limitError <= B3_ANGULAR_SLOP;
 }
 
+void b3ConeJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_impulse);
+	buffer->Write(m_coneImpulse);
+	buffer->Write(m_coneState);
+	buffer->Write(m_twistImpulse);
+	buffer->Write(m_twistState);
+}
+
+void b3ConeJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_impulse);
+	buffer->Read(m_coneImpulse);
+	buffer->Read(m_coneState);
+	buffer->Read(m_twistImpulse);
+	buffer->Read(m_twistState);
+}
+
 void b3ConeJoint::SetEnableConeLimit(bool bit)
 {
 	if (bit != m_enableConeLimit)
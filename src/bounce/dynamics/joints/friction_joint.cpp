@@ -49,13 +49,13 @@ void b3FrictionJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
 
-	b3Vec3 localCenterA = m_bodyA->m_sweep.localCenter;
-	b3Vec3 localCenterB = m_bodyB->m_sweep.localCenter;
+	b3Vec3 localCenterA = m_bodyA->Sweep().localCenter;
+	b3Vec3 localCenterB = m_bodyB->Sweep().localCenter;
 	
 	b3Quat qA = data->positions[m_indexA].q;
 	b3Quat qB = data->positions[m_indexB].q;
@@ -95,7 +95,7 @@ void b3FrictionJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3FrictionJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3FrictionJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -104,6 +104,8 @@ void b3FrictionJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 	scalar h = data->dt;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	// Solve angular friction.
 	{
 		b3Vec3 Cdot = wB - wA;
@@ -123,6 +125,8 @@ void b3FrictionJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * impulse;
 		wB += m_iB * impulse;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	// Solve linear friction
@@ -146,12 +150,16 @@ void b3FrictionJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += m_mB * impulse;
 		wB += m_iB * b3Cross(m_rB, impulse);
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 	
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3FrictionJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -160,6 +168,18 @@ bool b3FrictionJoint::SolvePositionConstraints(const b3SolverData* data)
 	return true;
 }
 
+void b3FrictionJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_linearImpulse);
+	buffer->Write(m_angularImpulse);
+}
+
+void b3FrictionJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_linearImpulse);
+	buffer->Read(m_angularImpulse);
+}
+
 b3Vec3 b3FrictionJoint::GetAnchorA() const
 {
 	return GetBodyA()->GetWorldPoint(m_localAnchorA);
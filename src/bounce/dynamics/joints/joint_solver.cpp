@@ -18,42 +18,403 @@
 
 #include <bounce/dynamics/joints/joint_solver.h>
 #include <bounce/dynamics/joints/joint.h>
+#include <bounce/dynamics/joints/sphere_joint.h>
+#include <bounce/dynamics/joints/cone_joint.h>
+#include <bounce/dynamics/joints/revolute_joint.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/common/memory/stack_allocator.h>
 
 b3JointSolver::b3JointSolver(const b3JointSolverDef* def) 
 {
+	m_allocator = def->allocator;
 	m_count = def->count;
 	m_joints = def->joints;
+	m_batch = def->batch;
 	m_solverData.dt = def->dt;
 	m_solverData.invdt = def->dt > scalar(0) ? scalar(1) / def->dt : scalar(0);
 	m_solverData.positions = def->positions;
 	m_solverData.velocities = def->velocities;
 	m_solverData.invInertias = def->invInertias;
+
+	// Count the constraints of each batch.
+	m_genericCount = 0;
+	m_pointCapacity = 0;
+	m_rowCapacity = 0;
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		b3Joint* j = m_joints[i];
+		if (IsBatched(j) == false)
+		{
+			m_genericCount += 1;
+			continue;
+		}
+
+		switch (j->GetType())
+		{
+		case e_sphereJoint:
+			m_pointCapacity += 1;
+			break;
+		case e_coneJoint:
+			m_pointCapacity += 1;
+			m_rowCapacity += 2;
+			break;
+		case e_revoluteJoint:
+			m_pointCapacity += 1;
+			m_rowCapacity += 4;
+			break;
+		default:
+			B3_ASSERT(false);
+			break;
+		}
+	}
+
+	m_genericJoints = (b3Joint**)m_allocator->Allocate(m_genericCount * sizeof(b3Joint*));
+	
+	m_genericCount = 0;
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		b3Joint* j = m_joints[i];
+		if (IsBatched(j) == false)
+		{
+			m_genericJoints[m_genericCount++] = j;
+		}
+	}
+
+	m_points.count = 0;
+	m_points.indexA = (u32*)m_allocator->Allocate(m_pointCapacity * sizeof(u32));
+	m_points.indexB = (u32*)m_allocator->Allocate(m_pointCapacity * sizeof(u32));
+	m_points.mA = (scalar*)m_allocator->Allocate(m_pointCapacity * sizeof(scalar));
+	m_points.mB = (scalar*)m_allocator->Allocate(m_pointCapacity * sizeof(scalar));
+	m_points.iA = (b3Mat33*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Mat33));
+	m_points.iB = (b3Mat33*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Mat33));
+	m_points.rA = (b3Vec3*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Vec3));
+	m_points.rB = (b3Vec3*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Vec3));
+	m_points.invMass = (b3Mat33*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Mat33));
+	m_points.impulse = (b3Vec3*)m_allocator->Allocate(m_pointCapacity * sizeof(b3Vec3));
+	m_points.jointImpulse = (b3Vec3**)m_allocator->Allocate(m_pointCapacity * sizeof(b3Vec3*));
+
+	m_rows.count = 0;
+	m_rows.indexA = (u32*)m_allocator->Allocate(m_rowCapacity * sizeof(u32));
+	m_rows.indexB = (u32*)m_allocator->Allocate(m_rowCapacity * sizeof(u32));
+	m_rows.axis = (b3Vec3*)m_allocator->Allocate(m_rowCapacity * sizeof(b3Vec3));
+	m_rows.invIAxisA = (b3Vec3*)m_allocator->Allocate(m_rowCapacity * sizeof(b3Vec3));
+	m_rows.invIAxisB = (b3Vec3*)m_allocator->Allocate(m_rowCapacity * sizeof(b3Vec3));
+	m_rows.mass = (scalar*)m_allocator->Allocate(m_rowCapacity * sizeof(scalar));
+	m_rows.bias = (scalar*)m_allocator->Allocate(m_rowCapacity * sizeof(scalar));
+	m_rows.lower = (scalar*)m_allocator->Allocate(m_rowCapacity * sizeof(scalar));
+	m_rows.upper = (scalar*)m_allocator->Allocate(m_rowCapacity * sizeof(scalar));
+	m_rows.impulse = (scalar*)m_allocator->Allocate(m_rowCapacity * sizeof(scalar));
+	m_rows.jointImpulse = (scalar**)m_allocator->Allocate(m_rowCapacity * sizeof(scalar*));
+}
+
+b3JointSolver::~b3JointSolver()
+{
+	m_allocator->Free(m_rows.jointImpulse);
+	m_allocator->Free(m_rows.impulse);
+	m_allocator->Free(m_rows.upper);
+	m_allocator->Free(m_rows.lower);
+	m_allocator->Free(m_rows.bias);
+	m_allocator->Free(m_rows.mass);
+	m_allocator->Free(m_rows.invIAxisB);
+	m_allocator->Free(m_rows.invIAxisA);
+	m_allocator->Free(m_rows.axis);
+	m_allocator->Free(m_rows.indexB);
+	m_allocator->Free(m_rows.indexA);
+
+	m_allocator->Free(m_points.jointImpulse);
+	m_allocator->Free(m_points.impulse);
+	m_allocator->Free(m_points.invMass);
+	m_allocator->Free(m_points.rB);
+	m_allocator->Free(m_points.rA);
+	m_allocator->Free(m_points.iB);
+	m_allocator->Free(m_points.iA);
+	m_allocator->Free(m_points.mB);
+	m_allocator->Free(m_points.mA);
+	m_allocator->Free(m_points.indexB);
+	m_allocator->Free(m_points.indexA);
+
+	m_allocator->Free(m_genericJoints);
+}
+
+bool b3JointSolver::IsBatched(const b3Joint* joint) const
+{
+	if (m_batch == false)
+	{
+		return false;
+	}
+
+	b3JointType type = joint->GetType();
+	return type == e_sphereJoint || type == e_coneJoint || type == e_revoluteJoint;
+}
+
+void b3JointSolver::AddPointConstraint(u32 indexA, u32 indexB, scalar mA, scalar mB,
+	const b3Mat33& iA, const b3Mat33& iB, const b3Vec3& rA, const b3Vec3& rB,
+	const b3Mat33& mass, b3Vec3* impulse)
+{
+	B3_ASSERT(m_points.count < m_pointCapacity);
+	u32 i = m_points.count++;
+	m_points.indexA[i] = indexA;
+	m_points.indexB[i] = indexB;
+	m_points.mA[i] = mA;
+	m_points.mB[i] = mB;
+	m_points.iA[i] = iA;
+	m_points.iB[i] = iB;
+	m_points.rA[i] = rA;
+	m_points.rB[i] = rB;
+	m_points.invMass[i] = b3SymInverse(mass);
+	m_points.impulse[i] = *impulse;
+	m_points.jointImpulse[i] = impulse;
+}
+
+void b3JointSolver::AddAngularRow(u32 indexA, u32 indexB, const b3Mat33& iA, const b3Mat33& iB,
+	const b3Vec3& axis, scalar bias, scalar lower, scalar upper, scalar* impulse)
+{
+	B3_ASSERT(m_rows.count < m_rowCapacity);
+	u32 i = m_rows.count++;
+	m_rows.indexA[i] = indexA;
+	m_rows.indexB[i] = indexB;
+
+	m_rows.axis[i] = axis;
+	m_rows.invIAxisA[i] = iA * axis;
+	m_rows.invIAxisB[i] = iB * axis;
+
+	scalar mass = b3Dot(axis, m_rows.invIAxisA[i]) + b3Dot(axis, m_rows.invIAxisB[i]);
+	m_rows.mass[i] = mass > scalar(0) ? scalar(1) / mass : scalar(0);
+	m_rows.bias[i] = bias;
+	m_rows.lower[i] = lower;
+	m_rows.upper[i] = upper;
+	m_rows.impulse[i] = *impulse;
+	m_rows.jointImpulse[i] = impulse;
 }
 
 void b3JointSolver::InitializeConstraints() 
 {
+	m_points.count = 0;
+	m_rows.count = 0;
+
 	for (u32 i = 0; i < m_count; ++i) 
 	{
 		b3Joint* j = m_joints[i];
-		j->InitializeConstraints(&m_solverData);
+		
+		if (IsBatched(j) == false)
+		{
+			j->InitializeConstraints(&m_solverData);
+			continue;
+		}
+
+		switch (j->GetType())
+		{
+		case e_sphereJoint:
+		{
+			b3SphereJoint* sj = (b3SphereJoint*)j;
+			sj->b3SphereJoint::InitializeConstraints(&m_solverData);
+
+			AddPointConstraint(sj->m_indexA, sj->m_indexB, sj->m_mA, sj->m_mB, 
+				sj->m_iA, sj->m_iB, sj->m_rA, sj->m_rB, sj->m_mass, &sj->m_impulse);
+			break;
+		}
+		case e_coneJoint:
+		{
+			b3ConeJoint* cj = (b3ConeJoint*)j;
+			cj->b3ConeJoint::InitializeConstraints(&m_solverData);
+
+			AddPointConstraint(cj->m_indexA, cj->m_indexB, cj->m_mA, cj->m_mB,
+				cj->m_iA, cj->m_iB, cj->m_rA, cj->m_rB, cj->m_mass, &cj->m_impulse);
+
+			if (cj->m_enableConeLimit && cj->m_coneState != e_inactiveLimit)
+			{
+				AddAngularRow(cj->m_indexA, cj->m_indexB, cj->m_iA, cj->m_iB, 
+					cj->m_coneAxis, scalar(0), scalar(0), B3_MAX_SCALAR, &cj->m_coneImpulse);
+			}
+
+			if (cj->m_enableTwistLimit && cj->m_twistState != e_inactiveLimit)
+			{
+				scalar lower = -B3_MAX_SCALAR, upper = B3_MAX_SCALAR;
+				if (cj->m_twistState == e_atLowerLimit)
+				{
+					lower = scalar(0);
+				}
+				else if (cj->m_twistState == e_atUpperLimit)
+				{
+					upper = scalar(0);
+				}
+
+				AddAngularRow(cj->m_indexA, cj->m_indexB, cj->m_iA, cj->m_iB,
+					cj->m_twistAxis, scalar(0), lower, upper, &cj->m_twistImpulse);
+			}
+			break;
+		}
+		case e_revoluteJoint:
+		{
+			b3RevoluteJoint* rj = (b3RevoluteJoint*)j;
+			rj->b3RevoluteJoint::InitializeConstraints(&m_solverData);
+
+			AddPointConstraint(rj->m_indexA, rj->m_indexB, rj->m_mA, rj->m_mB,
+				rj->m_iA, rj->m_iB, rj->m_rA, rj->m_rB, rj->m_linearMass, &rj->m_linearImpulse);
+
+			// The 2x2 angular block becomes two rows.
+			AddAngularRow(rj->m_indexA, rj->m_indexB, rj->m_iA, rj->m_iB,
+				rj->m_a1, scalar(0), -B3_MAX_SCALAR, B3_MAX_SCALAR, &rj->m_angularImpulse.x);
+
+			AddAngularRow(rj->m_indexA, rj->m_indexB, rj->m_iA, rj->m_iB,
+				rj->m_a2, scalar(0), -B3_MAX_SCALAR, B3_MAX_SCALAR, &rj->m_angularImpulse.y);
+
+			if (rj->m_enableMotor && rj->m_limitState != e_equalLimits)
+			{
+				scalar maxImpulse = m_solverData.dt * rj->m_maxMotorTorque;
+
+				AddAngularRow(rj->m_indexA, rj->m_indexB, rj->m_iA, rj->m_iB,
+					rj->m_motorAxis, -rj->m_motorSpeed, -maxImpulse, maxImpulse, &rj->m_motorImpulse);
+			}
+
+			if (rj->m_enableLimit && rj->m_limitState != e_inactiveLimit)
+			{
+				scalar lower = -B3_MAX_SCALAR, upper = B3_MAX_SCALAR;
+				if (rj->m_limitState == e_atLowerLimit)
+				{
+					lower = scalar(0);
+				}
+				else if (rj->m_limitState == e_atUpperLimit)
+				{
+					upper = scalar(0);
+				}
+
+				AddAngularRow(rj->m_indexA, rj->m_indexB, rj->m_iA, rj->m_iB,
+					rj->m_motorAxis, scalar(0), lower, upper, &rj->m_limitImpulse);
+			}
+			break;
+		}
+		default:
+		{
+			B3_ASSERT(false);
+			break;
+		}
+		}
 	}
 }
 
 void b3JointSolver::WarmStart() 
 {
-	for (u32 i = 0; i < m_count; ++i) 
+	for (u32 i = 0; i < m_genericCount; ++i) 
 	{
-		b3Joint* j = m_joints[i];
+		b3Joint* j = m_genericJoints[i];
 		j->WarmStart(&m_solverData);
 	}
+
+	b3Velocity* velocities = m_solverData.velocities;
+
+	for (u32 i = 0; i < m_points.count; ++i)
+	{
+		u32 indexA = m_points.indexA[i];
+		u32 indexB = m_points.indexB[i];
+		b3Vec3 P = m_points.impulse[i];
+
+		velocities[indexA].v -= m_points.mA[i] * P;
+		velocities[indexA].w -= m_points.iA[i] * b3Cross(m_points.rA[i], P);
+
+		velocities[indexB].v += m_points.mB[i] * P;
+		velocities[indexB].w += m_points.iB[i] * b3Cross(m_points.rB[i], P);
+	}
+
+	for (u32 i = 0; i < m_rows.count; ++i)
+	{
+		u32 indexA = m_rows.indexA[i];
+		u32 indexB = m_rows.indexB[i];
+		scalar impulse = m_rows.impulse[i];
+
+		velocities[indexA].w -= impulse * m_rows.invIAxisA[i];
+		velocities[indexB].w += impulse * m_rows.invIAxisB[i];
+	}
 }
 
-void b3JointSolver::SolveVelocityConstraints() 
+void b3JointSolver::SolvePointConstraints(scalar& maxImpulseDelta)
 {
-	for (u32 i = 0; i < m_count; ++i) 
+	b3Velocity* velocities = m_solverData.velocities;
+
+	for (u32 i = 0; i < m_points.count; ++i)
 	{
-		b3Joint* j = m_joints[i];
-		j->SolveVelocityConstraints(&m_solverData);
+		u32 indexA = m_points.indexA[i];
+		u32 indexB = m_points.indexB[i];
+		b3Vec3 rA = m_points.rA[i];
+		b3Vec3 rB = m_points.rB[i];
+
+		b3Vec3 vA = velocities[indexA].v;
+		b3Vec3 wA = velocities[indexA].w;
+		b3Vec3 vB = velocities[indexB].v;
+		b3Vec3 wB = velocities[indexB].w;
+
+		b3Vec3 Cdot = vB + b3Cross(wB, rB) - vA - b3Cross(wA, rA);
+		b3Vec3 P = -(m_points.invMass[i] * Cdot);
+
+		m_points.impulse[i] += P;
+
+		vA -= m_points.mA[i] * P;
+		wA -= m_points.iA[i] * b3Cross(rA, P);
+
+		vB += m_points.mB[i] * P;
+		wB += m_points.iB[i] * b3Cross(rB, P);
+
+		velocities[indexA].v = vA;
+		velocities[indexA].w = wA;
+		velocities[indexB].v = vB;
+		velocities[indexB].w = wB;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(P));
+	}
+}
+
+void b3JointSolver::SolveRowConstraints(scalar& maxImpulseDelta)
+{
+	b3Velocity* velocities = m_solverData.velocities;
+
+	for (u32 i = 0; i < m_rows.count; ++i)
+	{
+		u32 indexA = m_rows.indexA[i];
+		u32 indexB = m_rows.indexB[i];
+
+		b3Vec3 wA = velocities[indexA].w;
+		b3Vec3 wB = velocities[indexB].w;
+
+		scalar Cdot = b3Dot(m_rows.axis[i], wB - wA);
+		scalar impulse = -m_rows.mass[i] * (Cdot + m_rows.bias[i]);
+		
+		scalar oldImpulse = m_rows.impulse[i];
+		m_rows.impulse[i] = b3Clamp(oldImpulse + impulse, m_rows.lower[i], m_rows.upper[i]);
+		impulse = m_rows.impulse[i] - oldImpulse;
+
+		velocities[indexA].w = wA - impulse * m_rows.invIAxisA[i];
+		velocities[indexB].w = wB + impulse * m_rows.invIAxisB[i];
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
+	}
+}
+
+scalar b3JointSolver::SolveVelocityConstraints() 
+{
+	scalar maxImpulseDelta = scalar(0);
+	for (u32 i = 0; i < m_genericCount; ++i) 
+	{
+		b3Joint* j = m_genericJoints[i];
+		scalar impulseDelta = j->SolveVelocityConstraints(&m_solverData);
+		maxImpulseDelta = b3Max(maxImpulseDelta, impulseDelta);
+	}
+
+	SolvePointConstraints(maxImpulseDelta);
+	SolveRowConstraints(maxImpulseDelta);
+
+	return maxImpulseDelta;
+}
+
+void b3JointSolver::StoreImpulses()
+{
+	for (u32 i = 0; i < m_points.count; ++i)
+	{
+		*m_points.jointImpulse[i] = m_points.impulse[i];
+	}
+
+	for (u32 i = 0; i < m_rows.count; ++i)
+	{
+		*m_rows.jointImpulse[i] = m_rows.impulse[i];
 	}
 }
 
@@ -54,12 +54,12 @@ void b3MotorJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	b3Vec3 xA = data->positions[m_indexA].x;
 	b3Quat qA = data->positions[m_indexA].q;
@@ -131,7 +131,7 @@ void b3MotorJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3MotorJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3MotorJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	scalar h = data->dt;
 	scalar inv_h = data->invdt;
@@ -141,6 +141,8 @@ void b3MotorJoint::SolveVelocityConstraints(const b3SolverData* data)
 	b3Vec3 vB = data->velocities[m_indexB].v;
 	b3Vec3 wB = data->velocities[m_indexB].w;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	// Solve linear friction
 	{
 		b3Vec3 Cdot = vB + b3Cross(wB, m_rB) - vA - b3Cross(wA, m_rA) + inv_h * m_correctionFactor * m_linearError;
@@ -164,6 +166,8 @@ void b3MotorJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += m_mB * impulse;
 		wB += m_iB * b3Cross(m_rB, impulse);
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	// Solve angular friction
@@ -186,12 +190,16 @@ void b3MotorJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * impulse;
 		wB += m_iB * impulse;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3MotorJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -200,6 +208,18 @@ bool b3MotorJoint::SolvePositionConstraints(const b3SolverData* data)
 	return true;
 }
 
+void b3MotorJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_linearImpulse);
+	buffer->Write(m_angularImpulse);
+}
+
+void b3MotorJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_linearImpulse);
+	buffer->Read(m_angularImpulse);
+}
+
 b3Vec3 b3MotorJoint::GetAnchorA() const
 {
 	return GetBodyA()->GetPosition();
@@ -54,9 +54,9 @@ void b3MouseJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyB = GetBodyB();
 
 	m_indexB = m_bodyB->m_islandID;
-	m_mB = m_bodyB->m_invMass;
+	m_mB = m_bodyB->InvMass();
 	m_iB = data->invInertias[m_indexB];
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	b3Vec3 xB = data->positions[m_indexB].x;
 	b3Quat qB = data->positions[m_indexB].q;
@@ -92,7 +92,7 @@ void b3MouseJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w += m_iB * b3Cross(m_rB, m_impulse);
 }
 
-void b3MouseJoint::SolveVelocityConstraints(const b3SolverData* data) 
+scalar b3MouseJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vB = data->velocities[m_indexB].v;
 	b3Vec3 wB = data->velocities[m_indexB].w;
@@ -114,6 +114,8 @@ void b3MouseJoint::SolveVelocityConstraints(const b3SolverData* data)
 	
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return b3Length(impulse);
 }
 
 bool b3MouseJoint::SolvePositionConstraints(const b3SolverData* data) 
@@ -123,6 +125,16 @@ bool b3MouseJoint::SolvePositionConstraints(const b3SolverData* data)
 	return true;
 }
 
+void b3MouseJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_impulse);
+}
+
+void b3MouseJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_impulse);
+}
+
 b3Vec3 b3MouseJoint::GetAnchorA() const 
 {
 	return m_worldTargetA;
@@ -66,12 +66,12 @@ void b3PrismaticJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
 
@@ -196,7 +196,7 @@ void b3PrismaticJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -206,6 +206,8 @@ void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 	scalar mA = m_mA, mB = m_mB;
 	b3Mat33 iA = m_iA, iB = m_iB;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	// Solve linear motor constraint.
 	if (m_enableMotor && m_limitState != e_equalLimits)
 	{
@@ -225,6 +227,8 @@ void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += mB * P;
 		wB += iB * LB;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	// Solve prismatic constraint in block form.
@@ -246,6 +250,8 @@ void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += mB * P;
 		wB += iB * LB;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	// Solve angular constraint in block form
@@ -256,6 +262,8 @@ void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= iA * impulse;
 		wB += iB * impulse;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	// Solve limit constraint.
@@ -285,12 +293,16 @@ void b3PrismaticJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += mB * P;
 		wB += iB * LB;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3PrismaticJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -456,6 +468,24 @@ bool b3PrismaticJoint::SolvePositionConstraints(const b3SolverData* data)
 	return linearError <= B3_LINEAR_SLOP && angularError <= B3_LINEAR_SLOP;
 }
 
+void b3PrismaticJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_linearImpulse);
+	buffer->Write(m_angularImpulse);
+	buffer->Write(m_limitImpulse);
+	buffer->Write(m_motorImpulse);
+	buffer->Write(m_limitState);
+}
+
+void b3PrismaticJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_linearImpulse);
+	buffer->Read(m_angularImpulse);
+	buffer->Read(m_limitImpulse);
+	buffer->Read(m_motorImpulse);
+	buffer->Read(m_limitState);
+}
+
 b3Vec3 b3PrismaticJoint::GetAnchorA() const
 {
 	return GetBodyA()->GetWorldPoint(m_localAnchorA);
@@ -482,20 +512,20 @@ scalar b3PrismaticJoint::GetJointSpeed() const
 	const b3Body* bA = GetBodyA();
 	const b3Body* bB = GetBodyB();
 
-	b3Vec3 rA = b3Mul(bA->m_xf.rotation, m_localAnchorA - bA->m_sweep.localCenter);
-	b3Vec3 rB = b3Mul(bB->m_xf.rotation, m_localAnchorB - bB->m_sweep.localCenter);
+	b3Vec3 rA = b3Mul(bA->Transform().rotation, m_localAnchorA - bA->Sweep().localCenter);
+	b3Vec3 rB = b3Mul(bB->Transform().rotation, m_localAnchorB - bB->Sweep().localCenter);
 
-	b3Vec3 p1 = bA->m_sweep.worldCenter + rA;
-	b3Vec3 p2 = bB->m_sweep.worldCenter + rB;
+	b3Vec3 p1 = bA->Sweep().worldCenter + rA;
+	b3Vec3 p2 = bB->Sweep().worldCenter + rB;
 
 	b3Vec3 d = p2 - p1;
 
-	b3Vec3 axis = b3Mul(bA->m_xf.rotation, m_localXAxisA);
+	b3Vec3 axis = b3Mul(bA->Transform().rotation, m_localXAxisA);
 
-	b3Vec3 vA = bA->m_linearVelocity;
-	b3Vec3 vB = bB->m_linearVelocity;
-	b3Vec3 wA = bA->m_angularVelocity;
-	b3Vec3 wB = bB->m_angularVelocity;
+	b3Vec3 vA = bA->LinearVelocity();
+	b3Vec3 vB = bB->LinearVelocity();
+	b3Vec3 wA = bA->AngularVelocity();
+	b3Vec3 wB = bB->AngularVelocity();
 
 	scalar speed = b3Dot(d, b3Cross(wA, axis)) + b3Dot(axis, vB + b3Cross(wB, rB) - vA - b3Cross(wA, rA));
 	return speed;
@@ -81,12 +81,12 @@ void b3RevoluteJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 	
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
@@ -247,7 +247,7 @@ void b3RevoluteJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -257,6 +257,8 @@ void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 	b3Mat33 iA = m_iA;
 	b3Mat33 iB = m_iB;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	// Solve motor constraint.
 	if (m_enableMotor && m_limitState != e_equalLimits)
 	{
@@ -272,6 +274,8 @@ void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= iA * P;
 		wB += iB * P;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	// Solve limit constraint.
@@ -301,6 +305,8 @@ void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= iA * P;
 		wB += iB * P;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Abs(impulse));
 	}
 
 	// Solve linear constraints.
@@ -315,6 +321,8 @@ void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += m_mB * impulse;
 		wB += m_iB * b3Cross(m_rB, impulse);
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	// Solve angular constraints.
@@ -333,12 +341,16 @@ void b3RevoluteJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * L;
 		wB += m_iB * L;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3RevoluteJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -483,6 +495,24 @@ bool b3RevoluteJoint::SolvePositionConstraints(const b3SolverData* data)
 	return linearError <= B3_LINEAR_SLOP && angularError <= B3_ANGULAR_SLOP;
 }
 
+void b3RevoluteJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_linearImpulse);
+	buffer->Write(m_angularImpulse);
+	buffer->Write(m_limitImpulse);
+	buffer->Write(m_motorImpulse);
+	buffer->Write(m_limitState);
+}
+
+void b3RevoluteJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_linearImpulse);
+	buffer->Read(m_angularImpulse);
+	buffer->Read(m_limitImpulse);
+	buffer->Read(m_motorImpulse);
+	buffer->Read(m_limitState);
+}
+
 b3Transform b3RevoluteJoint::GetFrameA() const
 {
 	b3Transform xf(m_localAnchorA, m_localRotationA);
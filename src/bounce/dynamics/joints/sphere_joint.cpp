@@ -43,12 +43,12 @@ void b3SphereJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
 
@@ -87,7 +87,7 @@ void b3SphereJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3SphereJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3SphereJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -109,6 +109,8 @@ void b3SphereJoint::SolveVelocityConstraints(const b3SolverData* data)
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return b3Length(impulse);
 }
 
 bool b3SphereJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -156,6 +158,16 @@ bool b3SphereJoint::SolvePositionConstraints(const b3SolverData* data)
 	return b3Length(C) <= B3_LINEAR_SLOP;
 }
 
+void b3SphereJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_impulse);
+}
+
+void b3SphereJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_impulse);
+}
+
 b3Vec3 b3SphereJoint::GetAnchorA() const
 {
 	return GetBodyA()->GetWorldPoint(m_localAnchorA);
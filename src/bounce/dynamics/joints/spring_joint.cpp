@@ -102,14 +102,14 @@ void b3SpringJoint::InitializeConstraints(const b3SolverData* data)
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
 
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
 
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
@@ -191,7 +191,7 @@ void b3SpringJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w += m_iB * b3Cross(m_rB, P);
 }
 
-void b3SpringJoint::SolveVelocityConstraints(const b3SolverData* data) 
+scalar b3SpringJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -216,6 +216,8 @@ void b3SpringJoint::SolveVelocityConstraints(const b3SolverData* data)
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return b3Abs(impulse);
 }
 
 bool b3SpringJoint::SolvePositionConstraints(const b3SolverData* data) 
@@ -273,6 +275,16 @@ bool b3SpringJoint::SolvePositionConstraints(const b3SolverData* data)
 	return b3Abs(C) < B3_LINEAR_SLOP;
 }
 
+void b3SpringJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_impulse);
+}
+
+void b3SpringJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_impulse);
+}
+
 void b3SpringJoint::Draw(b3Draw* draw) const
 {
 	b3Vec3 a = GetBodyA()->GetWorldPoint(m_localAnchorA);
@@ -91,14 +91,14 @@ void b3WeldJoint::InitializeConstraints(const b3SolverData* data)
 
 	m_indexA = m_bodyA->m_islandID;
 	m_indexB = m_bodyB->m_islandID;
-	m_mA = m_bodyA->m_invMass;
-	m_mB = m_bodyB->m_invMass;
+	m_mA = m_bodyA->InvMass();
+	m_mB = m_bodyB->InvMass();
 	m_iA = data->invInertias[m_indexA];
 	m_iB = data->invInertias[m_indexB];
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
-	m_localInvIA = m_bodyA->m_invI;
-	m_localInvIB = m_bodyB->m_invI;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
+	m_localInvIA = m_bodyA->InvInertia();
+	m_localInvIB = m_bodyB->InvInertia();
 
 	b3Quat qA = data->positions[m_indexA].q;
 	b3Quat qB = data->positions[m_indexB].q;
@@ -184,7 +184,7 @@ void b3WeldJoint::WarmStart(const b3SolverData* data)
 	data->velocities[m_indexB].w = wB;
 }
 
-void b3WeldJoint::SolveVelocityConstraints(const b3SolverData* data)
+scalar b3WeldJoint::SolveVelocityConstraints(const b3SolverData* data)
 {
 	b3Vec3 vA = data->velocities[m_indexA].v;
 	b3Vec3 wA = data->velocities[m_indexA].w;
@@ -194,6 +194,8 @@ void b3WeldJoint::SolveVelocityConstraints(const b3SolverData* data)
 	b3Quat qA = data->positions[m_indexA].q;
 	b3Quat qB = data->positions[m_indexB].q;
 
+	scalar maxImpulseDelta = scalar(0);
+
 	{
 		b3Vec3 Cdot = vB + b3Cross(wB, m_rB) - vA - b3Cross(wA, m_rA);
 		b3Vec3 impulse = m_linearMass.Solve(-Cdot);
@@ -205,6 +207,8 @@ void b3WeldJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		vB += m_mB * impulse;
 		wB += m_iB * b3Cross(m_rB, impulse);
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	{
@@ -214,12 +218,16 @@ void b3WeldJoint::SolveVelocityConstraints(const b3SolverData* data)
 
 		wA -= m_iA * impulse;
 		wB += m_iB * impulse;
+
+		maxImpulseDelta = b3Max(maxImpulseDelta, b3Length(impulse));
 	}
 
 	data->velocities[m_indexA].v = vA;
 	data->velocities[m_indexA].w = wA;
 	data->velocities[m_indexB].v = vB;
 	data->velocities[m_indexB].w = wB;
+
+	return maxImpulseDelta;
 }
 
 bool b3WeldJoint::SolvePositionConstraints(const b3SolverData* data)
@@ -313,6 +321,18 @@ bool b3WeldJoint::SolvePositionConstraints(const b3SolverData* data)
 	return linearError <= B3_LINEAR_SLOP && angularError <= B3_ANGULAR_SLOP;
 }
 
+void b3WeldJoint::SaveState(b3StateBuffer* buffer) const
+{
+	buffer->Write(m_linearImpulse);
+	buffer->Write(m_angularImpulse);
+}
+
+void b3WeldJoint::RestoreState(b3StateBuffer* buffer)
+{
+	buffer->Read(m_linearImpulse);
+	buffer->Read(m_angularImpulse);
+}
+
 b3Vec3 b3WeldJoint::GetAnchorA() const
 {
 	return GetBodyA()->GetWorldPoint(m_localAnchorA);
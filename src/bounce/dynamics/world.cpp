@@ -22,55 +22,126 @@
 #include <bounce/dynamics/island.h>
 #include <bounce/dynamics/world_callbacks.h>
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/contact_solver.h>
 #include <bounce/dynamics/joints/joint.h>
 #include <bounce/dynamics/time_step.h>
 #include <bounce/collision/collide/collide.h>
 #include <bounce/collision/time_of_impact.h>
 #include <bounce/collision/gjk/gjk.h>
 #include <bounce/collision/gjk/gjk_proxy.h>
+#include <bounce/collision/shapes/hull_shape.h>
+#include <bounce/collision/geometry/hull.h>
 #include <bounce/collision/shapes/mesh_shape.h>
 #include <bounce/collision/geometry/mesh.h>
+#include <bounce/collision/shapes/height_field_shape.h>
+#include <bounce/collision/geometry/height_field.h>
+#include <bounce/collision/shapes/compound_shape.h>
+#include <bounce/collision/geometry/compound.h>
 #include <bounce/common/draw.h>
 #include <bounce/common/profiler.h>
+#include <algorithm>
 
-extern u32 b3_allocCalls, b3_maxAllocCalls;
-extern u32 b3_convexCalls, b3_convexCacheHits;
-extern u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters;
-extern bool b3_convexCache;
+extern thread_local u32 b3_allocCalls;
+extern thread_local u32 b3_convexCalls, b3_convexCacheHits;
+extern thread_local u32 b3_contactUpdates, b3_contactReuses;
+extern thread_local u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters, b3_gjkCacheHits;
+extern thread_local u32 b3_toiCalls, b3_toiMaxIters;
 
 b3World::b3World()
 {
 	m_flags = e_clearForcesFlag;
 	m_sleeping = false;
 	m_warmStarting = true;
+	m_convexCache = true;
+	m_contactReuse = true;
+	m_blockSolve = false;
+	m_splitImpulse = false;
+	m_continuousPhysics = false;
+	m_speculativeContacts = false;
+	m_jointBatching = false;
+	m_impulseTolerance = scalar(0);
+	m_subStepCount = 0;
+	m_timeStep = scalar(0);
+	m_stepCount = 0;
 	
 	m_gravity.Set(scalar(0), scalar(-9.8), scalar(0));
 	
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_stackAllocator = &m_stackAllocator;
 	m_jointManager.m_allocator = &m_blockAllocator;
 	
 	m_drawFlags = 0;
 	m_debugDraw = nullptr;
 	m_profiler = nullptr;
-	
-	b3_allocCalls = 0;
-	b3_maxAllocCalls = 0;
-	b3_gjkCalls = 0;
-	b3_gjkIters = 0;
-	b3_convexCalls = 0;
-	b3_convexCacheHits = 0;
-	b3_convexCache = true;
+
+	memset(&m_stepStats, 0, sizeof(b3StepStats));
+
+	m_publishedTransforms = nullptr;
+	m_publishedCapacity = 0;
+	m_publishedCount = 0;
+
+	m_stepThread = nullptr;
+	m_stepRequested = false;
+	m_stepDone = false;
+	m_stepQuit = false;
+	m_stepping = false;
+	m_locked = false;
+	m_stepDt = scalar(0);
+	m_stepVelocityIterations = 0;
+	m_stepPositionIterations = 0;
 }
 
 b3World::~b3World()
 {
-	// None of the objects use b3Alloc.
-	b3_allocCalls = 0;
-	b3_maxAllocCalls = 0;
-	b3_gjkCalls = 0;
-	b3_gjkIters = 0;
-	b3_convexCalls = 0;
-	b3_convexCacheHits = 0;
+	WaitStep();
+
+	if (m_stepThread)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stepMutex);
+			m_stepQuit = true;
+		}
+		m_stepCondition.notify_all();
+		m_stepThread->join();
+		delete m_stepThread;
+	}
+
+	b3Free(m_publishedTransforms);
+
+	b3Articulation* a = m_articulationList.m_head;
+	while (a)
+	{
+		b3Articulation* next = a->m_next;
+		a->~b3Articulation();
+		a = next;
+	}
+
+	// Destroy the contacts. The mesh, height field, and compound contacts use b3Alloc 
+	// for their caches, and the contacts larger than the largest block use b3Alloc too.
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
+	{
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			b3Array<b3Contact*>& contacts = m_contactManager.m_contacts[i][j];
+			for (u32 k = 0; k < contacts.Count(); ++k)
+			{
+				b3Contact::Destroy(contacts[k], m_contactManager.m_allocator);
+			}
+		}
+	}
+
+	// Free the fixture contact edges that didn't fit inside the fixtures.
+	// The bodies, fixtures, shapes, and joints live in the block allocator, which frees its memory when it is destroyed.
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		b3Fixture* f = b->m_fixtureList.m_head;
+		while (f)
+		{
+			b3Fixture* next = f->m_next;
+			f->~b3Fixture();
+			f = next;
+		}
+	}
 }
 
 void b3World::SetSleeping(bool flag)
@@ -82,51 +153,191 @@ void b3World::SetSleeping(bool flag)
 		{
 			b->SetAwake(true);
 		}
+
+		for (b3Articulation* a = m_articulationList.m_head; a; a = a->m_next)
+		{
+			a->SetAwake(true);
+		}
 	}
 }
 
 b3Body* b3World::CreateBody(const b3BodyDef& def)
 {
+	B3_ASSERT(m_stepping == false);
+
 	void* mem = m_blockAllocator.Allocate(sizeof(b3Body));
 	b3Body* b = new(mem) b3Body(def, this);
 	m_bodyList.PushFront(b);
+	b->MarkMoved();
 	return b;
 }
 
 void b3World::DestroyBody(b3Body* b)
 {
+	B3_ASSERT(m_stepping == false);
+
+	// Destroy the articulation first.
+	B3_ASSERT(b->m_articulation == nullptr);
+
 	b->DestroyFixtures();
 	b->DestroyJoints();
 	b->DestroyContacts();
 
+	// Remove the body from the moved list.
+	if (b->m_movedIndex != B3_MAX_U32)
+	{
+		B3_ASSERT(m_movedBodies[b->m_movedIndex] == b);
+		b3Body* last = m_movedBodies[m_movedBodies.Count() - 1];
+		m_movedBodies[b->m_movedIndex] = last;
+		last->m_movedIndex = b->m_movedIndex;
+		m_movedBodies.PopBack();
+	}
+
 	m_bodyList.Remove(b);
+	
+	u32 index = b->m_index;
+	m_bodyStorage.Remove(index);
+	
+	// The last body was moved into the free index. 
+	// Mark it moved so a moved-only export writes the new index.
+	if (index < m_bodyStorage.m_count)
+	{
+		m_bodyStorage.m_bodies[index]->MarkMoved();
+	}
+
 	b->~b3Body();
 	m_blockAllocator.Free(b, sizeof(b3Body));
 }
 
+void b3World::BeginBulkLoad()
+{
+	m_contactManager.m_broadPhase.BeginBulkLoad();
+}
+
+void b3World::EndBulkLoad()
+{
+	m_contactManager.m_broadPhase.EndBulkLoad();
+
+	if (m_flags & e_fixtureAddedFlag)
+	{
+		// Find the pairs of all new proxies in a single pass.
+		m_contactManager.FindNewContacts();
+		m_flags &= ~e_fixtureAddedFlag;
+	}
+}
+
+void b3World::CreateBodies(const b3BodyDef* bodyDefs, const b3FixtureDef* fixtureDefs, u32 count, b3Body** bodies)
+{
+	BeginBulkLoad();
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		b3Body* b = CreateBody(bodyDefs[i]);
+		
+		if (fixtureDefs)
+		{
+			b->CreateFixture(fixtureDefs[i]);
+		}
+
+		bodies[i] = b;
+	}
+
+	EndBulkLoad();
+}
+
 b3Joint* b3World::CreateJoint(const b3JointDef& def)
 {
+	B3_ASSERT(m_stepping == false);
+
+	// Articulation links can't be connected to joints.
+	B3_ASSERT(def.bodyA->m_articulation == nullptr);
+	B3_ASSERT(def.bodyB->m_articulation == nullptr);
+
 	return m_jointManager.Create(&def);
 }
 
 void b3World::DestroyJoint(b3Joint* j)
 {
+	B3_ASSERT(m_stepping == false);
+
 	m_jointManager.Destroy(j);
 }
 
+b3Articulation* b3World::CreateArticulation(const b3ArticulationDef& def)
+{
+	void* mem = m_blockAllocator.Allocate(sizeof(b3Articulation));
+	b3Articulation* a = new(mem) b3Articulation(def, this);
+	m_articulationList.PushFront(a);
+	return a;
+}
+
+void b3World::DestroyArticulation(b3Articulation* a)
+{
+	m_articulationList.Remove(a);
+	a->~b3Articulation();
+	m_blockAllocator.Free(a, sizeof(b3Articulation));
+}
+
 void b3World::Step(scalar dt, u32 velocityIterations, u32 positionIterations)
+{
+	// The step thread calls Simulate directly.
+	B3_ASSERT(m_stepping == false);
+
+	Simulate(dt, velocityIterations, positionIterations);
+}
+
+void b3World::Simulate(scalar dt, u32 velocityIterations, u32 positionIterations)
 {
 	B3_PROFILE(m_profiler, "Step");
 
-	// Clear statistics
+	B3_ASSERT(m_contactManager.m_broadPhase.IsBulkLoading() == false);
+
+	B3_ASSERT(m_locked == false);
+	m_locked = true;
+
+	// Clear the statistics of this thread
 	b3_allocCalls = 0;
 
 	b3_convexCalls = 0;
 	b3_convexCacheHits = 0;
 
+	b3_contactUpdates = 0;
+	b3_contactReuses = 0;
+
 	b3_gjkCalls = 0;
 	b3_gjkIters = 0;
 	b3_gjkMaxIters = 0;
+	b3_gjkCacheHits = 0;
+
+	b3_toiCalls = 0;
+	b3_toiMaxIters = 0;
+
+	m_stepStats.islandCount = 0;
+	m_stepStats.velocityIters = 0;
+	m_stepStats.maxVelocityIters = 0;
+
+	// The contacts predict the motion in this step.
+	m_timeStep = dt;
+
+	// Keep the bodies moved after the last step and the bodies moved by the last step. 
+	// A body that stops moving in this step stays in the list for this step, 
+	// so a moved-only export replaces its interpolated transform by its final transform.
+	++m_stepCount;
+	u32 movedCount = 0;
+	for (u32 i = 0; i < m_movedBodies.Count(); ++i)
+	{
+		b3Body* b = m_movedBodies[i];
+		if (b->m_movedStamp + 1 >= m_stepCount)
+		{
+			b->m_movedIndex = movedCount;
+			m_movedBodies[movedCount++] = b;
+		}
+		else
+		{
+			b->m_movedIndex = B3_MAX_U32;
+		}
+	}
+	m_movedBodies.Resize(movedCount);
 
 	if (m_flags & e_fixtureAddedFlag)
 	{
@@ -143,6 +354,171 @@ void b3World::Step(scalar dt, u32 velocityIterations, u32 positionIterations)
 	{
 		Solve(dt, velocityIterations, positionIterations);
 	}
+
+	// Copy the statistics of this thread to this world
+	m_stepStats.gjkCalls = b3_gjkCalls;
+	m_stepStats.gjkIters = b3_gjkIters;
+	m_stepStats.gjkMaxIters = b3_gjkMaxIters;
+	m_stepStats.gjkCacheHits = b3_gjkCacheHits;
+	
+	m_stepStats.convexCalls = b3_convexCalls;
+	m_stepStats.convexCacheHits = b3_convexCacheHits;
+	
+	m_stepStats.contactUpdates = b3_contactUpdates;
+	m_stepStats.contactReuses = b3_contactReuses;
+	
+	m_stepStats.toiCalls = b3_toiCalls;
+	m_stepStats.toiMaxIters = b3_toiMaxIters;
+	
+	m_stepStats.allocCalls = b3_allocCalls;
+	m_stepStats.maxAllocCalls = b3Max(m_stepStats.maxAllocCalls, b3_allocCalls);
+
+	m_locked = false;
+}
+
+b3Transform b3World::GetExportTransform(const b3Body* b, scalar alpha) const
+{
+	// The sweeps of the bodies that didn't move in the last step can be older.
+	if (alpha < scalar(1) && b->m_movedStamp == m_stepCount)
+	{
+		return b->Sweep().GetTransform(alpha);
+	}
+
+	return b->Transform();
+}
+
+void b3World::ExportTransforms(b3Transform* transforms, bool movedOnly, scalar alpha) const
+{
+	B3_ASSERT(scalar(0) <= alpha && alpha <= scalar(1));
+
+	if (movedOnly)
+	{
+		for (u32 i = 0; i < m_movedBodies.Count(); ++i)
+		{
+			const b3Body* b = m_movedBodies[i];
+			transforms[b->m_index] = GetExportTransform(b, alpha);
+		}
+		return;
+	}
+
+	if (alpha == scalar(1))
+	{
+		memcpy(transforms, m_bodyStorage.m_transforms, m_bodyStorage.m_count * sizeof(b3Transform));
+		return;
+	}
+
+	for (u32 i = 0; i < m_bodyStorage.m_count; ++i)
+	{
+		transforms[i] = GetExportTransform(m_bodyStorage.m_bodies[i], alpha);
+	}
+}
+
+void b3World::ExportMatrices(b3Mat44* matrices, bool movedOnly, scalar alpha) const
+{
+	B3_ASSERT(scalar(0) <= alpha && alpha <= scalar(1));
+
+	if (movedOnly)
+	{
+		for (u32 i = 0; i < m_movedBodies.Count(); ++i)
+		{
+			const b3Body* b = m_movedBodies[i];
+			matrices[b->m_index] = GetExportTransform(b, alpha).GetTransformMatrix();
+		}
+		return;
+	}
+
+	for (u32 i = 0; i < m_bodyStorage.m_count; ++i)
+	{
+		matrices[i] = GetExportTransform(m_bodyStorage.m_bodies[i], alpha).GetTransformMatrix();
+	}
+}
+
+void b3World::PublishTransforms()
+{
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+
+	u32 count = m_bodyStorage.m_count;
+	if (count > m_publishedCapacity)
+	{
+		b3Free(m_publishedTransforms);
+		m_publishedCapacity = b3Max(count, 2 * m_publishedCapacity);
+		m_publishedTransforms = (b3Transform*)b3Alloc(m_publishedCapacity * sizeof(b3Transform));
+	}
+
+	memcpy(m_publishedTransforms, m_bodyStorage.m_transforms, count * sizeof(b3Transform));
+	m_publishedCount = count;
+}
+
+u32 b3World::GetPublishedTransforms(b3Transform* transforms, u32 capacity) const
+{
+	std::lock_guard<std::mutex> lock(m_publishMutex);
+
+	u32 count = b3Min(capacity, m_publishedCount);
+	memcpy(transforms, m_publishedTransforms, count * sizeof(b3Transform));
+	return m_publishedCount;
+}
+
+void b3World::StepThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_stepMutex);
+	for (;;)
+	{
+		m_stepCondition.wait(lock, [this]() { return m_stepRequested || m_stepQuit; });
+		
+		if (m_stepQuit)
+		{
+			return;
+		}
+
+		m_stepRequested = false;
+		
+		lock.unlock();
+		
+		Simulate(m_stepDt, m_stepVelocityIterations, m_stepPositionIterations);
+		
+		lock.lock();
+		
+		m_stepDone = true;
+		
+		m_stepCondition.notify_all();
+	}
+}
+
+void b3World::BeginStep(scalar dt, u32 velocityIterations, u32 positionIterations)
+{
+	B3_ASSERT(m_stepping == false);
+
+	PublishTransforms();
+
+	if (m_stepThread == nullptr)
+	{
+		m_stepThread = new std::thread(&b3World::StepThreadMain, this);
+	}
+
+	m_stepping = true;
+
+	{
+		std::lock_guard<std::mutex> lock(m_stepMutex);
+		m_stepDt = dt;
+		m_stepVelocityIterations = velocityIterations;
+		m_stepPositionIterations = positionIterations;
+		m_stepRequested = true;
+		m_stepDone = false;
+	}
+	m_stepCondition.notify_all();
+}
+
+void b3World::WaitStep()
+{
+	if (m_stepping == false)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_stepMutex);
+	m_stepCondition.wait(lock, [this]() { return m_stepDone; });
+	
+	m_stepping = false;
 }
 
 void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
@@ -150,9 +526,9 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 	B3_PROFILE(m_profiler, "Solve");
 
 	// Clear all visited flags for the depth first search.
-	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	for (u32 i = 0; i < m_bodyStorage.m_count; ++i)
 	{
-		b->m_flags &= ~b3Body::e_islandFlag;
+		m_bodyStorage.m_bodies[i]->m_flags &= ~b3Body::e_islandFlag;
 	}
 
 	for (b3Joint* j = m_jointManager.m_jointList.m_head; j; j = j->m_next)
@@ -160,14 +536,38 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 		j->m_flags &= ~b3Joint::e_islandFlag;
 	}
 
-	for (b3Contact* c = m_contactManager.m_contactList.m_head; c; c = c->m_next)
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
 	{
-		c->m_flags &= ~b3Contact::e_islandFlag;
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			b3Contact** contacts = m_contactManager.m_contacts[i][j].Begin();
+			u32 count = m_contactManager.m_contacts[i][j].Count();
+			for (u32 k = 0; k < count; ++k)
+			{
+				contacts[k]->m_flags &= ~b3Contact::e_islandFlag;
+			}
+		}
+	}
+
+	// Step the articulations before the islands so the bodies pushed by the links 
+	// move in this step. This marks the link bodies so they aren't added to islands.
+	if (m_articulationList.m_count > 0)
+	{
+		B3_PROFILE(m_profiler, "Articulations");
+
+		for (b3Articulation* a = m_articulationList.m_head; a; a = a->m_next)
+		{
+			a->Step(m_gravity, dt, velocityIterations, m_warmStarting, m_sleeping, &m_stackAllocator, m_contactManager.m_contactFilter);
+		}
 	}
 
 	u32 islandFlags = 0;
 	islandFlags |= m_warmStarting * b3Island::e_warmStartBit;
 	islandFlags |= m_sleeping * b3Island::e_sleepBit;
+	islandFlags |= m_blockSolve * b3Island::e_blockSolveBit;
+	islandFlags |= m_splitImpulse * b3Island::e_splitImpulseBit;
+	islandFlags |= m_speculativeContacts * b3Island::e_speculativeBit;
+	islandFlags |= m_jointBatching * b3Island::e_jointBatchBit;
 
 	// Create a worst case island.
 	b3Island island(&m_stackAllocator, 
@@ -224,8 +624,11 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 			// Search all contacts connected to this body.
 			for (b3Fixture* f = b->m_fixtureList.m_head; f; f = f->m_next)
 			{
-				for (b3ContactEdge* ce = f->m_contactEdges.m_head; ce; ce = ce->m_next)
+				const b3ContactEdge* edges = f->m_contactEdges.Begin();
+				u32 edgeCount = f->m_contactEdges.Count();
+				for (u32 k = 0; k < edgeCount; ++k)
 				{
+					const b3ContactEdge* ce = edges + k;
 					b3Contact* contact = ce->contact;
 
 					// The contact must not be on an island.
@@ -246,6 +649,12 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 						continue;
 					}
 
+					// Contacts with articulation links are solved by the articulations.
+					if (contact->GetFixtureA()->m_body->m_articulation || contact->GetFixtureB()->m_body->m_articulation)
+					{
+						continue;
+					}
+
 					// A sensor can't respond to contacts. 
 					bool sensorA = contact->GetFixtureA()->m_isSensor;
 					bool sensorB = contact->GetFixtureB()->m_isSensor;
@@ -313,7 +722,11 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 		}
 
 		// Integrate velocities, clear forces and torques, solve constraints, integrate positions.
-		island.Solve(m_gravity, dt, velocityIterations, positionIterations, islandFlags);
+		island.Solve(m_gravity, dt, velocityIterations, positionIterations, m_impulseTolerance, m_subStepCount, islandFlags);
+
+		++m_stepStats.islandCount;
+		m_stepStats.velocityIters += island.m_velocityIterationCount;
+		m_stepStats.maxVelocityIters = b3Max(m_stepStats.maxVelocityIters, island.m_velocityIterationCount);
 
 		// Allow static bodies to participate in other islands.
 		for (u32 i = 0; i < island.m_bodyCount; ++i)
@@ -344,15 +757,486 @@ void b3World::Solve(scalar dt, u32 velocityIterations, u32 positionIterations)
 				continue;
 			}
 
-			// Update fixtures for broad-phase.
-			b->SynchronizeFixtures();
+			b->m_movedStamp = m_stepCount;
+			if (b->m_movedIndex == B3_MAX_U32)
+			{
+				b->m_movedIndex = m_movedBodies.Count();
+				m_movedBodies.PushBack(b);
+			}
+
+			// Update fixtures for broad-phase.
+			b->SynchronizeFixtures();
+		}
+
+		// The fixtures swept in this step are in the broad-phase.
+		if (m_continuousPhysics)
+		{
+			SolveTOI(dt);
+		}
+
+		// Update fixtures for mid-phase.
+		m_contactManager.SynchronizeFixtures();
+
+		// Find new contacts.
+		m_contactManager.FindNewContacts();
+	}
+}
+
+// Get the convex child of a fixture and its sweep.
+static void b3GetChildSweep(b3ShapeGJKProxy* proxy, b3Sweep* sweep, const b3Fixture* fixture, u32 childIndex, const b3Sweep& bodySweep)
+{
+	const b3Shape* shape = fixture->GetShape();
+	*sweep = bodySweep;
+
+	if (shape->GetType() == b3Shape::e_compound)
+	{
+		const b3CompoundShape* compound = (b3CompoundShape*)shape;
+
+		b3Transform xfChild;
+		const b3Shape* child = compound->GetChildShape(&xfChild, childIndex);
+
+		// The child frame is the body frame times the child transform.
+		sweep->localCenter = b3MulC(xfChild.rotation, bodySweep.localCenter - xfChild.translation);
+		sweep->orientation0 = bodySweep.orientation0 * xfChild.rotation;
+		sweep->orientation = bodySweep.orientation * xfChild.rotation;
+
+		proxy->Set(child, 0);
+		return;
+	}
+
+	proxy->Set(shape, childIndex);
+}
+
+// Get the sweep of a body in the remaining fraction of the step.
+static b3Sweep b3GetRemainingSweep(const b3Body* body, scalar alpha)
+{
+	b3Sweep sweep = body->GetSweep();
+	
+	// Bodies that weren't solved in this step don't move.
+	if (body->GetType() == e_staticBody || body->IsAwake() == false)
+	{
+		sweep.worldCenter0 = sweep.worldCenter;
+		sweep.orientation0 = sweep.orientation;
+		return sweep;
+	}
+
+	sweep.Advance(alpha);
+	return sweep;
+}
+
+// Find the earliest impact of a fast body against the static and kinematic fixtures.
+struct b3WorldTOIQueryWrapper
+{
+	struct MeshQueryWrapper
+	{
+		bool Report(u32 proxyId)
+		{
+			u32 triangleIndex = wrapper->meshB->m_mesh->tree.GetUserData(proxyId);
+			wrapper->ReportChild(triangleIndex);
+			return true;
+		}
+
+		b3WorldTOIQueryWrapper* wrapper;
+	};
+
+	struct HeightFieldQueryWrapper
+	{
+		bool Report(u32 triangleIndex)
+		{
+			wrapper->ReportChild(triangleIndex);
+			return true;
+		}
+
+		b3WorldTOIQueryWrapper* wrapper;
+	};
+
+	struct CompoundQueryWrapper
+	{
+		bool Report(u32 proxyId)
+		{
+			u32 childIndex = compoundB->m_compound->tree.GetUserData(proxyId);
+			wrapper->ReportChild(childIndex);
+			return true;
+		}
+
+		b3WorldTOIQueryWrapper* wrapper;
+		const b3CompoundShape* compoundB;
+	};
+
+	// Sweep the children of the fixture A against a child of the fixture B.
+	void ReportChild(u32 childIndexB)
+	{
+		b3ShapeGJKProxy proxyB;
+		b3Sweep sweepB;
+		b3GetChildSweep(&proxyB, &sweepB, fixtureB, childIndexB, bodySweepB);
+
+		const b3Shape* shapeA = fixtureA->GetShape();
+		u32 childCountA = 1;
+		if (shapeA->GetType() == b3Shape::e_compound)
+		{
+			childCountA = ((b3CompoundShape*)shapeA)->m_compound->childCount;
+		}
+
+		for (u32 childIndexA = 0; childIndexA < childCountA; ++childIndexA)
+		{
+			b3ShapeGJKProxy proxyA;
+			b3Sweep sweepA;
+			b3GetChildSweep(&proxyA, &sweepA, fixtureA, childIndexA, bodySweepA);
+
+			b3TOIInput input;
+			input.proxyA = proxyA;
+			input.proxyB = proxyB;
+			input.sweepA = sweepA;
+			input.sweepB = sweepB;
+			input.tMax = t0;
+
+			b3TOIOutput output = b3TimeOfImpact(input);
+
+			// Impacts at the start of the sweep are ignored. These are the shapes 
+			// touching since the last impact or handled by the contact solver.
+			if (output.state == b3TOIOutput::e_touching && scalar(0) < output.t && output.t < t0)
+			{
+				t0 = output.t;
+				fixtureA0 = fixtureA;
+				childIndexA0 = childIndexA;
+				fixtureB0 = fixtureB;
+				childIndexB0 = childIndexB;
+			}
+		}
+	}
+
+	// Compute the AABB swept by the fixture A in the frame of the unscaled shape B.
+	b3AABB ComputeSweptAABB(const b3Vec3& scaleB) const
+	{
+		B3_ASSERT(scaleB.x != scalar(0));
+		B3_ASSERT(scaleB.y != scalar(0));
+		B3_ASSERT(scaleB.z != scalar(0));
+
+		b3Vec3 inv_scale;
+		inv_scale.x = scalar(1) / scaleB.x;
+		inv_scale.y = scalar(1) / scaleB.y;
+		inv_scale.z = scalar(1) / scaleB.z;
+
+		b3Transform xfA1 = bodySweepA.GetTransform(scalar(0));
+		b3Transform xfA2 = bodySweepA.GetTransform(scalar(1));
+		b3Transform xfB1 = bodySweepB.GetTransform(scalar(0));
+		b3Transform xfB2 = bodySweepB.GetTransform(scalar(1));
+
+		b3AABB aabb1, aabb2;
+		fixtureA->GetShape()->ComputeAABB(&aabb1, b3MulT(xfB1, xfA1));
+		fixtureA->GetShape()->ComputeAABB(&aabb2, b3MulT(xfB2, xfA2));
+
+		b3AABB aabb = b3Combine(aabb1, aabb2);
+		aabb.Scale(inv_scale);
+		return aabb;
+	}
+
+	bool Report(u32 proxyId)
+	{
+		fixtureB = (b3Fixture*)broadPhase->GetUserData(proxyId);
+		if (fixtureB->IsSensor())
+		{
+			return true;
+		}
+
+		// Fast dynamic bodies only collide continuously with static and kinematic bodies.
+		b3Body* bodyB = fixtureB->GetBody();
+		if (bodyB->m_type == e_dynamicBody)
+		{
+			return true;
+		}
+
+		if (bodyA->ShouldCollide(bodyB) == false)
+		{
+			return true;
+		}
+
+		if (filter)
+		{
+			if (filter->ShouldCollide(fixtureA, fixtureB) == false || filter->ShouldRespond(fixtureA, fixtureB) == false)
+			{
+				return true;
+			}
+		}
+
+		bodySweepB = b3GetRemainingSweep(bodyB, alpha);
+
+		b3Shape* shapeB = fixtureB->GetShape();
+
+		if (shapeB->GetType() == b3Shape::e_mesh)
+		{
+			meshB = (b3MeshShape*)shapeB;
+
+			b3AABB aabb = ComputeSweptAABB(meshB->m_scale);
+
+			MeshQueryWrapper wrapper;
+			wrapper.wrapper = this;
+
+			meshB->m_mesh->tree.QueryAABB(&wrapper, aabb);
+
+			return true;
+		}
+
+		if (shapeB->GetType() == b3Shape::e_heightField)
+		{
+			b3HeightFieldShape* heightFieldB = (b3HeightFieldShape*)shapeB;
+
+			b3AABB aabb = ComputeSweptAABB(heightFieldB->m_scale);
+
+			HeightFieldQueryWrapper wrapper;
+			wrapper.wrapper = this;
+
+			heightFieldB->m_heightField->QueryAABB(&wrapper, aabb);
+
+			return true;
+		}
+
+		if (shapeB->GetType() == b3Shape::e_compound)
+		{
+			const b3CompoundShape* compoundB = (b3CompoundShape*)shapeB;
+
+			b3AABB aabb = ComputeSweptAABB(b3Vec3(scalar(1), scalar(1), scalar(1)));
+
+			CompoundQueryWrapper wrapper;
+			wrapper.wrapper = this;
+			wrapper.compoundB = compoundB;
+
+			compoundB->m_compound->tree.QueryAABB(&wrapper, aabb);
+
+			return true;
+		}
+
+		// The shape B is convex.
+		ReportChild(0);
+
+		return true;
+	}
+
+	// Find the earliest impact of the fixtures of the body A.
+	void FindImpact()
+	{
+		b3Transform xfA1 = bodySweepA.GetTransform(scalar(0));
+		b3Transform xfA2 = bodySweepA.GetTransform(scalar(1));
+
+		for (b3Fixture* f = bodyA->GetFixtureList().m_head; f; f = f->GetNext())
+		{
+			if (f->IsSensor())
+			{
+				continue;
+			}
+
+			const b3Shape* shape = f->GetShape();
+			if (shape->GetType() == b3Shape::e_mesh || shape->GetType() == b3Shape::e_heightField)
+			{
+				continue;
+			}
+
+			fixtureA = f;
+
+			b3AABB aabb1, aabb2;
+			shape->ComputeAABB(&aabb1, xfA1);
+			shape->ComputeAABB(&aabb2, xfA2);
+
+			broadPhase->QueryAABB(this, b3Combine(aabb1, aabb2));
+		}
+	}
+
+	b3ContactFilter* filter;
+	const b3BroadPhase* broadPhase;
+	
+	b3Body* bodyA;
+	b3Sweep bodySweepA;
+	b3Fixture* fixtureA;
+	scalar alpha;
+
+	b3Fixture* fixtureB;
+	b3Sweep bodySweepB;
+	b3MeshShape* meshB;
+
+	// The earliest impact
+	scalar t0;
+	b3Fixture* fixtureA0;
+	u32 childIndexA0;
+	b3Fixture* fixtureB0;
+	u32 childIndexB0;
+};
+
+// "Continuous Collision", Erin Catto
+// The fast bodies are sub-stepped alone. Each impact moves the body to the time of impact 
+// and removes the approach velocity of the body, with restitution and friction. 
+// The body then moves with the new velocity for the rest of the step.
+// The contact solver handles the contact in the next steps.
+void b3World::SolveTOI(scalar dt)
+{
+	B3_PROFILE(m_profiler, "Solve TOI");
+
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		// The body must be dynamic and moved in this step.
+		if (b->m_type != e_dynamicBody || (b->m_flags & b3Body::e_islandFlag) == 0)
+		{
+			continue;
+		}
+
+		b3Vec3 v = b->LinearVelocity();
+		b3Vec3 w = b->AngularVelocity();
+
+		// A body is fast if it can move more than its smallest extent in this step.
+		if (b->IsBullet() == false)
+		{
+			scalar maxMotion = dt * (b3Length(v) + b3Length(w) * b->m_maxExtent);
+			if (maxMotion < b->m_minExtent)
+			{
+				continue;
+			}
+		}
+
+		b3Sweep& sweep = b->Sweep();
+		
+		// Keep the start of the step for the mid-phase.
+		b3Vec3 worldCenter0 = sweep.worldCenter0;
+		b3Quat orientation0 = sweep.orientation0;
+
+		// The fraction of the step done
+		scalar alpha = scalar(0);
+		bool moved = false;
+
+		for (u32 iteration = 0; iteration < B3_MAX_TOI_SUB_STEPS; ++iteration)
+		{
+			b3WorldTOIQueryWrapper wrapper;
+			wrapper.filter = m_contactManager.m_contactFilter;
+			wrapper.broadPhase = &m_contactManager.m_broadPhase;
+			wrapper.bodyA = b;
+			wrapper.bodySweepA = sweep;
+			wrapper.alpha = alpha;
+			wrapper.t0 = scalar(1);
+			wrapper.fixtureA0 = nullptr;
+			wrapper.childIndexA0 = B3_MAX_U32;
+			wrapper.fixtureB0 = nullptr;
+			wrapper.childIndexB0 = B3_MAX_U32;
+			
+			wrapper.FindImpact();
+
+			if (wrapper.fixtureB0 == nullptr)
+			{
+				break;
+			}
+
+			moved = true;
+
+			// Move the body to the time of impact.
+			scalar t = wrapper.t0;
+			sweep.Advance(t);
+			alpha += t * (scalar(1) - alpha);
+
+			b3Vec3 c = sweep.worldCenter0;
+			b3Quat q = sweep.orientation0;
+
+			// Compute the contact point and normal at the time of impact.
+			b3Fixture* fixtureA = wrapper.fixtureA0;
+			b3Fixture* fixtureB = wrapper.fixtureB0;
+			b3Body* bodyB = fixtureB->GetBody();
+			b3Sweep bodySweepB = b3GetRemainingSweep(bodyB, alpha);
+
+			b3ShapeGJKProxy proxyA, proxyB;
+			b3Sweep sweepA, sweepB;
+			b3GetChildSweep(&proxyA, &sweepA, fixtureA, wrapper.childIndexA0, sweep);
+			b3GetChildSweep(&proxyB, &sweepB, fixtureB, wrapper.childIndexB0, bodySweepB);
+
+			b3GJKOutput query = b3GJK(sweepA.GetTransform(scalar(0)), proxyA, sweepB.GetTransform(scalar(0)), proxyB, false);
+			
+			scalar totalRadius = proxyA.radius + proxyB.radius;
+
+			b3Vec3 normal(scalar(0), scalar(0), scalar(0));
+			if (query.distance > scalar(0))
+			{
+				normal = (query.point1 - query.point2) / query.distance;
+			}
+
+			b3Vec3 point = query.point2 + proxyB.radius * normal;
+			
+			// Velocity of the body B at the contact point
+			b3Vec3 vB(scalar(0), scalar(0), scalar(0));
+			if (bodyB->m_type == e_kinematicBody && bodyB->IsAwake())
+			{
+				b3Vec3 rB = point - bodySweepB.worldCenter0;
+				vB = bodyB->LinearVelocity() + b3Cross(bodyB->AngularVelocity(), rB);
+			}
+
+			// The response acts on the center of mass only. 
+			// An impulse at the contact point would convert the approach into spin
+			// and let the body roll over the fixture.
+			b3Vec3 dv = v - vB;
+			scalar vn = b3Dot(dv, normal);
+
+			// The body stops at the impact if it runs out of sub-steps or doesn't approach. 
+			// The contact solver handles the contact in the next step.
+			if (iteration + 1 == B3_MAX_TOI_SUB_STEPS || vn >= scalar(0))
+			{
+				// Move the body into the contact slop so the contact finds the touching points.
+				scalar gap = query.distance - totalRadius + scalar(0.5) * B3_LINEAR_SLOP;
+				if (gap > scalar(0))
+				{
+					c -= gap * normal;
+				}
+				
+				sweep.worldCenter0 = c;
+				sweep.worldCenter = c;
+				sweep.orientation = q;
+				break;
+			}
+
+			// Move the body slightly away so the next sweep starts separated. 
+			// Otherwise the time of impact would be found at the start of the sweep and ignored.
+			scalar target = b3Max(B3_LINEAR_SLOP, totalRadius - scalar(3) * B3_LINEAR_SLOP);
+			scalar push = target + scalar(0.5) * B3_LINEAR_SLOP - query.distance;
+			if (push > scalar(0))
+			{
+				c += push * normal;
+				sweep.worldCenter0 = c;
+			}
+
+			// Stop the approach.
+			scalar restitution = scalar(0);
+			if (vn < -B3_VELOCITY_THRESHOLD)
+			{
+				restitution = b3MixRestitution(fixtureA->GetRestitution(), fixtureB->GetRestitution());
+			}
+
+			scalar dvn = -(scalar(1) + restitution) * vn;
+
+			// Remove the sliding velocity up to the friction limit.
+			b3Vec3 vt = dv - vn * normal;
+			scalar speed = b3Length(vt);
+			if (speed > B3_EPSILON)
+			{
+				scalar friction = b3MixFriction(fixtureA->GetFriction(), fixtureB->GetFriction());
+				scalar dvt = b3Min(speed, friction * dvn);
+
+				v -= (dvt / speed) * vt;
+			}
+
+			v += dvn * normal;
+
+			// Move the body with the new velocity in the rest of the step.
+			scalar h = (scalar(1) - alpha) * dt;
+			sweep.worldCenter = c + h * v;
+			sweep.orientation = b3Integrate(q, w, h);
+		}
+
+		if (moved == false)
+		{
+			continue;
 		}
 
-		// Update fixtures for mid-phase.
-		m_contactManager.SynchronizeFixtures();
+		sweep.worldCenter0 = worldCenter0;
+		sweep.orientation0 = orientation0;
 
-		// Find new contacts.
-		m_contactManager.FindNewContacts();
+		b->LinearVelocity() = v;
+		b->AngularVelocity() = w;
+		b->WorldInvInertia() = b3RotateToFrame(b->InvInertia(), sweep.orientation);
+		b->SynchronizeTransform();
+		b->SynchronizeFixtures();
 	}
 }
 
@@ -472,6 +1356,27 @@ bool b3World::RayCastSingle(b3RayCastSingleOutput* output, b3RayCastFilter* filt
 	return false;
 }
 
+// Get the convex child of a fixture and its world frame.
+static void b3GetChildProxy(b3ShapeGJKProxy* proxy, b3Transform* xf, const b3Fixture* fixture, u32 childIndex)
+{
+	const b3Shape* shape = fixture->GetShape();
+	*xf = fixture->GetBody()->GetTransform();
+
+	if (shape->GetType() == b3Shape::e_compound)
+	{
+		const b3CompoundShape* compound = (b3CompoundShape*)shape;
+		
+		b3Transform xfChild;
+		const b3Shape* child = compound->GetChildShape(&xfChild, childIndex);
+		
+		*xf = *xf * xfChild;
+		proxy->Set(child, 0);
+		return;
+	}
+
+	proxy->Set(shape, childIndex);
+}
+
 struct b3WorldShapeCastQueryWrapper
 {
 	struct MeshQueryWrapper
@@ -479,54 +1384,134 @@ struct b3WorldShapeCastQueryWrapper
 		bool Report(u32 proxyId)
 		{
 			u32 triangleIndex = wrapper->meshB->m_mesh->tree.GetUserData(proxyId);
+			return wrapper->ReportChild(triangleIndex);
+		}
 
-			b3Body* bodyB = wrapper->fixtureB->GetBody();
-			b3Transform xfB = bodyB->GetTransform();
-			b3ShapeGJKProxy proxyB(wrapper->meshB, triangleIndex);
+		b3WorldShapeCastQueryWrapper* wrapper;
+	};
 
-			b3TOIOutput toi = b3TimeOfImpact(wrapper->xfA, *wrapper->proxyA, wrapper->dA, xfB, proxyB, b3Vec3_zero);
+	struct HeightFieldQueryWrapper
+	{
+		bool Report(u32 triangleIndex)
+		{
+			return wrapper->ReportChild(triangleIndex);
+		}
 
-			b3TOIOutput::State state = toi.state;
-			scalar fraction = toi.t;
+		b3WorldShapeCastQueryWrapper* wrapper;
+	};
 
-			if (state == b3TOIOutput::e_touching)
-			{
-				if (fraction > wrapper->maxFraction)
-				{
-					return true;
-				}
+	struct CompoundQueryWrapper
+	{
+		bool Report(u32 proxyId)
+		{
+			u32 childIndex = compoundB->m_compound->tree.GetUserData(proxyId);
+			return wrapper->ReportChild(childIndex);
+		}
 
-				if (fraction < wrapper->fraction0)
-				{
-					wrapper->fraction0 = fraction;
-					wrapper->fixture0 = wrapper->fixtureB;
-					wrapper->childIndex0 = triangleIndex;
-				}
+		b3WorldShapeCastQueryWrapper* wrapper;
+		const b3CompoundShape* compoundB;
+	};
 
-				if (wrapper->listener)
-				{
-					b3Transform xf;
-					xf.rotation = wrapper->xfA.rotation;
-					xf.translation = wrapper->xfA.translation + fraction * wrapper->dA;
+	// Report a child of the shape B.
+	bool ReportChild(u32 childIndex)
+	{
+		b3Transform xfB;
+		b3ShapeGJKProxy proxyB;
+		b3GetChildProxy(&proxyB, &xfB, fixtureB, childIndex);
 
-					b3Vec3 point, normal;
-					wrapper->Evaluate(&point, &normal, xf, *wrapper->proxyA, xfB, proxyB);
+		b3TOIOutput toi = b3TimeOfImpact(xfA, *proxyA, dA, xfB, proxyB, b3Vec3_zero);
 
-					wrapper->maxFraction = wrapper->listener->ReportFixture(wrapper->fixtureB, point, normal, fraction);
-					if (wrapper->maxFraction == scalar(0))
-					{
-						return false;
-					}
-				}
+		b3TOIOutput::State state = toi.state;
+		scalar fraction = toi.t;
 
+		if (state == b3TOIOutput::e_touching)
+		{
+			if (fraction > maxFraction)
+			{
 				return true;
 			}
 
+			if (fraction < fraction0)
+			{
+				fraction0 = fraction;
+				fixture0 = fixtureB;
+				childIndex0 = childIndex;
+			}
+
+			if (listener)
+			{
+				b3Transform xf;
+				xf.rotation = xfA.rotation;
+				xf.translation = xfA.translation + fraction * dA;
+
+				b3Vec3 point, normal;
+				Evaluate(&point, &normal, xf, *proxyA, xfB, proxyB);
+
+				maxFraction = listener->ReportFixture(fixtureB, point, normal, fraction);
+				if (maxFraction == scalar(0))
+				{
+					return false;
+				}
+			}
+
 			return true;
 		}
 
-		b3WorldShapeCastQueryWrapper* wrapper;
-	};
+		return true;
+	}
+
+	// Compute the AABB swept by the shape A in the frame of the unscaled shape B.
+	b3AABB ComputeSweptAABB(const b3Transform& xfB, const b3Vec3& scaleB) const
+	{
+		B3_ASSERT(scaleB.x != scalar(0));
+		B3_ASSERT(scaleB.y != scalar(0));
+		B3_ASSERT(scaleB.z != scalar(0));
+
+		b3Vec3 inv_scale;
+		inv_scale.x = scalar(1) / scaleB.x;
+		inv_scale.y = scalar(1) / scaleB.y;
+		inv_scale.z = scalar(1) / scaleB.z;
+
+		b3Transform xf = b3MulT(xfB, xfA);
+
+		// Compute the aabb in the space of the unscaled shape
+		b3AABB aabb;
+		shapeA->ComputeAABB(&aabb, xf);
+		aabb.Scale(inv_scale);
+
+		// Compute the displacement in the space of the unscaled shape
+		b3Vec3 displacement = b3MulC(xfB.rotation, dA);
+		displacement = b3Mul(inv_scale, displacement);
+
+		if (displacement.x < scalar(0))
+		{
+			aabb.lowerBound.x += displacement.x;
+		}
+		else
+		{
+			aabb.upperBound.x += displacement.x;
+		}
+
+		if (displacement.y < scalar(0))
+		{
+			aabb.lowerBound.y += displacement.y;
+		}
+		else
+		{
+			aabb.upperBound.y += displacement.y;
+		}
+
+		if (displacement.z < scalar(0))
+		{
+			aabb.lowerBound.z += displacement.z;
+		}
+		else
+		{
+			aabb.upperBound.z += displacement.z;
+		}
+
+		return aabb;
+	}
 
 	bool Report(u32 proxyId)
 	{
@@ -545,57 +1530,51 @@ struct b3WorldShapeCastQueryWrapper
 		{
 			meshB = (b3MeshShape*)fixtureB->GetShape();
 
-			B3_ASSERT(meshB->m_scale.x != scalar(0));
-			B3_ASSERT(meshB->m_scale.y != scalar(0));
-			B3_ASSERT(meshB->m_scale.z != scalar(0));
-
-			b3Vec3 inv_scale;
-			inv_scale.x = scalar(1) / meshB->m_scale.x;
-			inv_scale.y = scalar(1) / meshB->m_scale.y;
-			inv_scale.z = scalar(1) / meshB->m_scale.z;
+			b3AABB aabb = ComputeSweptAABB(xfB, meshB->m_scale);
 
-			b3Transform xf = b3MulT(xfB, xfA);
-
-			// Compute the aabb in the space of the unscaled tree
-			b3AABB aabb;
-			shapeA->ComputeAABB(&aabb, xf);
-			aabb.Scale(inv_scale);
+			MeshQueryWrapper wrapper;
+			wrapper.wrapper = this;
 
-			// Compute the displacement in the space of the unscaled tree
-			b3Vec3 displacement = b3MulC(xfB.rotation, dA);
-			displacement = b3Mul(inv_scale, displacement);
+			meshB->m_mesh->tree.QueryAABB(&wrapper, aabb);
 
-			if (displacement.x < scalar(0))
-			{
-				aabb.lowerBound.x += displacement.x;
-			}
-			else
+			if (maxFraction == scalar(0))
 			{
-				aabb.upperBound.x += displacement.x;
+				return false;
 			}
 
-			if (displacement.y < scalar(0))
-			{
-				aabb.lowerBound.y += displacement.y;
-			}
-			else
-			{
-				aabb.upperBound.y += displacement.y;
-			}
+			return true;
+		}
 
-			if (displacement.z < scalar(0))
-			{
-				aabb.lowerBound.z += displacement.z;
-			}
-			else
+		if (shapeB->GetType() == b3Shape::e_heightField)
+		{
+			b3HeightFieldShape* heightFieldB = (b3HeightFieldShape*)fixtureB->GetShape();
+
+			b3AABB aabb = ComputeSweptAABB(xfB, heightFieldB->m_scale);
+
+			HeightFieldQueryWrapper wrapper;
+			wrapper.wrapper = this;
+
+			heightFieldB->m_heightField->QueryAABB(&wrapper, aabb);
+
+			if (maxFraction == scalar(0))
 			{
-				aabb.upperBound.z += displacement.z;
+				return false;
 			}
 
-			MeshQueryWrapper wrapper;
+			return true;
+		}
+
+		if (shapeB->GetType() == b3Shape::e_compound)
+		{
+			const b3CompoundShape* compoundB = (b3CompoundShape*)fixtureB->GetShape();
+
+			b3AABB aabb = ComputeSweptAABB(xfB, b3Vec3(scalar(1), scalar(1), scalar(1)));
+
+			CompoundQueryWrapper wrapper;
 			wrapper.wrapper = this;
+			wrapper.compoundB = compoundB;
 
-			meshB->m_mesh->tree.QueryAABB(&wrapper, aabb);
+			compoundB->m_compound->tree.QueryAABB(&wrapper, aabb);
 
 			if (maxFraction == scalar(0))
 			{
@@ -686,8 +1665,8 @@ void b3World::ShapeCast(b3ShapeCastListener* listener, b3ShapeCastFilter* filter
 	const b3Shape* shape, const b3Transform& xf, const b3Vec3& displacement) const
 {
 	// The shape must be convex.
-	B3_ASSERT(shape->m_type != b3Shape::e_mesh);
-	if (shape->m_type == b3Shape::e_mesh)
+	B3_ASSERT(shape->m_type != b3Shape::e_mesh && shape->m_type != b3Shape::e_heightField && shape->m_type != b3Shape::e_compound);
+	if (shape->m_type == b3Shape::e_mesh || shape->m_type == b3Shape::e_heightField || shape->m_type == b3Shape::e_compound)
 	{
 		return;
 	}
@@ -743,8 +1722,8 @@ void b3World::ShapeCast(b3ShapeCastListener* listener, b3ShapeCastFilter* filter
 bool b3World::ShapeCastSingle(b3ShapeCastSingleOutput* output, b3ShapeCastFilter* filter, 
 	const b3Shape* shape, const b3Transform& xf, const b3Vec3& displacement) const
 {
-	B3_ASSERT(shape->m_type != b3Shape::e_mesh);
-	if (shape->m_type == b3Shape::e_mesh)
+	B3_ASSERT(shape->m_type != b3Shape::e_mesh && shape->m_type != b3Shape::e_heightField && shape->m_type != b3Shape::e_compound);
+	if (shape->m_type == b3Shape::e_mesh || shape->m_type == b3Shape::e_heightField || shape->m_type == b3Shape::e_compound)
 	{
 		return false;
 	}
@@ -801,10 +1780,9 @@ bool b3World::ShapeCastSingle(b3ShapeCastSingleOutput* output, b3ShapeCastFilter
 		return false;
 	}
 
-	b3ShapeGJKProxy proxyB(wrapper.fixture0->GetShape(), wrapper.childIndex0);
-
-	b3Body* bodyB = wrapper.fixture0->GetBody();
-	b3Transform xfB = bodyB->GetTransform();
+	b3Transform xfB;
+	b3ShapeGJKProxy proxyB;
+	b3GetChildProxy(&proxyB, &xfB, wrapper.fixture0, wrapper.childIndex0);
 	
 	b3Transform xft;
 	xft.translation = xf.translation + wrapper.fraction0 * displacement;
@@ -847,6 +1825,274 @@ void b3World::QueryAABB(b3QueryListener* listener, b3QueryFilter* filter, const
 	m_contactManager.m_broadPhase.QueryAABB(&wrapper, aabb);
 }
 
+// Geometry referenced by a shape.
+struct b3ShapeData
+{
+	bool operator<(const b3ShapeData& other) const
+	{
+		return data < other.data;
+	}
+
+	const void* data;
+	u32 size;
+};
+
+static bool b3GetShapeData(b3ShapeData* out, const b3Shape* shape)
+{
+	switch (shape->GetType())
+	{
+	case b3Shape::e_hull:
+	{
+		const b3Hull* hull = ((b3HullShape*)shape)->m_hull;
+		out->data = hull;
+		out->size = hull->GetSize();
+		return true;
+	}
+	case b3Shape::e_mesh:
+	{
+		const b3Mesh* mesh = ((b3MeshShape*)shape)->m_mesh;
+		out->data = mesh;
+		out->size = mesh->GetSize();
+		return true;
+	}
+	case b3Shape::e_heightField:
+	{
+		const b3HeightField* heightField = ((b3HeightFieldShape*)shape)->m_heightField;
+		out->data = heightField;
+		out->size = heightField->GetSize();
+		return true;
+	}
+	case b3Shape::e_compound:
+	{
+		const b3Compound* compound = ((b3CompoundShape*)shape)->m_compound;
+		out->data = compound;
+		out->size = compound->GetSize();
+		return true;
+	}
+	default:
+	{
+		return false;
+	}
+	}
+}
+
+void b3World::GetMemoryStats(b3WorldMemoryStats* stats) const
+{
+	m_blockAllocator.GetStats(&stats->blockStats);
+	m_stackAllocator.GetStats(&stats->stackStats);
+
+	stats->bodyCount = m_bodyList.m_count;
+	stats->bodyStorageCapacity = m_bodyStorage.m_capacity;
+	stats->bodyStorageSize = m_bodyStorage.GetSize();
+
+	stats->fixtureCount = 0;
+	stats->fixtureEdgeSize = 0;
+	stats->shapeSize = 0;
+	stats->shapeDataSize = 0;
+
+	// Shapes can share geometry. Collect it and count each one once.
+	b3StackArray<b3ShapeData, 256> shapeData;
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		for (b3Fixture* f = b->m_fixtureList.m_head; f; f = f->m_next)
+		{
+			++stats->fixtureCount;
+
+			if (f->m_contactEdges.IsHeapAllocated())
+			{
+				stats->fixtureEdgeSize += f->m_contactEdges.Capacity() * sizeof(b3ContactEdge);
+			}
+
+			stats->shapeSize += f->m_shape->GetSize();
+
+			b3ShapeData data;
+			if (b3GetShapeData(&data, f->m_shape))
+			{
+				shapeData.PushBack(data);
+			}
+		}
+	}
+
+	std::sort(shapeData.Begin(), shapeData.Begin() + shapeData.Count());
+	for (u32 i = 0; i < shapeData.Count(); ++i)
+	{
+		if (i > 0 && shapeData[i].data == shapeData[i - 1].data)
+		{
+			continue;
+		}
+		stats->shapeDataSize += shapeData[i].size;
+	}
+
+	stats->jointCount = m_jointManager.m_jointList.m_count;
+
+	const b3BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	const b3DynamicTree* tree = &broadPhase->GetTree();
+	stats->treeNodeCount = tree->GetNodeCount();
+	stats->treeNodeCapacity = tree->GetNodeCapacity();
+	stats->treeSize = tree->GetSize();
+
+	stats->moveBufferCapacity = broadPhase->GetMoveCapacity();
+	stats->pairBufferCapacity = broadPhase->GetPairCapacity();
+	stats->broadPhaseBufferSize = stats->moveBufferCapacity * sizeof(u32) + stats->pairBufferCapacity * sizeof(b3Pair);
+
+	stats->contactCount = 0;
+	stats->contactSize = 0;
+	stats->contactArraySize = 0;
+	stats->manifoldCount = 0;
+	stats->manifoldCapacity = 0;
+	stats->manifoldSize = 0;
+	stats->contactCacheCount = 0;
+	stats->contactCacheSize = 0;
+
+	for (u32 i = 0; i < b3Shape::e_typeCount; ++i)
+	{
+		for (u32 j = 0; j < b3Shape::e_typeCount; ++j)
+		{
+			const b3Array<b3Contact*>& contacts = m_contactManager.m_contacts[i][j];
+			
+			if (contacts.IsHeapAllocated())
+			{
+				stats->contactArraySize += contacts.Capacity() * sizeof(b3Contact*);
+			}
+
+			if (contacts.Count() == 0)
+			{
+				continue;
+			}
+
+			u32 contactSize = b3Contact::GetSize(b3Shape::Type(i), b3Shape::Type(j));
+
+			for (u32 k = 0; k < contacts.Count(); ++k)
+			{
+				const b3Contact* c = contacts[k];
+
+				++stats->contactCount;
+				stats->contactSize += contactSize;
+				stats->manifoldCount += c->m_manifoldCount;
+				stats->manifoldCapacity += c->m_manifoldCapacity;
+				stats->manifoldSize += c->m_manifoldCapacity * sizeof(b3Manifold);
+
+				u32 cacheCount, cacheSize;
+				c->GetCacheStats(&cacheCount, &cacheSize);
+				stats->contactCacheCount += cacheCount;
+				stats->contactCacheSize += cacheSize;
+			}
+		}
+	}
+
+	u32 blockSize = 0;
+	for (u32 i = 0; i < b3_blockSizeCount; ++i)
+	{
+		const b3BlockSizeStats* s = stats->blockStats.sizes + i;
+		blockSize += s->blockCount * s->blockSize;
+	}
+	blockSize += stats->blockStats.largeAllocatedSize;
+
+	stats->totalSize = 0;
+	stats->totalSize += blockSize;
+	stats->totalSize += stats->stackStats.capacity;
+	for (u32 i = 0; i < m_contactManager.m_threadStackCount; ++i)
+	{
+		stats->totalSize += m_contactManager.m_threadStacks[i]->GetCapacity();
+	}
+	stats->totalSize += stats->bodyStorageSize;
+	stats->totalSize += stats->fixtureEdgeSize;
+	stats->totalSize += stats->treeSize;
+	stats->totalSize += stats->broadPhaseBufferSize;
+	stats->totalSize += stats->contactArraySize;
+	stats->totalSize += stats->contactCacheSize;
+	stats->totalSize += m_publishedCapacity * sizeof(b3Transform);
+}
+
+// Identifies the world topology in a saved state.
+struct b3WorldStateHeader
+{
+	u32 bodyCount;
+	u32 proxyCount;
+	u32 jointCount;
+	u32 articulationCount;
+};
+
+void b3World::SaveState(b3StateBuffer* buffer) const
+{
+	B3_ASSERT(m_contactManager.m_broadPhase.IsBulkLoading() == false);
+
+	buffer->Clear();
+
+	b3WorldStateHeader header;
+	header.bodyCount = m_bodyStorage.m_count;
+	header.proxyCount = m_contactManager.m_broadPhase.GetProxyCount();
+	header.jointCount = m_jointManager.m_jointList.m_count;
+	header.articulationCount = m_articulationList.m_count;
+	buffer->Write(header);
+
+	buffer->Write(m_flags);
+
+	m_contactManager.SaveState(buffer);
+
+	m_bodyStorage.SaveState(buffer);
+	for (u32 i = 0; i < m_bodyStorage.m_count; ++i)
+	{
+		const b3Body* b = m_bodyStorage.m_bodies[i];
+		buffer->Write(b->m_flags);
+		buffer->Write(b->m_sleepTime);
+	}
+
+	for (b3Joint* j = m_jointManager.m_jointList.m_head; j; j = j->m_next)
+	{
+		j->SaveState(buffer);
+	}
+
+	for (b3Articulation* a = m_articulationList.m_head; a; a = a->m_next)
+	{
+		a->SaveState(buffer);
+	}
+}
+
+bool b3World::RestoreState(b3StateBuffer* buffer)
+{
+	B3_ASSERT(m_contactManager.m_broadPhase.IsBulkLoading() == false);
+
+	buffer->Rewind();
+
+	b3WorldStateHeader header;
+	buffer->Read(header);
+
+	if (header.bodyCount != m_bodyStorage.m_count ||
+		header.proxyCount != m_contactManager.m_broadPhase.GetProxyCount() ||
+		header.jointCount != m_jointManager.m_jointList.m_count ||
+		header.articulationCount != m_articulationList.m_count)
+	{
+		return false;
+	}
+
+	buffer->Read(m_flags);
+
+	// Creating or destroying contacts can wake up bodies, so restore the contacts first.
+	m_contactManager.RestoreState(buffer, &m_stackAllocator);
+
+	m_bodyStorage.RestoreState(buffer);
+	for (u32 i = 0; i < m_bodyStorage.m_count; ++i)
+	{
+		b3Body* b = m_bodyStorage.m_bodies[i];
+		buffer->Read(b->m_flags);
+		buffer->Read(b->m_sleepTime);
+		b->MarkMoved();
+	}
+
+	for (b3Joint* j = m_jointManager.m_jointList.m_head; j; j = j->m_next)
+	{
+		j->RestoreState(buffer);
+	}
+
+	for (b3Articulation* a = m_articulationList.m_head; a; a = a->m_next)
+	{
+		a->RestoreState(buffer);
+	}
+
+	return true;
+}
+
 void b3World::Draw() const
 {
 	if (m_debugDraw == nullptr)
@@ -861,8 +2107,8 @@ void b3World::Draw() const
 		for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
 		{
 			b3Transform xf;
-			xf.rotation = b->m_sweep.orientation;
-			xf.translation = b->m_sweep.worldCenter;
+			xf.rotation = b->Sweep().orientation;
+			xf.translation = b->Sweep().worldCenter;
 			m_debugDraw->DrawTransform(xf);
 		}
 	}
@@ -896,6 +2142,11 @@ void b3World::Draw() const
 		{
 			j->Draw(m_debugDraw);
 		}
+
+		for (b3Articulation* a = m_articulationList.m_head; a; a = a->m_next)
+		{
+			a->Draw(m_debugDraw);
+		}
 	}
 
 	for (b3Contact* c = m_contactManager.m_contactList.m_head; c; c = c->m_next)
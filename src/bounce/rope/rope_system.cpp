@@ -0,0 +1,527 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson 
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/rope/rope_system.h>
+#include <bounce/common/thread_pool.h>
+#include <bounce/common/draw.h>
+#include <algorithm>
+
+// Number of ropes stepped by a task.
+// A batch is small enough for its link arrays to stay in the cache across the passes.
+static const u32 b3_ropeBatchSize = 64;
+
+template <typename T>
+static T* b3AllocArray(u32 count)
+{
+	return (T*)b3Alloc(count * sizeof(T));
+}
+
+b3RopeSystem::b3RopeSystem(const b3RopeSystemDef& def)
+{
+	B3_ASSERT(def.ropeCount > 0);
+
+	m_gravity.SetZero();
+	m_threadPool = nullptr;
+
+	m_ropeCount = def.ropeCount;
+	m_ropeSlots = b3AllocArray<u32>(m_ropeCount);
+	m_linkCounts = b3AllocArray<u32>(m_ropeCount);
+	m_linearDampings = b3AllocArray<scalar>(m_ropeCount);
+	m_angularDampings = b3AllocArray<scalar>(m_ropeCount);
+
+	// Sort the ropes by decreasing link count. 
+	// Keep the definition order for ropes of the same link count.
+	u32* ropes = b3AllocArray<u32>(m_ropeCount);
+	for (u32 i = 0; i < m_ropeCount; ++i)
+	{
+		B3_ASSERT(def.ropes[i].count > 0);
+		ropes[i] = i;
+	}
+
+	std::stable_sort(ropes, ropes + m_ropeCount, [&def](u32 a, u32 b)
+	{
+		return def.ropes[a].count > def.ropes[b].count;
+	});
+
+	for (u32 i = 0; i < m_ropeCount; ++i)
+	{
+		const b3RopeDef& rd = def.ropes[ropes[i]];
+
+		m_ropeSlots[ropes[i]] = i;
+		m_linkCounts[i] = rd.count;
+		m_linearDampings[i] = rd.linearDamping;
+		m_angularDampings[i] = rd.angularDamping;
+	}
+
+	m_maxLinkCount = m_linkCounts[0];
+	m_activeCounts = b3AllocArray<u32>(m_maxLinkCount);
+	m_linkOffsets = b3AllocArray<u32>(m_maxLinkCount);
+
+	m_linkCount = 0;
+	for (u32 j = 0; j < m_maxLinkCount; ++j)
+	{
+		u32 activeCount = 0;
+		while (activeCount < m_ropeCount && m_linkCounts[activeCount] > j)
+		{
+			++activeCount;
+		}
+
+		m_activeCounts[j] = activeCount;
+		m_linkOffsets[j] = m_linkCount;
+		m_linkCount += activeCount;
+	}
+
+	m_masses = b3AllocArray<scalar>(m_linkCount);
+	m_inertias = b3AllocArray<scalar>(m_linkCount);
+	m_jointOffsets = b3AllocArray<b3Vec3>(m_linkCount);
+	m_jointRotations = b3AllocArray<b3Quat>(m_linkCount);
+	m_jointVelocities = b3AllocArray<b3Vec3>(m_linkCount);
+	m_transforms = b3AllocArray<b3Transform>(m_linkCount);
+	m_angularVelocities = b3AllocArray<b3Vec3>(m_linkCount);
+	m_linearVelocities = b3AllocArray<b3Vec3>(m_linkCount);
+	m_invTransforms = b3AllocArray<b3Transform>(m_linkCount);
+	m_rotations = b3AllocArray<b3Mat33>(m_linkCount);
+	m_angularBiases = b3AllocArray<b3Vec3>(m_linkCount);
+	m_linearBiases = b3AllocArray<b3Vec3>(m_linkCount);
+	m_articulatedMasses = b3AllocArray<b3Mat33>(m_linkCount);
+	m_articulatedForces = b3AllocArray<b3Vec3>(m_linkCount);
+	m_invD = b3AllocArray<b3Mat33>(m_linkCount);
+	m_u = b3AllocArray<b3Vec3>(m_linkCount);
+	m_jointAccelerations = b3AllocArray<b3Vec3>(m_linkCount);
+	m_angularAccelerations = b3AllocArray<b3Vec3>(m_linkCount);
+	m_linearAccelerations = b3AllocArray<b3Vec3>(m_linkCount);
+
+	// Same setup as b3Rope.
+	for (u32 i = 0; i < m_ropeCount; ++i)
+	{
+		const b3RopeDef& rd = def.ropes[ropes[i]];
+
+		for (u32 j = 0; j < rd.count; ++j)
+		{
+			u32 index = GetLinkIndex(i, j);
+
+			scalar m = rd.masses[j];
+
+			// Simplify r = 1
+			m_masses[index] = m;
+			m_inertias[index] = m * scalar(0.4);
+
+			m_transforms[index].rotation.SetIdentity();
+			m_transforms[index].translation = rd.vertices[j];
+			m_jointRotations[index].SetIdentity();
+			m_jointVelocities[index].SetZero();
+			m_angularVelocities[index].SetZero();
+			m_linearVelocities[index].SetZero();
+			m_jointOffsets[index].SetZero();
+
+			if (j > 0)
+			{
+				// Set the joint anchor to the parent body position to simulate a rope.
+				b3Transform X_J;
+				X_J.rotation.SetIdentity();
+				X_J.translation = rd.vertices[j - 1];
+
+				m_jointOffsets[index] = b3MulT(m_transforms[index], X_J).translation;
+			}
+		}
+	}
+
+	b3Free(ropes);
+}
+
+b3RopeSystem::~b3RopeSystem()
+{
+	b3Free(m_ropeSlots);
+	b3Free(m_linkCounts);
+	b3Free(m_linearDampings);
+	b3Free(m_angularDampings);
+	b3Free(m_activeCounts);
+	b3Free(m_linkOffsets);
+	b3Free(m_masses);
+	b3Free(m_inertias);
+	b3Free(m_jointOffsets);
+	b3Free(m_jointRotations);
+	b3Free(m_jointVelocities);
+	b3Free(m_transforms);
+	b3Free(m_angularVelocities);
+	b3Free(m_linearVelocities);
+	b3Free(m_invTransforms);
+	b3Free(m_rotations);
+	b3Free(m_angularBiases);
+	b3Free(m_linearBiases);
+	b3Free(m_articulatedMasses);
+	b3Free(m_articulatedForces);
+	b3Free(m_invD);
+	b3Free(m_u);
+	b3Free(m_jointAccelerations);
+	b3Free(m_angularAccelerations);
+	b3Free(m_linearAccelerations);
+}
+
+void b3RopeSystem::SetPosition(u32 rope, const b3Vec3& position)
+{
+	B3_ASSERT(rope < m_ropeCount);
+	m_transforms[m_ropeSlots[rope]].translation = position;
+}
+
+const b3Vec3& b3RopeSystem::GetPosition(u32 rope) const
+{
+	B3_ASSERT(rope < m_ropeCount);
+	return m_transforms[m_ropeSlots[rope]].translation;
+}
+
+void b3RopeSystem::SetLinearVelocity(u32 rope, const b3Vec3& linearVelocity)
+{
+	B3_ASSERT(rope < m_ropeCount);
+	u32 index = m_ropeSlots[rope];
+	m_linearVelocities[index] = b3MulC(m_transforms[index].rotation, linearVelocity);
+}
+
+b3Vec3 b3RopeSystem::GetLinearVelocity(u32 rope) const
+{
+	B3_ASSERT(rope < m_ropeCount);
+	u32 index = m_ropeSlots[rope];
+	return b3Mul(m_transforms[index].rotation, m_linearVelocities[index]);
+}
+
+void b3RopeSystem::SetAngularVelocity(u32 rope, const b3Vec3& angularVelocity)
+{
+	B3_ASSERT(rope < m_ropeCount);
+	u32 index = m_ropeSlots[rope];
+	m_angularVelocities[index] = b3MulC(m_transforms[index].rotation, angularVelocity);
+}
+
+b3Vec3 b3RopeSystem::GetAngularVelocity(u32 rope) const
+{
+	B3_ASSERT(rope < m_ropeCount);
+	u32 index = m_ropeSlots[rope];
+	return b3Mul(m_transforms[index].rotation, m_angularVelocities[index]);
+}
+
+const b3Transform& b3RopeSystem::GetLinkTransform(u32 rope, u32 link) const
+{
+	B3_ASSERT(rope < m_ropeCount);
+	u32 slot = m_ropeSlots[rope];
+	B3_ASSERT(link < m_linkCounts[slot]);
+	return m_transforms[GetLinkIndex(slot, link)];
+}
+
+struct b3RopeSystemStepTask
+{
+	static void Run(void* context, u32 begin, u32 end, u32 threadIndex)
+	{
+		B3_NOT_USED(threadIndex);
+		b3RopeSystemStepTask* task = (b3RopeSystemStepTask*)context;
+		task->system->StepRopes(begin, end, task->h);
+	}
+
+	b3RopeSystem* system;
+	scalar h;
+};
+
+void b3RopeSystem::Step(scalar h)
+{
+	b3RopeSystemStepTask task;
+	task.system = this;
+	task.h = h;
+
+	if (m_threadPool && m_threadPool->GetThreadCount() > 1)
+	{
+		m_threadPool->ParallelFor(m_ropeCount, b3_ropeBatchSize, b3RopeSystemStepTask::Run, &task);
+	}
+	else
+	{
+		// Step in batches anyway, for the cache.
+		for (u32 begin = 0; begin < m_ropeCount; begin += b3_ropeBatchSize)
+		{
+			u32 end = b3Min(begin + b3_ropeBatchSize, m_ropeCount);
+			StepRopes(begin, end, h);
+		}
+	}
+}
+
+// This is b3Rope::Step with the loops over the links and the ropes interchanged.
+// The ropes are independent, so any batch of ropes can be stepped by any thread.
+// 
+// In the frame of a link, with the joint offset e and the motion subspace S = [I, e x I], 
+// the articulated inertia of a link is [I * 1, 0; 0, M], where M is the linear block, 
+// because each child link only adds a linear block at the center of this link. Therefore,
+// U = [M * skew(e), I * 1]
+// D = I * 1 - skew(e) * M * skew(e)
+// and the articulated inertia sent to the parent link is the linear block
+// K = M - M * skew(e) * D^-1 * (M * skew(e))^T
+void b3RopeSystem::StepRopes(u32 begin, u32 end, scalar h)
+{
+	B3_ASSERT(begin < end);
+
+	// Propagate down velocities, inertias and bias forces.
+	for (u32 i = begin; i < end; ++i)
+	{
+		scalar m = m_masses[i];
+		b3Vec3 w = m_angularVelocities[i];
+		b3Vec3 v = m_linearVelocities[i];
+
+		m_invTransforms[i] = b3Inverse(m_transforms[i]);
+
+		if (m == scalar(0))
+		{
+			m_articulatedMasses[i].SetZero();
+			m_articulatedForces[i].SetZero();
+		}
+		else
+		{
+			// Pdot - gravity - damping
+			b3Vec3 g = b3Mul(m_invTransforms[i].rotation, m_gravity);
+
+			m_articulatedMasses[i] = b3Mat33Diagonal(m);
+			m_articulatedForces[i] = b3Cross(w, m * v) - g + m_linearDampings[i] * m * v;
+		}
+	}
+
+	for (u32 j = 1; j < m_maxLinkCount; ++j)
+	{
+		u32 last = b3Min(end, m_activeCounts[j]);
+		for (u32 slot = begin; slot < last; ++slot)
+		{
+			u32 i = GetLinkIndex(slot, j);
+			u32 parent = GetLinkIndex(slot, j - 1);
+
+			scalar m = m_masses[i];
+			b3Vec3 e = m_jointOffsets[i];
+			b3Vec3 qd = m_jointVelocities[i];
+
+			// The joint frame is located at the parent link.
+			b3Transform X_i_j;
+			X_i_j.rotation = b3Conjugate(m_jointRotations[i]);
+			X_i_j.translation = e;
+
+			m_invTransforms[i] = X_i_j * m_invTransforms[parent];
+
+			b3Mat33 E = X_i_j.rotation.GetRotationMatrix();
+			m_rotations[i] = E;
+
+			b3Vec3 w = E * m_angularVelocities[parent] + qd;
+			b3Vec3 v = E * m_linearVelocities[parent] + b3Cross(e, w);
+
+			m_angularVelocities[i] = w;
+			m_linearVelocities[i] = v;
+
+			// v x jv
+			m_angularBiases[i] = b3Cross(w, qd);
+			m_linearBiases[i] = b3Cross(v, qd) + b3Cross(w, b3Cross(e, qd));
+
+			// Pdot - gravity - damping
+			b3Vec3 g = b3Mul(m_invTransforms[i].rotation, m_gravity);
+
+			m_articulatedMasses[i] = b3Mat33Diagonal(m);
+			m_articulatedForces[i] = b3Cross(w, m * v) - g + m_linearDampings[slot] * m * v;
+		}
+	}
+
+	// Propagate up bias forces and inertias.
+	for (u32 j = m_maxLinkCount - 1; j >= 1; --j)
+	{
+		u32 last = b3Min(end, m_activeCounts[j]);
+		for (u32 slot = begin; slot < last; ++slot)
+		{
+			u32 i = GetLinkIndex(slot, j);
+			u32 parent = GetLinkIndex(slot, j - 1);
+
+			scalar I = m_inertias[i];
+			b3Vec3 e = m_jointOffsets[i];
+			b3Mat33 M = m_articulatedMasses[i];
+			b3Vec3 F = m_articulatedForces[i];
+
+			// The torque is only the damping torque.
+			b3Vec3 T = m_angularDampings[slot] * I * m_angularVelocities[i];
+
+			// U_n = M * skew(e)
+			b3Mat33 P = M * b3Skew(e);
+
+			// D = S^T * U
+			b3Mat33 D = b3Mat33Diagonal(I) - b3Skew(e) * P;
+
+			b3Mat33 invD = b3SymInverse(D);
+			m_invD[i] = invD;
+
+			// u = tau - S^T * F_A
+			b3Vec3 u = -(T + b3Cross(F, e));
+			m_u[i] = u;
+
+			b3Mat33 P_invD = P * invD;
+
+			// I_a = I_A - U * D^-1 * U^T
+			b3Mat33 K = M - P_invD * b3Transpose(P);
+
+			// F_a = F_A + I_a * c + U * D^-1 * u
+			b3Vec3 F_a = F + K * m_linearBiases[i] + P_invD * (u - I * m_angularBiases[i]);
+
+			b3Mat33 E = m_rotations[i];
+
+			m_articulatedMasses[parent] += b3MulT(E, K * E);
+			m_articulatedForces[parent] += b3MulT(E, F_a);
+		}
+	}
+
+	// Propagate down accelerations
+	for (u32 i = begin; i < end; ++i)
+	{
+		scalar m = m_masses[i];
+
+		if (m == scalar(0))
+		{
+			m_angularAccelerations[i].SetZero();
+			m_linearAccelerations[i].SetZero();
+		}
+		else
+		{
+			// a = I^-1 * F 
+			m_angularAccelerations[i] = -m_angularDampings[i] * m_angularVelocities[i];
+			m_linearAccelerations[i] = m_articulatedMasses[i].Solve(-m_articulatedForces[i]);
+		}
+	}
+
+	for (u32 j = 1; j < m_maxLinkCount; ++j)
+	{
+		u32 last = b3Min(end, m_activeCounts[j]);
+		for (u32 slot = begin; slot < last; ++slot)
+		{
+			u32 i = GetLinkIndex(slot, j);
+			u32 parent = GetLinkIndex(slot, j - 1);
+
+			b3Vec3 e = m_jointOffsets[i];
+			b3Mat33 E = m_rotations[i];
+
+			b3Vec3 parent_w = E * m_angularAccelerations[parent];
+			b3Vec3 a_w = parent_w + m_angularBiases[i];
+			b3Vec3 a_v = E * m_linearAccelerations[parent] + b3Cross(e, parent_w) + m_linearBiases[i];
+
+			// u - U^T * a
+			b3Vec3 b = m_u[i] - b3Cross(m_articulatedMasses[i] * a_v, e) - m_inertias[i] * a_w;
+
+			// D^-1 * b
+			b3Vec3 qdd = m_invD[i] * b;
+			m_jointAccelerations[i] = qdd;
+
+			m_angularAccelerations[i] = a_w + qdd;
+			m_linearAccelerations[i] = a_v + b3Cross(e, qdd);
+		}
+	}
+
+	// Integrate
+	
+	// Integrate base
+	for (u32 i = begin; i < end; ++i)
+	{
+		b3Vec3 x = m_transforms[i].translation;
+		b3Quat q = m_transforms[i].rotation;
+
+		b3Vec3 v = m_linearVelocities[i];
+		b3Vec3 w = m_angularVelocities[i];
+
+		b3Vec3 v_dot = m_linearAccelerations[i];
+		b3Vec3 w_dot = m_angularAccelerations[i];
+		
+		// Integrate acceleration
+		v += h * v_dot;
+		w += h * w_dot;
+
+		// Integrate velocity		
+		x += h * v;
+
+		b3Quat q_w(w.x, w.y, w.z, scalar(0));
+		b3Quat q_dot = scalar(0.5) * q * q_w;
+		q += h * q_dot;
+		q.Normalize();
+
+		m_linearVelocities[i] = v;
+		m_angularVelocities[i] = w;
+
+		m_transforms[i].translation = x;
+		m_transforms[i].rotation = q;
+
+		m_invTransforms[i] = b3Inverse(m_transforms[i]);
+	}
+	
+	// Integrate joints and propagate down transforms
+	for (u32 j = 1; j < m_maxLinkCount; ++j)
+	{
+		u32 last = b3Min(end, m_activeCounts[j]);
+		for (u32 slot = begin; slot < last; ++slot)
+		{
+			u32 i = GetLinkIndex(slot, j);
+			u32 parent = GetLinkIndex(slot, j - 1);
+
+			// Integrate acceleration
+			m_jointVelocities[i] += h * m_jointAccelerations[i];
+
+			// Integrate velocity
+			b3Vec3 v = m_jointVelocities[i];
+			b3Quat q_w(v.x, v.y, v.z, scalar(0));
+			b3Quat q_dot = scalar(0.5) * m_jointRotations[i] * q_w;
+
+			m_jointRotations[i] += h * q_dot;
+			m_jointRotations[i].Normalize();
+
+			b3Transform X_i_j;
+			X_i_j.rotation = b3Conjugate(m_jointRotations[i]);
+			X_i_j.translation = m_jointOffsets[i];
+
+			m_invTransforms[i] = X_i_j * m_invTransforms[parent];
+			m_transforms[i] = b3Inverse(m_invTransforms[i]);
+		}
+	}
+}
+
+void b3RopeSystem::Draw(b3Draw* draw) const
+{
+	for (u32 slot = 0; slot < m_ropeCount; ++slot)
+	{
+		{
+			const b3Transform& X = m_transforms[slot];
+
+			draw->DrawTransform(X);
+			draw->DrawSolidSphere(X.rotation.GetXAxis(), X.translation, scalar(0.2), b3Color_green);
+		}
+
+		for (u32 j = 1; j < m_linkCounts[slot]; ++j)
+		{
+			u32 i = GetLinkIndex(slot, j);
+			u32 parent = GetLinkIndex(slot, j - 1);
+
+			b3Transform X_J;
+			X_J.rotation = m_transforms[parent].rotation;
+			X_J.translation = m_transforms[parent].translation;
+			
+			b3Transform X_J_j;
+			X_J_j.rotation.SetIdentity();
+			X_J_j.translation = m_jointOffsets[i];
+			
+			b3Transform X_J0 = m_transforms[i] * X_J_j;
+
+			draw->DrawTransform(X_J);
+			draw->DrawPoint(X_J.translation, scalar(5), b3Color_red);
+
+			draw->DrawTransform(X_J0);
+			draw->DrawPoint(X_J0.translation, scalar(5), b3Color_red);
+
+			draw->DrawTransform(m_transforms[i]);
+			draw->DrawSolidSphere(m_transforms[i].rotation.GetXAxis(), m_transforms[i].translation, scalar(0.2), b3Color_green);
+		}
+	}
+}